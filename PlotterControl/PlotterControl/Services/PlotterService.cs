@@ -30,6 +30,9 @@ namespace PlotterControl.Services
         private Task _plotExecutionTask;
         private volatile bool _isPlottingPaused;
 
+        // Firmware pushes status lines (M154), so the periodic M114/M119 poll is not needed
+        private volatile bool _autoReportActive;
+
         public event Action<MachineState> MachineStateChanged;
         public event Action<string> LogReceived;
         public event Action<PlotProgress> PlotProgressChanged; // New event for plot progress
@@ -40,6 +43,7 @@ namespace PlotterControl.Services
         private const int RESPONSE_TIMEOUT_MS = 30000;  // Timeout for normal moves
         private const int HOMING_TIMEOUT_MS = 120000;   // 2 minutes for full G28 (all 3 axes)
         private const double DEFAULT_Z_FEEDRATE_MM_MIN = 600; // From firmware config.h: MAX_VELOCITY_Z * 60
+        private const int AUTO_REPORT_INTERVAL_MS = 500; // M154 status line interval
 
         public PlotterService(SerialConnection serialConnection, ConfigManager configManager)
         {
@@ -62,6 +66,14 @@ namespace PlotterControl.Services
 
         private void HandleSerialDataReceived(string line)
         {
+            // M154 status lines are unsolicited: update state only, keep them out of the
+            // response queue and the serial log
+            if (line.StartsWith("<") && line.EndsWith(">"))
+            {
+                ParseStatusReport(line);
+                return;
+            }
+
             Logger.Info($"< {line}");
             LogReceived?.Invoke(line);
 
@@ -247,6 +259,15 @@ namespace PlotterControl.Services
                 Logger.Info($"Firmware already identified from boot: {_machineState.FirmwareName}");
             }
 
+            // Older firmware answers M154 with an error; fall back to polling then
+            _autoReportActive = await SendGCodeAndAwaitOkAsync($"M154 S{AUTO_REPORT_INTERVAL_MS}");
+            if (!_autoReportActive)
+            {
+                Logger.Info("Firmware has no status auto-report, polling M114/M119 instead.");
+                await Task.Delay(100);
+                while (_responseQueue.TryDequeue(out _)) { } // Trailing ok after the error
+            }
+
             UpdateMachineState(ms => ms.StatusMessage = "Ready.");
             StartPollingMachineState();
             return true;
@@ -257,6 +278,7 @@ namespace PlotterControl.Services
             StopPlot(); // Stop any running plot
             _readLoopCancellationTokenSource?.Cancel(); // Stop polling
             _readLoopTask?.Wait(100);
+            _autoReportActive = false;
 
             _serialConnection.Close();
             UpdateMachineState(ms => ms.StatusMessage = "Disconnected");
@@ -610,8 +632,9 @@ namespace PlotterControl.Services
                     }
 
                     // Only poll when connected AND NOT busy to avoid command lock deadlocks
-                    // during homing, plotting, or other long operations.
-                    if (_serialConnection.IsOpen && !_machineState.IsBusy && !_machineState.IsPlotting)
+                    // during homing, plotting, or other long operations. Not needed at all
+                    // while the firmware auto-reports.
+                    if (_serialConnection.IsOpen && !_autoReportActive && !_machineState.IsBusy && !_machineState.IsPlotting)
                     {
                         await GetMachineStateAsync();
                     }
@@ -636,6 +659,31 @@ namespace PlotterControl.Services
             }
         }
 
+        private void ParseStatusReport(string report)
+        {
+            // Example: <Run X:12.34 Y:5.60 Z:2.00 Q:3 B:1 SD:45 T:1234 E:Z>
+            // Position is from the step counters; E lists triggered endstops ("-" = none)
+            var posMatch = Regex.Match(report, @"X:([\d.-]+)\s+Y:([\d.-]+)\s+Z:([\d.-]+)");
+            var endstopMatch = Regex.Match(report, @"E:([XYZ-]+)");
+
+            UpdateMachineState(ms =>
+            {
+                if (posMatch.Success)
+                {
+                    ms.CurrentX = double.Parse(posMatch.Groups[1].Value, CultureInfo.InvariantCulture);
+                    ms.CurrentY = double.Parse(posMatch.Groups[2].Value, CultureInfo.InvariantCulture);
+                    ms.CurrentZ = double.Parse(posMatch.Groups[3].Value, CultureInfo.InvariantCulture);
+                }
+                if (endstopMatch.Success)
+                {
+                    string triggered = endstopMatch.Groups[1].Value;
+                    ms.XMinTriggered = triggered.Contains('X');
+                    ms.YMinTriggered = triggered.Contains('Y');
+                    ms.ZMinTriggered = triggered.Contains('Z');
+                }
+            });
+        }
+
         private void ParseM115Response(string response)
         {
             // Example: FIRMWARE_NAME:SimplePlotter FIRMWARE_VERSION:1.0 PROTOCOL_VERSION:1.0 ...
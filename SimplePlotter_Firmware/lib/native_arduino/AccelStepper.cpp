@@ -0,0 +1,205 @@
+// SimplePlotter_Firmware/lib/native_arduino/AccelStepper.cpp
+
+#include "AccelStepper.h"
+
+AccelStepper::AccelStepper(uint8_t interface, uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4, bool enable) :
+    _direction(DIRECTION_CCW), _interface(interface), _pin{pin1, pin2}, _pinInverted{false, false},
+    _currentPos(0), _targetPos(0), _speed(0.0f), _maxSpeed(0.0f), _acceleration(0.0f),
+    _stepInterval(0), _lastStepTime(0), _minPulseWidth(1), _enableInverted(false), _enablePin(0xff),
+    _n(0), _c0(0.0f), _cn(0.0f), _cmin(1.0f)
+{
+    (void)pin3;
+    (void)pin4;
+    if (enable) enableOutputs();
+    // Some reasonable default
+    setAcceleration(1);
+    setMaxSpeed(1);
+}
+
+void AccelStepper::moveTo(long absolute) {
+    if (_targetPos != absolute) {
+        _targetPos = absolute;
+        computeNewSpeed();
+    }
+}
+
+void AccelStepper::move(long relative) {
+    moveTo(_currentPos + relative);
+}
+
+// One step if it is due, at most one per call
+bool AccelStepper::runSpeed() {
+    if (!_stepInterval) return false;
+
+    unsigned long time = micros();
+    if (time - _lastStepTime >= _stepInterval) {
+        if (_direction == DIRECTION_CW) _currentPos += 1;
+        else _currentPos -= 1;
+        step(_currentPos);
+        _lastStepTime = time;
+        return true;
+    }
+    return false;
+}
+
+bool AccelStepper::run() {
+    if (runSpeed()) computeNewSpeed();
+    return _speed != 0.0f || distanceToGo() != 0;
+}
+
+void AccelStepper::setCurrentPosition(long position) {
+    _targetPos = _currentPos = position;
+    _n = 0;
+    _stepInterval = 0;
+    _speed = 0.0f;
+}
+
+void AccelStepper::computeNewSpeed() {
+    long distanceTo = distanceToGo();
+    long stepsToStop = (long)((_speed * _speed) / (2.0f * _acceleration));
+
+    if (distanceTo == 0 && stepsToStop <= 1) {
+        // At the target and nearly stopped
+        _stepInterval = 0;
+        _speed = 0.0f;
+        _n = 0;
+        return;
+    }
+
+    if (distanceTo > 0) {
+        // Target is ahead: decelerate if we would overshoot or are going the wrong way
+        if (_n > 0) {
+            if ((stepsToStop >= distanceTo) || _direction == DIRECTION_CCW) _n = -stepsToStop;
+        } else if (_n < 0) {
+            if ((stepsToStop < distanceTo) && _direction == DIRECTION_CW) _n = -_n;
+        }
+    } else if (distanceTo < 0) {
+        if (_n > 0) {
+            if ((stepsToStop >= -distanceTo) || _direction == DIRECTION_CW) _n = -stepsToStop;
+        } else if (_n < 0) {
+            if ((stepsToStop < -distanceTo) && _direction == DIRECTION_CCW) _n = -_n;
+        }
+    }
+
+    if (_n == 0) {
+        // First step from stopped
+        _cn = _c0;
+        _direction = (distanceTo > 0) ? DIRECTION_CW : DIRECTION_CCW;
+    } else {
+        // Subsequent step. Works for accel (n is +_ve) and decel (n is -ve).
+        _cn = _cn - ((2.0f * _cn) / ((4.0f * _n) + 1));
+        _cn = max(_cn, _cmin);
+    }
+    _n++;
+    _stepInterval = _cn;
+    _speed = 1000000.0f / _cn;
+    if (_direction == DIRECTION_CCW) _speed = -_speed;
+}
+
+void AccelStepper::setMaxSpeed(float speed) {
+    if (speed < 0.0f) speed = -speed;
+    if (_maxSpeed != speed) {
+        _maxSpeed = speed;
+        _cmin = 1000000.0f / speed;
+        // Recompute _n from current speed and adjust speed if accelerating or cruising
+        if (_n > 0) {
+            _n = (long)((_speed * _speed) / (2.0f * _acceleration));
+            computeNewSpeed();
+        }
+    }
+}
+
+void AccelStepper::setAcceleration(float acceleration) {
+    if (acceleration == 0.0f) return;
+    if (acceleration < 0.0f) acceleration = -acceleration;
+    if (_acceleration != acceleration) {
+        // Recompute _n per Equation 17
+        _n = _n * (_acceleration / acceleration);
+        // New c0 per Equation 7, with correction per Equation 15
+        _c0 = 0.676f * sqrt(2.0f / acceleration) * 1000000.0f;
+        _acceleration = acceleration;
+        computeNewSpeed();
+    }
+}
+
+void AccelStepper::setSpeed(float speed) {
+    if (speed == _speed) return;
+    speed = constrain(speed, -_maxSpeed, _maxSpeed);
+    if (speed == 0.0f) {
+        _stepInterval = 0;
+    } else {
+        _stepInterval = fabs(1000000.0f / speed);
+        _direction = (speed > 0.0f) ? DIRECTION_CW : DIRECTION_CCW;
+    }
+    _speed = speed;
+}
+
+void AccelStepper::setOutputPins(uint8_t mask) {
+    for (uint8_t i = 0; i < 2; i++) {
+        digitalWrite(_pin[i], (mask & (1 << i)) ? (HIGH ^ _pinInverted[i]) : (LOW ^ _pinInverted[i]));
+    }
+}
+
+void AccelStepper::step(long step) {
+    (void)step;
+    // Direction first, else the driver sees a rogue pulse
+    setOutputPins(_direction ? 0b10 : 0b00);
+    setOutputPins(_direction ? 0b11 : 0b01); // Step HIGH
+    delayMicroseconds(_minPulseWidth);
+    setOutputPins(_direction ? 0b10 : 0b00); // Step LOW
+}
+
+void AccelStepper::disableOutputs() {
+    setOutputPins(0);
+    if (_enablePin != 0xff) {
+        pinMode(_enablePin, OUTPUT);
+        digitalWrite(_enablePin, LOW ^ _enableInverted);
+    }
+}
+
+void AccelStepper::enableOutputs() {
+    pinMode(_pin[0], OUTPUT);
+    pinMode(_pin[1], OUTPUT);
+    if (_enablePin != 0xff) {
+        pinMode(_enablePin, OUTPUT);
+        digitalWrite(_enablePin, HIGH ^ _enableInverted);
+    }
+}
+
+void AccelStepper::setEnablePin(uint8_t enablePin) {
+    _enablePin = enablePin;
+    if (_enablePin != 0xff) {
+        pinMode(_enablePin, OUTPUT);
+        digitalWrite(_enablePin, HIGH ^ _enableInverted);
+    }
+}
+
+void AccelStepper::setPinsInverted(bool directionInvert, bool stepInvert, bool enableInvert) {
+    _pinInverted[0] = stepInvert;
+    _pinInverted[1] = directionInvert;
+    _enableInverted = enableInvert;
+}
+
+void AccelStepper::runToPosition() {
+    while (run()) yield();
+}
+
+bool AccelStepper::runSpeedToPosition() {
+    if (_targetPos == _currentPos) return false;
+    if (_targetPos > _currentPos) _direction = DIRECTION_CW;
+    else _direction = DIRECTION_CCW;
+    return runSpeed();
+}
+
+void AccelStepper::runToNewPosition(long position) {
+    moveTo(position);
+    runToPosition();
+}
+
+void AccelStepper::stop() {
+    if (_speed != 0.0f) {
+        long stepsToStop = (long)((_speed * _speed) / (2.0f * _acceleration)) + 1; // Equation 16 (+integer rounding)
+        if (_speed > 0) move(stepsToStop);
+        else move(-stepsToStop);
+    }
+}
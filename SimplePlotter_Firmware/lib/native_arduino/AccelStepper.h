@@ -0,0 +1,79 @@
+// SimplePlotter_Firmware/lib/native_arduino/AccelStepper.h
+
+#ifndef ACCELSTEPPER_H
+#define ACCELSTEPPER_H
+
+#include <Arduino.h>
+
+// AccelStepper 1.64 for the native build, DRIVER interface only: the same speed
+// profile (David Austin's per-step approximation) and the same pin writes, so homing
+// and jog steps come out with the library's timing. Step pulses go through
+// digitalWrite() and delayMicroseconds() and cost virtual time like the real ones.
+class AccelStepper {
+public:
+    typedef enum {
+        FUNCTION = 0,
+        DRIVER = 1
+    } MotorInterfaceType;
+
+    AccelStepper(uint8_t interface = AccelStepper::DRIVER, uint8_t pin1 = 2, uint8_t pin2 = 3,
+                 uint8_t pin3 = 4, uint8_t pin4 = 5, bool enable = true);
+
+    void moveTo(long absolute);
+    void move(long relative);
+    bool run();
+    bool runSpeed();
+    void setMaxSpeed(float speed);
+    float maxSpeed() { return _maxSpeed; }
+    void setAcceleration(float acceleration);
+    float acceleration() { return _acceleration; }
+    void setSpeed(float speed);
+    float speed() { return _speed; }
+    long distanceToGo() { return _targetPos - _currentPos; }
+    long targetPosition() { return _targetPos; }
+    long currentPosition() { return _currentPos; }
+    void setCurrentPosition(long position);
+    void runToPosition();
+    bool runSpeedToPosition();
+    void runToNewPosition(long position);
+    void stop();
+    void disableOutputs();
+    void enableOutputs();
+    void setMinPulseWidth(unsigned int minWidth) { _minPulseWidth = minWidth; }
+    void setEnablePin(uint8_t enablePin = 0xff);
+    void setPinsInverted(bool directionInvert = false, bool stepInvert = false, bool enableInvert = false);
+    bool isRunning() { return !(_speed == 0.0f && _targetPos == _currentPos); }
+
+protected:
+    typedef enum {
+        DIRECTION_CCW = 0,
+        DIRECTION_CW = 1
+    } Direction;
+
+    void computeNewSpeed();
+    void setOutputPins(uint8_t mask);
+    void step(long step);
+
+    bool _direction;
+
+private:
+    uint8_t _interface;
+    uint8_t _pin[2];
+    bool _pinInverted[2];
+    long _currentPos;
+    long _targetPos;
+    float _speed;
+    float _maxSpeed;
+    float _acceleration;
+    unsigned long _stepInterval;
+    unsigned long _lastStepTime;
+    unsigned int _minPulseWidth;
+    bool _enableInverted;
+    uint8_t _enablePin;
+    long _n;
+    float _c0;
+    float _cn;
+    float _cmin;
+};
+
+#endif // ACCELSTEPPER_H
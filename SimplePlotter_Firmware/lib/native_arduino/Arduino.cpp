@@ -0,0 +1,317 @@
+// SimplePlotter_Firmware/lib/native_arduino/Arduino.cpp
+
+#include <Arduino.h>
+#include "native_sim.h"
+
+HardwareSerial Serial;
+
+//===========================================================================
+// Time
+//===========================================================================
+
+unsigned long micros() {
+    nativeSim.advance(NATIVE_TIME_CALL_CYCLES);
+    return (unsigned long)(nativeSim.cycles() / NATIVE_CYCLES_PER_US);
+}
+
+unsigned long millis() {
+    nativeSim.advance(NATIVE_TIME_CALL_CYCLES);
+    return (unsigned long)(nativeSim.cycles() / (F_CPU / 1000));
+}
+
+void delay(unsigned long ms) {
+    nativeSim.advance((uint64_t)ms * (F_CPU / 1000));
+}
+
+void delayMicroseconds(unsigned int us) {
+    nativeSim.advance((uint64_t)us * NATIVE_CYCLES_PER_US);
+}
+
+void yield() {}
+
+//===========================================================================
+// Pins
+//===========================================================================
+
+uint8_t digitalPinToPort(uint8_t pin) {
+    return pin / 8 + 1;
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin) {
+    return 1 << (pin % 8);
+}
+
+volatile uint8_t* portOutputRegister(uint8_t port) {
+    return nativeSim.port(port);
+}
+
+volatile uint8_t* portInputRegister(uint8_t port) {
+    return nativeSim.portInput(port);
+}
+
+volatile uint8_t* portModeRegister(uint8_t port) {
+    return nativeSim.portMode(port);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+    volatile uint8_t* ddr = portModeRegister(digitalPinToPort(pin));
+    volatile uint8_t* out = portOutputRegister(digitalPinToPort(pin));
+    uint8_t mask = digitalPinToBitMask(pin);
+    if (mode == OUTPUT) {
+        *ddr |= mask;
+    } else {
+        *ddr &= ~mask;
+        if (mode == INPUT_PULLUP) *out |= mask;
+        else *out &= ~mask;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+    volatile uint8_t* out = portOutputRegister(digitalPinToPort(pin));
+    if (val == LOW) *out &= ~digitalPinToBitMask(pin);
+    else *out |= digitalPinToBitMask(pin);
+    nativeSim.advance(NATIVE_PIN_CALL_CYCLES);
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= NUM_DIGITAL_PINS) return LOW;
+    nativeSim.advance(NATIVE_PIN_CALL_CYCLES);
+    return nativeSim.level(pin);
+}
+
+int analogRead(uint8_t pin) {
+    if (pin >= A0) pin -= A0; // analogRead(A0) and analogRead(0) are the same channel
+    nativeSim.advance(112 * NATIVE_CYCLES_PER_US); // 13 ADC clocks at 125 kHz
+    return nativeSim.analog(pin + A0);
+}
+
+void analogWrite(uint8_t pin, int val) {
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, val > 127 ? HIGH : LOW);
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+    (void)pin;
+    (void)frequency;
+    (void)duration;
+}
+
+void noTone(uint8_t pin) {
+    (void)pin;
+}
+
+//===========================================================================
+// Interrupts
+//===========================================================================
+
+void noInterrupts() {
+    cli();
+}
+
+void interrupts() {
+    sei();
+}
+
+// External interrupts aren't modelled: the native build reads its endstops from
+// the simulator (ENDSTOP_SIM), which needs none
+uint8_t digitalPinToInterrupt(uint8_t pin) {
+    return pin;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode) {
+    (void)interrupt;
+    (void)handler;
+    (void)mode;
+}
+
+void detachInterrupt(uint8_t interrupt) {
+    (void)interrupt;
+}
+
+//===========================================================================
+// Math
+//===========================================================================
+
+// avr-libc's random(): Park-Miller minimal standard, so a seed gives the same
+// sequence as on the Mega
+static unsigned long random_state = 1;
+
+static long doRandom() {
+    long x = (long)random_state;
+    if (x == 0) x = 123459876L;
+    long hi = x / 127773L;
+    long lo = x % 127773L;
+    x = 16807L * lo - 2836L * hi;
+    if (x < 0) x += 0x7FFFFFFFL;
+    random_state = x;
+    return x % 0x80000000L;
+}
+
+long random(long howbig) {
+    if (howbig == 0) return 0;
+    return doRandom() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) random_state = seed;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+//===========================================================================
+// Conversions
+//===========================================================================
+
+char* dtostrf(double val, signed char width, unsigned char prec, char* s) {
+    sprintf(s, "%*.*f", width, prec, val);
+    return s;
+}
+
+static char* toBase(unsigned long v, bool negative, char* s, int radix) {
+    char tmp[34];
+    int len = 0;
+    do {
+        int digit = v % radix;
+        tmp[len++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        v /= radix;
+    } while (v);
+    char* p = s;
+    if (negative) *p++ = '-';
+    while (len) *p++ = tmp[--len];
+    *p = '\0';
+    return s;
+}
+
+char* itoa(int val, char* s, int radix) {
+    return (radix == 10 && val < 0) ? toBase(-(long)val, true, s, radix) : toBase((unsigned int)val, false, s, radix);
+}
+
+char* ltoa(long val, char* s, int radix) {
+    return (radix == 10 && val < 0) ? toBase(-(unsigned long)val, true, s, radix) : toBase((unsigned long)val, false, s, radix);
+}
+
+char* utoa(unsigned int val, char* s, int radix) {
+    return toBase(val, false, s, radix);
+}
+
+char* ultoa(unsigned long val, char* s, int radix) {
+    return toBase(val, false, s, radix);
+}
+
+//===========================================================================
+// String
+//===========================================================================
+
+String::String(int v, unsigned char base) {
+    char buf[34];
+    _s = ltoa(v, buf, base);
+}
+
+String::String(unsigned int v, unsigned char base) {
+    char buf[34];
+    _s = ultoa(v, buf, base);
+}
+
+String::String(long v, unsigned char base) {
+    char buf[34];
+    _s = ltoa(v, buf, base);
+}
+
+String::String(unsigned long v, unsigned char base) {
+    char buf[34];
+    _s = ultoa(v, buf, base);
+}
+
+String::String(float v, unsigned char decimals) {
+    char buf[40];
+    _s = dtostrf(v, decimals + 2, decimals, buf);
+}
+
+String::String(double v, unsigned char decimals) {
+    char buf[40];
+    _s = dtostrf(v, decimals + 2, decimals, buf);
+}
+
+//===========================================================================
+// Print
+//===========================================================================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+}
+
+size_t Print::_printNumber(unsigned long v, int base) {
+    char buf[34];
+    toBase(v, false, buf, base < 2 ? 10 : base);
+    if (base == HEX) {
+        for (char* p = buf; *p; p++) *p = toupper(*p); // Arduino prints hex in capitals
+    }
+    return write(buf);
+}
+
+size_t Print::print(const __FlashStringHelper* s) { return write(reinterpret_cast<const char*>(s)); }
+size_t Print::print(const String& s) { return write(s.c_str()); }
+size_t Print::print(const char* s) { return write(s); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char v, int base) { return print((unsigned long)v, base); }
+size_t Print::print(int v, int base) { return print((long)v, base); }
+size_t Print::print(unsigned int v, int base) { return print((unsigned long)v, base); }
+
+size_t Print::print(long v, int base) {
+    if (base == DEC && v < 0) return write('-') + _printNumber(-(unsigned long)v, DEC);
+    if (base == DEC) return _printNumber(v, DEC);
+    return _printNumber((uint32_t)v, base); // The Mega's long is 32 bits
+}
+
+size_t Print::print(unsigned long v, int base) { return _printNumber(v, base); }
+
+size_t Print::print(double v, int digits) {
+    if (isnan(v)) return write("nan");
+    if (isinf(v)) return write("inf");
+    if (v > 4294967040.0 || v < -4294967040.0) return write("ovf");
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    return write(buf);
+}
+
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper* s) { return print(s) + println(); }
+size_t Print::println(const String& s) { return print(s) + println(); }
+size_t Print::println(const char* s) { return print(s) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char v, int base) { return print(v, base) + println(); }
+size_t Print::println(int v, int base) { return print(v, base) + println(); }
+size_t Print::println(unsigned int v, int base) { return print(v, base) + println(); }
+size_t Print::println(long v, int base) { return print(v, base) + println(); }
+size_t Print::println(unsigned long v, int base) { return print(v, base) + println(); }
+size_t Print::println(double v, int digits) { return print(v, digits) + println(); }
+
+//===========================================================================
+// Serial
+//===========================================================================
+
+void HardwareSerial::begin(unsigned long baud) { nativeSim.serialBegin(baud); }
+int HardwareSerial::available() { return nativeSim.serialAvailable(); }
+int HardwareSerial::peek() { return nativeSim.serialPeek(); }
+int HardwareSerial::read() { return nativeSim.serialRead(); }
+int HardwareSerial::availableForWrite() { return nativeSim.serialAvailableForWrite(); }
+
+void HardwareSerial::flush() {
+    while (nativeSim.serialAvailableForWrite() < SERIAL_TX_BUFFER_SIZE - 1) {}
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    nativeSim.serialWrite(c);
+    return 1;
+}
@@ -0,0 +1,197 @@
+// SimplePlotter_Firmware/lib/native_arduino/Arduino.h
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Arduino core for the native test build: the same API the firmware uses on the
+// Mega, run against the virtual board in native_sim.h. Time only moves when the
+// firmware calls into this core (native_sim.h lists the cost of each call).
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <ctype.h>
+#include <string>
+#include <type_traits>
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PI 3.1415926535897932384626433832795
+
+#define NUM_DIGITAL_PINS 70
+static const uint8_t A0 = 54, A1 = 55, A2 = 56, A3 = 57, A4 = 58, A5 = 59, A6 = 60, A7 = 61;
+static const uint8_t A8 = 62, A9 = 63, A10 = 64, A11 = 65, A12 = 66, A13 = 67, A14 = 68, A15 = 69;
+static const uint8_t SS = 53, MOSI = 51, MISO = 50, SCK = 52;
+
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 64
+#endif
+#ifndef SERIAL_RX_BUFFER_SIZE
+#define SERIAL_RX_BUFFER_SIZE 64
+#endif
+
+// Functions rather than the AVR core's macros, which would break the C++ headers
+template<class T, class U> auto min(T a, U b) -> typename std::common_type<T, U>::type { return a < b ? a : b; }
+template<class T, class U> auto max(T a, U b) -> typename std::common_type<T, U>::type { return a > b ? a : b; }
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define sq(x) ((x) * (x))
+
+// Time
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// Pins: port = pin / 8 + 1, bit = pin % 8 (not the Mega's map; nothing here depends on it)
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+volatile uint8_t* portOutputRegister(uint8_t port);
+volatile uint8_t* portInputRegister(uint8_t port);
+volatile uint8_t* portModeRegister(uint8_t port);
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+// Interrupts
+void noInterrupts();
+void interrupts();
+uint8_t digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+// Math
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+// avr-libc conversions
+char* dtostrf(double val, signed char width, unsigned char prec, char* s);
+char* itoa(int val, char* s, int radix);
+char* ltoa(long val, char* s, int radix);
+char* utoa(unsigned int val, char* s, int radix);
+char* ultoa(unsigned long val, char* s, int radix);
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(PSTR(string_literal)))
+
+class String {
+public:
+    String(const char* s = "") : _s(s ? s : "") {}
+    String(const __FlashStringHelper* s) : _s(reinterpret_cast<const char*>(s)) {}
+    explicit String(char c) : _s(1, c) {}
+    explicit String(int v, unsigned char base = DEC);
+    explicit String(unsigned int v, unsigned char base = DEC);
+    explicit String(long v, unsigned char base = DEC);
+    explicit String(unsigned long v, unsigned char base = DEC);
+    explicit String(float v, unsigned char decimals = 2);
+    explicit String(double v, unsigned char decimals = 2);
+
+    String& operator+=(const String& rhs) { _s += rhs._s; return *this; }
+    String& operator+=(const char* rhs) { _s += rhs; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    friend String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+    friend String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, const __FlashStringHelper* b) { return a + String(b); }
+    friend String operator+(const String& a, char b) { String r(a); r += b; return r; }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    bool operator==(const char* rhs) const { return _s == rhs; }
+
+private:
+    std::string _s;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+    virtual int availableForWrite() { return 0; }
+
+    size_t print(const __FlashStringHelper* s);
+    size_t print(const String& s);
+    size_t print(const char* s);
+    size_t print(char c);
+    size_t print(unsigned char v, int base = DEC);
+    size_t print(int v, int base = DEC);
+    size_t print(unsigned int v, int base = DEC);
+    size_t print(long v, int base = DEC);
+    size_t print(unsigned long v, int base = DEC);
+    size_t print(double v, int digits = 2);
+
+    size_t println(const __FlashStringHelper* s);
+    size_t println(const String& s);
+    size_t println(const char* s);
+    size_t println(char c);
+    size_t println(unsigned char v, int base = DEC);
+    size_t println(int v, int base = DEC);
+    size_t println(unsigned int v, int base = DEC);
+    size_t println(long v, int base = DEC);
+    size_t println(unsigned long v, int base = DEC);
+    size_t println(double v, int digits = 2);
+    size_t println();
+
+private:
+    size_t _printNumber(unsigned long v, int base);
+};
+
+// UART0 at the wire rate set by begin(): received bytes arrive one frame time apart
+// into a SERIAL_RX_BUFFER_SIZE ring, and write() blocks while the TX ring is full
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud);
+    void end() {}
+    int available();
+    int peek();
+    int read();
+    int availableForWrite() override;
+    void flush();
+    size_t write(uint8_t c) override;
+    using Print::write;
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// Entry points of the sketch
+void setup();
+void loop();
+
+#endif // ARDUINO_H
@@ -0,0 +1,5 @@
+// SimplePlotter_Firmware/lib/native_arduino/EEPROM.cpp
+
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
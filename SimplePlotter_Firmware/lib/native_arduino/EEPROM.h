@@ -0,0 +1,38 @@
+// SimplePlotter_Firmware/lib/native_arduino/EEPROM.h
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define NATIVE_EEPROM_SIZE 4096 // ATmega2560
+
+// 4 KB that start erased (0xFF), as a new board's EEPROM does
+class EEPROMClass {
+public:
+    uint8_t read(int idx) { return _cells[idx]; }
+    void write(int idx, uint8_t val) { _cells[idx] = val; }
+    void update(int idx, uint8_t val) { _cells[idx] = val; }
+    uint16_t length() { return NATIVE_EEPROM_SIZE; }
+
+    template<class T> T& get(int idx, T& t) {
+        memcpy(&t, _cells + idx, sizeof(T));
+        return t;
+    }
+    template<class T> const T& put(int idx, const T& t) {
+        memcpy(_cells + idx, &t, sizeof(T));
+        return t;
+    }
+
+    void erase() { memset(_cells, 0xFF, sizeof(_cells)); }
+
+    EEPROMClass() { erase(); }
+
+private:
+    uint8_t _cells[NATIVE_EEPROM_SIZE];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // EEPROM_H
@@ -0,0 +1,8 @@
+// SimplePlotter_Firmware/lib/native_arduino/SPI.h
+
+#ifndef SPI_H
+#define SPI_H
+
+#include <Arduino.h>
+
+#endif // SPI_H
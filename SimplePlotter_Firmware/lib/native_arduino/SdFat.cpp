@@ -0,0 +1,131 @@
+// SimplePlotter_Firmware/lib/native_arduino/SdFat.cpp
+
+#include "SdFat.h"
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "native_sim.h"
+
+// Path on the host for a path on the card
+static bool hostPath(const char* path, char* out, size_t size) {
+    const char* root = nativeSim.sdRoot();
+    if (!root) return false;
+    while (*path == '/') path++;
+    return (size_t)snprintf(out, size, "%s/%s", root, path) < size;
+}
+
+bool SdFile::open(const char* path, oflag_t oflag) {
+    close();
+    if (!hostPath(path, _path, sizeof(_path))) return false;
+
+    struct stat st;
+    if (stat(_path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        _dir = opendir(_path);
+    } else {
+        const char* mode = "rb";
+        if ((oflag & O_ACCMODE) != O_RDONLY) {
+            bool exists = stat(_path, &st) == 0;
+            if (!exists && !(oflag & O_CREAT)) return false;
+            if (exists && (oflag & O_CREAT) && (oflag & O_EXCL)) return false;
+            mode = (oflag & O_TRUNC) || !exists ? "w+b" : "r+b";
+        }
+        _fp = fopen(_path, mode);
+        if (_fp && (oflag & O_APPEND)) fseek(_fp, 0, SEEK_END);
+    }
+    if (!isOpen()) return false;
+
+    const char* slash = strrchr(_path, '/');
+    strncpy(_name, slash ? slash + 1 : _path, sizeof(_name) - 1);
+    _name[sizeof(_name) - 1] = '\0';
+    return true;
+}
+
+bool SdFile::openNext(SdFile* dir, oflag_t oflag) {
+    close();
+    if (!dir || !dir->_dir) return false;
+    struct dirent* entry;
+    while ((entry = readdir((DIR*)dir->_dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        const char* root = nativeSim.sdRoot();
+        char path[512];
+        snprintf(path, sizeof(path), "%s", dir->_path + strlen(root));
+        size_t len = strlen(path);
+        snprintf(path + len, sizeof(path) - len, "/%s", entry->d_name);
+        return open(path, oflag);
+    }
+    return false;
+}
+
+bool SdFile::close() {
+    if (_fp) fclose(_fp);
+    if (_dir) closedir((DIR*)_dir);
+    _fp = nullptr;
+    _dir = nullptr;
+    return true;
+}
+
+bool SdFile::getName(char* name, size_t size) {
+    if (!isOpen() || size == 0) return false;
+    strncpy(name, _name, size - 1);
+    name[size - 1] = '\0';
+    return true;
+}
+
+int SdFile::read() {
+    if (!_fp) return -1;
+    int c = fgetc(_fp);
+    return c == EOF ? -1 : c;
+}
+
+int SdFile::read(void* buf, size_t count) {
+    if (!_fp) return -1;
+    return fread(buf, 1, count, _fp);
+}
+
+size_t SdFile::write(const void* buf, size_t count) {
+    if (!_fp) return 0;
+    return fwrite(buf, 1, count, _fp);
+}
+
+bool SdFile::sync() {
+    return _fp && fflush(_fp) == 0;
+}
+
+bool SdFile::seekSet(uint32_t pos) {
+    return _fp && fseek(_fp, pos, SEEK_SET) == 0;
+}
+
+uint32_t SdFile::curPosition() {
+    return _fp ? ftell(_fp) : 0;
+}
+
+uint32_t SdFile::fileSize() {
+    struct stat st;
+    if (!_fp) return 0;
+    fflush(_fp);
+    return fstat(fileno(_fp), &st) == 0 ? st.st_size : 0;
+}
+
+bool SdFile::remove() {
+    if (!_fp) return false;
+    close();
+    return unlink(_path) == 0;
+}
+
+bool SdFat::begin(uint8_t csPin, uint8_t spiSpeed) {
+    (void)csPin;
+    (void)spiSpeed;
+    return nativeSim.sdRoot() != nullptr;
+}
+
+bool SdFat::exists(const char* path) {
+    char host[512];
+    struct stat st;
+    return hostPath(path, host, sizeof(host)) && stat(host, &st) == 0;
+}
+
+bool SdFat::remove(const char* path) {
+    char host[512];
+    return hostPath(path, host, sizeof(host)) && unlink(host) == 0;
+}
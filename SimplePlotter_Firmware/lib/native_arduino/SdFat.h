@@ -0,0 +1,68 @@
+// SimplePlotter_Firmware/lib/native_arduino/SdFat.h
+
+#ifndef SDFAT_H
+#define SDFAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// The card is a host directory (NativeSim::setSdRoot()); no root means no card
+
+#define O_RDONLY 0x00
+#define O_WRONLY 0x01
+#define O_RDWR   0x02
+#define O_ACCMODE 0x03
+#define O_APPEND 0x08
+#define O_CREAT  0x10
+#define O_TRUNC  0x20
+#define O_EXCL   0x40
+#define O_READ   O_RDONLY
+#define O_WRITE  O_WRONLY
+
+#define SPI_FULL_SPEED    0
+#define SPI_HALF_SPEED    1
+#define SPI_QUARTER_SPEED 2
+
+typedef int oflag_t;
+
+class SdFile {
+public:
+    SdFile() : _fp(nullptr), _dir(nullptr), _name{0} {}
+    ~SdFile() { close(); }
+
+    bool open(const char* path, oflag_t oflag = O_RDONLY);
+    bool openNext(SdFile* dir, oflag_t oflag = O_RDONLY);
+    bool close();
+    bool isOpen() const { return _fp || _dir; }
+    bool isDir() const { return _dir != nullptr; }
+    bool getName(char* name, size_t size);
+
+    int read();
+    int read(void* buf, size_t count);
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const void* buf, size_t count);
+    bool sync();
+    bool seekSet(uint32_t pos);
+    uint32_t curPosition();
+    uint32_t fileSize();
+    bool remove();
+
+private:
+    SdFile(const SdFile&);
+    SdFile& operator=(const SdFile&);
+
+    FILE* _fp;
+    void* _dir; // DIR*
+    char _name[256];
+    char _path[512];
+};
+
+class SdFat {
+public:
+    bool begin(uint8_t csPin, uint8_t spiSpeed);
+    bool exists(const char* path);
+    bool remove(const char* path);
+};
+
+#endif // SDFAT_H
@@ -0,0 +1,55 @@
+// SimplePlotter_Firmware/lib/native_arduino/U8g2lib.cpp
+
+#include "U8g2lib.h"
+
+const u8g2_cb_t u8g2_cb_r0 = {0};
+
+const uint8_t u8g2_font_4x6_tf[1] = {0};
+const uint8_t u8g2_font_5x7_tf[1] = {0};
+const uint8_t u8g2_font_6x10_tf[1] = {0};
+
+void u8g2_Setup_st7920_s_128x64_2(u8g2_t* u8g2, const u8g2_cb_t* rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb) {
+    (void)rotation;
+    u8g2->u8x8.byte_cb = byte_cb;
+    u8g2->u8x8.gpio_and_delay_cb = gpio_and_delay_cb;
+    for (uint8_t i = 0; i < U8X8_PIN_CNT; i++) u8g2->u8x8.pins[i] = U8X8_PIN_NONE;
+}
+
+void u8x8_SetPin_4Wire_SW_SPI(u8x8_t* u8x8, uint8_t clock, uint8_t data, uint8_t cs, uint8_t dc, uint8_t reset) {
+    (void)dc;
+    u8x8_SetPin_3Wire_SW_SPI(u8x8, clock, data, cs, reset);
+}
+
+void u8x8_SetPin_3Wire_SW_SPI(u8x8_t* u8x8, uint8_t clock, uint8_t data, uint8_t cs, uint8_t reset) {
+    u8x8->pins[U8X8_PIN_SPI_CLOCK] = clock;
+    u8x8->pins[U8X8_PIN_SPI_DATA] = data;
+    u8x8->pins[U8X8_PIN_CS] = cs;
+    u8x8->pins[U8X8_PIN_RESET] = reset;
+}
+
+void u8x8_SetPin_ST7920_HW_SPI(u8x8_t* u8x8, uint8_t cs, uint8_t reset) {
+    u8x8->pins[U8X8_PIN_CS] = cs;
+    u8x8->pins[U8X8_PIN_RESET] = reset;
+}
+
+void u8x8_gpio_Delay(u8x8_t* u8x8, uint8_t msg, uint8_t dly) {
+    (void)u8x8;
+    (void)msg;
+    (void)dly;
+}
+
+uint8_t u8x8_gpio_and_delay_arduino(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+    (void)u8x8;
+    (void)msg;
+    (void)arg_int;
+    (void)arg_ptr;
+    return 1;
+}
+
+uint8_t u8x8_byte_arduino_hw_spi(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+    (void)u8x8;
+    (void)msg;
+    (void)arg_int;
+    (void)arg_ptr;
+    return 1;
+}
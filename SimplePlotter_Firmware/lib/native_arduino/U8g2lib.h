@@ -0,0 +1,129 @@
+// SimplePlotter_Firmware/lib/native_arduino/U8g2lib.h
+
+#ifndef U8G2LIB_H
+#define U8G2LIB_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Display with nothing attached: drawing is accepted and dropped, each picture loop
+// runs one page, and none of it costs virtual time. The transport callbacks are
+// stored but never called.
+
+typedef struct u8x8_struct u8x8_t;
+typedef struct u8g2_struct u8g2_t;
+typedef struct { uint8_t rotation; } u8g2_cb_t;
+typedef uint8_t (*u8x8_msg_cb)(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr);
+
+typedef struct {
+    uint8_t chip_enable_level;
+    uint8_t chip_disable_level;
+    uint8_t post_chip_enable_wait_ns;
+    uint8_t pre_chip_disable_wait_ns;
+    uint8_t reset_pulse_width_ms;
+    uint8_t post_reset_wait_ms;
+    uint8_t sda_setup_time_ns;
+    uint8_t sck_pulse_width_ns;
+    uint32_t sck_clock_hz;
+    uint8_t spi_mode;
+} u8x8_display_info_t;
+
+#define U8X8_PIN_CS        0
+#define U8X8_PIN_SPI_CLOCK 1
+#define U8X8_PIN_SPI_DATA  2
+#define U8X8_PIN_RESET     3
+#define U8X8_PIN_CNT       16
+#define U8X8_PIN_NONE      255
+
+struct u8x8_struct {
+    const u8x8_display_info_t* display_info;
+    u8x8_msg_cb byte_cb;
+    u8x8_msg_cb gpio_and_delay_cb;
+    uint8_t pins[U8X8_PIN_CNT];
+};
+
+struct u8g2_struct {
+    u8x8_t u8x8;
+};
+
+#define u8x8_GetSPIClockPhase(u8x8)    ((u8x8)->display_info->spi_mode & 0x01)
+#define u8x8_GetSPIClockPolarity(u8x8) (((u8x8)->display_info->spi_mode & 0x02) >> 1)
+
+#define U8X8_MSG_BYTE_INIT           20
+#define U8X8_MSG_BYTE_SET_DC         21
+#define U8X8_MSG_BYTE_START_TRANSFER 22
+#define U8X8_MSG_BYTE_SEND           23
+#define U8X8_MSG_BYTE_END_TRANSFER   24
+#define U8X8_MSG_GPIO_AND_DELAY_INIT 40
+#define U8X8_MSG_DELAY_MILLI         41
+#define U8X8_MSG_DELAY_10MICRO       42
+#define U8X8_MSG_DELAY_100NANO       43
+#define U8X8_MSG_DELAY_NANO          44
+
+extern const u8g2_cb_t u8g2_cb_r0;
+#define U8G2_R0 (&u8g2_cb_r0)
+
+extern const uint8_t u8g2_font_4x6_tf[];
+extern const uint8_t u8g2_font_5x7_tf[];
+extern const uint8_t u8g2_font_6x10_tf[];
+
+void u8g2_Setup_st7920_s_128x64_2(u8g2_t* u8g2, const u8g2_cb_t* rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb);
+void u8x8_SetPin_4Wire_SW_SPI(u8x8_t* u8x8, uint8_t clock, uint8_t data, uint8_t cs, uint8_t dc, uint8_t reset);
+void u8x8_SetPin_3Wire_SW_SPI(u8x8_t* u8x8, uint8_t clock, uint8_t data, uint8_t cs, uint8_t reset);
+void u8x8_SetPin_ST7920_HW_SPI(u8x8_t* u8x8, uint8_t cs, uint8_t reset);
+void u8x8_gpio_Delay(u8x8_t* u8x8, uint8_t msg, uint8_t dly);
+uint8_t u8x8_gpio_and_delay_arduino(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr);
+uint8_t u8x8_byte_arduino_hw_spi(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr);
+
+class U8G2 {
+public:
+    U8G2() { memset(&u8g2, 0, sizeof(u8g2)); }
+    u8g2_t* getU8g2() { return &u8g2; }
+    u8x8_t* getU8x8() { return &u8g2.u8x8; }
+
+    void begin() {}
+    void initDisplay() {}
+    void clearDisplay() {}
+    void setPowerSave(uint8_t) {}
+    void setContrast(uint8_t) {}
+    void enableUTF8Print() {}
+
+    void firstPage() {}
+    uint8_t nextPage() { return 0; }
+    void clearBuffer() {}
+    void sendBuffer() {}
+
+    void setFont(const uint8_t*) {}
+    void setFontMode(uint8_t) {}
+    void setDrawColor(uint8_t) {}
+    int getStrWidth(const char* s) { return 6 * (int)strlen(s); }
+    int drawStr(int, int, const char* s) { return getStrWidth(s); }
+    void drawPixel(int, int) {}
+    void drawLine(int, int, int, int) {}
+    void drawBox(int, int, int, int) {}
+    void drawFrame(int, int, int, int) {}
+    void drawDisc(int, int, int) {}
+    void drawXBMP(int, int, int, int, const uint8_t*) {}
+
+protected:
+    u8g2_t u8g2;
+};
+
+class U8G2_ST7920_128X64_2_SW_SPI : public U8G2 {
+public:
+    U8G2_ST7920_128X64_2_SW_SPI(const u8g2_cb_t* rotation, uint8_t clock, uint8_t data, uint8_t cs,
+                                uint8_t reset = U8X8_PIN_NONE) : U8G2() {
+        u8g2_Setup_st7920_s_128x64_2(&u8g2, rotation, nullptr, u8x8_gpio_and_delay_arduino);
+        u8x8_SetPin_3Wire_SW_SPI(getU8x8(), clock, data, cs, reset);
+    }
+};
+
+class U8G2_ST7920_128X64_2_HW_SPI : public U8G2 {
+public:
+    U8G2_ST7920_128X64_2_HW_SPI(const u8g2_cb_t* rotation, uint8_t cs, uint8_t reset = U8X8_PIN_NONE) : U8G2() {
+        u8g2_Setup_st7920_s_128x64_2(&u8g2, rotation, u8x8_byte_arduino_hw_spi, u8x8_gpio_and_delay_arduino);
+        u8x8_SetPin_ST7920_HW_SPI(getU8x8(), cs, reset);
+    }
+};
+
+#endif // U8G2LIB_H
@@ -0,0 +1,12 @@
+// SimplePlotter_Firmware/lib/native_arduino/avr/interrupt.h
+
+#ifndef AVR_INTERRUPT_H
+#define AVR_INTERRUPT_H
+
+// Vectors are plain functions the virtual board calls by name (native_sim.cpp)
+#define ISR(vector, ...) extern "C" void vector(void)
+
+void cli();
+void sei();
+
+#endif // AVR_INTERRUPT_H
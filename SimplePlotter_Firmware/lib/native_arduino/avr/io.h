@@ -0,0 +1,127 @@
+// SimplePlotter_Firmware/lib/native_arduino/avr/io.h
+
+#ifndef AVR_IO_H
+#define AVR_IO_H
+
+#include <stdint.h>
+
+// Registers of the ATmega2560 the firmware touches. Timer3 and Timer4 (jog tick and
+// move ISR) count against the virtual clock and raise their compare interrupts; the
+// rest are plain bytes, with the status bits transports poll preset to "ready".
+
+#define _BV(bit) (1 << (bit))
+#define RAMEND 0x21FF
+
+// Counter of a clocked timer: a read returns the count and costs one timer tick, a
+// write restarts the count from that value
+class NativeTimerCount {
+public:
+    explicit NativeTimerCount(uint8_t timer) : _timer(timer) {}
+    operator uint16_t() const;
+    NativeTimerCount& operator=(uint16_t value);
+private:
+    uint8_t _timer;
+};
+
+// Interrupt flags of a clocked timer: writing a 1 clears that flag
+class NativeTimerFlags {
+public:
+    explicit NativeTimerFlags(uint8_t timer) : _timer(timer) {}
+    operator uint8_t() const;
+    NativeTimerFlags& operator=(uint8_t value);
+private:
+    uint8_t _timer;
+};
+
+extern NativeTimerCount TCNT3, TCNT4;
+extern NativeTimerFlags TIFR3, TIFR4;
+
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR2A, TCCR2B, TCCR3A, TCCR3B, TCCR4A, TCCR4B, TCCR5A, TCCR5B;
+extern volatile uint8_t TIMSK1, TIMSK2, TIMSK3, TIMSK4, TIMSK5, TIFR1, TIFR5, OCR2A;
+extern volatile uint16_t TCNT1, TCNT5, OCR1A, OCR1B, OCR3A, OCR4A, OCR4B, OCR4C, OCR5A, OCR5B, OCR5C, ICR1, ICR4, ICR5;
+extern volatile uint8_t PCICR, PCIFR, PCMSK1, SREG, MCUSR;
+extern volatile uint8_t UCSR1A, UCSR1B, UCSR1C, UDR1, UCSR2A, UCSR2B, UCSR2C, UDR2, UCSR3A, UCSR3B, UCSR3C, UDR3;
+extern volatile uint16_t UBRR1, UBRR2, UBRR3;
+extern volatile uint8_t SPCR, SPSR, SPDR;
+extern volatile uint8_t DDRB, PORTB, PINB, DDRG, PORTG, PING, DDRH, PORTH, PINH, PINJ;
+
+// Timers
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define WGM32 3
+#define WGM41 1
+#define WGM42 3
+#define WGM43 4
+#define WGM51 1
+#define WGM52 3
+#define WGM53 4
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define CS30 0
+#define CS31 1
+#define CS32 2
+#define CS40 0
+#define CS41 1
+#define CS42 2
+#define CS50 0
+#define CS51 1
+#define COM1A1 7
+#define COM4A1 7
+#define COM4B1 5
+#define COM4C1 3
+#define COM5A1 7
+#define COM5B1 5
+#define OCIE1A 1
+#define OCIE3A 1
+#define OCIE4A 1
+#define OCF3A 1
+#define OCF4A 1
+
+// Pin change interrupts
+#define PCIE1 1
+#define PCINT10 2
+
+// USART in SPI master mode
+#define UMSEL11 7
+#define UMSEL10 6
+#define UDORD1 2
+#define UCPHA1 1
+#define UCPOL1 0
+#define TXEN1 3
+#define UDRIE1 5
+#define UDRE1 5
+#define TXC1 6
+#define UMSEL21 7
+#define UMSEL20 6
+#define UDORD2 2
+#define UCPHA2 1
+#define UCPOL2 0
+#define TXEN2 3
+#define UDRIE2 5
+#define UDRE2 5
+#define TXC2 6
+
+// SPI
+#define SPIE 7
+#define SPE 6
+#define MSTR 4
+#define CPOL 3
+#define CPHA 2
+#define SPR1 1
+#define SPR0 0
+#define SPIF 7
+#define SPI2X 0
+
+#define DDB0 0
+#define DDB1 1
+#define DDB2 2
+#define PH0 0
+#define PH1 1
+#define PH2 2
+#define PJ1 1
+#define WDRF 3
+
+#endif // AVR_IO_H
@@ -0,0 +1,35 @@
+// SimplePlotter_Firmware/lib/native_arduino/avr/pgmspace.h
+
+#ifndef AVR_PGMSPACE_H
+#define AVR_PGMSPACE_H
+
+// One address space on the host: flash strings are ordinary strings
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr)  (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+#define pgm_read_ptr(addr)   (*(void* const*)(addr))
+
+#define strcpy_P     strcpy
+#define strncpy_P    strncpy
+#define strcat_P     strcat
+#define strncat_P    strncat
+#define strlen_P     strlen
+#define strcmp_P     strcmp
+#define strcasecmp_P strcasecmp
+#define memcpy_P     memcpy
+
+// avr-libc's %S (a flash string argument) is %s here
+int snprintf_P(char* s, size_t n, PGM_P fmt, ...);
+
+#endif // AVR_PGMSPACE_H
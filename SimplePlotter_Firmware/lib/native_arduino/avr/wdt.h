@@ -0,0 +1,24 @@
+// SimplePlotter_Firmware/lib/native_arduino/avr/wdt.h
+
+#ifndef AVR_WDT_H
+#define AVR_WDT_H
+
+// The watchdog doesn't reset the virtual board; a missed wdt_reset() is counted
+// instead (NativeSim::watchdogBites())
+
+#define WDTO_15MS 0
+#define WDTO_30MS 1
+#define WDTO_60MS 2
+#define WDTO_120MS 3
+#define WDTO_250MS 4
+#define WDTO_500MS 5
+#define WDTO_1S 6
+#define WDTO_2S 7
+#define WDTO_4S 8
+#define WDTO_8S 9
+
+void wdt_enable(int timeout);
+void wdt_disable();
+void wdt_reset();
+
+#endif // AVR_WDT_H
@@ -0,0 +1,86 @@
+// SimplePlotter_Firmware/lib/native_arduino/avr_io.cpp
+
+#include <stdarg.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/wdt.h>
+#include <util/atomic.h>
+#include "native_sim.h"
+
+NativeTimerCount TCNT3(3), TCNT4(4);
+NativeTimerFlags TIFR3(3), TIFR4(4);
+
+volatile uint8_t TCCR1A, TCCR1B, TCCR2A, TCCR2B, TCCR3A, TCCR3B, TCCR4A, TCCR4B, TCCR5A, TCCR5B;
+volatile uint8_t TIMSK1, TIMSK2, TIMSK3, TIMSK4, TIMSK5, TIFR1, TIFR5, OCR2A;
+volatile uint16_t TCNT1, TCNT5, OCR1A, OCR1B, OCR3A, OCR4A, OCR4B, OCR4C, OCR5A, OCR5B, OCR5C, ICR1, ICR4, ICR5;
+volatile uint8_t PCICR, PCIFR, PCMSK1, SREG, MCUSR = _BV(0); // Power-on reset
+// Transmitters idle, nothing to wait for
+volatile uint8_t UCSR1A = _BV(UDRE1) | _BV(TXC1), UCSR1B, UCSR1C, UDR1;
+volatile uint8_t UCSR2A = _BV(UDRE2) | _BV(TXC2), UCSR2B, UCSR2C, UDR2;
+volatile uint8_t UCSR3A = _BV(5) | _BV(6), UCSR3B, UCSR3C, UDR3;
+volatile uint16_t UBRR1, UBRR2, UBRR3;
+volatile uint8_t SPCR, SPSR = _BV(SPIF), SPDR;
+volatile uint8_t DDRB, PORTB, PINB, DDRG, PORTG, PING, DDRH, PORTH, PINH, PINJ;
+
+NativeTimerCount::operator uint16_t() const {
+    return nativeSim.timerCount(_timer);
+}
+
+NativeTimerCount& NativeTimerCount::operator=(uint16_t value) {
+    nativeSim.timerWrite(_timer, value);
+    return *this;
+}
+
+NativeTimerFlags::operator uint8_t() const {
+    const NativeSim::Timer& t = nativeSim.timer(_timer);
+    return t.pending ? _BV(t.flagBit) : 0;
+}
+
+NativeTimerFlags& NativeTimerFlags::operator=(uint8_t value) {
+    if (value & _BV(nativeSim.timer(_timer).flagBit)) nativeSim.clearTimerFlag(_timer);
+    return *this;
+}
+
+void cli() {
+    nativeSim.setInterrupts(false);
+}
+
+void sei() {
+    nativeSim.setInterrupts(true);
+}
+
+bool nativeAtomicEnter() {
+    bool was = nativeSim.interruptsEnabled();
+    nativeSim.setInterrupts(false);
+    return was;
+}
+
+void nativeAtomicLeave(bool on) {
+    nativeSim.setInterrupts(on);
+}
+
+void wdt_enable(int timeout) {
+    nativeSim.wdtEnable(timeout);
+}
+
+void wdt_disable() {
+    nativeSim.wdtDisable();
+}
+
+void wdt_reset() {
+    nativeSim.wdtReset();
+}
+
+int snprintf_P(char* s, size_t n, PGM_P fmt, ...) {
+    char host_fmt[256];
+    size_t i = 0;
+    for (; fmt[i] && i < sizeof(host_fmt) - 1; i++) {
+        host_fmt[i] = (fmt[i] == 'S' && i > 0 && fmt[i - 1] == '%') ? 's' : fmt[i];
+    }
+    host_fmt[i] = '\0';
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(s, n, host_fmt, args);
+    va_end(args);
+    return len;
+}
@@ -0,0 +1,98 @@
+// SimplePlotter_Firmware/lib/native_arduino/native_main.cpp
+
+// Entry point of `pio run -e native`: the firmware on the virtual board, fed from the
+// host's standard input the way a simple streaming host would. After the boot banner
+// each line goes out once the previous one has its ok; comments and blank lines are
+// skipped. Everything the firmware sends is printed with the board time it finished.
+// At the end of the input it waits for --until TEXT, or sends M400 and waits for its ok.
+//
+//   program [--sd DIR] [--until TEXT] [--max-s SECONDS]
+//
+//   --sd DIR        the SD card: files in DIR (default: no card)
+//   --until TEXT    finish once a line containing TEXT has come back
+//   --max-s SECONDS give up after this much board time (default 3600)
+//
+// Replaying a captured session offline, with its report at the end:
+//   printf 'G28\nG0 X117 Y95 Z3 F6000\nM938 CUST.SSN\n' |
+//       .pio/build/native/program --sd captures --until "M938: waited for bytes"
+
+#ifndef PIO_UNIT_TESTING // The test suites have their own main()
+
+#include <Arduino.h>
+#include <string>
+#include "native_sim.h"
+
+static const char* BOOT_LINE = "start"; // READY_TOKEN: commands are accepted from now on
+
+static std::string partial; // Output after the last complete line
+static unsigned long oks;
+static bool seen;           // A line has contained the text being waited for
+static const char* wanted;
+
+static void pump() {
+    nativeSim.runLoop();
+    partial += nativeSim.takeOutput();
+    size_t end;
+    while ((end = partial.find('\n')) != std::string::npos) {
+        std::string line = partial.substr(0, end);
+        partial.erase(0, end + 1);
+        if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+        printf("%10.3f %s\n", nativeSim.seconds(), line.c_str());
+        if (line == "ok") oks++;
+        if (wanted && line.find(wanted) != std::string::npos) seen = true;
+    }
+}
+
+// Loop passes until `text` has come back in a line, or the board time runs out
+static bool waitFor(const char* text, double max_s) {
+    wanted = text;
+    seen = false;
+    while (!seen && nativeSim.seconds() < max_s) pump();
+    wanted = nullptr;
+    return seen;
+}
+
+static bool sendLine(const char* line, double max_s) {
+    unsigned long before = oks;
+    nativeSim.sendToFirmware(line);
+    nativeSim.sendToFirmware("\n");
+    while (oks == before && nativeSim.seconds() < max_s) pump();
+    return oks != before;
+}
+
+static int usage() {
+    fprintf(stderr, "usage: program [--sd DIR] [--until TEXT] [--max-s SECONDS] < lines\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    const char* until = nullptr;
+    double max_s = 3600.0;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) return usage();
+        if (!strcmp(argv[i], "--sd")) nativeSim.setSdRoot(argv[++i]);
+        else if (!strcmp(argv[i], "--until")) until = argv[++i];
+        else if (!strcmp(argv[i], "--max-s")) max_s = atof(argv[++i]);
+        else return usage();
+    }
+
+    setup();
+    bool ok = waitFor(BOOT_LINE, max_s);
+    unsigned long lines = 0;
+    char buf[256];
+    while (ok && fgets(buf, sizeof(buf), stdin)) {
+        buf[strcspn(buf, "\r\n;")] = '\0';
+        size_t len = strlen(buf);
+        while (len && isspace((unsigned char)buf[len - 1])) buf[--len] = '\0';
+        if (!len) continue;
+        ok = sendLine(buf, max_s);
+        lines++;
+    }
+    if (ok) ok = until ? waitFor(until, max_s) : sendLine("M400", max_s);
+
+    fprintf(stderr, "native: %lu lines sent, %.3f s of board time%s\n", lines, nativeSim.seconds(),
+            ok ? "" : ", gave up waiting");
+    return ok ? 0 : 1;
+}
+
+#endif // PIO_UNIT_TESTING
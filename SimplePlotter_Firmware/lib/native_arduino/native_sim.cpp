@@ -0,0 +1,287 @@
+// SimplePlotter_Firmware/lib/native_arduino/native_sim.cpp
+
+#include "native_sim.h"
+
+// Firmware objects call into the board from their constructors (AccelStepper sets pin
+// modes), so it is built before any of them
+NativeSim nativeSim __attribute__((init_priority(101))); // Global instance definition
+
+// Vectors the firmware may define; the weak references are null when it doesn't
+extern "C" void TIMER3_COMPA_vect(void) __attribute__((weak));
+extern "C" void TIMER4_COMPA_vect(void) __attribute__((weak));
+
+static const uint16_t wdt_timeout_ms[] = {15, 30, 60, 120, 250, 500, 1000, 2000, 4000, 8000};
+
+static uint16_t prescaler(const NativeSim::Timer& t) {
+    static const uint16_t div[8] = {0, 1, 8, 64, 256, 1024, 0, 0}; // External clock: stopped
+    return div[*t.tccrb & 0x07];
+}
+
+NativeSim::NativeSim() :
+    _now(0), _horizon(0), _irq(true), _inIsr(false), _pinHook(nullptr), _byteCycles(F_CPU * 10 / 115200),
+    _rxNextArrival(0), _rxOverruns(0), _txNextDone(0), _wdtMs(0), _wdtLast(0), _wdtBites(0)
+{
+    _timers[0] = {&TCCR3B, &OCR3A, &TIMSK3, OCF3A, 0, false, TIMER3_COMPA_vect, 0, 0, 0};
+    _timers[1] = {&TCCR4B, &OCR4A, &TIMSK4, OCF4A, 0, false, TIMER4_COMPA_vect, 0, 0, 0};
+    for (uint8_t p = 0; p < PORTS; p++) {
+        _port[p] = 0;
+        _ddr[p] = 0;
+        _pin[p] = 0xFF;
+        _reported[p] = 0;
+    }
+    for (uint8_t i = 0; i < NUM_DIGITAL_PINS; i++) _analog[i] = 0;
+}
+
+//===========================================================================
+// Clock and timer interrupts
+//===========================================================================
+
+void NativeSim::advance(uint64_t cycles) {
+    uint64_t end = _now + cycles;
+    pinsChanged(); // Port writes since the last call happened at the current cycle
+    if (_quietUntil(end)) { // Nearly every call: no compare, UART byte or watchdog on the way
+        _now = end;
+        return;
+    }
+    _serviceSerial();
+    while (true) {
+        _runPendingIsrs();
+        if (_now >= end) break; // An ISR may have run past the end
+
+        // Next stop: a compare that can raise an interrupt, or the end
+        uint64_t next = end;
+        for (uint8_t i = 0; i < 2; i++) {
+            const Timer& t = _timers[i];
+            if (!prescaler(t) || (t.pending && !(*t.timsk & _BV(t.flagBit)))) continue;
+            uint64_t due = _nextCompare(t);
+            if (due < next) next = due;
+        }
+        _now = next;
+        for (uint8_t i = 0; i < 2; i++) _catchUp(_timers[i]);
+        _serviceSerial();
+
+        if (_wdtMs && _now - _wdtLast > (uint64_t)_wdtMs * (F_CPU / 1000)) {
+            _wdtBites++;
+            _wdtLast = _now;
+            fprintf(stderr, "native: watchdog expired at %.3f s\n", seconds());
+        }
+    }
+    _setHorizon();
+}
+
+bool NativeSim::_quietUntil(uint64_t end) const {
+    if (end >= _horizon) return false;
+    for (uint8_t i = 0; i < 2; i++) {
+        const Timer& t = _timers[i];
+        if (*t.tccrb != t.seenTccrb || *t.ocr != t.seenOcr || *t.timsk != t.seenTimsk) return false;
+    }
+    return true;
+}
+
+// The first cycle anything can happen at, with the timer registers as they are now.
+// An enabled compare flag that is still set waits for sei(), which runs it directly.
+void NativeSim::_setHorizon() {
+    _horizon = UINT64_MAX;
+    for (uint8_t i = 0; i < 2; i++) {
+        Timer& t = _timers[i];
+        t.seenTccrb = *t.tccrb;
+        t.seenOcr = *t.ocr;
+        t.seenTimsk = *t.timsk;
+        if (prescaler(t)) _horizon = min(_horizon, _nextCompare(t));
+    }
+    if (!_rxWire.empty()) _horizon = min(_horizon, _rxNextArrival);
+    if (!_txRing.empty()) _horizon = min(_horizon, _txNextDone);
+    if (_wdtMs) _horizon = min(_horizon, _wdtLast + (uint64_t)_wdtMs * (F_CPU / 1000) + 1);
+}
+
+void NativeSim::runLoop() {
+    loop();
+    advance((uint64_t)NATIVE_LOOP_US * NATIVE_CYCLES_PER_US);
+}
+
+// The cycle of the next compare match. A count already past OCR runs on to the wrap.
+uint64_t NativeSim::_nextCompare(const Timer& t) const {
+    uint64_t p = prescaler(t);
+    uint64_t match = ((uint64_t)*t.ocr + 1) * p;
+    return (_now - t.base <= match) ? t.base + match : t.base + 0x10000 * p + match;
+}
+
+// Every match up to now sets the flag and restarts the count (CTC)
+void NativeSim::_catchUp(Timer& t) {
+    uint64_t p = prescaler(t);
+    if (!p) return;
+    uint64_t due;
+    while ((due = _nextCompare(t)) <= _now) {
+        t.base = due;
+        t.pending = true;
+        uint64_t period = ((uint64_t)*t.ocr + 1) * p;
+        t.base += (_now - t.base) / period * period;
+    }
+}
+
+// Lower vector first, as the AVR does: Timer3 before Timer4
+void NativeSim::_runPendingIsrs() {
+    while (_irq && !_inIsr) {
+        Timer* run = nullptr;
+        for (uint8_t i = 0; i < 2 && !run; i++) {
+            Timer& t = _timers[i];
+            if (t.pending && (*t.timsk & _BV(t.flagBit)) && t.vector) run = &t;
+        }
+        if (!run) return;
+        run->pending = false;
+        _inIsr = true;
+        _irq = false;
+        advance(NATIVE_ISR_CYCLES / 2);
+        run->vector();
+        advance(NATIVE_ISR_CYCLES / 2);
+        _irq = true;
+        _inIsr = false;
+    }
+}
+
+void NativeSim::setInterrupts(bool on) {
+    _irq = on;
+    if (on) _runPendingIsrs();
+}
+
+uint16_t NativeSim::timerCount(uint8_t n) {
+    Timer& t = timer(n);
+    uint64_t p = prescaler(t);
+    if (!p) return 0;
+    advance(p);
+    return (uint16_t)((_now - t.base) / p);
+}
+
+void NativeSim::timerWrite(uint8_t n, uint16_t count) {
+    Timer& t = timer(n);
+    uint64_t p = prescaler(t);
+    t.base = _now - (uint64_t)count * p; // A stopped timer (p = 0) starts from 0 when clocked
+    _horizon = 0;
+}
+
+void NativeSim::clearTimerFlag(uint8_t n) {
+    timer(n).pending = false;
+    _horizon = 0;
+}
+
+//===========================================================================
+// Pins
+//===========================================================================
+
+uint8_t NativeSim::level(uint8_t pin) const {
+    uint8_t p = digitalPinToPort(pin), mask = digitalPinToBitMask(pin);
+    return ((_ddr[p] & mask) ? _port[p] & mask : _pin[p] & mask) ? HIGH : LOW;
+}
+
+void NativeSim::setInput(uint8_t pin, uint8_t level) {
+    uint8_t p = digitalPinToPort(pin), mask = digitalPinToBitMask(pin);
+    if (level) _pin[p] |= mask;
+    else _pin[p] &= ~mask;
+}
+
+void NativeSim::pinsChanged() {
+    if (memcmp(_port, _reported, PORTS) == 0) return; // Nearly every call
+    for (uint8_t p = 0; p < PORTS; p++) {
+        uint8_t diff = _port[p] ^ _reported[p];
+        if (!diff) continue;
+        _reported[p] = _port[p];
+        if (!_pinHook) continue;
+        for (uint8_t b = 0; b < 8; b++) {
+            if (diff & (1 << b)) _pinHook((p - 1) * 8 + b, (_port[p] >> b) & 1, _now);
+        }
+    }
+}
+
+//===========================================================================
+// UART0
+//===========================================================================
+
+void NativeSim::sendToFirmware(const char* data, size_t len) {
+    if (_rxWire.empty()) _rxNextArrival = _now + _byteCycles;
+    _rxWire.append(data, len);
+    _horizon = 0;
+}
+
+std::string NativeSim::takeOutput() {
+    std::string out;
+    out.swap(_output);
+    return out;
+}
+
+void NativeSim::_serviceSerial() {
+    bool rx = !_rxWire.empty() && _rxNextArrival <= _now;
+    bool tx = !_txRing.empty() && _txNextDone <= _now;
+    if (!rx && !tx) return; // Nearly every call
+    size_t arrived = 0;
+    while (arrived < _rxWire.size() && _rxNextArrival <= _now) {
+        // HardwareSerial drops a byte that finds the ring full
+        if (_rxRing.size() < SERIAL_RX_BUFFER_SIZE - 1) _rxRing += _rxWire[arrived];
+        else _rxOverruns++;
+        arrived++;
+        _rxNextArrival += _byteCycles;
+    }
+    if (arrived) _rxWire.erase(0, arrived);
+
+    size_t sent = 0;
+    while (sent < _txRing.size() && _txNextDone <= _now) {
+        _output += _txRing[sent];
+        sent++;
+        _txNextDone += _byteCycles;
+    }
+    if (sent) _txRing.erase(0, sent);
+}
+
+void NativeSim::serialBegin(unsigned long baud) {
+    _byteCycles = F_CPU * 10 / baud; // Start, 8 data, stop
+}
+
+int NativeSim::serialAvailable() {
+    advance(NATIVE_SERIAL_CALL_CYCLES);
+    return _rxRing.size();
+}
+
+int NativeSim::serialPeek() {
+    advance(NATIVE_SERIAL_CALL_CYCLES);
+    return _rxRing.empty() ? -1 : (uint8_t)_rxRing[0];
+}
+
+int NativeSim::serialRead() {
+    advance(NATIVE_SERIAL_CALL_CYCLES);
+    if (_rxRing.empty()) return -1;
+    uint8_t c = _rxRing[0];
+    _rxRing.erase(0, 1);
+    return c;
+}
+
+int NativeSim::serialAvailableForWrite() {
+    advance(NATIVE_SERIAL_CALL_CYCLES);
+    return SERIAL_TX_BUFFER_SIZE - 1 - (int)_txRing.size();
+}
+
+void NativeSim::serialWrite(uint8_t c) {
+    // A full ring blocks until the UART has shifted a byte out
+    while (_txRing.size() >= SERIAL_TX_BUFFER_SIZE - 1) advance(_txNextDone > _now ? _txNextDone - _now : 1);
+    if (_txRing.empty()) {
+        _txNextDone = _now + _byteCycles;
+        _horizon = 0;
+    }
+    _txRing += (char)c;
+    advance(NATIVE_SERIAL_CALL_CYCLES);
+}
+
+//===========================================================================
+// SD card and watchdog
+//===========================================================================
+
+void NativeSim::setSdRoot(const char* dir) {
+    _sdRoot = dir ? dir : "";
+#ifdef NATIVE_SD_DETECT_PIN
+    setInput(NATIVE_SD_DETECT_PIN, _sdRoot.empty() ? HIGH : LOW); // The detect switch pulls the pin low
+#endif
+}
+
+void NativeSim::wdtEnable(int timeout) {
+    _wdtMs = wdt_timeout_ms[timeout];
+    _wdtLast = _now;
+    _horizon = 0;
+}
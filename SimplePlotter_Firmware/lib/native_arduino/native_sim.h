@@ -0,0 +1,142 @@
+// SimplePlotter_Firmware/lib/native_arduino/native_sim.h
+
+#ifndef NATIVE_SIM_H
+#define NATIVE_SIM_H
+
+#include <Arduino.h>
+
+// Virtual board behind the native Arduino core. It has a cycle clock at F_CPU,
+// Timer3/Timer4 compare interrupts, port bytes, UART0 at its wire rate, the SD card
+// as a host directory and an erased EEPROM.
+//
+// The clock moves only when the firmware calls the core, by a fixed cost per call, so
+// every run of the same input gives the same steps at the same cycles:
+//   micros()/millis()            NATIVE_TIME_CALL_CYCLES
+//   digitalWrite()/digitalRead()  NATIVE_PIN_CALL_CYCLES
+//   TCNTn read                   one timer count
+//   delay()/delayMicroseconds()  exactly the delay
+//   ISR entry + exit             NATIVE_ISR_CYCLES
+//   one loop() pass              NATIVE_LOOP_US on top of the calls it made
+// Timer compares that fall due while interrupts are off run when they come back on,
+// as on the AVR; a compare whose OCR was set below the count waits for the wrap.
+
+#define NATIVE_CYCLES_PER_US     (F_CPU / 1000000UL)
+#define NATIVE_TIME_CALL_CYCLES  16    // micros(): about 1 us
+#define NATIVE_PIN_CALL_CYCLES   60    // digitalWrite(): about 4 us
+#define NATIVE_SERIAL_CALL_CYCLES 16
+#define NATIVE_ISR_CYCLES        80    // Register save/restore around a vector
+#define NATIVE_LOOP_US           100   // Work in a loop() pass that calls nothing timed
+
+// Called for every level change of an output pin, with the cycle it happened in
+typedef void (*NativePinHook)(uint8_t pin, uint8_t level, uint64_t cycle);
+
+class NativeSim {
+public:
+    NativeSim();
+
+    // Clock
+    uint64_t cycles() const { return _now; }
+    double seconds() const { return (double)_now / F_CPU; }
+    void advance(uint64_t cycles); // Runs timer ISRs that fall due on the way
+    void runLoop();                 // One loop() pass plus NATIVE_LOOP_US
+
+    // Pins
+    uint8_t level(uint8_t pin) const; // Output latch, or input level; costs no time
+    void setInput(uint8_t pin, uint8_t level); // Inputs read HIGH (pulled up) until set
+    void setAnalog(uint8_t pin, int value) { _analog[pin] = value; }
+    int analog(uint8_t pin) const { return _analog[pin]; }
+    void watchPins(NativePinHook hook) { _pinHook = hook; }
+
+    // Host end of UART0: bytes sent here reach Serial one frame time apart
+    void sendToFirmware(const char* data, size_t len);
+    void sendToFirmware(const char* line) { sendToFirmware(line, strlen(line)); }
+    bool wireIdle() const { return _rxWire.empty(); }
+    std::string takeOutput(); // What the firmware has finished sending since the last call
+    unsigned long rxOverruns() const { return _rxOverruns; }
+
+    // SD card: files in this directory; none (nullptr) = no card in the slot. With
+    // NATIVE_SD_DETECT_PIN defined, that input follows the card.
+    void setSdRoot(const char* dir);
+    const char* sdRoot() const { return _sdRoot.empty() ? nullptr : _sdRoot.c_str(); }
+
+    // Watchdog expiries (8 s without wdt_reset() in an enabled watchdog)
+    unsigned long watchdogBites() const { return _wdtBites; }
+
+    //=== Used by the core ===
+    struct Timer {
+        volatile uint8_t* tccrb;
+        volatile uint16_t* ocr;
+        volatile uint8_t* timsk;
+        uint8_t flagBit;
+        uint64_t base;   // Cycle the count was last 0
+        bool pending;    // Compare flag
+        void (*vector)();
+        uint8_t seenTccrb, seenTimsk; // Registers as the last event horizon saw them
+        uint16_t seenOcr;
+    };
+    Timer& timer(uint8_t n) { return _timers[n == 3 ? 0 : 1]; }
+    uint16_t timerCount(uint8_t n);
+    void timerWrite(uint8_t n, uint16_t count);
+    void clearTimerFlag(uint8_t n);
+
+    volatile uint8_t* port(uint8_t p) { return &_port[p]; }
+    volatile uint8_t* portInput(uint8_t p) { return &_pin[p]; }
+    volatile uint8_t* portMode(uint8_t p) { return &_ddr[p]; }
+    void pinsChanged(); // Report output edges since the last check
+
+    bool interruptsEnabled() const { return _irq; }
+    void setInterrupts(bool on);
+
+    void serialBegin(unsigned long baud);
+    int serialAvailable();
+    int serialPeek();
+    int serialRead();
+    int serialAvailableForWrite();
+    void serialWrite(uint8_t c);
+
+    void wdtEnable(int timeout);
+    void wdtDisable() { _wdtMs = 0; }
+    void wdtReset() { _wdtLast = _now; }
+
+private:
+    static const uint8_t PORTS = NUM_DIGITAL_PINS / 8 + 2;
+
+    uint64_t _now;
+    uint64_t _horizon; // Nothing happens before this cycle unless a timer register changes
+    bool _irq;
+    bool _inIsr;
+    Timer _timers[2]; // Timer3, Timer4
+
+    uint8_t _port[PORTS];     // Output latches
+    uint8_t _ddr[PORTS];
+    uint8_t _pin[PORTS];      // Input levels
+    uint8_t _reported[PORTS]; // Output levels as last reported to the hook
+    int _analog[NUM_DIGITAL_PINS];
+    NativePinHook _pinHook;
+
+    uint32_t _byteCycles;
+    std::string _rxWire;       // Bytes on their way in
+    uint64_t _rxNextArrival;   // Cycle the first of them is complete
+    std::string _rxRing;       // Serial's receive buffer
+    unsigned long _rxOverruns;
+    std::string _txRing;       // Bytes waiting to be shifted out
+    uint64_t _txNextDone;
+    std::string _output;
+
+    std::string _sdRoot;
+
+    unsigned long _wdtMs;
+    uint64_t _wdtLast;
+    unsigned long _wdtBites;
+
+    bool _quietUntil(uint64_t end) const;
+    void _setHorizon();
+    void _catchUp(Timer& t);
+    uint64_t _nextCompare(const Timer& t) const;
+    void _runPendingIsrs();
+    void _serviceSerial();
+};
+
+extern NativeSim nativeSim; // Global instance
+
+#endif // NATIVE_SIM_H
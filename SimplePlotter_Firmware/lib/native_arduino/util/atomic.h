@@ -0,0 +1,29 @@
+// SimplePlotter_Firmware/lib/native_arduino/util/atomic.h
+
+#ifndef UTIL_ATOMIC_H
+#define UTIL_ATOMIC_H
+
+#include <stdint.h>
+
+// Interrupts off for the block; on leaving, RESTORESTATE puts back what was there and
+// FORCEON enables them. Timer compares that fell due inside run then.
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON      1
+
+bool nativeAtomicEnter(); // Interrupts off; returns whether they were on
+void nativeAtomicLeave(bool on);
+
+class NativeAtomic {
+public:
+    explicit NativeAtomic(uint8_t restore) : _restore(restore), _was(nativeAtomicEnter()), _pass(0) {}
+    ~NativeAtomic() { nativeAtomicLeave(_restore == ATOMIC_FORCEON || _was); }
+    bool once() { return _pass++ == 0; }
+private:
+    uint8_t _restore;
+    bool _was;
+    uint8_t _pass;
+};
+
+#define ATOMIC_BLOCK(type) for (NativeAtomic _atomic_guard(type); _atomic_guard.once(); )
+
+#endif // UTIL_ATOMIC_H
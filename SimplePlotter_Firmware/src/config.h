@@ -45,6 +45,13 @@
 #define LCD_PINS_D6     27
 #define LCD_PINS_D7     29
 
+// ST7920 byte transport (see ui/lcd_transport.h)
+#define LCD_TRANSPORT_SW_SPI    0     // U8g2 stock bit-bang (digitalWrite per edge)
+#define LCD_TRANSPORT_FAST_SW   1     // Direct port writes on the same EXP1 pins
+#define LCD_TRANSPORT_HW_SPI    2     // SPI peripheral, interrupt-driven; needs SCLK->D52, SID->D51
+#define LCD_TRANSPORT           LCD_TRANSPORT_SW_SPI  // FAST_SW once M503 display timings from a board back it
+#define LCD_TX_RING_SIZE        64    // HW_SPI transmit ring (power of 2)
+
 #define BTN_EN1         31    // Rotary encoder pin A
 #define BTN_EN2         33    // Rotary encoder pin B
 #define BTN_ENC         35    // Rotary encoder push button
@@ -58,40 +65,78 @@
 //                            MACHINE DIMENSIONS & STEPS
 //===========================================================================
 
-// Machine dimensions measured from physical plotter (in mm)
-#define X_MAX_POS       234.0  // Measured pen travel: home (right) to far wall (left)
-#define Y_MAX_POS       191.0  // Measured bed travel: home (front) to far wall (back)
-#define Z_MAX_POS       203.0  // Measured Z travel (only 0-5mm used for pen)
-
-// Steps per mm calculation
-// DRV8825 drivers at 1/32 microstepping, GT2 belt, 20-tooth pulley:
-// Steps per revolution = 200 (full steps) * 32 (microstepping) = 6400
-// Pulley circumference = 20 teeth * 2mm = 40mm
-// Steps per mm = 6400 / 40 = 160 steps/mm
-// Verified: 50mm command moved 24.5mm at 80 steps/mm → 4000/24.5 ≈ 163 ≈ 160
-#define X_STEPS_PER_MM  160.0
-#define Y_STEPS_PER_MM  160.0
-
-// For Z-axis Leadscrew (T8 leadscrew: 8mm pitch, 1/16 microstepping)
-// Steps per revolution = 200 (full steps) * 16 (microstepping) = 3200
-// Leadscrew pitch = 8mm/rev
-// Steps per mm = 3200 / 8 = 400 steps/mm
-// TODO: If Z uses DRV8825 at 1/32, this should be 800 — verify physically
-#define Z_STEPS_PER_MM  400.0
+// Mechanics (steps/mm, travel, acceleration, velocity) live in typed profiles in
+// machine_config.h; pick one here or with -DMACHINE_PROFILE=... in platformio.ini.
+#define MACHINE_PROFILE_PLOTTER_V1      1     // Original build, Z at 1/16 (400 steps/mm)
+#define MACHINE_PROFILE_PLOTTER_V1_Z32  2     // Same, Z driver at 1/32 (800 steps/mm)
+#ifndef MACHINE_PROFILE
+#define MACHINE_PROFILE                 MACHINE_PROFILE_PLOTTER_V1
+#endif
+#define MAX_STEP_RATE_HZ                20000 // Highest per-axis step rate the step loop sustains
+
+#include "machine_config.h"
+
+// Names used throughout the firmware, as aliases of the selected profile
+#define X_MAX_POS       (MACHINE.x.max_pos)
+#define Y_MAX_POS       (MACHINE.y.max_pos)
+#define Z_MAX_POS       (MACHINE.z.max_pos)
+#define X_STEPS_PER_MM  (MACHINE.x.steps_per_mm)
+#define Y_STEPS_PER_MM  (MACHINE.y.steps_per_mm)
+#define Z_STEPS_PER_MM  (MACHINE.z.steps_per_mm)
 
 //===========================================================================
 //                               MOTION PARAMETERS
 //===========================================================================
 
-// Max Acceleration (mm/s^2)
-#define MAX_ACCEL_X     1000.0  // Configurable: 500-2000
-#define MAX_ACCEL_Y     1000.0
-#define MAX_ACCEL_Z     500.0   // Pen lift - gentle
-
-// Max Velocity (mm/s)
-#define MAX_VELOCITY_XY 100.0   // 6000 mm/min rapid moves
+// Max Acceleration (mm/s^2) and Velocity (mm/s), from the machine profile
+#define MAX_ACCEL_X     (MACHINE.x.max_accel)
+#define MAX_ACCEL_Y     (MACHINE.y.max_accel)
+#define MAX_ACCEL_Z     (MACHINE.z.max_accel)
+#define MAX_VELOCITY_XY MACHINE_MAX_VELOCITY_XY
 #define DEFAULT_DRAW_VELOCITY_XY 50.0 // 3000 mm/min default drawing speed
-#define MAX_VELOCITY_Z  10.0    // 600 mm/min pen lift
+#define MAX_VELOCITY_Z  (MACHINE.z.max_velocity)
+#define MAX_VELOCITY_X  (MACHINE.x.max_velocity) // Per-axis ceilings used by the vector limiter
+#define MAX_VELOCITY_Y  (MACHINE.y.max_velocity)
+
+// Per-move-type path limits (mm/s^2 and mm/s), applied along the actual move vector.
+// The limiter additionally keeps every axis component within its own acceleration and
+// velocity limit, so diagonal moves never exceed a single axis' limit. Those per-axis
+// limits start at the profile's MAX_ACCEL_* / MAX_VELOCITY_* and are replaced by the
+// values M172 measures. G0 travel has no separate ceiling: it runs at the axis limits.
+#define DRAW_ACCEL      1000.0  // G1 drawing moves
+#define PEN_ACCEL       MAX_ACCEL_Z      // Z-only pen lift/lower moves
+#define DRAW_VELOCITY   MAX_VELOCITY_XY
+#define PEN_VELOCITY    MAX_VELOCITY_Z
+
+// Motion-limit auto-tune (M172, X/Y): back-and-forth strokes through the motion queue at
+// rising acceleration, then rising velocity. After each level the endstop is touched
+// slowly; a trigger that moved more than AUTOTUNE_LOSS_MM from the post-homing baseline
+// means steps were lost. Stored limits = highest passing level * AUTOTUNE_SAFETY_FACTOR.
+#define AUTOTUNE_ACCEL_START        500.0  // mm/s^2, first level
+#define AUTOTUNE_ACCEL_MAX          5000.0 // mm/s^2, search ceiling
+#define AUTOTUNE_VELOCITY_START     50.0   // mm/s; ceiling is MAX_STEP_RATE_HZ / steps per mm
+#define AUTOTUNE_STEP_FACTOR        1.25   // Each level this much more aggressive than the last
+#define AUTOTUNE_STROKES            8      // Back-and-forth strokes per level
+#define AUTOTUNE_SPAN_MM            100.0  // Stroke length (shortened to fit the axis travel)
+#define AUTOTUNE_CHECK_MM           5.0    // Strokes start and end this far from the switch
+#define AUTOTUNE_LOSS_MM            0.1    // Half a full step at 160 steps/mm, 1/32 microstepping
+#define AUTOTUNE_SAFETY_FACTOR      0.75
+
+// Motion queue: G0/G1 are planned into blocks and acknowledged once queued, so the host
+// can stream while the previous moves run. Steps come from a Timer4 compare ISR; loop()
+// only advances each block's speed profile.
+#define MOTION_QUEUE_SIZE           16    // Planned moves (44 bytes each)
+
+// Input shaping (XY ringing suppression, M593 to tune at runtime)
+// Step rates are shaped with a ZV or ZVD filter tuned to the gantry's ringing frequency.
+// This delays each move by half a ringing period (ZV) or one period (ZVD) but allows
+// much higher MAX_ACCEL_X/Y without visible wobble after corners. Frequency 0 = off.
+#define INPUT_SHAPING_FREQ_X        0.0   // Hz, measured from the ringing on a test print
+#define INPUT_SHAPING_FREQ_Y        0.0   // Hz (Y carries the bed, usually lower than X)
+#define INPUT_SHAPING_ZETA_X        0.1   // Damping ratio (0..<1)
+#define INPUT_SHAPING_ZETA_Y        0.1
+#define INPUT_SHAPING_TYPE          SHAPER_ZV // SHAPER_ZV or SHAPER_ZVD
+#define INPUT_SHAPING_HISTORY_MS    64    // Step-rate history (power of 2); limits min freq (~16 Hz ZVD, ~8 Hz ZV)
 
 // Jerk (mm/s - for trapezoidal velocity profiles, if used)
 // AccelStepper handles this internally, but conceptually for software limits
@@ -101,6 +146,23 @@
 #define PEN_UP_Z        3.0     // Z position when pen is raised (above paper)
 #define PEN_DOWN_Z      0.5     // Z position when pen contacts paper
 
+// Pen actuator (motion/pen.h), chosen at build time with -DPEN_BACKEND=...
+// Z_STEPPER: the pen height is the Z axis (leadscrew, needs homing, ~0.3 s per lift).
+// SERVO: a hobby servo on PEN_SERVO_PIN lifts the pen in ~50 ms. G-code Z then only
+// selects up (Z at or above the midpoint of pen up/down Z) or down, queued in order
+// with the XY moves. The Z stepper stays put and G29 is unavailable.
+#define PEN_BACKEND_Z_STEPPER   1
+#define PEN_BACKEND_SERVO       2
+#ifndef PEN_BACKEND
+#define PEN_BACKEND             PEN_BACKEND_Z_STEPPER
+#endif
+#define PEN_SERVO_PIN           11    // SERVO0 header = OC1A, Timer1 hardware PWM
+#define PEN_SERVO_UP_DEG        90
+#define PEN_SERVO_DOWN_DEG      30
+#define PEN_SERVO_MIN_US        544   // Pulse width at 0 degrees
+#define PEN_SERVO_MAX_US        2400  // Pulse width at 180 degrees
+#define PEN_SERVO_SETTLE_MS     150   // Queued motion waits this long after each change
+
 // Homing Parameters
 #define HOMING_FEEDRATE_FAST    20.0  // mm/s for fast approach (gentle to avoid missed steps)
 #define HOMING_FEEDRATE_SLOW    5.0   // mm/s for slow approach (precision)
@@ -108,6 +170,76 @@
 #define HOMING_TIMEOUT_S        60    // seconds before homing times out per axis
 #define HOMING_ACCEL_FACTOR     0.5   // Use 50% of normal acceleration during homing
 #define Z_HOME_POSITION         2.0   // mm above sensor after Z homing (pen start position)
+#define HOMING_SETTLE_MS        200   // Mechanical settle after each homing stop (ms)
+#define HOMING_TRIGGER_READS    4     // Closed readings in a row that count as a touch; a stray one doesn't
+
+// Homing calibration (M171): touches each endstop repeatedly at every feedrate below,
+// measures switch release distance, trigger spread and settling, and stores per-axis
+// backoff / slow feedrate / settle time (M500 to keep) that replace the defaults above.
+#define HOMING_TUNE_FEEDRATES           10.0f, 5.0f, 2.5f, 1.0f // mm/s candidates, fastest first
+#define HOMING_TUNE_TOUCHES             5     // Touches per feedrate
+#define HOMING_TUNE_REPEATABILITY_MM    0.02  // Required trigger spread (max - min)
+#define HOMING_TUNE_RELEASE_FEEDRATE    1.0   // mm/s while measuring the switch release distance
+#define HOMING_TUNE_BACKOFF_MARGIN      1.5   // Backoff = release distance * margin + accel run-up
+#define HOMING_TUNE_MIN_BACKOFF_MM      0.5
+#define HOMING_TUNE_SETTLE_WINDOW_MS    300   // Switch watched this long after each stop
+#define HOMING_TUNE_SETTLE_MARGIN_MS    10    // Added to the longest observed bounce
+
+// Endstop simulator (io/endstop_sim.h), chosen at build time with -DENDSTOP_SIM=1
+// (env:mks_gen_1_4_endstop_sim). Virtual switches driven by the step counts replace the
+// endstop pins; M934 runs randomized homing trials against them. The motors still step:
+// unplug them or take the belts off, because the real switches are ignored.
+#ifndef ENDSTOP_SIM
+#define ENDSTOP_SIM                     0
+#endif
+#define ENDSTOP_SIM_OVERTRAVEL_MM       2.0   // Hard stop this far past the trigger point; steps beyond it are lost
+#define ENDSTOP_SIM_HYSTERESIS_MM       0.10  // Switch opens this far back from where it closed (M934 H)
+#define ENDSTOP_SIM_JITTER_MM           0.01  // Trigger point varies by up to +-this per touch (M934 J)
+#define ENDSTOP_SIM_BOUNCE_MS           2     // Random readings after each edge (M934 B)
+#define ENDSTOP_SIM_NOISE_PPM           0     // Readings flipped per million (M934 R)
+#define ENDSTOP_SIM_RUNS                20    // M934 without N
+
+// Paper height map (G29 probe, M420 enable/report)
+// The Z optical endstop is touched at each grid point to measure the local paper height.
+// When enabled, G0/G1 Z targets are offset by the bilinearly interpolated height, so
+// PEN_DOWN_Z / PEN_UP_Z become heights above the local paper surface and can be
+// reduced to the minimum that clears the paper.
+#define HEIGHTMAP_GRID_X            4     // Probe points along X (>= 2)
+#define HEIGHTMAP_GRID_Y            4     // Probe points along Y (>= 2)
+#define HEIGHTMAP_MIN_X             10.0  // Probed area (mm)
+#define HEIGHTMAP_MAX_X             (X_MAX_POS - 10.0)
+#define HEIGHTMAP_MIN_Y             10.0
+#define HEIGHTMAP_MAX_Y             (Y_MAX_POS - 10.0)
+#define HEIGHTMAP_CLEARANCE_Z       3.0   // Z height for travel between probe points (mm)
+#define HEIGHTMAP_PROBE_FEEDRATE    2.0   // Z descent speed while probing (mm/s)
+#define HEIGHTMAP_MAX_DEPTH_MM      2.0   // Give up if no trigger this far below Z=0 (mm)
+
+// Continuous jog (LCD encoder, M170 velocity command, realtime cancel byte)
+// Jog steps are generated from a Timer3 tick so LCD redraws don't stall the carriage.
+#define JOG_MAX_VELOCITY_XY     50.0  // mm/s
+#define JOG_MAX_VELOCITY_Z      5.0   // mm/s
+#define JOG_ACCEL_XY            500.0 // mm/s^2 (also used for the stop ramp)
+#define JOG_ACCEL_Z             200.0 // mm/s^2
+#define JOG_MM_PER_DETENT       0.5   // Encoder: velocity = distance per detent / time between detents
+#define JOG_COMMAND_TIMEOUT_MS  250   // Dead-man: decelerate if velocity isn't refreshed in time
+#define JOG_TICK_HZ             10000 // Step tick rate while jogging (caps jog step rate)
+#define JOG_CANCEL_CHAR         0x85  // Realtime serial byte: cancel jog (Grbl-compatible)
+#define QUICKSTOP_CHAR          0x18  // Realtime serial byte: M410 quickstop, ahead of anything queued (Ctrl-X)
+
+// Host-planned blocks (M932 S1): binary frames <HOST_FRAME_START> <len> <record> <crc16>
+// carrying one step stream record each, taken between text lines
+#define HOST_FRAME_START        0x02  // STX; never part of a G-code line
+#define HOST_FRAME_TIMEOUT_MS   100   // A frame not complete by then is dropped
+#define HOST_FRAME_RECORD_MAX   37    // Longest record: flags + 3 axes (StepStream::RECORD_MAX)
+
+// LZSS-compressed input (heatshrink format, advertised as Cap:LZSS in M115): serial
+// frames <LZSS_FRAME_START> <len> <data> <crc16> and .gcz files on the SD card. Each
+// decoder keeps a 2^LZSS_WINDOW_BITS byte window; 0 compiles both paths out.
+#define LZSS_ENABLED            1
+#define LZSS_WINDOW_BITS        8     // heatshrink -w
+#define LZSS_LOOKAHEAD_BITS     4     // heatshrink -l
+#define LZSS_FRAME_START        0x01  // SOH; never part of a G-code line
+#define LZSS_FRAME_MAX          64    // Compressed bytes per serial frame
 
 //===========================================================================
 //                             ENDSTOP CONFIGURATION
@@ -146,15 +278,45 @@
 //                           SERIAL COMMUNICATION
 //===========================================================================
 #define BAUDRATE                115200
+#define READY_TOKEN             "start" // Printed on its own line once commands are accepted (Marlin-compatible)
 
 // G-code buffer size
-#define GCODE_BUFFER_SIZE       8       // Number of G-code commands to buffer
+#define GCODE_BUFFER_SIZE       6       // Number of G-code commands to buffer
 #define GCODE_MAX_LENGTH        64      // Max characters per G-code line
 
 //===========================================================================
 //                               MISCELLANEOUS
 //===========================================================================
 
+// Persistent settings in EEPROM (M500 save, M501 load, M502 defaults)
+#define SETTINGS_EEPROM_ADDR            0
+#define SETTINGS_VERSION                3   // Bump when PersistentSettings changes layout
+
+// Trusted-position resume (M933): the resting position and homed flags are kept in
+// EEPROM, so a reboot restores them instead of requiring G28
+#define POSITION_TRUST_EEPROM_ADDR      128  // After the settings block
+#define POSITION_TRUST_IDLE_MS          5000 // Machine at rest this long before its position is saved
+
+// Job ETA (SD screen, plot preview, M154 status line): estimated time of the queued
+// blocks plus the unread file bytes at a time-per-byte rate learned while the job runs
+#define ETA_WINDOW_BYTES                1024 // Rate re-measured over each window of file bytes
+#define ETA_RATE_WEIGHT                 0.3  // Weight of the newest window in the rolling rate
+
+// SD writers (M928 capture, M930 step stream, M936/M938 sessions) take turns on one file
+// and one RAM buffer of SD_WRITE_CHUNK_BYTES plus a line of overflow
+#define SD_WRITE_CHUNK_BYTES            256  // Written between blocks, a chunk at a time
+
+// Serial job capture to SD (M928/M29)
+#define SD_CAPTURE_DEFAULT_NAME         "CAPTURE.GC" // M928 without a file name
+
+// Step stream recording (M930/M931), replayed from the LCD file browser
+#define STEP_STREAM_DEFAULT_NAME        "STREAM.STP" // M930 without a file name
+
+// Serial session capture (M936/M937) and replay (M938)
+#define SESSION_DEFAULT_NAME            "SESSION.SSN" // M936/M938 without a file name
+#define SESSION_CHUNK_MAX               32   // Received bytes per record
+#define SESSION_LATENCY_SLOTS           8    // Replayed lines awaiting their ok, for the latency figures
+
 // Stepper idle timeout
 #define DISABLE_STEPPERS_AFTER_IDLE_S   600 // Disable steppers after 10 minutes of idle
 
@@ -164,6 +326,12 @@
 // Debugging
 #define DEBUG_SERIAL_COMMUNICATION      false // Set to true to echo received commands
 
+// Event trace: timestamped ring of loop/motion/UI events kept in .noinit RAM, so it
+// survives a watchdog reset. Dump with M157. 0 compiles every tracepoint out.
+#define EVENT_TRACE_ENABLED             1
+#define EVENT_TRACE_SIZE                32   // Events (power of 2, <= 128), 8 bytes each
+#define EVENT_TRACE_WDT_WARN_MS         2000 // Longer loop() pass is logged as a watchdog near-miss
+
 // Status Icons for LCD
 #define ICON_USB_CONNECTED    "#" // Example: filled square
 #define ICON_USB_DISCONNECTED "O" // Example: empty circle
@@ -9,7 +9,7 @@
 #include "commands.h"            // Include our G-code command definitions
 
 // Define the size of the G-code command buffer
-#define GCODE_COMMAND_BUFFER_SIZE GCODE_BUFFER_SIZE // From config.h (8 commands)
+#define GCODE_COMMAND_BUFFER_SIZE GCODE_BUFFER_SIZE // From config.h (6 commands)
 
 class GCodeBuffer {
 public:
@@ -4,14 +4,16 @@
 #define GCODE_COMMANDS_H
 
 #include <Arduino.h>
+#include "../config.h"
 
 // Define possible G-code command types
-enum GCodeType {
+enum GCodeType : uint8_t {
     GCODE_UNKNOWN = 0,
     // Motion Commands
     GCODE_G0,  // Rapid Move
     GCODE_G1,  // Linear Move
     GCODE_G28, // Home
+    GCODE_G29, // Probe paper height map
     GCODE_G90, // Absolute Positioning
     GCODE_G91, // Relative Positioning
     GCODE_G92, // Set Position
@@ -20,14 +22,38 @@ enum GCodeType {
     GCODE_M0,   // Unconditional Stop
     GCODE_M24,  // Resume SD/serial execution
     GCODE_M25,  // Pause SD/serial execution
+    GCODE_M29,  // Stop SD capture
     GCODE_M84,  // Disable Steppers
     GCODE_M114, // Get Current Position
     GCODE_M115, // Get Firmware Info
     GCODE_M119, // Get Endstop Status
+    GCODE_M154, // Status auto-report interval
+    GCODE_M156, // Latency tracing on/off
+    GCODE_M157, // Event trace dump/clear
+    GCODE_M170, // Continuous jog velocity
+    GCODE_M171, // Homing calibration
+    GCODE_M172, // Motion-limit auto-tune
     GCODE_M220, // Set Speed Factor
+    GCODE_M400, // Wait for queued moves
     GCODE_M410, // Quickstop
+    GCODE_M420, // Height map enable/report
+    GCODE_M500, // Save settings to EEPROM
+    GCODE_M501, // Load settings from EEPROM
+    GCODE_M502, // Reset settings to defaults
     GCODE_M503, // Report Settings
-    GCODE_M999  // Z Motor Raw Test (diagnostic)
+    GCODE_M593, // Input shaping
+    GCODE_M928, // Start SD capture
+    GCODE_M930, // Start step stream recording
+    GCODE_M931, // Stop step stream recording
+    GCODE_M932, // Host-planned block frames on/off
+    GCODE_M933, // Trusted-position resume on/off
+    GCODE_M934, // Homing trials against the endstop simulator
+    GCODE_M936, // Start serial session capture
+    GCODE_M937, // Stop serial session capture
+    GCODE_M938, // Replay a serial session
+    GCODE_M999, // Z Motor Raw Test (diagnostic)
+
+    GCODE_HOST_BLOCK // Host-planned motion block (binary frame, M932)
 };
 
 // Structure for common parameters
@@ -58,25 +84,135 @@ struct M84Params {
     bool has_s = false; float s_val = 0.0; // Timeout in seconds
 };
 
+struct M154Params {
+    bool has_s = false; float s_val = 0.0; // Report interval in ms (0 = off)
+};
+
+struct M156Params {
+    bool has_s = false; float s_val = 0.0; // 1 = trace commands, 0 = off
+};
+
+struct M157Params {
+    bool has_s = false; float s_val = 0.0; // S0 = clear the trace instead of dumping it
+};
+
+struct M170Params {
+    bool has_x = false; float x_val = 0.0; // Jog velocity in mm/s (signed)
+    bool has_y = false; float y_val = 0.0;
+    bool has_z = false; float z_val = 0.0;
+};
+
+struct M171Params {
+    bool axis_x = false; // No axis given = all axes
+    bool axis_y = false;
+    bool axis_z = false;
+};
+
+struct M172Params {
+    bool axis_x = false; // Neither X nor Y given = both axes
+    bool axis_y = false;
+};
+
 struct M220Params {
     bool has_s = false; float s_val = 0.0; // Speed factor in percent
 };
 
+struct M420Params {
+    bool has_s = false; float s_val = 0.0; // 1 = enable compensation, 0 = disable
+};
+
+struct M593Params {
+    bool axis_x = false; // Neither X nor Y given = both axes
+    bool axis_y = false;
+    bool has_f = false; float f_val = 0.0; // Frequency in Hz (0 = off)
+    bool has_d = false; float d_val = 0.0; // Damping ratio
+    bool has_t = false; float t_val = 0.0; // Shaper type: 0 = ZV, 1 = ZVD
+};
+
+struct M928Params {
+    char filename[13]; // 8.3 name + null; SD_CAPTURE_DEFAULT_NAME when none given
+    bool compact;      // S1 = write lines without spaces or trailing zeros
+};
+
+struct M930Params {
+    char filename[13]; // 8.3 name + null; STEP_STREAM_DEFAULT_NAME when none given
+};
+
+struct M932Params {
+    bool has_s = false; float s_val = 0.0; // 1 = accept block frames, 0 = off
+};
+
+struct M933Params {
+    bool has_s = false; float s_val = 0.0; // 1 = restore the saved position at boot, 0 = off
+};
+
+struct M934Params {
+    bool axis_x = false; // No axis given = X and Y
+    bool axis_y = false;
+    bool axis_z = false;
+    uint16_t runs = ENDSTOP_SIM_RUNS; // N, per axis
+    // Switch model changes; negative = keep the current value
+    float hysteresis_mm = -1.0; // H
+    float jitter_mm = -1.0;     // J
+    int16_t bounce_ms = -1;     // B
+    long noise_ppm = -1;        // R
+    int8_t dead_pct = -1;       // D: share of runs with a switch that never closes
+    unsigned long seed = 0;     // S, 0 = from micros()
+};
+
+struct M936Params {
+    char filename[13]; // 8.3 name + null; SESSION_DEFAULT_NAME when none given
+};
+
+struct M938Params {
+    char filename[13]; // 8.3 name + null; SESSION_DEFAULT_NAME when none given
+    bool fast;         // S1 = as fast as the acks allow, instead of the recorded pacing
+};
+
+struct HostBlockParams {
+    uint8_t record[HOST_FRAME_RECORD_MAX]; // One step stream record; its flags give the length
+};
+
 struct M999Params {
     char axis = 'Z'; // Default to Z for backward compatibility
 };
 
+// Latency trace of one command (see latency_trace.h); seq 0 = not traced
+struct CommandTrace {
+    uint16_t seq = 0;
+    uint32_t t_rx = 0;     // micros() when the line was complete
+    uint16_t parse_us = 0; // Parsed, relative to t_rx
+    uint16_t queue_us = 0; // Inserted into gcodeBuffer, relative to t_rx
+};
+
 // Main G-code command structure
 struct ParsedGCodeCommand {
     GCodeType type;
+    CommandTrace trace;
     
     union {
         GCodeParam  move;     // Used for G0, G1
         G28Params   g28_args;
         G92Params   g92_args;
         M84Params   m84_args;
+        M154Params  m154_args;
+        M156Params  m156_args;
+        M157Params  m157_args;
+        M170Params  m170_args;
+        M171Params  m171_args;
+        M172Params  m172_args;
         M220Params  m220_args;
+        M420Params  m420_args;
+        M593Params  m593_args;
+        M928Params  m928_args;
+        M930Params  m930_args;
+        M932Params  m932_args;
+        M933Params  m933_args;
+        M934Params  m934_args;
+        M936Params  m936_args;
+        M938Params  m938_args;
         M999Params  m999_args;
+        HostBlockParams host_block;
     };
 
     // Default constructor to initialize the union (optional, but good practice)
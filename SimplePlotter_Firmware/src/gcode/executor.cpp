@@ -0,0 +1,1008 @@
+// SimplePlotter_Firmware/src/gcode/executor.cpp
+
+#include "executor.h"
+#include "buffer.h"
+#include "latency_trace.h"
+#include "../utils/event_trace.h"
+#include "../globals.h"
+#include "../motion/motion_queue.h"
+#include "../motion/height_map.h"
+#include "../motion/motion_tuner.h"
+#include "../motion/pen.h"
+#include "../motion/step_stream.h"
+#include "../io/sd_card.h"
+#include "../io/sd_capture.h"
+#include "../io/buzzer.h"
+#include "../io/status_report.h"
+#include "../io/settings.h"
+#include "../io/position_trust.h"
+#include "../io/serial_session.h"
+#include "../ui/screens.h" // For sd_exec_state, plotPreviewScreen, lines_plotted
+#include "../ui/lcd_menu.h" // For frame timing in M503
+
+CommandExecutor executor; // Global instance definition
+
+typedef ExecResult (*CommandHandler)(const ParsedGCodeCommand& cmd);
+typedef void (*CompletionHandler)(const ParsedGCodeCommand& cmd);
+
+void syncPositionFromSteps() {
+    current_position_mm.x = kinematics.stepsToMmX(stepperControl.getCurrentXSteps());
+    current_position_mm.y = kinematics.stepsToMmY(stepperControl.getCurrentYSteps());
+#if PEN_BACKEND == PEN_BACKEND_SERVO
+    current_position_mm.z = pen.isUp() ? pen_up_z : pen_down_z; // Z is the pen state, not the stepper
+#else
+    current_position_mm.z = kinematics.stepsToMmZ(stepperControl.getCurrentZSteps());
+#endif
+}
+
+static void reportInputShaper(char axis) {
+    const InputShaper& shaper = stepperControl.getInputShaper(axis);
+    if (!shaper.isEnabled()) {
+        serialHandler.sendInfo((String(F("Input shaping ")) + String(axis) + F(": off")).c_str());
+        return;
+    }
+    serialHandler.sendInfo((String(F("Input shaping ")) + String(axis) + F(": ") + (shaper.type() == SHAPER_ZVD ? F("ZVD") : F("ZV")) +
+                            F(" F") + String(shaper.frequency()) + F(" D") + String(shaper.damping())).c_str());
+}
+
+static void flushCommandBuffer() {
+    while (!gcodeBuffer.isEmpty()) {
+        ParsedGCodeCommand dummy_cmd;
+        gcodeBuffer.pop(dummy_cmd);
+    }
+}
+
+//===========================================================================
+// Motion
+//===========================================================================
+
+static ExecResult handleMove(const ParsedGCodeCommand& cmd) { // G0/G1
+    if (motionQueue.isFull()) return EXEC_BUSY;
+
+    // Endstop-safe jogging: in relative mode, check endstops for axes moving toward home
+    // HOME_DIR_X=1 means endstop is at max, so positive jog = toward endstop
+    // HOME_DIR_Y=-1 means endstop is at min, so negative jog = toward endstop
+    uint8_t endstop_mask = 0;
+    if (!absolute_mode) {
+        if (cmd.move.has_x && ((HOME_DIR_X < 0) ? (cmd.move.x_val < -0.001f) : (cmd.move.x_val > 0.001f))) endstop_mask |= 0x01;
+        if (cmd.move.has_y && ((HOME_DIR_Y < 0) ? (cmd.move.y_val < -0.001f) : (cmd.move.y_val > 0.001f))) endstop_mask |= 0x02;
+        if (cmd.move.has_z && ((HOME_DIR_Z < 0) ? (cmd.move.z_val < -0.001f) : (cmd.move.z_val > 0.001f))) endstop_mask |= 0x04;
+#if PEN_BACKEND == PEN_BACKEND_SERVO
+        endstop_mask &= ~0x04; // Z never moves toward its endstop
+#endif
+    }
+    // A checked jog may end anywhere, so it runs alone and is acknowledged on completion
+    if (endstop_mask && !motionQueue.isIdle()) return EXEC_BUSY;
+
+    Point3D target_mm = current_position_mm;
+    float feedrate_mm_min = current_feedrate_mm_min;
+
+    // Apply parameters
+    if (cmd.move.has_x) target_mm.x = cmd.move.x_val;
+    if (cmd.move.has_y) target_mm.y = cmd.move.y_val;
+    if (cmd.move.has_z) target_mm.z = cmd.move.z_val;
+    if (cmd.move.has_f) feedrate_mm_min = cmd.move.f_val;
+
+    // Apply relative positioning if G91 is active
+    if (!absolute_mode) {
+        if (cmd.move.has_x) target_mm.x = current_position_mm.x + cmd.move.x_val;
+        if (cmd.move.has_y) target_mm.y = current_position_mm.y + cmd.move.y_val;
+        if (cmd.move.has_z) target_mm.z = current_position_mm.z + cmd.move.z_val;
+    }
+
+    // Apply speed factor (M220)
+    if (speed_factor != 100.0f) {
+        float base_feedrate = feedrate_mm_min;
+        feedrate_mm_min = feedrate_mm_min * (speed_factor / 100.0);
+        char spd_msg[64];
+        snprintf_P(spd_msg, sizeof(spd_msg), PSTR("Feed=%d (base=%d * %d%%)"),
+                 (int)feedrate_mm_min, (int)base_feedrate, (int)speed_factor);
+        serialHandler.sendInfo(spd_msg);
+    }
+
+    // Convert feedrate to mm/s
+    float feedrate_mm_s = feedrate_mm_min / 60.0;
+
+    // Calculate Euclidean distance for jump detection
+    float dx = target_mm.x - current_position_mm.x;
+    float dy = target_mm.y - current_position_mm.y;
+    float dz = target_mm.z - current_position_mm.z;
+    float jump_distance_sq = (dx*dx) + (dy*dy) + (dz*dz);
+
+    if (jump_distance_sq > (MAX_ALLOWED_JUMP_MM * MAX_ALLOWED_JUMP_MM)) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Impossible position jump detected"));
+        return EXEC_DONE;
+    }
+
+    // Check soft limits — only in absolute mode (G90).
+    // In relative mode (G91), jogging must work without homing.
+    if (absolute_mode) {
+        // Per-axis homing check: only require homing for axes being commanded
+        if ((cmd.move.has_x && !homing.isHomedX()) ||
+            (cmd.move.has_y && !homing.isHomedY()) ||
+            (cmd.move.has_z && !homing.isHomedZ())) {
+            serialHandler.sendError(ERR_NOT_HOMED, F("Required axis not homed"));
+            return EXEC_DONE;
+        }
+        if (!kinematics.isValidPosition(target_mm)) {
+            serialHandler.sendError(ERR_OUT_OF_RANGE, F("Target position out of bounds"));
+            return EXEC_DONE;
+        }
+    }
+
+#if PEN_BACKEND == PEN_BACKEND_SERVO
+    // Servo pen: Z only selects up or down. The change is queued ahead of this move's XY
+    // part, so it runs after everything queued before it. A full queue returns busy
+    // before anything changed; on the retry the pen is already queued.
+    if (cmd.move.has_z) {
+        bool up = PenActuator::isUpHeight(target_mm.z);
+        if (up != pen.isQueuedUp()) {
+            MotionBlock pen_block = MotionBlock();
+            pen_block.pen = up ? PEN_RAISE : PEN_LOWER;
+            pen_block.trace_seq = cmd.trace.seq;
+            if (!motionQueue.push(pen_block)) return EXEC_BUSY;
+            pen.setQueued(up);
+        }
+    }
+    dz = 0.0f;
+    if (fabsf(dx) < 0.0001f && fabsf(dy) < 0.0001f) {
+        current_position_mm = target_mm;
+        sdCapture.record(cmd);
+        return EXEC_DONE;
+    }
+#endif
+
+    // Classify the move so it gets travel, draw or pen limits
+    MoveType move_type;
+    if (fabsf(dx) < 0.0001f && fabsf(dy) < 0.0001f) move_type = MOVE_PEN;
+    else if (cmd.type == GCODE_G0) move_type = MOVE_TRAVEL;
+    else move_type = MOVE_DRAW;
+
+    // Paper height compensation: offset Z by the probed height under the XY position.
+    // Inside one cell the surface is close to a plane, so the move is split where it
+    // crosses a grid line and each piece ramps Z between the heights at its ends. A
+    // checked jog stays one block, since it may end anywhere.
+    float split[HeightMap::MAX_CROSSINGS];
+    uint8_t pieces = 1;
+    long z_steps = 0; // Compensated Z at the start of the next piece
+    if (heightMap.isEnabled()) {
+        long x0 = kinematics.mmToStepsX(current_position_mm.x), y0 = kinematics.mmToStepsY(current_position_mm.y);
+        if (!endstop_mask) {
+            pieces += heightMap.cellCrossings(x0, y0, kinematics.mmToStepsX(target_mm.x), kinematics.mmToStepsY(target_mm.y), split);
+        }
+        // The start is the planned position (end of the previous block), not where the
+        // carriage is right now
+        z_steps = kinematics.mmToStepsZ(current_position_mm.z) + heightMap.zOffsetSteps(x0, y0);
+    }
+    static_assert(HeightMap::MAX_CROSSINGS + 1 <= MOTION_QUEUE_SIZE, "A split move must fit an empty queue");
+    if (motionQueue.freeSlots() < pieces) return EXEC_BUSY; // All pieces or none
+
+    float t0 = 0.0f;
+    for (uint8_t piece = 0; piece < pieces; piece++) {
+        float t1 = (piece + 1 < pieces) ? split[piece] : 1.0f;
+        Point3D end_mm = target_mm;
+        if (t1 < 1.0f) {
+            end_mm.x = current_position_mm.x + dx * t1;
+            end_mm.y = current_position_mm.y + dy * t1;
+            end_mm.z = current_position_mm.z + (target_mm.z - current_position_mm.z) * t1;
+        }
+        float pdx = dx * (t1 - t0), pdy = dy * (t1 - t0), pdz = dz * (t1 - t0);
+        t0 = t1;
+
+        // Convert target mm to steps
+        MotionBlock block;
+        kinematics.mmToSteps(end_mm, block.target);
+        block.endstop_mask = endstop_mask;
+        block.trace_seq = cmd.trace.seq;
+        block.pen = PEN_KEEP;
+#if PEN_BACKEND == PEN_BACKEND_SERVO
+        block.target[2] = stepperControl.getCurrentZSteps(); // The Z stepper stays put
+#endif
+        if (heightMap.isEnabled()) {
+            block.target[2] += heightMap.zOffsetSteps(block.target[0], block.target[1]);
+            pdz = kinematics.stepsToMmZ(block.target[2] - z_steps); // Including the correction
+            z_steps = block.target[2];
+        }
+
+        // Limit velocity and acceleration along the actual move vector so no axis
+        // component exceeds its own ceiling (diagonals would otherwise see up to sqrt(2)x)
+        const AxisLimits* limits = settings.data().limits;
+        float path_v = kinematics.limitAlongVector(pdx, pdy, pdz,
+            min(feedrate_mm_s, kinematics.maxPathVelocity(move_type)),
+            limits[AXIS_X].max_velocity, limits[AXIS_Y].max_velocity, limits[AXIS_Z].max_velocity);
+        float path_a = kinematics.limitAlongVector(pdx, pdy, pdz,
+            kinematics.maxPathAcceleration(move_type),
+            limits[AXIS_X].max_accel, limits[AXIS_Y].max_accel, limits[AXIS_Z].max_accel);
+
+        // Project path limits onto each axis so all axes arrive together
+        float total_dist = sqrtf(pdx*pdx + pdy*pdy + pdz*pdz);
+        float ux, uy, uz;
+        if (total_dist > 0.001f) {
+            ux = fabsf(pdx) / total_dist;
+            uy = fabsf(pdy) / total_dist;
+            uz = fabsf(pdz) / total_dist;
+        } else {
+            ux = uy = uz = 1.0f;
+            path_v = min(feedrate_mm_s, limits[AXIS_Z].max_velocity);
+        }
+
+        block.max_speed[0] = path_v * ux * X_STEPS_PER_MM;
+        block.max_speed[1] = path_v * uy * Y_STEPS_PER_MM;
+        block.max_speed[2] = path_v * uz * Z_STEPS_PER_MM;
+        block.accel[0] = path_a * ux * X_STEPS_PER_MM;
+        block.accel[1] = path_a * uy * Y_STEPS_PER_MM;
+        block.accel[2] = path_a * uz * Z_STEPS_PER_MM;
+
+        // Debug: log target steps (disabled by default to avoid flooding serial)
+#ifdef DEBUG_MOVES
+        {
+            char dbg[96];
+            snprintf_P(dbg, sizeof(dbg), PSTR("MOVE to X=%ld Y=%ld Z=%ld"),
+                     block.target[0], block.target[1], block.target[2]);
+            serialHandler.sendInfo(dbg);
+        }
+#endif
+
+        motionQueue.push(block); // Room checked above
+        TRACE_EVENT(EV_BLOCK_PLANNED, motionQueue.size());
+    }
+
+    // Feed plot preview with XY segments (only for drawing moves, not Z-only)
+    if (cmd.move.has_x || cmd.move.has_y) {
+        plotPreviewScreen.addSegment(
+            current_position_mm.x, current_position_mm.y,
+            target_mm.x, target_mm.y);
+    }
+
+    // The planned position advances now; a checked jog corrects it on completion
+    current_position_mm = target_mm;
+    lines_plotted++;
+    last_stepper_activity_time = millis();
+    sdCapture.record(cmd);
+    return endstop_mask ? EXEC_WAIT_MOTION : EXEC_DONE;
+}
+
+// Host-planned block (M932 frame): only checked against the machine, then queued as is
+static const __FlashStringHelper* checkHostBlock(const MotionBlock& block, const long (&start)[3]) {
+    if (block.endstop_mask) return F("Host block: endstop checks are not supported");
+    if (block.pen != PEN_KEEP) {
+        return PenActuator::USES_Z_AXIS ? F("Host block: pen blocks need the servo pen backend") : nullptr;
+    }
+    if (!PenActuator::USES_Z_AXIS && block.target[AXIS_Z] != start[AXIS_Z]) return F("Host block: Z is a pen block in servo mode");
+    if (!kinematics.isValidPosition(kinematics.stepsToMm(block.target))) return F("Host block: target out of bounds");
+
+    const AxisLimits* limits = settings.data().limits;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (block.target[i] == start[i]) continue;
+        float steps_per_mm = axisConfig[i].steps_per_mm;
+        // Allow for the host rounding mm/s to steps/s
+        float max_speed = min(limits[i].max_velocity * steps_per_mm, (float)MAX_STEP_RATE_HZ) * 1.001f;
+        float max_accel = limits[i].max_accel * steps_per_mm * 1.001f;
+        if (!(block.max_speed[i] > 0.0f && block.max_speed[i] <= max_speed)) return F("Host block: speed out of range");
+        if (!(block.accel[i] > 0.0f && block.accel[i] <= max_accel)) return F("Host block: acceleration out of range");
+    }
+    return nullptr;
+}
+
+static ExecResult handleHostBlock(const ParsedGCodeCommand& cmd) { // Binary frame after M932 S1
+    if (motionQueue.isFull()) return EXEC_BUSY;
+
+    // M928 writes G-code, and a block planned by the host has none to write back
+    if (sdCapture.isActive()) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Host block: not while M928 captures"));
+        return EXEC_DONE;
+    }
+
+    // Targets are absolute steps, so they only mean something on a homed machine
+    if (!homing.isHomed()) {
+        serialHandler.sendError(ERR_NOT_HOMED, F("Host block: home all axes first"));
+        return EXEC_DONE;
+    }
+
+    // Axes the record leaves out stay where the queue ends
+    long start[3];
+    motionQueue.planEnd(start);
+    MotionBlock block;
+    if (!StepStream::decodeRecord(cmd.host_block.record, start, block)) {
+        serialHandler.sendError(ERR_INVALID_SYNTAX, F("Host block: invalid pen change"));
+        return EXEC_DONE;
+    }
+    const __FlashStringHelper* problem = checkHostBlock(block, start);
+    if (problem) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, problem);
+        return EXEC_DONE;
+    }
+    block.trace_seq = cmd.trace.seq;
+    if (!motionQueue.push(block)) return EXEC_BUSY;
+
+    Point3D target_mm = current_position_mm;
+    if (block.pen != PEN_KEEP) {
+        pen.setQueued(block.pen == PEN_RAISE);
+        target_mm.z = pen.isQueuedUp() ? pen_up_z : pen_down_z;
+    } else {
+        target_mm = kinematics.stepsToMm(block.target);
+        if (!PenActuator::USES_Z_AXIS) target_mm.z = current_position_mm.z;
+        if (block.target[AXIS_X] != start[AXIS_X] || block.target[AXIS_Y] != start[AXIS_Y]) {
+            plotPreviewScreen.addSegment(current_position_mm.x, current_position_mm.y, target_mm.x, target_mm.y);
+        }
+        lines_plotted++;
+    }
+    current_position_mm = target_mm;
+    last_stepper_activity_time = millis();
+    return EXEC_DONE;
+}
+
+static void completeMove(const ParsedGCodeCommand& cmd) {
+    // Handle endstop hit during jog: auto-home the triggered axis
+    char endstop_triggered = motionQueue.endstopHit();
+    if (endstop_triggered == '\0') return;
+
+    // Read actual stepper positions since move was interrupted
+    syncPositionFromSteps();
+
+    char msg[64];
+    snprintf_P(msg, sizeof(msg), PSTR("Endstop hit on %c during jog, auto-homing"), endstop_triggered);
+    serialHandler.sendInfo(msg);
+    homing.homeAxis(axisIndex(endstop_triggered));
+    if (endstop_triggered == 'X') current_position_mm.x = (HOME_DIR_X == 1) ? X_MAX_POS : 0.0f;
+    else if (endstop_triggered == 'Y') current_position_mm.y = (HOME_DIR_Y == 1) ? Y_MAX_POS : 0.0f;
+    else if (endstop_triggered == 'Z') current_position_mm.z = PEN_UP_Z;
+    stepperControl.setCurrentPosition(
+        kinematics.mmToStepsX(current_position_mm.x),
+        kinematics.mmToStepsY(current_position_mm.y),
+        kinematics.mmToStepsZ(current_position_mm.z));
+}
+
+static ExecResult handleHome(const ParsedGCodeCommand& cmd) { // G28
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    stepperControl.enableSteppers(); // Ensure steppers are enabled for homing
+    bool homing_success = false;
+    if (cmd.g28_args.home_all) {
+        homing_success = homing.homeAllAxes();
+    } else {
+        // Home specific axis/axes
+        bool x_success = true, y_success = true, z_success = true;
+        if (cmd.g28_args.home_x) x_success = homing.homeAxis(AXIS_X);
+        if (cmd.g28_args.home_y) y_success = homing.homeAxis(AXIS_Y);
+        if (cmd.g28_args.home_z) z_success = homing.homeAxis(AXIS_Z);
+        homing_success = x_success && y_success && z_success;
+    }
+    // Update position based on which axes actually homed
+    // X homes to max (right side), so position = X_MAX_POS
+    // Y homes to min (front), so position = 0
+    // Z homes to min, then moves to Z_HOME_POSITION
+    if (homing.isHomedX()) current_position_mm.x = (HOME_DIR_X == 1) ? X_MAX_POS : 0.0f;
+    if (homing.isHomedY()) current_position_mm.y = (HOME_DIR_Y == 1) ? Y_MAX_POS : 0.0f;
+    if (homing.isHomedZ()) current_position_mm.z = PenActuator::USES_Z_AXIS ? Z_HOME_POSITION : pen_up_z;
+    // Sync stepper positions with current_position_mm
+    stepperControl.setCurrentPosition(
+        kinematics.mmToStepsX(current_position_mm.x),
+        kinematics.mmToStepsY(current_position_mm.y),
+        kinematics.mmToStepsZ(current_position_mm.z));
+
+    if (homing_success) {
+        sdCapture.record(cmd);
+        serialHandler.sendInfo(F("Homing complete."));
+        Buzzer::playHomingDone();
+    } else {
+        serialHandler.sendError(ERR_HOMING_FAILED, F("Partial homing - check serial log for details."));
+        Buzzer::playError();
+    }
+    // Steppers stay enabled - idle timeout handles disabling
+    last_stepper_activity_time = millis(); // Update activity
+    return EXEC_DONE;
+}
+
+static ExecResult handleProbe(const ParsedGCodeCommand& cmd) { // G29
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    if (!PenActuator::USES_Z_AXIS) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("G29 needs the Z-stepper pen backend"));
+        return EXEC_DONE;
+    }
+
+    if (heightMap.probe()) {
+        sdCapture.record(cmd);
+        serialHandler.sendInfo(F("Height map probed, compensation enabled."));
+        heightMap.report();
+    } else {
+        serialHandler.sendError(ERR_HOMING_FAILED, F("Height map probing failed"));
+        Buzzer::playError();
+    }
+    // Probing moves XY and leaves Z at clearance height; resync logical position
+    syncPositionFromSteps();
+    last_stepper_activity_time = millis();
+    return EXEC_DONE;
+}
+
+static ExecResult handleAbsolute(const ParsedGCodeCommand& cmd) { // G90
+    absolute_mode = true;
+    sdCapture.record(cmd);
+    serialHandler.sendInfo(F("Absolute positioning mode (G90)"));
+    return EXEC_DONE;
+}
+
+static ExecResult handleRelative(const ParsedGCodeCommand& cmd) { // G91
+    absolute_mode = false;
+    sdCapture.record(cmd);
+    serialHandler.sendInfo(F("Relative positioning mode (G91)"));
+    return EXEC_DONE;
+}
+
+static ExecResult handleSetPosition(const ParsedGCodeCommand& cmd) { // G92
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    // Set current position to new values without moving
+    if (cmd.g92_args.has_x) current_position_mm.x = cmd.g92_args.x_val;
+    if (cmd.g92_args.has_y) current_position_mm.y = cmd.g92_args.y_val;
+    if (cmd.g92_args.has_z) current_position_mm.z = cmd.g92_args.z_val;
+
+    // Also update AccelStepper's internal position for consistency
+    long new_x_steps = kinematics.mmToStepsX(current_position_mm.x);
+    long new_y_steps = kinematics.mmToStepsY(current_position_mm.y);
+    long new_z_steps = kinematics.mmToStepsZ(current_position_mm.z);
+    stepperControl.setCurrentPosition(new_x_steps, new_y_steps, new_z_steps);
+    sdCapture.record(cmd);
+    serialHandler.sendInfo(F("Current position set."));
+    last_stepper_activity_time = millis(); // Update activity
+    return EXEC_DONE;
+}
+
+//===========================================================================
+// Machine
+//===========================================================================
+
+static ExecResult handleStop(const ParsedGCodeCommand& cmd) { // M0
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    serialHandler.sendInfo(F("M0: Stop."));
+    flushCommandBuffer();
+    if (sd_exec_state == SD_EXEC_RUNNING || sd_exec_state == SD_EXEC_PAUSED) {
+        sd_exec_state = SD_EXEC_DONE;
+        sdCard.closeFile();
+    }
+    stepperControl.disableSteppers();
+    return EXEC_DONE;
+}
+
+static ExecResult handleResume(const ParsedGCodeCommand& cmd) { // M24
+    if (sd_exec_state == SD_EXEC_PAUSED) {
+        sd_exec_state = SD_EXEC_RUNNING;
+        serialHandler.sendInfo(F("Execution resumed."));
+    } else {
+        serialHandler.sendInfo(F("Nothing to resume."));
+    }
+    return EXEC_DONE;
+}
+
+static ExecResult handlePause(const ParsedGCodeCommand& cmd) { // M25
+    if (sd_exec_state == SD_EXEC_RUNNING) {
+        sd_exec_state = SD_EXEC_PAUSED;
+        serialHandler.sendInfo(F("Execution paused."));
+    } else {
+        serialHandler.sendInfo(F("Not running."));
+    }
+    return EXEC_DONE;
+}
+
+static ExecResult handleStopCapture(const ParsedGCodeCommand& cmd) { // M29
+    if (sdCapture.isActive()) sdCapture.stop();
+    else serialHandler.sendInfo(F("M29: not capturing."));
+    return EXEC_DONE;
+}
+
+static ExecResult handleDisableSteppers(const ParsedGCodeCommand& cmd) { // M84
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    if (cmd.m84_args.has_s) {
+        if (cmd.m84_args.s_val == 0) { // M84 S0 means disable indefinitely
+            stepper_disable_timeout_ms = 0; // Never timeout
+            stepperControl.disableSteppers();
+            serialHandler.sendInfo(F("Steppers permanently disabled (timeout 0)."));
+        } else { // M84 S<seconds>
+            stepper_disable_timeout_ms = (long)cmd.m84_args.s_val * 1000UL;
+            stepperControl.disableSteppers(); // Disable now, then re-enable on next activity
+            last_stepper_activity_time = millis(); // Reset timer
+            serialHandler.sendInfo((String(F("Stepper timeout set to ")) + String(cmd.m84_args.s_val) + F("s. Steppers disabled.")).c_str());
+        }
+    } else { // M84 without S means disable immediately and use default timeout from config.h
+        stepperControl.disableSteppers();
+        if (DISABLE_STEPPERS_AFTER_IDLE_S > 0) {
+            stepper_disable_timeout_ms = (long)DISABLE_STEPPERS_AFTER_IDLE_S * 1000UL;
+        } else {
+            stepper_disable_timeout_ms = 0; // Never disable
+        }
+        last_stepper_activity_time = millis(); // Reset timer
+        serialHandler.sendInfo(F("Steppers disabled. Default timeout applied."));
+    }
+    positionTrust.save(); // A disable at rest keeps the position trusted
+    return EXEC_DONE;
+}
+
+static ExecResult handleGetPosition(const ParsedGCodeCommand& cmd) { // M114
+    // Planned position: includes moves that are queued but not finished yet
+    serialHandler.sendPosition(current_position_mm.x, current_position_mm.y, current_position_mm.z);
+    return EXEC_DONE;
+}
+
+static ExecResult handleFirmwareInfo(const ParsedGCodeCommand& cmd) { // M115
+    serialHandler.sendFirmwareInfo(); // Already sent during setup; resend if requested again
+    return EXEC_DONE;
+}
+
+static ExecResult handleEndstopStatus(const ParsedGCodeCommand& cmd) { // M119
+    serialHandler.sendEndstopStatus(endstops.isTriggered(AXIS_X), endstops.isTriggered(AXIS_Y), endstops.isTriggered(AXIS_Z));
+    return EXEC_DONE;
+}
+
+static ExecResult handleAutoReport(const ParsedGCodeCommand& cmd) { // M154 [S<ms>]
+    if (!cmd.m154_args.has_s) {
+        statusReporter.requestReport(); // One report now, interval unchanged
+    } else if (cmd.m154_args.s_val < 0) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Interval must be >= 0"));
+    } else {
+        statusReporter.setInterval((unsigned long)cmd.m154_args.s_val);
+    }
+    return EXEC_DONE;
+}
+
+static ExecResult handleLatencyTrace(const ParsedGCodeCommand& cmd) { // M156 [S<0|1>]
+    if (cmd.m156_args.has_s) {
+        latencyTrace.setEnabled(cmd.m156_args.s_val != 0);
+    }
+    serialHandler.sendInfo(latencyTrace.isEnabled() ? F("Latency trace: on") : F("Latency trace: off"));
+    return EXEC_DONE;
+}
+
+static ExecResult handleEventTrace(const ParsedGCodeCommand& cmd) { // M157 [S0]
+    if (cmd.m157_args.has_s && cmd.m157_args.s_val == 0) {
+        eventTrace.clear();
+        serialHandler.sendInfo(F("Event trace cleared"));
+    } else {
+        eventTrace.dump();
+    }
+    return EXEC_DONE;
+}
+
+static ExecResult handleJogVelocity(const ParsedGCodeCommand& cmd) { // M170
+    // Jog steps come from the Timer3 tick; never overlap them with queued moves
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    if (sd_exec_state == SD_EXEC_RUNNING) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Cannot jog while a file is running"));
+    } else if (!cmd.m170_args.has_x && !cmd.m170_args.has_y && !cmd.m170_args.has_z) {
+        stepperControl.jogStop();
+    } else {
+        if (cmd.m170_args.has_x) stepperControl.jogSetVelocity(AXIS_X, cmd.m170_args.x_val * X_STEPS_PER_MM);
+        if (cmd.m170_args.has_y) stepperControl.jogSetVelocity(AXIS_Y, cmd.m170_args.y_val * Y_STEPS_PER_MM);
+        if (cmd.m170_args.has_z) stepperControl.jogSetVelocity(AXIS_Z, cmd.m170_args.z_val * Z_STEPS_PER_MM);
+        last_stepper_activity_time = millis();
+    }
+    return EXEC_DONE;
+}
+
+static ExecResult handleHomingCalibration(const ParsedGCodeCommand& cmd) { // M171 [X] [Y] [Z]
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    if (sd_exec_state == SD_EXEC_RUNNING) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Cannot calibrate while a file is running"));
+        return EXEC_DONE;
+    }
+    bool all = !cmd.m171_args.axis_x && !cmd.m171_args.axis_y && !cmd.m171_args.axis_z;
+    const bool selected[AXIS_COUNT] = { cmd.m171_args.axis_x, cmd.m171_args.axis_y, cmd.m171_args.axis_z };
+    bool changed = false;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (!all && !selected[i]) continue;
+        if (i == AXIS_Z && !PenActuator::USES_Z_AXIS) continue; // Servo pen: no Z endstop in use
+        HomingTuning tune;
+        if (homing.calibrateAxis((AxisIndex)i, tune)) {
+            settings.data().homing[i] = tune;
+            changed = true;
+        }
+    }
+    syncPositionFromSteps();
+    last_stepper_activity_time = millis();
+    if (changed) {
+        settings.report();
+        serialHandler.sendInfo(F("M171: axes left unhomed. M500 to save, then G28"));
+    }
+    return EXEC_DONE;
+}
+
+static ExecResult handleMotionTune(const ParsedGCodeCommand& cmd) { // M172 [X] [Y]
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    if (sd_exec_state == SD_EXEC_RUNNING) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Cannot tune while a file is running"));
+        return EXEC_DONE;
+    }
+    // The strokes cover most of the bed; the pen must be known to be up
+    if (!homing.isHomedZ()) {
+        serialHandler.sendError(ERR_NOT_HOMED, F("Home Z first (G28 Z)"));
+        return EXEC_DONE;
+    }
+    bool both = !cmd.m172_args.axis_x && !cmd.m172_args.axis_y;
+    const bool selected[2] = { cmd.m172_args.axis_x, cmd.m172_args.axis_y };
+    bool changed = false;
+    for (uint8_t i = AXIS_X; i <= AXIS_Y; i++) {
+        if (!both && !selected[i]) continue;
+        AxisLimits limits;
+        if (motionTuner.tuneAxis((AxisIndex)i, limits)) {
+            settings.data().limits[i] = limits;
+            changed = true;
+        } else if (motionTuner.aborted()) {
+            // Stopped mid-stroke with the steppers off: neither axis is where it was homed
+            homing.setHomed(false, false, homing.isHomedZ());
+            break;
+        } else {
+            serialHandler.sendError(ERR_OUT_OF_RANGE, F("M172: no safe level found, limits unchanged"));
+        }
+    }
+    syncPositionFromSteps();
+    last_stepper_activity_time = millis();
+    if (changed) {
+        settings.report();
+        serialHandler.sendInfo(F("M172 done. M500 to save"));
+    }
+    return EXEC_DONE;
+}
+
+static ExecResult handleSpeedFactor(const ParsedGCodeCommand& cmd) { // M220
+    if (cmd.m220_args.has_s) {
+        speed_factor = constrain(cmd.m220_args.s_val, 1, 999); // Constrain between 1% and 999%
+        serialHandler.sendInfo((String(F("Speed factor set to ")) + String(speed_factor) + F("%")).c_str());
+    }
+    return EXEC_DONE;
+}
+
+static ExecResult handleWaitForMoves(const ParsedGCodeCommand& cmd) { // M400
+    return motionQueue.isIdle() ? EXEC_DONE : EXEC_BUSY;
+}
+
+static void stopAll() {
+    // Drop queued commands and moves, stop where the carriage is
+    if (stepperControl.isJogging()) stepperControl.jogAbort();
+    motionTuner.abort(); // M172 reads serial between strokes and ends at the next one
+    flushCommandBuffer();
+    motionQueue.clear();
+    syncPositionFromSteps();
+    stepperControl.disableSteppers(); // Emergency stop effect
+    serialHandler.sendInfo(F("M410: Quickstop initiated. G-code buffer and motion queue cleared."));
+}
+
+static ExecResult handleQuickstop(const ParsedGCodeCommand& cmd) { // M410 from an SD file
+    stopAll();
+    return EXEC_DONE;
+}
+
+static ExecResult handleHeightMap(const ParsedGCodeCommand& cmd) { // M420
+    if (cmd.m420_args.has_s) {
+        if (cmd.m420_args.s_val != 0 && !heightMap.isValid()) {
+            serialHandler.sendError(ERR_OUT_OF_RANGE, F("No height map, run G29 first"));
+        } else {
+            heightMap.setEnabled(cmd.m420_args.s_val != 0);
+        }
+    }
+    heightMap.report();
+    return EXEC_DONE;
+}
+
+static ExecResult handleSaveSettings(const ParsedGCodeCommand& cmd) { // M500
+    settings.save();
+    serialHandler.sendInfo(F("Settings saved"));
+    return EXEC_DONE;
+}
+
+static ExecResult handleLoadSettings(const ParsedGCodeCommand& cmd) { // M501
+    if (!settings.load()) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("No valid settings in EEPROM"));
+    }
+    settings.report();
+    return EXEC_DONE;
+}
+
+static ExecResult handleResetSettings(const ParsedGCodeCommand& cmd) { // M502
+    settings.reset();
+    serialHandler.sendInfo(F("Settings reset to defaults (M500 to save)"));
+    return EXEC_DONE;
+}
+
+static ExecResult handleReportSettings(const ParsedGCodeCommand& cmd) { // M503
+    serialHandler.sendInfo(F("Reporting settings (placeholder)..."));
+    // Current position
+    serialHandler.sendInfo((String(F("Current position (mm): X:")) + String(current_position_mm.x) +
+                            F(" Y:") + String(current_position_mm.y) +
+                            F(" Z:") + String(current_position_mm.z)).c_str());
+    // Positioning mode
+    serialHandler.sendInfo((String(F("Positioning mode: ")) + String(absolute_mode ? F("Absolute") : F("Relative"))).c_str());
+    // Speed factor
+    serialHandler.sendInfo((String(F("Speed factor: ")) + String(speed_factor) + F("%")).c_str());
+    // Stepper timeout
+    serialHandler.sendInfo((String(F("Stepper timeout (ms): ")) + String(stepper_disable_timeout_ms)).c_str());
+    // Homing status
+    serialHandler.sendInfo((String(F("Homed: X:")) + String(homing.isHomedX() ? F("true") : F("false")) +
+                            F(" Y:") + String(homing.isHomedY() ? F("true") : F("false")) +
+                            F(" Z:") + String(homing.isHomedZ() ? F("true") : F("false"))).c_str());
+    // Height map
+    serialHandler.sendInfo((String(F("Height map: ")) + String(heightMap.isEnabled() ? F("ON") : (heightMap.isValid() ? F("OFF") : F("not probed")))).c_str());
+    // Input shaping
+    reportInputShaper('X');
+    reportInputShaper('Y');
+    // Status auto-report
+    serialHandler.sendInfo((String(F("Auto-report interval (ms): ")) + String(statusReporter.getInterval())).c_str());
+    // Display cost (render + transmit, LCD_TRANSPORT dependent)
+    serialHandler.sendInfo((String(F("LCD frame (us): last:")) + String(lcdMenu.getLastFrameUs()) +
+                            F(" max:") + String(lcdMenu.getMaxFrameUs())).c_str());
+    // Machine profile and feedrates
+    serialHandler.sendInfo((String(F("Machine profile: ")) + String(MACHINE.name) +
+                            F(" steps/mm X:") + String(X_STEPS_PER_MM) +
+                            F(" Y:") + String(Y_STEPS_PER_MM) +
+                            F(" Z:") + String(Z_STEPS_PER_MM)).c_str());
+    serialHandler.sendInfo((String(F("Max XY Speed (mm/s): ")) + String(MAX_VELOCITY_XY)).c_str());
+    serialHandler.sendInfo((String(F("Max Z Speed (mm/s): ")) + String(MAX_VELOCITY_Z)).c_str());
+    // Persistent settings (M500/M501/M502)
+    settings.report();
+    return EXEC_DONE;
+}
+
+static ExecResult handleInputShaping(const ParsedGCodeCommand& cmd) { // M593 [X] [Y] [F<hz>] [D<zeta>] [T<0=ZV|1=ZVD>]
+    // The running move reads the shaper every millisecond; change it between moves only
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    bool both = !cmd.m593_args.axis_x && !cmd.m593_args.axis_y;
+    for (char axis = 'X'; axis <= 'Y'; axis++) {
+        if (!both && !(axis == 'X' ? cmd.m593_args.axis_x : cmd.m593_args.axis_y)) continue;
+        const InputShaper& shaper = stepperControl.getInputShaper(axis);
+        float freq = cmd.m593_args.has_f ? cmd.m593_args.f_val : shaper.frequency();
+        float zeta = cmd.m593_args.has_d ? cmd.m593_args.d_val : shaper.damping();
+        ShaperType type = cmd.m593_args.has_t ? (cmd.m593_args.t_val != 0 ? SHAPER_ZVD : SHAPER_ZV) : shaper.type();
+        if (!stepperControl.setInputShaper(axis, freq, zeta, type)) {
+            serialHandler.sendError(ERR_OUT_OF_RANGE, F("Shaper frequency too low or damping out of range"));
+        }
+        reportInputShaper(axis);
+    }
+    return EXEC_DONE;
+}
+
+static ExecResult handleStartCapture(const ParsedGCodeCommand& cmd) { // M928 [<file>] [S1]
+    if (sd_exec_state == SD_EXEC_RUNNING || sd_exec_state == SD_EXEC_PAUSED) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M928: SD job running"));
+        return EXEC_DONE;
+    }
+    sdCapture.start(cmd.m928_args.filename, cmd.m928_args.compact);
+    return EXEC_DONE;
+}
+
+static ExecResult handleStartStepRecording(const ParsedGCodeCommand& cmd) { // M930 [<file>]
+    // The stream starts where the axes are; blocks queued before this aren't part of it
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+    stepStream.startRecording(cmd.m930_args.filename);
+    return EXEC_DONE;
+}
+
+static ExecResult handleStopStepRecording(const ParsedGCodeCommand& cmd) { // M931
+    // Everything queued before M931 belongs to the stream
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+    if (stepStream.isRecording()) stepStream.stopRecording();
+    else serialHandler.sendInfo(F("M931: not recording."));
+    return EXEC_DONE;
+}
+
+static ExecResult handleHostFrames(const ParsedGCodeCommand& cmd) { // M932 [S<0|1>]
+    if (cmd.m932_args.has_s) serialHandler.setHostFrames(cmd.m932_args.s_val != 0.0f);
+    serialHandler.sendInfo(serialHandler.hostFramesEnabled() ? F("Host block frames on") : F("Host block frames off"));
+    return EXEC_DONE;
+}
+
+static ExecResult handleTrustedResume(const ParsedGCodeCommand& cmd) { // M933 [S<0|1>]
+    if (cmd.m933_args.has_s) {
+        settings.data().trusted_resume = cmd.m933_args.s_val != 0.0f;
+        if (settings.data().trusted_resume) positionTrust.save();
+        else positionTrust.invalidate();
+    }
+    serialHandler.sendInfo(settings.data().trusted_resume ? F("Trusted resume: on (M500 to keep)") : F("Trusted resume: off"));
+    return EXEC_DONE;
+}
+
+static ExecResult handleEndstopSim(const ParsedGCodeCommand& cmd) { // M934 [X] [Y] [Z] [N] [H] [J] [B] [R] [D] [S]
+#if ENDSTOP_SIM
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    if (sd_exec_state == SD_EXEC_RUNNING) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Cannot run trials while a file is running"));
+        return EXEC_DONE;
+    }
+    const M934Params& a = cmd.m934_args;
+    EndstopSimParams& p = endstopSim.params();
+    if (a.hysteresis_mm >= 0.0f) p.hysteresis_mm = a.hysteresis_mm;
+    if (a.jitter_mm >= 0.0f) p.jitter_mm = a.jitter_mm;
+    if (a.bounce_ms >= 0) p.bounce_ms = a.bounce_ms;
+    if (a.noise_ppm >= 0) p.noise_ppm = a.noise_ppm;
+    if (a.dead_pct >= 0) p.dead_pct = a.dead_pct;
+    unsigned long seed = a.seed ? a.seed : micros();
+
+    bool both = !a.axis_x && !a.axis_y && !a.axis_z;
+    const bool selected[AXIS_COUNT] = { both || a.axis_x, both || a.axis_y, a.axis_z && PenActuator::USES_Z_AXIS };
+    for (uint8_t i = 0; i < AXIS_COUNT && a.runs > 0; i++) {
+        if (selected[i]) endstopSim.runTrials((AxisIndex)i, a.runs, seed);
+    }
+    syncPositionFromSteps();
+    last_stepper_activity_time = millis();
+#else
+    serialHandler.sendError(ERR_INVALID_SYNTAX, F("M934: endstop simulator not built in (ENDSTOP_SIM)"));
+#endif
+    return EXEC_DONE;
+}
+
+static ExecResult handleStartSession(const ParsedGCodeCommand& cmd) { // M936 [<file>]
+    serialSession.startCapture(cmd.m936_args.filename);
+    return EXEC_DONE;
+}
+
+static ExecResult handleStopSession(const ParsedGCodeCommand& cmd) { // M937
+    if (serialSession.isCapturing()) serialSession.stopCapture();
+    else serialHandler.sendInfo(F("M937: not capturing."));
+    return EXEC_DONE;
+}
+
+static ExecResult handleReplaySession(const ParsedGCodeCommand& cmd) { // M938 [<file>] [S1]
+    // The replay measures from an idle machine, like the session it was captured from
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    if (sd_exec_state == SD_EXEC_RUNNING || sd_exec_state == SD_EXEC_PAUSED) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M938: SD job running"));
+        return EXEC_DONE;
+    }
+    serialSession.startReplay(cmd.m938_args.filename, cmd.m938_args.fast);
+    return EXEC_DONE;
+}
+
+static ExecResult handleMotorTest(const ParsedGCodeCommand& cmd) { // M999 per-axis raw diagnostic
+    if (!motionQueue.isIdle()) return EXEC_BUSY;
+
+    char test_axis = cmd.m999_args.axis;
+    char msg_buf[80];
+    snprintf_P(msg_buf, sizeof(msg_buf), PSTR("M999: Testing %c motor with raw pin toggles..."), test_axis);
+    serialHandler.sendInfo(msg_buf);
+
+    uint8_t step_pin = 0;
+    if (test_axis == 'X') step_pin = X_STEP_PIN;
+    else if (test_axis == 'Y') step_pin = Y_STEP_PIN;
+    else step_pin = Z_STEP_PIN;
+    snprintf_P(msg_buf, sizeof(msg_buf), PSTR("Sending 800 steps at 1kHz to %c_STEP_PIN (%d)..."), test_axis, step_pin);
+    serialHandler.sendInfo(msg_buf);
+
+    stepperControl.testMotorDirect(axisIndex(test_axis), 800, 500);
+
+    snprintf_P(msg_buf, sizeof(msg_buf), PSTR("M999: %c raw test complete. Did the motor move?"), test_axis);
+    serialHandler.sendInfo(msg_buf);
+    serialHandler.sendInfo(F("If YES: AccelStepper config issue. If NO: hardware issue (wiring/driver/current)."));
+    return EXEC_DONE;
+}
+
+static ExecResult handleUnknown(const ParsedGCodeCommand& cmd) {
+    // Should be caught by SerialHandler, but defensive check
+    serialHandler.sendError(ERR_UNKNOWN_COMMAND, F("Unknown command encountered in executor."));
+    return EXEC_DONE;
+}
+
+//===========================================================================
+// Dispatch
+//===========================================================================
+
+static CommandHandler handlerFor(GCodeType type) {
+    switch (type) {
+        case GCODE_G0:
+        case GCODE_G1:   return handleMove;
+        case GCODE_G28:  return handleHome;
+        case GCODE_G29:  return handleProbe;
+        case GCODE_G90:  return handleAbsolute;
+        case GCODE_G91:  return handleRelative;
+        case GCODE_G92:  return handleSetPosition;
+        case GCODE_M0:   return handleStop;
+        case GCODE_M24:  return handleResume;
+        case GCODE_M25:  return handlePause;
+        case GCODE_M29:  return handleStopCapture;
+        case GCODE_M84:  return handleDisableSteppers;
+        case GCODE_M114: return handleGetPosition;
+        case GCODE_M115: return handleFirmwareInfo;
+        case GCODE_M119: return handleEndstopStatus;
+        case GCODE_M154: return handleAutoReport;
+        case GCODE_M156: return handleLatencyTrace;
+        case GCODE_M157: return handleEventTrace;
+        case GCODE_M170: return handleJogVelocity;
+        case GCODE_M171: return handleHomingCalibration;
+        case GCODE_M172: return handleMotionTune;
+        case GCODE_M220: return handleSpeedFactor;
+        case GCODE_M400: return handleWaitForMoves;
+        case GCODE_M410: return handleQuickstop;
+        case GCODE_M420: return handleHeightMap;
+        case GCODE_M500: return handleSaveSettings;
+        case GCODE_M501: return handleLoadSettings;
+        case GCODE_M502: return handleResetSettings;
+        case GCODE_M503: return handleReportSettings;
+        case GCODE_M593: return handleInputShaping;
+        case GCODE_M928: return handleStartCapture;
+        case GCODE_M930: return handleStartStepRecording;
+        case GCODE_M931: return handleStopStepRecording;
+        case GCODE_M932: return handleHostFrames;
+        case GCODE_M933: return handleTrustedResume;
+        case GCODE_M934: return handleEndstopSim;
+        case GCODE_M936: return handleStartSession;
+        case GCODE_M937: return handleStopSession;
+        case GCODE_M938: return handleReplaySession;
+        case GCODE_M999: return handleMotorTest;
+        case GCODE_HOST_BLOCK: return handleHostBlock;
+        default:         return handleUnknown;
+    }
+}
+
+// Runs once the motion a handler queued has finished, before the ack
+static CompletionHandler completionFor(GCodeType type) {
+    switch (type) {
+        case GCODE_G0:
+        case GCODE_G1:   return completeMove;
+        default:         return nullptr;
+    }
+}
+
+// A running continuous jog must come to rest before anything that moves or
+// redefines position; stop-type commands end it instantly
+static void settleJog(GCodeType type) {
+    if (!stepperControl.isJogging()) return;
+    if (type == GCODE_M0 || type == GCODE_M84 || type == GCODE_M410) {
+        stepperControl.jogAbort();
+        syncPositionFromSteps();
+    } else if (type == GCODE_G0 || type == GCODE_G1 || type == GCODE_G28 ||
+               type == GCODE_G29 || type == GCODE_G92 || type == GCODE_M171 ||
+               type == GCODE_M172 || type == GCODE_M934 || type == GCODE_HOST_BLOCK) {
+        stepperControl.jogFinish();
+        syncPositionFromSteps();
+    }
+}
+
+CommandExecutor::CommandExecutor() : _hasCurrent(false), _waitingMotion(false), _execStartUs(0) {}
+
+void CommandExecutor::_finish() {
+    if (_current.trace.seq) {
+        latencyTrace.reportCommand(_current.trace, _execStartUs, micros());
+    }
+    serialHandler.sendOK();
+    _hasCurrent = false;
+    _waitingMotion = false;
+}
+
+void CommandExecutor::quickstop() {
+    if (_hasCurrent) _finish(); // Its motion, if any, is about to be dropped
+    stopAll();
+}
+
+void CommandExecutor::service() {
+    if (_waitingMotion) {
+        if (!motionQueue.isIdle()) return;
+        CompletionHandler complete = completionFor(_current.type);
+        if (complete) complete(_current);
+        _finish();
+    }
+
+    if (!_hasCurrent) {
+        if (!gcodeBuffer.pop(_current)) return;
+        _hasCurrent = true;
+        _execStartUs = micros();
+        settleJog(_current.type);
+    }
+
+    ExecResult result = handlerFor(_current.type)(_current);
+    if (!_hasCurrent) return; // A quickstop read while the handler ran has acknowledged it
+    switch (result) {
+        case EXEC_DONE:
+            _finish();
+            break;
+        case EXEC_WAIT_MOTION:
+            _waitingMotion = true;
+            break;
+        case EXEC_BUSY:
+            break; // Retried on the next loop() pass
+    }
+}
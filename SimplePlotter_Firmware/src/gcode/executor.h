@@ -0,0 +1,46 @@
+// SimplePlotter_Firmware/src/gcode/executor.h
+
+#ifndef GCODE_EXECUTOR_H
+#define GCODE_EXECUTOR_H
+
+#include <Arduino.h>
+#include "commands.h"
+
+// What a command handler reports back to the executor
+enum ExecResult {
+    EXEC_DONE,        // Finished (or failed with an error already sent); acknowledge now
+    EXEC_BUSY,        // Can't start yet (motion queue full, or needs the machine idle); retry later
+    EXEC_WAIT_MOTION  // Queued motion that must finish first; acknowledge when the queue drains
+};
+
+// Runs commands from gcodeBuffer in order. Each GCodeType has its own handler.
+// Motion handlers only plan and enqueue blocks, so queries and settings are
+// answered while earlier moves are still running. Commands that depend on the
+// physical position (homing, G92, stepper disable, ...) wait for the queue to drain.
+class CommandExecutor {
+public:
+    CommandExecutor();
+
+    void service(); // Call from loop()
+    bool isIdle() const { return !_hasCurrent; }
+
+    // M410 from the serial handler, ahead of the command buffer: the running command is
+    // acknowledged, everything queued behind it is dropped and the axes stop in place
+    void quickstop();
+
+private:
+    ParsedGCodeCommand _current; // Command being started or awaiting completion
+    bool _hasCurrent;
+    bool _waitingMotion;
+    uint32_t _execStartUs; // When _current was taken from the buffer (latency trace)
+
+    void _finish();
+};
+
+extern CommandExecutor executor; // Global instance
+
+// Resync current_position_mm from the step counters after motion the planner
+// didn't produce itself (continuous jog, probing, quickstop)
+void syncPositionFromSteps();
+
+#endif // GCODE_EXECUTOR_H
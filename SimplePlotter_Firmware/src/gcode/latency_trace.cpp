@@ -0,0 +1,40 @@
+// SimplePlotter_Firmware/src/gcode/latency_trace.cpp
+
+#include "latency_trace.h"
+
+LatencyTrace latencyTrace; // Global instance definition
+
+LatencyTrace::LatencyTrace() : _enabled(false), _nextSeq(1) {}
+
+void LatencyTrace::stamp(ParsedGCodeCommand& cmd, uint32_t t_rx, uint32_t t_parse) {
+    if (!_enabled) return;
+    cmd.trace.seq = _nextSeq++;
+    if (_nextSeq == 0) _nextSeq = 1; // 0 marks an untraced command
+    cmd.trace.t_rx = t_rx;
+    cmd.trace.parse_us = (uint16_t)(t_parse - t_rx);
+    cmd.trace.queue_us = (uint16_t)(micros() - t_rx);
+}
+
+void LatencyTrace::reportCommand(const CommandTrace& trace, uint32_t t_exec, uint32_t t_ack) {
+    Serial.print(F("// LAT "));
+    Serial.print(trace.seq);
+    Serial.print(F(" rx:"));
+    Serial.print(trace.t_rx);
+    Serial.print(F(" p:"));
+    Serial.print(trace.t_rx + trace.parse_us);
+    Serial.print(F(" q:"));
+    Serial.print(trace.t_rx + trace.queue_us);
+    Serial.print(F(" x:"));
+    Serial.print(t_exec);
+    Serial.print(F(" ok:"));
+    Serial.println(t_ack);
+}
+
+void LatencyTrace::reportBlock(uint16_t seq, uint32_t t_start, uint32_t t_end) {
+    Serial.print(F("// BLK "));
+    Serial.print(seq);
+    Serial.print(F(" s:"));
+    Serial.print(t_start);
+    Serial.print(F(" e:"));
+    Serial.println(t_end);
+}
@@ -0,0 +1,38 @@
+// SimplePlotter_Firmware/src/gcode/latency_trace.h
+
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <Arduino.h>
+#include "commands.h"
+
+// Per-command latency tracing, switched on with M156 S1. Every line accepted while
+// it is on gets a sequence ID and micros() timestamps, reported on the trace channel
+// (info lines) just before the command's "ok":
+//   // LAT <seq> rx:<us> p:<us> q:<us> x:<us> ok:<us>
+// rx = first byte of the line taken from the UART buffer (serial) or line read (SD),
+// p = parsed, q = inserted into gcodeBuffer, x = taken by the executor, ok =
+// acknowledged. Each motion block the command queued reports when it ran:
+//   // BLK <seq> s:<us> e:<us>
+// All values are absolute micros() (wraps after ~71 min); the host takes differences.
+class LatencyTrace {
+public:
+    LatencyTrace();
+
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    bool isEnabled() const { return _enabled; }
+
+    // Call right before gcodeBuffer.push(); no-op while tracing is off
+    void stamp(ParsedGCodeCommand& cmd, uint32_t t_rx, uint32_t t_parse);
+
+    void reportCommand(const CommandTrace& trace, uint32_t t_exec, uint32_t t_ack);
+    void reportBlock(uint16_t seq, uint32_t t_start, uint32_t t_end);
+
+private:
+    bool _enabled;
+    uint16_t _nextSeq;
+};
+
+extern LatencyTrace latencyTrace; // Global instance
+
+#endif // LATENCY_TRACE_H
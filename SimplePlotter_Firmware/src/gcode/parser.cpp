@@ -35,6 +35,23 @@ bool GCodeParser::has_axis_param(const char* line, char axis_char) {
     return strstr(line, search_str) != nullptr;
 }
 
+// Helper to read an SD file name (M928 <file>, M930 <file>)
+bool GCodeParser::extract_filename(const char*& line, char* name, PGM_P default_name) {
+    while (*line == ' ') line++;
+    const char* end = line;
+    while (*end && *end != ' ') end++;
+    size_t len = end - line;
+    if (!memchr(line, '.', len)) {
+        strcpy_P(name, default_name);
+        return true;
+    }
+    if (len > 12) return false; // Longer than 8.3
+    memcpy(name, line, len);
+    name[len] = '\0';
+    line = end;
+    return true;
+}
+
 
 ParsedGCodeCommand GCodeParser::parse(const char* raw_line) {
     ParsedGCodeCommand cmd;
@@ -100,6 +117,10 @@ ParsedGCodeCommand GCodeParser::parse(const char* raw_line) {
                     }
                     break;
                 }
+                case 29: { // G29 Probe paper height map
+                    cmd.type = GCODE_G29;
+                    break;
+                }
                 case 90: { // G90 Absolute Positioning
                     cmd.type = GCODE_G90;
                     break;
@@ -140,6 +161,10 @@ ParsedGCodeCommand GCodeParser::parse(const char* raw_line) {
                     cmd.type = GCODE_M25;
                     break;
                 }
+                case 29: { // M29 Stop SD capture
+                    cmd.type = GCODE_M29;
+                    break;
+                }
                 case 84: { // M84 Disable Steppers
                     cmd.type = GCODE_M84;
                     cmd.m84_args.has_s = extract_float_param(line_for_param_extraction, 'S', cmd.m84_args.s_val);
@@ -157,19 +182,159 @@ ParsedGCodeCommand GCodeParser::parse(const char* raw_line) {
                     cmd.type = GCODE_M119;
                     break;
                 }
+                case 154: { // M154 Status auto-report
+                    cmd.type = GCODE_M154;
+                    cmd.m154_args.has_s = extract_float_param(line_for_param_extraction, 'S', cmd.m154_args.s_val);
+                    break;
+                }
+                case 156: { // M156 Latency tracing
+                    cmd.type = GCODE_M156;
+                    cmd.m156_args.has_s = extract_float_param(line_for_param_extraction, 'S', cmd.m156_args.s_val);
+                    break;
+                }
+                case 157: { // M157 Event trace
+                    cmd.type = GCODE_M157;
+                    cmd.m157_args.has_s = extract_float_param(line_for_param_extraction, 'S', cmd.m157_args.s_val);
+                    break;
+                }
+                case 170: { // M170 Continuous jog velocity
+                    cmd.type = GCODE_M170;
+                    cmd.m170_args.has_x = extract_float_param(line_for_param_extraction, 'X', cmd.m170_args.x_val);
+                    cmd.m170_args.has_y = extract_float_param(line_for_param_extraction, 'Y', cmd.m170_args.y_val);
+                    cmd.m170_args.has_z = extract_float_param(line_for_param_extraction, 'Z', cmd.m170_args.z_val);
+                    break;
+                }
+                case 171: { // M171 Homing calibration
+                    cmd.type = GCODE_M171;
+                    cmd.m171_args.axis_x = has_axis_param(line_for_param_extraction, 'X');
+                    cmd.m171_args.axis_y = has_axis_param(line_for_param_extraction, 'Y');
+                    cmd.m171_args.axis_z = has_axis_param(line_for_param_extraction, 'Z');
+                    break;
+                }
+                case 172: { // M172 Motion-limit auto-tune
+                    cmd.type = GCODE_M172;
+                    cmd.m172_args.axis_x = has_axis_param(line_for_param_extraction, 'X');
+                    cmd.m172_args.axis_y = has_axis_param(line_for_param_extraction, 'Y');
+                    break;
+                }
                 case 220: { // M220 Set Speed Factor
                     cmd.type = GCODE_M220;
                     cmd.m220_args.has_s = extract_float_param(line_for_param_extraction, 'S', cmd.m220_args.s_val);
                     break;
                 }
+                case 400: { // M400 Wait for queued moves
+                    cmd.type = GCODE_M400;
+                    break;
+                }
                 case 410: { // M410 Quickstop
                     cmd.type = GCODE_M410;
                     break;
                 }
+                case 420: { // M420 Height map enable/report
+                    cmd.type = GCODE_M420;
+                    cmd.m420_args.has_s = extract_float_param(line_for_param_extraction, 'S', cmd.m420_args.s_val);
+                    break;
+                }
+                case 500: { // M500 Save settings
+                    cmd.type = GCODE_M500;
+                    break;
+                }
+                case 501: { // M501 Load settings
+                    cmd.type = GCODE_M501;
+                    break;
+                }
+                case 502: { // M502 Reset settings
+                    cmd.type = GCODE_M502;
+                    break;
+                }
                 case 503: { // M503 Report Settings
                     cmd.type = GCODE_M503;
                     break;
                 }
+                case 593: { // M593 Input shaping
+                    cmd.type = GCODE_M593;
+                    cmd.m593_args.axis_x = has_axis_param(line_for_param_extraction, 'X');
+                    cmd.m593_args.axis_y = has_axis_param(line_for_param_extraction, 'Y');
+                    cmd.m593_args.has_f = extract_float_param(line_for_param_extraction, 'F', cmd.m593_args.f_val);
+                    cmd.m593_args.has_d = extract_float_param(line_for_param_extraction, 'D', cmd.m593_args.d_val);
+                    cmd.m593_args.has_t = extract_float_param(line_for_param_extraction, 'T', cmd.m593_args.t_val);
+                    break;
+                }
+                case 928: { // M928 Start SD capture: [<file>] [S1]
+                    cmd.type = GCODE_M928;
+                    // S is only looked for after the name, so names containing an S still work
+                    const char* p = line_for_param_extraction + 4;
+                    if (!extract_filename(p, cmd.m928_args.filename, PSTR(SD_CAPTURE_DEFAULT_NAME))) {
+                        cmd.type = GCODE_UNKNOWN;
+                        break;
+                    }
+                    float s_val = 0.0f;
+                    cmd.m928_args.compact = extract_float_param(p, 'S', s_val) && s_val != 0.0f;
+                    break;
+                }
+                case 930: { // M930 Start step stream recording: [<file>]
+                    cmd.type = GCODE_M930;
+                    const char* p = line_for_param_extraction + 4;
+                    if (!extract_filename(p, cmd.m930_args.filename, PSTR(STEP_STREAM_DEFAULT_NAME))) {
+                        cmd.type = GCODE_UNKNOWN;
+                    }
+                    break;
+                }
+                case 931: { // M931 Stop step stream recording
+                    cmd.type = GCODE_M931;
+                    break;
+                }
+                case 932: { // M932 Host-planned block frames
+                    cmd.type = GCODE_M932;
+                    cmd.m932_args.has_s = extract_float_param(line_for_param_extraction, 'S', cmd.m932_args.s_val);
+                    break;
+                }
+                case 933: { // M933 Trusted-position resume
+                    cmd.type = GCODE_M933;
+                    cmd.m933_args.has_s = extract_float_param(line_for_param_extraction, 'S', cmd.m933_args.s_val);
+                    break;
+                }
+                case 934: { // M934 Endstop simulator homing trials
+                    cmd.type = GCODE_M934;
+                    cmd.m934_args = M934Params(); // Member defaults don't apply inside the union
+                    M934Params& a = cmd.m934_args;
+                    a.axis_x = has_axis_param(line_for_param_extraction, 'X');
+                    a.axis_y = has_axis_param(line_for_param_extraction, 'Y');
+                    a.axis_z = has_axis_param(line_for_param_extraction, 'Z');
+                    float v;
+                    if (extract_float_param(line_for_param_extraction, 'N', v)) a.runs = constrain(v, 0, 65535);
+                    if (extract_float_param(line_for_param_extraction, 'H', v)) a.hysteresis_mm = max(v, 0.0f);
+                    if (extract_float_param(line_for_param_extraction, 'J', v)) a.jitter_mm = max(v, 0.0f);
+                    if (extract_float_param(line_for_param_extraction, 'B', v)) a.bounce_ms = constrain(v, 0, 255);
+                    if (extract_float_param(line_for_param_extraction, 'R', v)) a.noise_ppm = constrain(v, 0, 65535);
+                    if (extract_float_param(line_for_param_extraction, 'D', v)) a.dead_pct = constrain(v, 0, 100);
+                    if (extract_float_param(line_for_param_extraction, 'S', v)) a.seed = (unsigned long)v;
+                    break;
+                }
+                case 936: { // M936 Start serial session capture: [<file>]
+                    cmd.type = GCODE_M936;
+                    const char* p = line_for_param_extraction + 4;
+                    if (!extract_filename(p, cmd.m936_args.filename, PSTR(SESSION_DEFAULT_NAME))) {
+                        cmd.type = GCODE_UNKNOWN;
+                    }
+                    break;
+                }
+                case 937: { // M937 Stop serial session capture
+                    cmd.type = GCODE_M937;
+                    break;
+                }
+                case 938: { // M938 Replay a serial session: [<file>] [S1]
+                    cmd.type = GCODE_M938;
+                    // S is only looked for after the name, so names containing an S still work
+                    const char* p = line_for_param_extraction + 4;
+                    if (!extract_filename(p, cmd.m938_args.filename, PSTR(SESSION_DEFAULT_NAME))) {
+                        cmd.type = GCODE_UNKNOWN;
+                        break;
+                    }
+                    float s_val = 0.0f;
+                    cmd.m938_args.fast = extract_float_param(p, 'S', s_val) && s_val != 0.0f;
+                    break;
+                }
                 case 999: { // M999 Motor Raw Test (per-axis diagnostic)
                     cmd.type = GCODE_M999;
                     // Default to Z for backward compatibility
@@ -22,6 +22,10 @@ private:
 
     // Helper to determine if an axis is present in G28 (e.g., G28 X)
     bool has_axis_param(const char* line, char axis_char);
+
+    // SD file name as the first word after the command (it must contain a dot), else
+    // default_name (in flash). Moves line past the name. False if the name is longer than 8.3.
+    bool extract_filename(const char*& line, char* name, PGM_P default_name);
 };
 
 extern GCodeParser gcodeParser; // Global instance
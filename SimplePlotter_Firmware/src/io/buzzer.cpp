@@ -1,5 +1,6 @@
 #include "buzzer.h"
 #include <avr/wdt.h>
+#include <avr/pgmspace.h>
 
 namespace Buzzer {
 
@@ -19,49 +20,78 @@ namespace Buzzer {
         delay(20); // Short gap between notes
     }
 
-    // Startup: ascending C-E-G-C5 arpeggio (cheerful boot jingle)
-    void playStartup() {
-        playNote(NOTE_C4, 100);
-        playNote(NOTE_E4, 100);
-        playNote(NOTE_G4, 100);
-        playNote(NOTE_C5, 200);
+    // Melody player state. The melodies live in PROGMEM; the player reads one note at a time.
+    struct Note {
+        uint16_t frequency; // Hz, NOTE_REST for silence
+        uint16_t durationMs;
+    };
+
+    static const Note* _melody = nullptr; // PROGMEM
+    static uint8_t _melodyLength = 0;
+    static uint8_t _noteIndex = 0;
+    static unsigned long _noteStart = 0;
+
+    static uint16_t noteFrequency(uint8_t index) { return pgm_read_word(&_melody[index].frequency); }
+    static uint16_t noteDuration(uint8_t index) { return pgm_read_word(&_melody[index].durationMs); }
+
+    static void startNote() {
+        uint16_t frequency = noteFrequency(_noteIndex);
+        if (frequency > 0) {
+            tone(BEEPER_PIN, frequency, noteDuration(_noteIndex));
+        } else {
+            noTone(BEEPER_PIN);
+        }
+        _noteStart = millis();
     }
 
-    // Plot start: two quick ascending notes (let's go!)
-    void playPlotStart() {
-        playNote(NOTE_G4, 80);
-        playNote(NOTE_C5, 120);
+    static void play(const Note* melody, uint8_t length) {
+        _melody = melody;
+        _melodyLength = length;
+        _noteIndex = 0;
+        startNote();
     }
 
-    // Plot finish: triumphant ascending + long finish note
-    void playPlotFinish() {
-        playNote(NOTE_C5, 100);
-        playNote(NOTE_E5, 100);
-        playNote(NOTE_G5, 300);
+    void update() {
+        if (_melody == nullptr) return;
+        // Each note is followed by the same short gap playNote() uses
+        if (millis() - _noteStart < (unsigned long)noteDuration(_noteIndex) + 20) return;
+        if (++_noteIndex >= _melodyLength) {
+            noTone(BEEPER_PIN);
+            _melody = nullptr;
+            return;
+        }
+        startNote();
     }
 
-    // Plot stop: two descending notes (cancelled)
-    void playPlotStop() {
-        playNote(NOTE_G4, 100);
-        playNote(NOTE_C4, 200);
+    bool isPlaying() {
+        return _melody != nullptr;
     }
 
+    // Startup: ascending C-E-G-C5 arpeggio (cheerful boot jingle)
+    static const Note startupMelody[] PROGMEM = { {NOTE_C4, 100}, {NOTE_E4, 100}, {NOTE_G4, 100}, {NOTE_C5, 200} };
+    void playStartup() { play(startupMelody, 4); }
+
+    // Plot start: two quick ascending notes (let's go!)
+    static const Note plotStartMelody[] PROGMEM = { {NOTE_G4, 80}, {NOTE_C5, 120} };
+    void playPlotStart() { play(plotStartMelody, 2); }
+
+    // Plot finish: triumphant ascending + long finish note
+    static const Note plotFinishMelody[] PROGMEM = { {NOTE_C5, 100}, {NOTE_E5, 100}, {NOTE_G5, 300} };
+    void playPlotFinish() { play(plotFinishMelody, 3); }
+
+    // Plot stop: two descending notes (cancelled)
+    static const Note plotStopMelody[] PROGMEM = { {NOTE_G4, 100}, {NOTE_C4, 200} };
+    void playPlotStop() { play(plotStopMelody, 2); }
+
     // Plot pause: single mid-tone beep
-    void playPlotPause() {
-        playNote(NOTE_E4, 200);
-    }
+    static const Note plotPauseMelody[] PROGMEM = { {NOTE_E4, 200} };
+    void playPlotPause() { play(plotPauseMelody, 1); }
 
     // Homing done: quick double beep
-    void playHomingDone() {
-        playNote(NOTE_C5, 80);
-        playNote(NOTE_REST, 50);
-        playNote(NOTE_C5, 80);
-    }
+    static const Note homingDoneMelody[] PROGMEM = { {NOTE_C5, 80}, {NOTE_REST, 50}, {NOTE_C5, 80} };
+    void playHomingDone() { play(homingDoneMelody, 3); }
 
     // Error: low descending tone
-    void playError() {
-        playNote(NOTE_A4, 150);
-        playNote(NOTE_F4, 150);
-        playNote(NOTE_D4, 300);
-    }
+    static const Note errorMelody[] PROGMEM = { {NOTE_A4, 150}, {NOTE_F4, 150}, {NOTE_D4, 300} };
+    void playError() { play(errorMelody, 3); }
 }
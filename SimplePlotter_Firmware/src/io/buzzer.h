@@ -20,9 +20,13 @@
 
 namespace Buzzer {
     void beep(int durationMs);
-    void playNote(int frequency, int durationMs);
+    void playNote(int frequency, int durationMs); // Blocking single note
+
+    // Event melodies are non-blocking: they start the first note and update()
+    // advances through the rest. A new melody replaces one still playing.
+    void update(); // Call from loop()
+    bool isPlaying();
 
-    // Event melodies
     void playStartup();     // Boot jingle
     void playPlotStart();   // Plot begins
     void playPlotFinish();  // Plot completed successfully
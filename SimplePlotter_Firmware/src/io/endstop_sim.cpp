@@ -0,0 +1,144 @@
+// SimplePlotter_Firmware/src/io/endstop_sim.cpp
+
+#include "endstop_sim.h"
+
+#if ENDSTOP_SIM
+
+#include <avr/wdt.h>
+#include "serial_handler.h"
+#include "../motion/stepper_control.h"
+#include "../motion/homing.h"
+
+EndstopSim endstopSim; // Global instance definition
+
+EndstopSim::EndstopSim() {
+    _params.hysteresis_mm = ENDSTOP_SIM_HYSTERESIS_MM;
+    _params.jitter_mm = ENDSTOP_SIM_JITTER_MM;
+    _params.bounce_ms = ENDSTOP_SIM_BOUNCE_MS;
+    _params.noise_ppm = ENDSTOP_SIM_NOISE_PPM;
+    _params.dead_pct = 0;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        // Boot: step count 0, carriage somewhere mid-travel
+        _offset[i] = -axisMmToSteps(i, axisConfig[i].max_pos / 2);
+        _trigger[i] = 0;
+        _closed[i] = false;
+        _dead[i] = false;
+        _edge_ms[i] = 0;
+        _read_ms[i] = 0;
+    }
+}
+
+long EndstopSim::_position(AxisIndex axis) const {
+    return axisConfig[axis].home_dir * stepperControl.getCurrentSteps(axis) + _offset[axis];
+}
+
+void EndstopSim::_place(AxisIndex axis, float distance_mm) {
+    _offset[axis] = -axisMmToSteps(axis, distance_mm) - axisConfig[axis].home_dir * stepperControl.getCurrentSteps(axis);
+    _closed[axis] = false;
+    _trigger[axis] = _jitter(axis);
+    _read_ms[axis] = millis();
+    _edge_ms[axis] = _read_ms[axis] - _params.bounce_ms; // Placed clear of the switch: nothing left to bounce
+}
+
+void EndstopSim::countSet(AxisIndex axis, long steps) {
+    _offset[axis] += axisConfig[axis].home_dir * (stepperControl.getCurrentSteps(axis) - steps);
+}
+
+long EndstopSim::_jitter(AxisIndex axis) {
+    long range = axisMmToSteps(axis, _params.jitter_mm);
+    return range > 0 ? random(-range, range + 1) : 0;
+}
+
+bool EndstopSim::read(AxisIndex axis) {
+    long pos = _position(axis);
+    long stop = axisMmToSteps(axis, ENDSTOP_SIM_OVERTRAVEL_MM);
+    if (pos > stop) { // Stalled against the hard stop: the extra steps are lost
+        _offset[axis] -= pos - stop;
+        pos = stop;
+    }
+
+    bool closed = _closed[axis];
+    if (_dead[axis]) {
+        closed = false;
+    } else if (!closed && pos >= _trigger[axis]) {
+        closed = true;
+    } else if (closed && pos < _trigger[axis] - axisMmToSteps(axis, _params.hysteresis_mm)) {
+        closed = false;
+        _trigger[axis] = _jitter(axis); // The next touch closes at a slightly different point
+    }
+    // The contact changed somewhere since the last read. Homing doesn't read the switch
+    // while it backs off, so dating the edge now would bounce the next approach.
+    unsigned long now = millis();
+    if (closed != _closed[axis]) {
+        _closed[axis] = closed;
+        _edge_ms[axis] = _read_ms[axis];
+    }
+    _read_ms[axis] = now;
+
+    bool reading = closed;
+    if (now - _edge_ms[axis] < _params.bounce_ms) reading = random(2);
+    if (_params.noise_ppm && random(1000000L) < _params.noise_ppm) reading = !reading;
+    return reading;
+}
+
+void EndstopSim::runTrials(AxisIndex axis, uint16_t runs, unsigned long seed) {
+    const AxisConfig& cfg = axisConfig[axis];
+    long ref_steps = (cfg.home_dir == 1) ? axisMmToSteps(axis, cfg.max_pos) : 0; // Homing's zero
+    randomSeed(seed);
+
+    uint16_t good = 0, false_fail = 0, dead = 0, dead_caught = 0;
+    unsigned long time_sum = 0, time_max = 0;
+    float err_sum = 0.0f, err_sq = 0.0f, err_min = 0.0f, err_max = 0.0f;
+
+    for (uint16_t run = 0; run < runs; run++) {
+        wdt_reset();
+        _dead[axis] = random(100) < _params.dead_pct;
+        _place(axis, (float)random(5, (long)cfg.max_pos + 1));
+
+        unsigned long start = millis();
+        bool ok = homing.homeAxis(axis);
+        unsigned long elapsed = millis() - start;
+
+        if (_dead[axis]) {
+            dead++;
+            if (!ok) dead_caught++;
+            continue;
+        }
+        if (!ok) {
+            false_fail++;
+            continue;
+        }
+        // Where the carriage really was when homing called it home, from the trigger point
+        float err = (cfg.home_dir * ref_steps + _offset[axis]) / cfg.steps_per_mm;
+        if (good == 0 || err < err_min) err_min = err;
+        if (good == 0 || err > err_max) err_max = err;
+        err_sum += err;
+        err_sq += err * err;
+        time_sum += elapsed;
+        if (elapsed > time_max) time_max = elapsed;
+        good++;
+    }
+    _dead[axis] = false;
+
+    char msg[80], a[10], b[10], c[10];
+    snprintf_P(msg, sizeof(msg), PSTR("M934 %c: %u runs, seed %lu"), cfg.name, runs, seed);
+    serialHandler.sendInfo(msg);
+    if (good) {
+        float mean = err_sum / good;
+        float var = err_sq / good - mean * mean;
+        dtostrf(time_sum / 1000.0f / good, 1, 2, a);
+        dtostrf(time_max / 1000.0f, 1, 2, b);
+        snprintf_P(msg, sizeof(msg), PSTR("M934 %c: homing time avg %ss max %ss"), cfg.name, a, b);
+        serialHandler.sendInfo(msg);
+        dtostrf(mean, 1, 3, a);
+        dtostrf(err_max - err_min, 1, 3, b);
+        dtostrf(var > 0.0f ? sqrt(var) : 0.0f, 1, 3, c);
+        snprintf_P(msg, sizeof(msg), PSTR("M934 %c: home at %smm past trigger, spread %smm, sd %smm"), cfg.name, a, b, c);
+        serialHandler.sendInfo(msg);
+    }
+    snprintf_P(msg, sizeof(msg), PSTR("M934 %c: %u of %u good switches failed, %u of %u dead switches caught"),
+             cfg.name, false_fail, runs - dead, dead_caught, dead);
+    serialHandler.sendInfo(msg);
+}
+
+#endif // ENDSTOP_SIM
@@ -0,0 +1,63 @@
+// SimplePlotter_Firmware/src/io/endstop_sim.h
+
+#ifndef ENDSTOP_SIM_H
+#define ENDSTOP_SIM_H
+
+#include <Arduino.h>
+#include "../config.h"
+#include "../motion/axis.h"
+
+#if ENDSTOP_SIM
+
+// Switch model, shared by all axes
+struct EndstopSimParams {
+    float hysteresis_mm;
+    float jitter_mm;
+    uint8_t bounce_ms;
+    uint16_t noise_ppm;
+    uint8_t dead_pct; // Share of M934 runs with a switch that never closes
+};
+
+// Virtual endstops for homing work without the machine (ENDSTOP_SIM builds). Each axis
+// has a carriage position derived from its step count plus an offset. The offset is
+// the unknown start position, and steps past the hard stop are lost into it, as when a
+// real motor stalls. Setting the count (homing, G92) moves the offset the other way.
+// The switch closes at the trigger point, which moves by up to
+// +-jitter each time it opens again. It opens hysteresis_mm back from there, reads
+// randomly for bounce_ms after each edge and flips single readings at noise_ppm.
+// Positions are along the homing direction: 0 is the nominal trigger point.
+class EndstopSim {
+public:
+    EndstopSim();
+
+    // Endstops::getRawState() in simulator builds
+    bool read(AxisIndex axis);
+
+    // StepperControl is about to set the step count to `steps` (homing, G92)
+    void countSet(AxisIndex axis, long steps);
+
+    EndstopSimParams& params() { return _params; }
+
+    // M934: home the axis `runs` times from random start points and report homing
+    // time, the spread of the homed position and how failures were handled
+    void runTrials(AxisIndex axis, uint16_t runs, unsigned long seed);
+
+private:
+    EndstopSimParams _params;
+    long _offset[AXIS_COUNT];  // Carriage position = home_dir * steps + offset (steps)
+    long _trigger[AXIS_COUNT]; // Trigger point of the current touch (steps)
+    bool _closed[AXIS_COUNT];  // Ideal contact state, before bounce and noise
+    bool _dead[AXIS_COUNT];
+    unsigned long _edge_ms[AXIS_COUNT];
+    unsigned long _read_ms[AXIS_COUNT]; // Last read; an edge found later happened after it
+
+    long _position(AxisIndex axis) const;
+    void _place(AxisIndex axis, float distance_mm); // Carriage this far before the trigger point
+    long _jitter(AxisIndex axis);
+};
+
+extern EndstopSim endstopSim; // Global instance
+
+#endif // ENDSTOP_SIM
+
+#endif // ENDSTOP_SIM_H
@@ -1,30 +1,59 @@
 // SimplePlotter_Firmware/src/io/endstops.cpp
 
 #include "endstops.h"
+#include "../utils/event_trace.h"
 
 Endstops endstops; // Global instance definition
 
+// Interrupt context: the pin and polarity are compile-time constants per axis
+template<uint8_t A> void Endstops::latchISR() {
+    bool raw_read_low = (digitalRead(AxisTraits<A>::MIN_PIN) == LOW);
+    bool triggered = AxisTraits<A>::ENDSTOP_INVERTING ? raw_read_low : !raw_read_low;
+    if (triggered) endstops._latched[A] = true;
+    TRACE_EVENT(EV_ENDSTOP, (A << 8) | triggered);
+}
+
+// Y_MIN (D14 / PJ1) has no external interrupt, only pin change interrupt PCINT10.
+// PCINT1 group also holds PE0 (RX0) and PJ0-PJ6; only PCINT10 is unmasked.
+ISR(PCINT1_vect) {
+    Endstops::latchISR<AXIS_Y>();
+}
+
 Endstops::Endstops() :
-    _x_min_config({X_MIN_PIN, ENDSTOP_X_MIN_INVERTING, ENDSTOP_X_MIN_PULLUP, ENDSTOP_DEBOUNCE_MS}),
-    _y_min_config({Y_MIN_PIN, ENDSTOP_Y_MIN_INVERTING, ENDSTOP_Y_MIN_PULLUP, ENDSTOP_DEBOUNCE_MS}),
-    _z_min_config({Z_MIN_PIN, ENDSTOP_Z_MIN_INVERTING, ENDSTOP_Z_MIN_PULLUP, ENDSTOP_DEBOUNCE_MS})
+    _config{
+        {AxisTraits<AXIS_X>::MIN_PIN, AxisTraits<AXIS_X>::ENDSTOP_INVERTING, AxisTraits<AXIS_X>::ENDSTOP_PULLUP, ENDSTOP_DEBOUNCE_MS},
+        {AxisTraits<AXIS_Y>::MIN_PIN, AxisTraits<AXIS_Y>::ENDSTOP_INVERTING, AxisTraits<AXIS_Y>::ENDSTOP_PULLUP, ENDSTOP_DEBOUNCE_MS},
+        {AxisTraits<AXIS_Z>::MIN_PIN, AxisTraits<AXIS_Z>::ENDSTOP_INVERTING, AxisTraits<AXIS_Z>::ENDSTOP_PULLUP, ENDSTOP_DEBOUNCE_MS}
+    }
 {
     // Constructor initializes config structs
 }
 
 void Endstops::init() {
-    setupEndstopPin(_x_min_config);
-    setupEndstopPin(_y_min_config);
-    setupEndstopPin(_z_min_config);
-
-    // Initialize debounce state from actual pin readings so first isTriggered()
-    // call doesn't spuriously reset the debounce timer
-    _last_stable_raw_state[0] = getPinTriggeredState(_x_min_config);
-    _last_stable_raw_state[1] = getPinTriggeredState(_y_min_config);
-    _last_stable_raw_state[2] = getPinTriggeredState(_z_min_config);
-    _debounced_triggered_state[0] = _last_stable_raw_state[0];
-    _debounced_triggered_state[1] = _last_stable_raw_state[1];
-    _debounced_triggered_state[2] = _last_stable_raw_state[2];
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        setupEndstopPin(_config[i]);
+
+        // Initialize debounce state from actual pin readings so first isTriggered()
+        // call doesn't spuriously reset the debounce timer
+        _last_stable_raw_state[i] = getRawState((AxisIndex)i);
+        _debounced_triggered_state[i] = _last_stable_raw_state[i];
+    }
+
+#if !ENDSTOP_SIM
+    attachLatchInterrupts();
+#endif
+}
+
+void Endstops::attachLatchInterrupts() {
+    attachInterrupt(digitalPinToInterrupt(X_MIN_PIN), latchISR<AXIS_X>, CHANGE); // INT5
+    attachInterrupt(digitalPinToInterrupt(Z_MIN_PIN), latchISR<AXIS_Z>, CHANGE); // INT3
+    PCMSK1 |= _BV(PCINT10);
+    PCICR |= _BV(PCIE1);
+}
+
+void Endstops::clearLatch(AxisIndex axis) {
+    // Re-latch immediately if the switch is still triggered
+    _latched[axis] = getRawState(axis);
 }
 
 void Endstops::setupEndstopPin(const EndstopConfig& config) {
@@ -43,31 +72,13 @@ bool Endstops::getPinTriggeredState(const EndstopConfig& config) const {
 }
 
 
-// Read raw state of an endstop pin (no debouncing)
-// Returns true if the endstop is considered "triggered" based on its config.
-bool Endstops::getRawState(char axis) const {
-    const EndstopConfig* config = nullptr;
-    if (axis == 'X') config = &_x_min_config;
-    else if (axis == 'Y') config = &_y_min_config;
-    else if (axis == 'Z') config = &_z_min_config;
-    
-    if (config == nullptr) return false; // Invalid axis
-
-    return getPinTriggeredState(*config);
-}
-
 // Check if a specific endstop is currently triggered (debounced)
 // Returns true if the endstop is considered "triggered" based on its config and debouncing.
-bool Endstops::isTriggered(char axis) { // No longer const
-    const EndstopConfig* config = nullptr;
-    int axis_idx = -1;
-    if (axis == 'X') { config = &_x_min_config; axis_idx = 0; }
-    else if (axis == 'Y') { config = &_y_min_config; axis_idx = 1; }
-    else if (axis == 'Z') { config = &_z_min_config; axis_idx = 2; }
-    
-    if (config == nullptr || axis_idx == -1) return false; // Invalid axis
-
-    bool current_raw_triggered_state = getPinTriggeredState(*config); // Get raw state, already inverted as per config
+bool Endstops::isTriggered(AxisIndex axis) { // No longer const
+    const EndstopConfig* config = &_config[axis];
+    uint8_t axis_idx = axis;
+
+    bool current_raw_triggered_state = getRawState(axis); // Get raw state, already inverted as per config
 
     // If the raw state has changed from the last time we checked its 'stable' state
     if (current_raw_triggered_state != _last_stable_raw_state[axis_idx]) {
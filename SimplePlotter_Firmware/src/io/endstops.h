@@ -5,6 +5,8 @@
 
 #include <Arduino.h>
 #include "../config.h" // For endstop pin definitions and configuration
+#include "../motion/axis.h"
+#include "endstop_sim.h" // Virtual switches instead of the pins (ENDSTOP_SIM builds)
 
 // Configuration for a single endstop
 struct EndstopConfig {
@@ -21,26 +23,43 @@ public:
     void init();
 
     // Check if a specific endstop is currently triggered (debounced)
-    bool isTriggered(char axis); 
+    bool isTriggered(AxisIndex axis);
 
     // Read raw state of an endstop pin (no debouncing, inverted as per config)
-    bool getRawState(char axis) const;
+#if ENDSTOP_SIM
+    bool getRawState(AxisIndex axis) const { return endstopSim.read(axis); }
+#else
+    bool getRawState(AxisIndex axis) const { return getPinTriggeredState(_config[axis]); }
+#endif
+
+    // Interrupt-latched trigger: set by a pin-change interrupt the moment the endstop
+    // triggers, so fast motion (continuous jog) can stop without polling. No interrupts in
+    // ENDSTOP_SIM builds, so it is never set; jogging there is bounded by the soft limits only.
+    bool isLatched(AxisIndex axis) const { return _latched[axis]; }
+    void clearLatch(AxisIndex axis);
 
 private:
-    EndstopConfig _x_min_config;
-    EndstopConfig _y_min_config;
-    EndstopConfig _z_min_config;
+    EndstopConfig _config[AXIS_COUNT]; // Min endstop per axis
 
     // Internal debouncing state (non-const part of the class)
-    unsigned long _last_debounce_time[3] = {0}; // For X, Y, Z
-    bool _last_stable_raw_state[3] = {false, false, false}; // Last observed raw triggered state
-    bool _debounced_triggered_state[3] = {false, false, false}; // Debounced triggered state
+    unsigned long _last_debounce_time[AXIS_COUNT] = {0};
+    bool _last_stable_raw_state[AXIS_COUNT] = {false, false, false}; // Last observed raw triggered state
+    bool _debounced_triggered_state[AXIS_COUNT] = {false, false, false}; // Debounced triggered state
+
+    // Latched trigger flags, written from interrupt context
+    volatile bool _latched[AXIS_COUNT] = {false, false, false};
     
     // Helper to initialize a single endstop pin
     void setupEndstopPin(const EndstopConfig& config);
     
     // Helper to get raw digital read, inverted if necessary
     bool getPinTriggeredState(const EndstopConfig& config) const;
+
+    // Attach INT5 (X), PCINT10 (Y) and INT3 (Z) to the latch flags
+    void attachLatchInterrupts();
+
+public:
+    template<uint8_t A> static void latchISR(); // Interrupt handler body for axis A
 };
 
 extern Endstops endstops; // Global instance
@@ -0,0 +1,71 @@
+// SimplePlotter_Firmware/src/io/job_eta.cpp
+
+#include "job_eta.h"
+#include "sd_card.h"
+#include "../motion/motion_queue.h"
+#include "../ui/screens.h" // For sd_exec_state
+
+JobEta jobEta; // Global instance definition
+
+JobEta::JobEta() : _tracking(false), _fileOpen(false), _lastMs(0), _runMs(0),
+                   _windowStartBytes(0), _windowStartPlanMs(0), _msPerByte(0.0f) {}
+
+// Work content of everything read so far: time already run plus time still queued
+uint32_t JobEta::_planMs() const {
+    return _runMs + motionQueue.remainingMs();
+}
+
+void JobEta::service() {
+    unsigned long now = millis();
+    bool open = sdCard.isFileOpen();
+    bool opened = open && !_fileOpen;
+    _fileOpen = open;
+
+    if (opened) {
+        _tracking = true;
+        _runMs = 0;
+        _lastMs = now;
+        _msPerByte = 0.0f;
+        _windowStartBytes = sdCard.filePosition();
+        _windowStartPlanMs = _planMs();
+        return;
+    }
+    if (!_tracking) return;
+    if (!open && motionQueue.isIdle()) {
+        _tracking = false; // Finished or cancelled, and the last block has run
+        return;
+    }
+
+    if (sd_exec_state != SD_EXEC_PAUSED || !motionQueue.isIdle()) _runMs += now - _lastMs;
+    _lastMs = now;
+    if (!open) return;
+
+    unsigned long bytes = sdCard.filePosition();
+    if (bytes - _windowStartBytes < ETA_WINDOW_BYTES) return;
+    uint32_t plan = _planMs();
+    // A block that ran shorter than estimated can pull the plan back a little
+    float rate = plan > _windowStartPlanMs ? (float)(plan - _windowStartPlanMs) / (float)(bytes - _windowStartBytes) : 0.0f;
+    _msPerByte = (_msPerByte == 0.0f) ? rate : _msPerByte + (float)ETA_RATE_WEIGHT * (rate - _msPerByte);
+    _windowStartBytes = bytes;
+    _windowStartPlanMs = plan;
+}
+
+long JobEta::remainingSeconds() const {
+    if (!_tracking) return -1;
+    unsigned long unread = _fileOpen ? sdCard.fileSize() - sdCard.filePosition() : 0;
+    if (unread > 0 && _msPerByte == 0.0f) return -1;
+    float ms = (float)motionQueue.remainingMs() + (float)unread * _msPerByte;
+    return (long)((ms + 500.0f) / 1000.0f);
+}
+
+void JobEta::format(char* buf) const {
+    long s = remainingSeconds();
+    if (s < 0) {
+        strcpy_P(buf, PSTR("--:--"));
+        return;
+    }
+    if (s > 99L * 3600L + 3599L) s = 99L * 3600L + 3599L;
+    unsigned int h = s / 3600, m = (s / 60) % 60, sec = s % 60;
+    if (h > 0) snprintf_P(buf, 9, PSTR("%u:%02u:%02u"), h, m, sec);
+    else snprintf_P(buf, 9, PSTR("%02u:%02u"), m, sec);
+}
@@ -0,0 +1,44 @@
+// SimplePlotter_Firmware/src/io/job_eta.h
+
+#ifndef JOB_ETA_H
+#define JOB_ETA_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+// Remaining time of the SD job. Byte progress alone mispredicts files whose dense
+// parts sit at one end, so the estimate has two parts:
+//   - the planned run time of the blocks already in the motion queue, and
+//   - the unread bytes at a rolling time-per-byte rate. Each ETA_WINDOW_BYTES of file
+//     read, the rate is re-measured as (run time so far + queued time) per byte over
+//     that window and blended in with weight ETA_RATE_WEIGHT.
+class JobEta {
+public:
+    JobEta();
+
+    // Call from loop(). Follows the SD file by itself: a newly opened file starts a
+    // fresh estimate, time spent paused is not counted, and after the last line has
+    // been read the estimate is the queued time alone until the queue drains.
+    void service();
+
+    // Seconds left, or -1 while no job runs or the first window hasn't been read yet
+    long remainingSeconds() const;
+
+    // "h:mm:ss" / "mm:ss", or "--:--" when unknown; buf needs 9 bytes
+    void format(char* buf) const;
+
+private:
+    bool _tracking;
+    bool _fileOpen;                // SD file open at the last service()
+    unsigned long _lastMs;
+    uint32_t _runMs;               // Time spent running this job
+    unsigned long _windowStartBytes;
+    uint32_t _windowStartPlanMs;   // _runMs + queued time when the window started
+    float _msPerByte;              // 0 = not measured yet
+
+    uint32_t _planMs() const;
+};
+
+extern JobEta jobEta; // Global instance
+
+#endif // JOB_ETA_H
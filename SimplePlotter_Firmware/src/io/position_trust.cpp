@@ -0,0 +1,94 @@
+// SimplePlotter_Firmware/src/io/position_trust.cpp
+
+#include "position_trust.h"
+#include <EEPROM.h>
+#include <util/crc16.h>
+#include "settings.h"
+#include "serial_handler.h"
+#include "../globals.h"
+#include "../motion/motion_queue.h"
+#include "../gcode/executor.h" // syncPositionFromSteps()
+
+PositionTrust positionTrust; // Global instance definition
+
+#define POSITION_TRUST_MARK 0xA5
+
+// EEPROM layout at POSITION_TRUST_EEPROM_ADDR: the mark byte, then the body and its
+// CRC16. The mark is written last when saving and cleared first, so a reset halfway
+// through either leaves an untrusted record.
+struct PositionRecord {
+    uint8_t homed; // Bit per axis
+    float steps_per_mm[AXIS_COUNT]; // A reflash with another machine profile drops the record
+    int32_t steps[AXIS_COUNT];
+};
+
+static_assert(POSITION_TRUST_EEPROM_ADDR + 1 + sizeof(PositionRecord) + 2 <= 4096,
+              "Trusted position does not fit the ATmega2560 EEPROM");
+
+static uint16_t crcOf(const PositionRecord& record) {
+    uint16_t crc = 0xFFFF;
+    const uint8_t* p = (const uint8_t*)&record;
+    for (uint8_t i = 0; i < sizeof(record); i++) crc = _crc16_update(crc, p[i]);
+    return crc;
+}
+
+PositionTrust::PositionTrust() : _trusted(false) {}
+
+bool PositionTrust::restore() {
+    if (!settings.data().trusted_resume) return false;
+
+    int addr = POSITION_TRUST_EEPROM_ADDR;
+    if (EEPROM.read(addr) != POSITION_TRUST_MARK) return false;
+    PositionRecord record;
+    uint16_t stored_crc;
+    EEPROM.get(addr + 1, record);
+    EEPROM.get(addr + 1 + (int)sizeof(record), stored_crc);
+    if (stored_crc != crcOf(record)) return false;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (record.steps_per_mm[i] != axisConfig[i].steps_per_mm) return false;
+    }
+
+    stepperControl.setCurrentPosition(record.steps[AXIS_X], record.steps[AXIS_Y], record.steps[AXIS_Z]);
+    homing.setHomed(record.homed & 0x01, record.homed & 0x02, record.homed & 0x04);
+    syncPositionFromSteps();
+    _trusted = true; // Still where the record says: nothing has moved yet
+
+    char msg[64], x[10], y[10];
+    dtostrf(current_position_mm.x, 1, 2, x);
+    dtostrf(current_position_mm.y, 1, 2, y);
+    snprintf_P(msg, sizeof(msg), PSTR("M933: position X%s Y%s restored, G28 if in doubt"), x, y);
+    serialHandler.sendInfo(msg);
+    return true;
+}
+
+void PositionTrust::save() {
+    if (_trusted || !settings.data().trusted_resume) return;
+    if (!homing.isHomedX() && !homing.isHomedY()) return;
+    if (!motionQueue.isIdle() || stepperControl.isJogging()) return;
+
+    PositionRecord record;
+    record.homed = (homing.isHomedX() ? 0x01 : 0) | (homing.isHomedY() ? 0x02 : 0) | (homing.isHomedZ() ? 0x04 : 0);
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        record.steps_per_mm[i] = axisConfig[i].steps_per_mm;
+        record.steps[i] = stepperControl.getCurrentSteps((AxisIndex)i);
+    }
+    // EEPROM.put() only writes bytes that differ: a save costs the changed step counts
+    int addr = POSITION_TRUST_EEPROM_ADDR;
+    EEPROM.put(addr + 1, record);
+    EEPROM.put(addr + 1 + (int)sizeof(record), crcOf(record));
+    EEPROM.update(addr, POSITION_TRUST_MARK);
+    _trusted = true;
+}
+
+void PositionTrust::invalidate() {
+    if (!_trusted) return;
+    // One byte: the write runs in the background while the caller goes on
+    EEPROM.update(POSITION_TRUST_EEPROM_ADDR, 0);
+    _trusted = false;
+}
+
+void PositionTrust::service() {
+    if (_trusted || !settings.data().trusted_resume) return;
+    if (millis() - last_stepper_activity_time < POSITION_TRUST_IDLE_MS) return;
+    save();
+}
@@ -0,0 +1,41 @@
+// SimplePlotter_Firmware/src/io/position_trust.h
+
+#ifndef POSITION_TRUST_H
+#define POSITION_TRUST_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+// Trusted-position resume (M933, opt-in). Once the machine has rested for
+// POSITION_TRUST_IDLE_MS, and again when its steppers are disabled through M84 or the
+// idle timeout, the step position and homed flags are written to EEPROM and marked
+// trusted. At boot, a trusted record is restored, so no G28 is needed.
+//
+// The mark is cleared before anything can move the carriage or change the step counts:
+// enabling the steppers, any other disable (M0, M410, homing), and G92. So a record is only
+// ever trusted while the carriage sits where it says. A power cut mid-move leaves no trust.
+// Disabled steppers can still be pushed by hand; opting in accepts that.
+class PositionTrust {
+public:
+    PositionTrust();
+
+    // Boot, after settings.load(): restore a trusted record if M933 is on. True when the
+    // position and homed flags were restored (info sent).
+    bool restore();
+
+    // Write and mark the record if M933 is on, an axis is homed and nothing is moving
+    void save();
+    // Clear the mark; one EEPROM byte, and only while the record is trusted
+    void invalidate();
+    bool isTrusted() const { return _trusted; }
+
+    // Call from loop(): saves once the machine has been at rest long enough
+    void service();
+
+private:
+    bool _trusted; // The EEPROM record currently carries the trust mark
+};
+
+extern PositionTrust positionTrust; // Global instance
+
+#endif // POSITION_TRUST_H
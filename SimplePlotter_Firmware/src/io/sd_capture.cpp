@@ -0,0 +1,160 @@
+// SimplePlotter_Firmware/src/io/sd_capture.cpp
+
+#include "sd_capture.h"
+#include "sd_card.h"
+#include "serial_handler.h"
+#include "../motion/stepper_control.h"
+#include "../ui/screens.h" // For sd_exec_state
+
+SDCapture sdCapture; // Global instance definition
+
+SDCapture::SDCapture() : _active(false), _compact(false), _fill(0), _lines(0), _bytes(0) {}
+
+// Only names the LCD browser lists can be replayed from it
+static bool hasGCodeExtension(const char* name) {
+    const char* dot = strrchr(name, '.');
+    return dot && (strcasecmp_P(dot, PSTR(".gcode")) == 0 ||
+                   strcasecmp_P(dot, PSTR(".gc")) == 0 ||
+                   strcasecmp_P(dot, PSTR(".g")) == 0);
+}
+
+bool SDCapture::start(const char* filename, bool compact) {
+    if (_active) stop();
+
+    if (!hasGCodeExtension(filename)) {
+        serialHandler.sendError(ERR_INVALID_SYNTAX, F("M928: file name must end in .gcode, .gc or .g"));
+        return false;
+    }
+    if (!sdCard.isInitialized() && !sdCard.init()) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M928: no SD card"));
+        return false;
+    }
+    if (!sdWriter.claim(F("M928"))) return false;
+    if (!sdWriter.file.open(filename, O_WRONLY | O_CREAT | O_TRUNC)) {
+        sdWriter.release();
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M928: cannot create file"));
+        return false;
+    }
+
+    _active = true;
+    _compact = compact;
+    _lines = 0;
+    _bytes = 0;
+    PGM_P header = compact ? PSTR("; SimplePlotter capture (compact)\n") : PSTR("; SimplePlotter capture\n");
+    strcpy_P((char*)sdWriter.buf, header);
+    _fill = strlen_P(header);
+
+    char msg[48];
+    snprintf_P(msg, sizeof(msg), PSTR("M928: capturing to %s"), filename);
+    serialHandler.sendInfo(msg);
+    return true;
+}
+
+void SDCapture::stop() {
+    if (!_active) return;
+    if (_fill > 0) _write(_fill);
+    if (!_active) return; // The write failed and already closed the file
+    sdWriter.file.close();
+    sdWriter.release();
+    _active = false;
+
+    char msg[64];
+    snprintf_P(msg, sizeof(msg), PSTR("M29: capture closed, %lu lines, %lu bytes"), _lines, _bytes);
+    serialHandler.sendInfo(msg);
+}
+
+void SDCapture::record(const ParsedGCodeCommand& cmd) {
+    if (!_active) return;
+    if (sd_exec_state == SD_EXEC_RUNNING || sd_exec_state == SD_EXEC_PAUSED) return;
+
+    char line[GCODE_MAX_LENGTH];
+    if (!_format(cmd, line)) return;
+    uint16_t len = strlen(line);
+
+    // service() normally empties the buffer between blocks; if a long run of blocks left
+    // no gap, write now rather than drop the line
+    if (_fill + len > sizeof(sdWriter.buf)) {
+        _write(_fill);
+        if (!_active) return;
+    }
+    memcpy(sdWriter.buf + _fill, line, len);
+    _fill += len;
+    _lines++;
+}
+
+void SDCapture::service() {
+    if (!_active || _fill < SD_WRITE_CHUNK_BYTES) return;
+    if (stepperControl.isMoving()) return;
+    _write(SD_WRITE_CHUNK_BYTES);
+}
+
+// Writes the first count bytes of the buffer and moves the rest to the front. A failed
+// write ends the capture: a file with a hole in it must not be replayed.
+void SDCapture::_write(uint16_t count) {
+    if ((uint16_t)sdWriter.file.write(sdWriter.buf, count) != count) {
+        sdWriter.file.close();
+        sdWriter.release();
+        _active = false;
+        _fill = 0;
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M928: SD write failed, capture stopped"));
+        return;
+    }
+    _bytes += count;
+    _fill -= count;
+    memmove(sdWriter.buf, sdWriter.buf + count, _fill);
+}
+
+void SDCapture::_appendNum(char*& p, char address, float value) const {
+    if (!_compact) *p++ = ' ';
+    *p++ = address;
+    value = constrain(value, -99999.0f, 99999.0f); // Four of these still fit GCODE_MAX_LENGTH
+    dtostrf(value, 1, 3, p);
+    char* end = p + strlen(p);
+    if (_compact) {
+        // "12.500" -> "12.5", "3.000" -> "3"
+        while (end[-1] == '0') end--;
+        if (end[-1] == '.') end--;
+        *end = '\0';
+    }
+    p = end;
+}
+
+// One command as a G-code line with '\n'; false for commands that aren't recorded
+bool SDCapture::_format(const ParsedGCodeCommand& cmd, char* line) const {
+    char* p = line;
+    switch (cmd.type) {
+        case GCODE_G0:
+        case GCODE_G1:
+            *p++ = 'G';
+            *p++ = (cmd.type == GCODE_G0) ? '0' : '1';
+            if (cmd.move.has_x) _appendNum(p, 'X', cmd.move.x_val);
+            if (cmd.move.has_y) _appendNum(p, 'Y', cmd.move.y_val);
+            if (cmd.move.has_z) _appendNum(p, 'Z', cmd.move.z_val);
+            if (cmd.move.has_f) _appendNum(p, 'F', cmd.move.f_val);
+            break;
+        case GCODE_G28:
+            strcpy_P(p, PSTR("G28"));
+            p += 3;
+            if (!cmd.g28_args.home_all) {
+                if (cmd.g28_args.home_x) { if (!_compact) *p++ = ' '; *p++ = 'X'; }
+                if (cmd.g28_args.home_y) { if (!_compact) *p++ = ' '; *p++ = 'Y'; }
+                if (cmd.g28_args.home_z) { if (!_compact) *p++ = ' '; *p++ = 'Z'; }
+            }
+            break;
+        case GCODE_G29: strcpy_P(p, PSTR("G29")); p += 3; break;
+        case GCODE_G90: strcpy_P(p, PSTR("G90")); p += 3; break;
+        case GCODE_G91: strcpy_P(p, PSTR("G91")); p += 3; break;
+        case GCODE_G92:
+            strcpy_P(p, PSTR("G92"));
+            p += 3;
+            if (cmd.g92_args.has_x) _appendNum(p, 'X', cmd.g92_args.x_val);
+            if (cmd.g92_args.has_y) _appendNum(p, 'Y', cmd.g92_args.y_val);
+            if (cmd.g92_args.has_z) _appendNum(p, 'Z', cmd.g92_args.z_val);
+            break;
+        default:
+            return false;
+    }
+    *p++ = '\n';
+    *p = '\0';
+    return true;
+}
@@ -0,0 +1,50 @@
+// SimplePlotter_Firmware/src/io/sd_capture.h
+
+#ifndef SD_CAPTURE_H
+#define SD_CAPTURE_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include "../config.h"
+#include "../gcode/commands.h"
+
+// Records a serial-streamed job to an SD file (M928 starts, M29 stops), so the next run
+// can be started from the LCD file browser without a host.
+//  - The executor hands over each motion command it accepted (G0/G1/G28/G29/G90/G91/G92).
+//    It is written back as G-code from the parsed values: readable ("G1 X12.500 Y3.000"),
+//    or compact (S1: no spaces or trailing zeros, "G1X12.5Y3"), which the existing reader
+//    replays as-is.
+//  - Lines collect in the shared SDWriter buffer. Whole chunks only go to the card while
+//    no block is stepping, so a slow card write never stalls a move.
+class SDCapture {
+public:
+    SDCapture();
+
+    // Open (truncate) the capture file; sends its own errors
+    bool start(const char* filename, bool compact);
+    // Write the rest of the buffer and close the file
+    void stop();
+    bool isActive() const { return _active; }
+
+    // Executor: cmd was accepted. Anything other than a motion command is ignored, and
+    // so is everything while an SD job is running (it is on the card already).
+    void record(const ParsedGCodeCommand& cmd);
+
+    // Call from loop(): writes a full chunk when no move is stepping
+    void service();
+
+private:
+    bool _active;
+    bool _compact;
+    uint16_t _fill;
+    unsigned long _lines;
+    unsigned long _bytes;
+
+    bool _format(const ParsedGCodeCommand& cmd, char* line) const;
+    void _appendNum(char*& p, char address, float value) const;
+    void _write(uint16_t count);
+};
+
+extern SDCapture sdCapture; // Global instance
+
+#endif // SD_CAPTURE_H
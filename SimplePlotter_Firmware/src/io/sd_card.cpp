@@ -1,6 +1,8 @@
 #include "sd_card.h"
+#include "serial_handler.h"
 
 SDCardManager sdCard;
+SDWriter sdWriter;
 
 bool SDCardManager::init() {
     if (!isPresent()) {
@@ -29,11 +31,13 @@ int SDCardManager::listGCodeFiles(char fileList[][SD_MAX_FILENAME], int maxFiles
             char name[SD_MAX_FILENAME];
             entry.getName(name, SD_MAX_FILENAME);
 
-            // Check for .gcode or .gc extension
+            // Check for .gcode or .gc extension, a recorded step stream or compressed G-code
             char* dot = strrchr(name, '.');
-            if (dot && (strcasecmp(dot, ".gcode") == 0 ||
-                        strcasecmp(dot, ".gc") == 0 ||
-                        strcasecmp(dot, ".g") == 0)) {
+            if (dot && (strcasecmp_P(dot, PSTR(".gcode")) == 0 ||
+                        strcasecmp_P(dot, PSTR(".gc")) == 0 ||
+                        strcasecmp_P(dot, PSTR(".g")) == 0 ||
+                        strcasecmp_P(dot, PSTR(".stp")) == 0 ||
+                        (LZSS_ENABLED && strcasecmp_P(dot, PSTR(".gcz")) == 0))) {
                 strncpy(fileList[count], name, SD_MAX_FILENAME - 1);
                 fileList[count][SD_MAX_FILENAME - 1] = '\0';
                 count++;
@@ -56,21 +60,43 @@ bool SDCardManager::openFile(const char* filename) {
     _fileSize = _file.fileSize();
     _filePos = 0;
     _fileOpen = true;
+#if LZSS_ENABLED
+    const char* dot = strrchr(filename, '.');
+    _compressed = dot && strcasecmp_P(dot, PSTR(".gcz")) == 0;
+    if (_compressed) _lz.reset();
+#endif
     return true;
 }
 
+int SDCardManager::_readByte() {
+#if LZSS_ENABLED
+    if (_compressed) {
+        int c;
+        while ((c = _lz.next()) < 0) {
+            int in = _file.read();
+            if (in < 0) return -1; // Padding bits of the last byte are dropped
+            _filePos++;
+            _lz.feed((uint8_t)in);
+        }
+        return c;
+    }
+#endif
+    int c = _file.read();
+    if (c >= 0) _filePos++;
+    return c;
+}
+
 bool SDCardManager::readLine(char* buffer, int bufSize) {
     if (!_fileOpen) return false;
 
     int idx = 0;
     while (idx < bufSize - 1) {
-        int c = _file.read();
+        int c = _readByte();
         if (c < 0) {
             // EOF
             if (idx == 0) return false; // No data read
             break;
         }
-        _filePos++;
         if (c == '\n') break;
         if (c == '\r') continue; // Skip CR
         buffer[idx++] = (char)c;
@@ -79,8 +105,18 @@ bool SDCardManager::readLine(char* buffer, int bufSize) {
     return true;
 }
 
+int SDCardManager::read(void* buffer, uint16_t count) {
+    if (!_fileOpen) return -1;
+    int n = _file.read(buffer, count);
+    if (n > 0) _filePos += n;
+    return n;
+}
+
 void SDCardManager::closeFile() {
     if (_fileOpen) {
+#if LZSS_ENABLED
+        if (_compressed) _lz.release();
+#endif
         _file.close();
         _fileOpen = false;
         _fileSize = 0;
@@ -92,3 +128,14 @@ uint8_t SDCardManager::progressPercent() const {
     if (_fileSize == 0) return 0;
     return (uint8_t)((unsigned long long)_filePos * 100ULL / _fileSize);
 }
+
+bool SDWriter::claim(const __FlashStringHelper* user) {
+    if (_owner) {
+        char msg[48];
+        snprintf_P(msg, sizeof(msg), PSTR("%S: SD file in use by %S"), (PGM_P)user, (PGM_P)_owner);
+        serialHandler.sendError(ERR_OUT_OF_RANGE, msg);
+        return false;
+    }
+    _owner = user;
+    return true;
+}
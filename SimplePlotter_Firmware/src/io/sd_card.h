@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <SdFat.h>
 #include "../config.h"
+#include "../utils/lzss.h"
 
 #define SD_MAX_FILES 20
 #define SD_MAX_FILENAME 13 // 8.3 format + null
@@ -17,9 +18,10 @@ public:
     // File listing
     int listGCodeFiles(char fileList[][SD_MAX_FILENAME], int maxFiles);
 
-    // File execution
+    // File execution. Lines of a .gcz file are decompressed (LZSS) as they are read.
     bool openFile(const char* filename);
     bool readLine(char* buffer, int bufSize);
+    int read(void* buffer, uint16_t count); // Binary files (step streams); bytes read, -1 on error
     void closeFile();
     bool isFileOpen() const { return _fileOpen; }
 
@@ -34,9 +36,33 @@ private:
     bool _initialized = false;
     bool _fileOpen = false;
     unsigned long _fileSize = 0;
-    unsigned long _filePos = 0;
+    unsigned long _filePos = 0; // Bytes read from the card (compressed bytes for .gcz)
+#if LZSS_ENABLED
+    bool _compressed = false;
+    LzssDecoder _lz;
+#endif
+
+    int _readByte(); // Next text byte, -1 at the end of the file
 };
 
 extern SDCardManager sdCard;
 
+// The file and RAM buffer the SD writers take turns on: M928 capture, M930 step stream
+// recording and M936/M938 sessions. Each claims it when it opens its file and releases
+// it after closing, so only one of them runs at a time.
+class SDWriter {
+public:
+    // False (error sent, prefixed with user) while another writer holds it
+    bool claim(const __FlashStringHelper* user);
+    void release() { _owner = nullptr; }
+
+    SdFile file;
+    uint8_t buf[SD_WRITE_CHUNK_BYTES + GCODE_MAX_LENGTH]; // A chunk plus one line of overflow
+
+private:
+    const __FlashStringHelper* _owner = nullptr;
+};
+
+extern SDWriter sdWriter;
+
 #endif // SD_CARD_H
@@ -1,12 +1,23 @@
 // SimplePlotter_Firmware/src/io/serial_handler.cpp
 
 #include "serial_handler.h"
+#include <util/crc16.h>
+#include "../motion/stepper_control.h" // For the realtime jog cancel byte
+#include "../gcode/executor.h"         // M410 ahead of the command buffer
+#include "../motion/step_stream.h"     // Block frame records
+#include "../gcode/latency_trace.h"
+#include "../utils/event_trace.h"
+#include "serial_session.h"
 
 // Global instance
 SerialHandler serialHandler;
 
-SerialHandler::SerialHandler() : _line_idx(0) {
+SerialHandler::SerialHandler() : _line_idx(0), _line_rx_us(0), _frames_enabled(false), _in_frame(false), _frame_type(0),
+                                 _frame_idx(0), _frame_start_ms(0), _lz_pending(false), _lz_pos(0), _lz_held(0) {
     _serial_line[0] = '\0'; // Initialize buffer
+#if LZSS_ENABLED
+    _lz.reset(); // The window is the host's until a .gcz job takes it
+#endif
 }
 
 void SerialHandler::init() {
@@ -15,63 +26,238 @@ void SerialHandler::init() {
 }
 
 void SerialHandler::handleSerialInput() {
+    if (_in_frame && millis() - _frame_start_ms > HOST_FRAME_TIMEOUT_MS) {
+        _in_frame = false;
+        rejectFrame(ERR_TIMEOUT, F("Frame incomplete"));
+    }
+    decodeFrame();
+
     while (Serial.available()) {
+        // Behind a frame still being decoded, bytes wait in the receive buffer; realtime
+        // bytes at its head still act at once
+        if (!acceptsBytes() && Serial.peek() != JOG_CANCEL_CHAR && Serial.peek() != QUICKSTOP_CHAR) break;
         char inChar = Serial.read();
+        serialSession.rxByte((uint8_t)inChar);
+        receiveByte(inChar);
+    }
+}
 
-        // Check for line termination characters
-        if (inChar == '\n' || inChar == '\r') {
-            if (_line_idx > 0) { // Only process if there's actual content
-                _serial_line[_line_idx] = '\0'; // Null-terminate the string
-                processIncomingLine();
-            }
-            _line_idx = 0; // Reset for the next line
-            _serial_line[0] = '\0'; // Clear buffer
+void SerialHandler::receiveByte(char inChar) {
+    // Frame bytes are binary: no realtime bytes or line terminators inside a frame
+    if (_in_frame) {
+        receiveFrameByte((uint8_t)inChar);
+        return;
+    }
+    bool block_frame = _frames_enabled && _line_idx == 0 && (uint8_t)inChar == HOST_FRAME_START;
+    bool lz_frame = LZSS_ENABLED && (uint8_t)inChar == LZSS_FRAME_START; // May split a line
+    if (block_frame || lz_frame) {
+        _in_frame = true;
+        _frame_type = (uint8_t)inChar;
+        _frame_idx = 0;
+        _frame_start_ms = millis();
+        return;
+    }
+
+    processChar(inChar);
+}
+
+void SerialHandler::processChar(char inChar) {
+    // Realtime bytes are acted on immediately and never enter the line buffer
+    if ((uint8_t)inChar == JOG_CANCEL_CHAR) {
+        stepperControl.jogStop();
+        return;
+    }
+    if ((uint8_t)inChar == QUICKSTOP_CHAR) {
+        executor.quickstop();
+        return;
+    }
+
+    // Check for line termination characters
+    if (inChar == '\n' || inChar == '\r') {
+        if (_line_idx > 0) { // Only process if there's actual content
+            _serial_line[_line_idx] = '\0'; // Null-terminate the string
+            processIncomingLine();
+        }
+        _line_idx = 0; // Reset for the next line
+        _serial_line[0] = '\0'; // Clear buffer
+    } else {
+        // Store character if there's space
+        if (_line_idx < GCODE_MAX_LENGTH) {
+            // Latency counts from here, not from the terminator, so the loop passes spent
+            // while the rest of the line came in (or sat unread) are part of it
+            if (_line_idx == 0) _line_rx_us = micros();
+            _serial_line[_line_idx++] = inChar;
         } else {
-            // Store character if there's space
-            if (_line_idx < GCODE_MAX_LENGTH) {
-                _serial_line[_line_idx++] = inChar;
-            } else {
-                // Line overflow, discard current line and report error if needed
-                // For now, just reset and silently discard the overflowing part
-                sendError(ERR_BUFFER_OVERFLOW, "Incoming line too long");
-                _line_idx = 0;
-                _serial_line[0] = '\0';
-            }
+            // Line overflow, discard current line and report error if needed
+            // For now, just reset and silently discard the overflowing part
+            sendError(ERR_BUFFER_OVERFLOW, F("Incoming line too long"));
+            _line_idx = 0;
+            _serial_line[0] = '\0';
         }
     }
 }
 
 void SerialHandler::processIncomingLine() {
+    uint32_t t_rx = _line_rx_us;
+    TRACE_EVENT(EV_LINE_RX, _line_idx);
+    serialSession.onLine();
     if (DEBUG_SERIAL_COMMUNICATION) {
         Serial.print(F("// Received: "));
         Serial.println(_serial_line);
     }
 
     ParsedGCodeCommand cmd = gcodeParser.parse(_serial_line);
+    uint32_t t_parse = micros();
 
     if (cmd.type == GCODE_UNKNOWN) {
         serialHandler.sendError(ERR_UNKNOWN_COMMAND, _serial_line);
         serialHandler.sendOK(); // Send ok even for errors, allows PC to proceed
         return;
     }
+
+    // A quickstop line can't wait behind the moves it is meant to stop
+    if (cmd.type == GCODE_M410) {
+        executor.quickstop();
+        sendOK();
+        return;
+    }
     
     if (gcodeBuffer.isFull()) {
-        serialHandler.sendError(ERR_BUFFER_OVERFLOW, "Command buffer full");
+        serialHandler.sendError(ERR_BUFFER_OVERFLOW, F("Command buffer full"));
         serialHandler.sendOK(); // Send ok even for errors, allows PC to proceed
         return;
     }
 
+    latencyTrace.stamp(cmd, t_rx, t_parse);
     gcodeBuffer.push(cmd);
     // DO NOT send OK here. The main loop will pop the command, execute it,
     // and then send OK (or data + OK) once it's ready for the next command.
     // This implements the "blocking mode: Wait for ok before sending next command".
 }
 
+void SerialHandler::receiveFrameByte(uint8_t b) {
+    _frame[_frame_idx++] = b;
+    uint8_t len = _frame[0];
+    if (_frame_idx == 1) {
+        // Block frames carry one record; an empty compressed frame resets the window
+        bool valid = (_frame_type == HOST_FRAME_START) ? (len > 0 && len <= HOST_FRAME_RECORD_MAX)
+                                                      : (len <= LZSS_FRAME_MAX);
+        if (!valid) {
+            _in_frame = false;
+            rejectFrame(ERR_INVALID_SYNTAX, F("Bad frame length"));
+            return;
+        }
+    }
+    if (_frame_idx == len + 3) { // Length byte, payload, two CRC bytes
+        _in_frame = false;
+        processFrame();
+    }
+}
+
+// A lost block frame is answered like a bad line (error + ok) and resent by the host.
+// A lost compressed frame takes part of the text stream and the window state with it:
+// the decoder and the partial line start over, and the host resets its encoder and
+// resends from the first line not acknowledged.
+void SerialHandler::rejectFrame(ErrorCode code, const __FlashStringHelper* description) {
+    if (_frame_type == HOST_FRAME_START) {
+        sendError(code, description);
+        sendOK();
+        return;
+    }
+#if LZSS_ENABLED
+    if (_lz.hasWindow() || !LzssDecoder::windowInUse()) _lz.reset(); // Never from a running .gcz job
+    _line_idx = 0;
+    _serial_line[0] = '\0';
+    char msg[48];
+    snprintf_P(msg, sizeof(msg), PSTR("%S, LZSS window reset"), (PGM_P)description);
+    sendError(code, msg);
+#endif
+}
+
+// Decodes the pending compressed frame as far as gcodeBuffer has room: a line end is
+// held back while the buffer is full, so no decoded line is refused
+void SerialHandler::decodeFrame() {
+#if LZSS_ENABLED
+    while (_lz_pending) {
+        int c = _lz_held ? _lz_held : _lz.next();
+        if (c < 0) {
+            if (_lz_pos > _frame[0]) {
+                _lz.endFrame();
+                _lz_pending = false;
+                return;
+            }
+            _lz.feed(_frame[_lz_pos++]);
+            continue;
+        }
+        if ((c == '\n' || c == '\r') && _line_idx > 0 && gcodeBuffer.isFull()) {
+            _lz_held = (char)c;
+            return;
+        }
+        _lz_held = 0;
+        processChar((char)c);
+    }
+#endif
+}
+
+void SerialHandler::processFrame() {
+    uint32_t t_rx = micros();
+    uint8_t len = _frame[0];
+
+    // CRC-16 (as for the EEPROM settings) over the length byte and the payload
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i <= len; i++) crc = _crc16_update(crc, _frame[i]);
+    uint16_t sent = _frame[len + 1] | ((uint16_t)_frame[len + 2] << 8);
+    if (crc != sent) {
+        rejectFrame(ERR_INVALID_SYNTAX, F("Frame CRC mismatch"));
+        return;
+    }
+
+#if LZSS_ENABLED
+    if (_frame_type == LZSS_FRAME_START) {
+        // A .gcz job decodes with the shared window; once it ends, the host starts over
+        if (!_lz.hasWindow()) {
+            rejectFrame(ERR_OUT_OF_RANGE, LzssDecoder::windowInUse() ? F("SD job is using the LZSS window")
+                                                                     : F("SD job used the LZSS window"));
+            return;
+        }
+        if (len == 0) {
+            _lz.reset();
+            return;
+        }
+        _lz_pending = true;
+        _lz_pos = 1;
+        decodeFrame();
+        return;
+    }
+#endif
+
+    TRACE_EVENT(EV_LINE_RX, _frame_idx);
+    serialSession.onLine();
+    if (StepStream::recordSize(_frame[1]) != len) {
+        sendError(ERR_INVALID_SYNTAX, F("Block frame length does not match its record"));
+        sendOK();
+        return;
+    }
+    if (gcodeBuffer.isFull()) {
+        sendError(ERR_BUFFER_OVERFLOW, F("Command buffer full"));
+        sendOK();
+        return;
+    }
+
+    ParsedGCodeCommand cmd;
+    cmd.type = GCODE_HOST_BLOCK;
+    memcpy(cmd.host_block.record, _frame + 1, len);
+    latencyTrace.stamp(cmd, t_rx, micros());
+    gcodeBuffer.push(cmd);
+}
+
 void SerialHandler::sendOK() {
     Serial.println(F("ok"));
+    serialSession.onAck();
 }
 
 void SerialHandler::sendError(ErrorCode code, const char* description) {
+    serialSession.onError(code);
     Serial.print(F("error: "));
     Serial.print(code);
     if (description) {
@@ -81,11 +267,24 @@ void SerialHandler::sendError(ErrorCode code, const char* description) {
     Serial.println();
 }
 
+void SerialHandler::sendError(ErrorCode code, const __FlashStringHelper* description) {
+    serialSession.onError(code);
+    Serial.print(F("error: "));
+    Serial.print(code);
+    Serial.print(F(" - "));
+    Serial.println(description);
+}
+
 void SerialHandler::sendInfo(const char* message) {
     Serial.print(F("// "));
     Serial.println(message);
 }
 
+void SerialHandler::sendInfo(const __FlashStringHelper* message) {
+    Serial.print(F("// "));
+    Serial.println(message);
+}
+
 void SerialHandler::sendPosition(float x, float y, float z) {
     Serial.print(F("X:"));
     Serial.print(x, 2);
@@ -102,6 +301,15 @@ void SerialHandler::sendFirmwareInfo() {
     Serial.print(F(" PROTOCOL_VERSION:1.0 MACHINE_TYPE:PenPlotter BOARD_TYPE:"));
     Serial.print(F(BOARD_TYPE));
     Serial.println(F(" EXTRUDER_COUNT:0"));
+    // Optional protocol features, Marlin-style; the host only uses what is listed
+    Serial.println(F("Cap:HOST_BLOCKS:1"));
+    Serial.println(LZSS_ENABLED ? F("Cap:LZSS:1") : F("Cap:LZSS:0"));
+}
+
+void SerialHandler::sendReady() {
+    sendFirmwareInfo();
+    sendInfo(F("SimplePlotter Firmware starting..."));
+    Serial.println(F(READY_TOKEN));
 }
 
 void SerialHandler::sendEndstopStatus(bool x_min_triggered, bool y_min_triggered, bool z_min_triggered) {
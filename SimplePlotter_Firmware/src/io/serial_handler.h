@@ -8,6 +8,14 @@
 #include "../gcode/commands.h" // For ParsedGCodeCommand
 #include "../gcode/parser.h"   // For GCodeParser
 #include "../gcode/buffer.h"   // For GCodeBuffer
+#include "../utils/lzss.h"
+
+// Longest frame payload: a host block record, or compressed bytes
+#if LZSS_ENABLED && LZSS_FRAME_MAX > HOST_FRAME_RECORD_MAX
+#define SERIAL_FRAME_MAX LZSS_FRAME_MAX
+#else
+#define SERIAL_FRAME_MAX HOST_FRAME_RECORD_MAX
+#endif
 
 // Error Codes as defined in Work_Plan
 enum ErrorCode {
@@ -29,20 +37,52 @@ public:
 
     void init();
     void handleSerialInput(); // To be called in main loop()
+    void receiveByte(char inChar); // One byte as if read from the port (M938 replay)
+    // False while a compressed frame waits for room in gcodeBuffer: its payload is still
+    // in the frame buffer, so the next bytes have to wait
+    bool acceptsBytes() const { return !_lz_pending; }
 
-    // Send responses to the host
+    // Send responses to the host. Fixed texts go in with F(); the const char* forms
+    // are for messages formatted into a RAM buffer.
     void sendOK();
     void sendError(ErrorCode code, const char* description = nullptr);
+    void sendError(ErrorCode code, const __FlashStringHelper* description);
     void sendInfo(const char* message);
+    void sendInfo(const __FlashStringHelper* message);
     void sendPosition(float x, float y, float z);
     void sendFirmwareInfo();
+    void sendReady(); // Boot banner ending in READY_TOKEN: commands are accepted from now on
     void sendEndstopStatus(bool x_min_triggered, bool y_min_triggered, bool z_min_triggered);
 
+    // Host-planned block frames (M932). A frame may only start between lines; each one
+    // is acknowledged with ok like a line, after its block has been queued.
+    void setHostFrames(bool enabled) { _frames_enabled = enabled; _in_frame = false; }
+    bool hostFramesEnabled() const { return _frames_enabled; }
+
 private:
     char _serial_line[GCODE_MAX_LENGTH + 1]; // Buffer for incoming serial line
     byte _line_idx;                          // Current index in _serial_line
+    uint32_t _line_rx_us;                    // micros() when its first byte left the UART buffer
+
+    bool _frames_enabled;
+    bool _in_frame;
+    uint8_t _frame_type;          // HOST_FRAME_START or LZSS_FRAME_START
+    uint8_t _frame[1 + SERIAL_FRAME_MAX + 2]; // Length, payload, CRC-16
+    uint8_t _frame_idx;           // Bytes of _frame received so far
+    unsigned long _frame_start_ms;
+    bool _lz_pending;             // Checked compressed frame not fully decoded yet
+    uint8_t _lz_pos;              // Next payload byte to feed
+    char _lz_held;                // Line end waiting for room in gcodeBuffer, 0 = none
+#if LZSS_ENABLED
+    LzssDecoder _lz;              // Window carries over from frame to frame
+#endif
 
+    void processChar(char inChar); // Line assembly, for plain and decompressed bytes
     void processIncomingLine(); // Parses and queues a complete line
+    void receiveFrameByte(uint8_t b);
+    void processFrame();        // Checks and queues a complete frame / starts decoding it
+    void decodeFrame();
+    void rejectFrame(ErrorCode code, const __FlashStringHelper* description);
 };
 
 extern SerialHandler serialHandler; // Global instance
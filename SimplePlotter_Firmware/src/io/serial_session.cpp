@@ -0,0 +1,334 @@
+// SimplePlotter_Firmware/src/io/serial_session.cpp
+
+#include "serial_session.h"
+#include "sd_card.h"
+#include "serial_handler.h"
+#include "../motion/stepper_control.h"
+#include "../motion/motion_queue.h"
+#include "../gcode/buffer.h"
+#include "../gcode/executor.h"
+
+SerialSession serialSession; // Global instance definition
+
+static const char SESSION_MAGIC[4] = {'S', 'S', 'C', '1'};
+
+SerialSession::SerialSession() :
+    _capturing(false), _replaying(false), _fast(false), _skipAck(false),
+    _fill(0), _lastMs(0), _rxLen(0), _rxMs(0), _bytes(0), _acks(0),
+    _recType(0), _recLen(0), _due(0), _fedAll(false), _start(0), _acksNeeded(0),
+    _lines(0), _errors(0), _lineHead(0), _lineCount(0), _latencySumUs(0.0f), _latencyMaxUs(0),
+    _latencyCount(0), _moved(false), _starved(false), _starvedSince(0), _starvations(0), _starvedMs(0) {}
+
+//===========================================================================
+// Capture
+//===========================================================================
+
+bool SerialSession::startCapture(const char* filename) {
+    if (_replaying) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M936: replay running"));
+        return false;
+    }
+    if (_capturing) stopCapture();
+
+    if (!sdCard.isInitialized() && !sdCard.init()) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M936: no SD card"));
+        return false;
+    }
+    if (!sdWriter.claim(F("M936"))) return false;
+    if (!sdWriter.file.open(filename, O_WRONLY | O_CREAT | O_TRUNC)) {
+        sdWriter.release();
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M936: cannot create file"));
+        return false;
+    }
+
+    memcpy(sdWriter.buf, SESSION_MAGIC, sizeof(SESSION_MAGIC));
+    _fill = sizeof(SESSION_MAGIC);
+    _lastMs = millis();
+    _rxLen = 0;
+    _bytes = 0;
+    _acks = 0;
+    _skipAck = true;
+    _capturing = true;
+
+    char msg[48];
+    snprintf_P(msg, sizeof(msg), PSTR("M936: capturing session to %s"), filename);
+    serialHandler.sendInfo(msg);
+    return true;
+}
+
+void SerialSession::stopCapture() {
+    if (!_capturing) return;
+    _flushRx();
+    if (_capturing && _fill > 0) _write(_fill);
+    if (!_capturing) return; // The write failed and already closed the file
+    sdWriter.file.close();
+    sdWriter.release();
+    _capturing = false;
+
+    char msg[64];
+    snprintf_P(msg, sizeof(msg), PSTR("M937: session closed, %lu bytes received, %lu acks"), _bytes, _acks);
+    serialHandler.sendInfo(msg);
+}
+
+// The bytes go straight into the buffer behind an 'R' header, whose length grows with them
+void SerialSession::rxByte(uint8_t b) {
+    if (!_capturing) return;
+    if (_rxLen == 0) {
+        _rxMs = millis();
+        _record('R', 0);
+        if (!_capturing) return;
+    }
+    sdWriter.buf[_fill++] = b;
+    _rxLen++;
+    sdWriter.buf[_fill - _rxLen - 1] = _rxLen;
+    _bytes++;
+    if (_rxLen == SESSION_CHUNK_MAX) _flushRx();
+}
+
+// Bytes from one loop() pass (or one millisecond) become a single record
+void SerialSession::_flushRx() {
+    _rxLen = 0;
+}
+
+// 'R' opens a record of received bytes, with room for SESSION_CHUNK_MAX of them
+void SerialSession::_record(uint8_t type, uint8_t code) {
+    unsigned long now = (type == 'R') ? _rxMs : millis();
+    unsigned long dt = now - _lastMs;
+    _lastMs = now;
+    while (dt > 0xFFFF) { // A pause longer than the field: empty receive records
+        const uint8_t pause[4] = {'R', 0xFF, 0xFF, 0};
+        if (_fill + sizeof(pause) > sizeof(sdWriter.buf)) _write(_fill);
+        if (!_capturing) return;
+        memcpy(sdWriter.buf + _fill, pause, sizeof(pause));
+        _fill += sizeof(pause);
+        dt -= 0xFFFF;
+    }
+
+    uint16_t size = 3 + (type == 'K' ? 0 : 1);
+    // service() normally empties the buffer between blocks; if a long run of blocks left
+    // no gap, write now rather than lose bytes
+    uint16_t room = size + (type == 'R' ? SESSION_CHUNK_MAX : 0);
+    if (_fill + room > sizeof(sdWriter.buf)) _write(_fill);
+    if (!_capturing) return;
+    uint8_t* p = sdWriter.buf + _fill;
+    *p++ = type;
+    *p++ = dt & 0xFF;
+    *p++ = dt >> 8;
+    if (type != 'K') *p = code; // Length 0 for 'R' until the bytes arrive
+    _fill += size;
+}
+
+// A failed write ends the capture: a session with a hole in it can't be replayed
+void SerialSession::_write(uint16_t count) {
+    if (sdWriter.file.write(sdWriter.buf, count) != count) {
+        sdWriter.file.close();
+        sdWriter.release();
+        _capturing = false;
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M936: SD write failed, capture stopped"));
+        return;
+    }
+    _fill = 0;
+}
+
+//===========================================================================
+// Replay
+//===========================================================================
+
+bool SerialSession::startReplay(const char* filename, bool fast) {
+    if (_capturing) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M938: stop the capture first (M937)"));
+        return false;
+    }
+    if (_replaying) {
+        sdWriter.file.close();
+        sdWriter.release();
+        _replaying = false;
+    }
+
+    if (!sdCard.isInitialized() && !sdCard.init()) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M938: no SD card"));
+        return false;
+    }
+    if (!sdWriter.claim(F("M938"))) return false;
+    char magic[sizeof(SESSION_MAGIC)];
+    if (!sdWriter.file.open(filename, O_RDONLY)) {
+        sdWriter.release();
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M938: file not found"));
+        return false;
+    }
+    if (sdWriter.file.read(magic, sizeof(magic)) != (int)sizeof(magic) || memcmp(magic, SESSION_MAGIC, sizeof(magic)) != 0) {
+        sdWriter.file.close();
+        sdWriter.release();
+        serialHandler.sendError(ERR_INVALID_SYNTAX, F("M938: not a session capture"));
+        return false;
+    }
+
+    _fast = fast;
+    _skipAck = true;
+    _due = 0;
+    _acks = 0;
+    _acksNeeded = 0;
+    _lines = 0;
+    _errors = 0;
+    _lineHead = 0;
+    _lineCount = 0;
+    _latencySumUs = 0.0f;
+    _latencyMaxUs = 0;
+    _latencyCount = 0;
+    _moved = false;
+    _starved = false;
+    _starvations = 0;
+    _starvedMs = 0;
+    _replaying = true;
+    _fedAll = !_readRecord();
+    _start = millis();
+
+    char msg[64];
+    snprintf_P(msg, sizeof(msg), PSTR("M938: replaying %s %S"), filename,
+               fast ? PSTR("as fast as acks allow") : PSTR("at original pacing"));
+    serialHandler.sendInfo(msg);
+    return true;
+}
+
+// The next record's header into _recType/_recLen; service() reads an 'R' record's bytes
+bool SerialSession::_readRecord() {
+    uint8_t head[3];
+    int n = sdWriter.file.read(head, sizeof(head));
+    if (n == 0) return false; // End of the session
+    _recType = head[0];
+    _recLen = 0;
+    bool ok = n == (int)sizeof(head);
+    if (ok && _recType == 'R') {
+        ok = sdWriter.file.read(&_recLen, 1) == 1 && _recLen <= SESSION_CHUNK_MAX;
+    } else if (ok && _recType == 'E') {
+        ok = sdWriter.file.read() >= 0; // Replay only counts errors
+    } else if (ok) {
+        ok = _recType == 'K';
+    }
+    if (!ok) {
+        _damaged();
+        return false;
+    }
+    _due += head[1] | ((uint16_t)head[2] << 8);
+    return true;
+}
+
+void SerialSession::_damaged() {
+    serialHandler.sendError(ERR_INVALID_SYNTAX, F("M938: damaged record, rest of the session skipped"));
+}
+
+void SerialSession::_finishReplay() {
+    sdWriter.file.close();
+    sdWriter.release();
+    _replaying = false;
+
+    char msg[72], a[12], b[12];
+    dtostrf((millis() - _start) / 1000.0f, 1, 2, a);
+    snprintf_P(msg, sizeof(msg), PSTR("M938: done in %ss, %lu lines, %lu errors"), a, _lines, _errors);
+    serialHandler.sendInfo(msg);
+    dtostrf(_latencyCount ? _latencySumUs / 1000.0f / _latencyCount : 0.0f, 1, 1, a);
+    dtostrf(_latencyMaxUs / 1000.0f, 1, 1, b);
+    snprintf_P(msg, sizeof(msg), PSTR("M938: ack latency avg %sms max %sms"), a, b);
+    serialHandler.sendInfo(msg);
+    dtostrf(_starvedMs / 1000.0f, 1, 2, a);
+    snprintf_P(msg, sizeof(msg), PSTR("M938: waited for bytes %lu times, %ss in total"), _starvations, a);
+    serialHandler.sendInfo(msg);
+}
+
+//===========================================================================
+// SerialHandler hooks
+//===========================================================================
+
+void SerialSession::onLine() {
+    if (!_replaying) return;
+    _lines++;
+    if (_lineCount < SESSION_LATENCY_SLOTS) {
+        _lineUs[(_lineHead + _lineCount) % SESSION_LATENCY_SLOTS] = micros();
+        _lineCount++;
+    }
+}
+
+void SerialSession::onAck() {
+    if (_skipAck) {
+        _skipAck = false;
+        return;
+    }
+    if (_capturing) {
+        _flushRx();
+        _record('K', 0);
+        _acks++;
+    }
+    if (_replaying) {
+        _acks++;
+        if (_lineCount) {
+            uint32_t us = micros() - _lineUs[_lineHead];
+            _lineHead = (_lineHead + 1) % SESSION_LATENCY_SLOTS;
+            _lineCount--;
+            _latencySumUs += us;
+            if (us > _latencyMaxUs) _latencyMaxUs = us;
+            _latencyCount++;
+        }
+    }
+}
+
+void SerialSession::onError(uint8_t code) {
+    if (_capturing) {
+        _flushRx();
+        _record('E', code);
+    }
+    if (_replaying) _errors++;
+}
+
+//===========================================================================
+// Loop
+//===========================================================================
+
+void SerialSession::service() {
+    if (_capturing) {
+        if (_rxLen && millis() != _rxMs) _flushRx();
+        // Like SDCapture: card writes only while no block is stepping
+        if (_capturing && _rxLen == 0 && _fill >= SD_WRITE_CHUNK_BYTES / 2 && !stepperControl.isMoving()) _write(_fill);
+        return;
+    }
+    if (!_replaying) return;
+
+    // Starved: the firmware has nothing left to do and the session has more to send
+    bool waiting = motionQueue.isIdle() && gcodeBuffer.isEmpty() && executor.isIdle();
+    if (!motionQueue.isIdle()) _moved = true;
+    if (_starved && !waiting) {
+        _starved = false;
+        _starvedMs += millis() - _starvedSince;
+    } else if (!_starved && waiting && _moved && !_fedAll) {
+        _starved = true;
+        _starvedSince = millis();
+        _starvations++;
+    }
+
+    while (!_fedAll) {
+        if (!_fast && millis() - _start < _due) break;
+        if (_recType == 'R') {
+            if (_fast && _acks < _acksNeeded) break; // The host was still waiting for an ok here
+            // Byte by byte: a compressed frame in the record may have to be decoded first
+            int c = 0;
+            while (_recLen > 0 && serialHandler.acceptsBytes() && (c = sdWriter.file.read()) >= 0) {
+                serialHandler.receiveByte((uint8_t)c);
+                _recLen--;
+            }
+            if (c < 0) {
+                _damaged();
+                _fedAll = true;
+                break;
+            }
+            if (_recLen > 0) break;
+        } else if (_recType == 'K') {
+            _acksNeeded++;
+        }
+        _fedAll = !_readRecord();
+    }
+
+    if (_fedAll && motionQueue.isIdle() && gcodeBuffer.isEmpty() && executor.isIdle()) {
+        if (_starved) _starvedMs += millis() - _starvedSince;
+        _starved = false;
+        _finishReplay();
+    }
+}
@@ -0,0 +1,92 @@
+// SimplePlotter_Firmware/src/io/serial_session.h
+
+#ifndef SERIAL_SESSION_H
+#define SERIAL_SESSION_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include "../config.h"
+
+// Serial session capture (M936/M937) and replay (M938). A capture stores the raw bytes
+// the host sent, with their arrival times, plus each ok and error the firmware answered.
+// Replaying the file feeds the bytes back through SerialHandler, either at their original
+// pacing or as fast as the acks allow. Then it reports ack latency, motion queue
+// starvation and the total time. Replies are kept only as ok or error code: the text
+// the firmware sent (info lines, M114, reports) is not in the file, so a replay shows
+// the host's pacing and flow control again, not what the firmware answered.
+//
+// File layout (little-endian): "SSC1", then records of
+//   uint8 type, uint16 ms since the previous record, and per type:
+//   'R' uint8 len, len received bytes (len 0 only stretches a long pause)
+//   'K' -            ok sent
+//   'E' uint8 code   error sent
+class SerialSession {
+public:
+    SerialSession();
+
+    // M936/M937; both send their own errors and summaries
+    bool startCapture(const char* filename);
+    void stopCapture();
+    bool isCapturing() const { return _capturing; }
+
+    // M938. fast: feed the next bytes as soon as the acks the host had seen at that
+    // point have been sent again, instead of at their recorded time.
+    bool startReplay(const char* filename, bool fast);
+    bool isReplaying() const { return _replaying; }
+
+    // SerialHandler
+    void rxByte(uint8_t b); // Byte read from the serial port
+    void onLine();          // Line or block frame complete
+    void onAck();
+    void onError(uint8_t code);
+
+    // Call from loop(): writes captured records between blocks, feeds the replay
+    void service();
+
+private:
+    bool _capturing;
+    bool _replaying;
+    bool _fast;
+    bool _skipAck;    // The ok of M936/M938 itself belongs to neither session
+
+    // Capture: records collect in the shared SDWriter buffer
+    uint16_t _fill;
+    unsigned long _lastMs;   // Time of the previous record
+    uint8_t _rxLen;          // Bytes in the open 'R' record at the end of the buffer
+    unsigned long _rxMs;
+    unsigned long _bytes;
+    unsigned long _acks;
+
+    // Replay: the next record (an 'R' record's bytes are read as they are fed), and the
+    // measurements
+    uint8_t _recType;
+    uint8_t _recLen;         // 'R': bytes not fed yet
+    unsigned long _due;      // ms after the start
+    bool _fedAll;
+    unsigned long _start;
+    unsigned long _acksNeeded; // Acks the host had seen before the next bytes
+    unsigned long _lines;
+    unsigned long _errors;
+    uint32_t _lineUs[SESSION_LATENCY_SLOTS]; // Lines awaiting their ok, oldest first
+    uint8_t _lineHead;
+    uint8_t _lineCount;
+    float _latencySumUs;
+    uint32_t _latencyMaxUs;
+    unsigned long _latencyCount;
+    bool _moved;             // Starvation only counts once motion has begun
+    bool _starved;
+    unsigned long _starvedSince;
+    unsigned long _starvations;
+    unsigned long _starvedMs;
+
+    void _record(uint8_t type, uint8_t code);
+    void _flushRx();
+    void _write(uint16_t count);
+    bool _readRecord();
+    void _damaged();
+    void _finishReplay();
+};
+
+extern SerialSession serialSession; // Global instance
+
+#endif // SERIAL_SESSION_H
@@ -0,0 +1,113 @@
+// SimplePlotter_Firmware/src/io/settings.cpp
+
+#include "settings.h"
+#include <EEPROM.h>
+#include <util/crc16.h>
+#include "serial_handler.h"
+
+Settings settings; // Global instance definition
+
+#define SETTINGS_MAGIC 0x5350 // "SP"
+
+// EEPROM layout at SETTINGS_EEPROM_ADDR: header, PersistentSettings, CRC16 of both
+struct SettingsHeader {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t size; // sizeof(PersistentSettings), catches layout changes without a version bump
+};
+
+static_assert(sizeof(PersistentSettings) < 256, "PersistentSettings too large for the header size field");
+static_assert(SETTINGS_EEPROM_ADDR + sizeof(SettingsHeader) + sizeof(PersistentSettings) + 2 <= 4096,
+              "Settings do not fit the ATmega2560 EEPROM");
+static_assert(SETTINGS_EEPROM_ADDR + sizeof(SettingsHeader) + sizeof(PersistentSettings) + 2 <= POSITION_TRUST_EEPROM_ADDR,
+              "Settings overlap the trusted position record");
+
+static uint16_t crcOf(const SettingsHeader& header, const PersistentSettings& data) {
+    uint16_t crc = 0xFFFF;
+    const uint8_t* p = (const uint8_t*)&header;
+    for (uint8_t i = 0; i < sizeof(header); i++) crc = _crc16_update(crc, p[i]);
+    p = (const uint8_t*)&data;
+    for (uint16_t i = 0; i < sizeof(data); i++) crc = _crc16_update(crc, p[i]);
+    return crc;
+}
+
+Settings::Settings() {
+    reset();
+}
+
+void Settings::reset() {
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        _data.homing[i].backoff_mm = HOMING_BACKOFF_MM;
+        _data.homing[i].slow_feedrate = HOMING_FEEDRATE_SLOW;
+        _data.homing[i].settle_ms = HOMING_SETTLE_MS;
+        _data.homing[i].spread_um = 0;
+        _data.limits[i].max_accel = axisConfig[i].max_accel;
+        _data.limits[i].max_velocity = axisConfig[i].max_velocity;
+    }
+    _data.trusted_resume = 0; // Opt-in
+}
+
+bool Settings::load() {
+    SettingsHeader header;
+    PersistentSettings data;
+    uint16_t stored_crc;
+    int addr = SETTINGS_EEPROM_ADDR;
+    EEPROM.get(addr, header);
+    addr += sizeof(header);
+    if (header.magic != SETTINGS_MAGIC || header.version != SETTINGS_VERSION ||
+        header.size != sizeof(PersistentSettings)) {
+        return false;
+    }
+    EEPROM.get(addr, data);
+    addr += sizeof(data);
+    EEPROM.get(addr, stored_crc);
+    if (stored_crc != crcOf(header, data)) return false;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        // Never accept a limit the step loop cannot deliver, whatever was saved
+        const AxisLimits& l = data.limits[i];
+        if (!(l.max_accel > 0.0f && l.max_velocity > 0.0f &&
+              l.max_velocity * axisConfig[i].steps_per_mm <= (float)MAX_STEP_RATE_HZ)) return false;
+    }
+
+    _data = data;
+    return true;
+}
+
+void Settings::save() {
+    SettingsHeader header = { SETTINGS_MAGIC, SETTINGS_VERSION, (uint8_t)sizeof(PersistentSettings) };
+    int addr = SETTINGS_EEPROM_ADDR;
+    // EEPROM.put() only writes bytes that differ, so saving unchanged settings costs no wear
+    EEPROM.put(addr, header);
+    addr += sizeof(header);
+    EEPROM.put(addr, _data);
+    addr += sizeof(_data);
+    EEPROM.put(addr, crcOf(header, _data));
+}
+
+void Settings::report() {
+    char buf[72];
+    char backoff[8], feed[8];
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        const HomingTuning& t = _data.homing[i];
+        dtostrf(t.backoff_mm, 1, 2, backoff);
+        dtostrf(t.slow_feedrate, 1, 2, feed);
+        if (t.spread_um) {
+            snprintf_P(buf, sizeof(buf), PSTR("Homing %c: backoff %smm slow %smm/s settle %ums spread %uum"),
+                       axisName(i), backoff, feed, t.settle_ms, t.spread_um);
+        } else {
+            snprintf_P(buf, sizeof(buf), PSTR("Homing %c: backoff %smm slow %smm/s settle %ums (defaults)"),
+                       axisName(i), backoff, feed, t.settle_ms);
+        }
+        serialHandler.sendInfo(buf);
+    }
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        const AxisLimits& l = _data.limits[i];
+        dtostrf(l.max_accel, 1, 0, backoff);
+        dtostrf(l.max_velocity, 1, 1, feed);
+        bool profile = l.max_accel == axisConfig[i].max_accel && l.max_velocity == axisConfig[i].max_velocity;
+        snprintf_P(buf, sizeof(buf), PSTR("Limits %c: accel %smm/s^2 velocity %smm/s%S"),
+                   axisName(i), backoff, feed, profile ? PSTR(" (profile)") : PSTR(""));
+        serialHandler.sendInfo(buf);
+    }
+    serialHandler.sendInfo(_data.trusted_resume ? F("Trusted resume: on") : F("Trusted resume: off"));
+}
@@ -0,0 +1,50 @@
+// SimplePlotter_Firmware/src/io/settings.h
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <Arduino.h>
+#include "../config.h"
+#include "../motion/axis.h"
+
+// Per-axis homing parameters, measured by M171 (Homing::calibrateAxis)
+struct HomingTuning {
+    float backoff_mm;    // Retract after the fast touch: switch release distance plus run-up
+    float slow_feedrate; // mm/s for the precision touch
+    uint16_t settle_ms;  // Wait after a stop before the switch reads reliably
+    uint16_t spread_um;  // Trigger spread measured at slow_feedrate (0 = not calibrated)
+};
+
+// Per-axis motion limits: the machine profile's until M172 (MotionTuner) measures them
+struct AxisLimits {
+    float max_accel;    // mm/s^2
+    float max_velocity; // mm/s
+};
+
+// Settings kept in EEPROM (M500/M501/M502). Bump SETTINGS_VERSION when this layout
+// changes; an old, blank or corrupt block falls back to the config.h defaults.
+struct PersistentSettings {
+    HomingTuning homing[AXIS_COUNT];
+    AxisLimits limits[AXIS_COUNT];
+    uint8_t trusted_resume; // M933: restore the saved position at boot (PositionTrust)
+};
+
+class Settings {
+public:
+    Settings();
+
+    bool load();   // Boot and M501; false (defaults kept) if EEPROM holds no valid block
+    void save();   // M500
+    void reset();  // M502: config.h defaults in RAM, EEPROM unchanged until M500
+    void report(); // Settings section of M503
+
+    PersistentSettings& data() { return _data; }
+    const PersistentSettings& data() const { return _data; }
+
+private:
+    PersistentSettings _data;
+};
+
+extern Settings settings; // Global instance
+
+#endif // SETTINGS_H
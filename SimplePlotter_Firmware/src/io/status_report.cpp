@@ -0,0 +1,107 @@
+// SimplePlotter_Firmware/src/io/status_report.cpp
+
+#include "status_report.h"
+#include "endstops.h"
+#include "sd_card.h"
+#include "job_eta.h"
+#include "../gcode/buffer.h"
+#include "../gcode/executor.h"
+#include "../motion/motion_queue.h"
+#include "../motion/stepper_control.h"
+#include "../ui/screens.h" // For sd_exec_state
+
+// Sized for the widest value of every field, so nothing is ever cut:
+//   "<Idle" 5, " X:"/" Y:"/" Z:" 3 + 14 each ("-2147483648.00", any step count at >= 1
+//   step/mm), " Q:"/" B:" 3 + 6 each (an int), " SD:" 4 + 3, " T:" 3 + 10 (positive long),
+//   " E:XYZ" 6, ">" and the terminator 2.
+// Lines with in-range positions fit the 63-byte TX buffer with CRLF; longer ones wait
+// well under a millisecond for the rest.
+#define STATUS_LINE_MAX (5 + 3 * (3 + 14) + 2 * (3 + 6) + (4 + 3) + (3 + 10) + 6 + 2)
+
+// Global instance
+StatusReporter statusReporter;
+
+StatusReporter::StatusReporter() : _interval_ms(0), _last_report_ms(0), _pending(false) {}
+
+void StatusReporter::setInterval(unsigned long interval_ms) {
+    _interval_ms = interval_ms;
+    _last_report_ms = millis();
+}
+
+static char* appendStr(char* p, PGM_P s) {
+    char c;
+    while ((c = pgm_read_byte(s++))) *p++ = c;
+    return p;
+}
+
+static char* appendFloat(char* p, float val) {
+    dtostrf(val, 1, 2, p);
+    return p + strlen(p);
+}
+
+static char* appendInt(char* p, int val) {
+    itoa(val, p, 10);
+    return p + strlen(p);
+}
+
+void StatusReporter::_formatLine(char* buf) const {
+    PGM_P state;
+    if (stepperControl.isJogging()) {
+        state = PSTR("<Jog");
+    } else if (sd_exec_state == SD_EXEC_PAUSED) {
+        state = PSTR("<Hold");
+    } else if (!motionQueue.isIdle() || !executor.isIdle() || !gcodeBuffer.isEmpty() ||
+               sd_exec_state == SD_EXEC_RUNNING) {
+        state = PSTR("<Run");
+    } else {
+        state = PSTR("<Idle");
+    }
+
+    char* p = appendStr(buf, state);
+    p = appendStr(p, PSTR(" X:"));
+    p = appendFloat(p, stepperControl.getCurrentXSteps() / X_STEPS_PER_MM);
+    p = appendStr(p, PSTR(" Y:"));
+    p = appendFloat(p, stepperControl.getCurrentYSteps() / Y_STEPS_PER_MM);
+    p = appendStr(p, PSTR(" Z:"));
+    p = appendFloat(p, stepperControl.getCurrentZSteps() / Z_STEPS_PER_MM);
+    p = appendStr(p, PSTR(" Q:"));
+    p = appendInt(p, motionQueue.size());
+    p = appendStr(p, PSTR(" B:"));
+    p = appendInt(p, gcodeBuffer.size());
+    if (sd_exec_state == SD_EXEC_RUNNING || sd_exec_state == SD_EXEC_PAUSED) {
+        p = appendStr(p, PSTR(" SD:"));
+        p = appendInt(p, sdCard.progressPercent());
+    }
+    long eta_s = jobEta.remainingSeconds();
+    if (eta_s >= 0) {
+        p = appendStr(p, PSTR(" T:"));
+        ltoa(eta_s, p, 10);
+        p += strlen(p);
+    }
+    p = appendStr(p, PSTR(" E:"));
+    char* endstops_start = p;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (endstops.getRawState((AxisIndex)i)) *p++ = axisName(i);
+    }
+    if (p == endstops_start) *p++ = '-';
+    *p++ = '>';
+    *p = '\0';
+}
+
+void StatusReporter::service() {
+    unsigned long now = millis();
+    if (_interval_ms > 0 && now - _last_report_ms >= _interval_ms) {
+        _pending = true;
+    }
+    if (!_pending) return;
+
+    // Low priority: only write into an empty TX buffer. The line always fits then,
+    // so Serial never blocks, and replies already queued go out first.
+    if (Serial.availableForWrite() < SERIAL_TX_BUFFER_SIZE - 1) return;
+
+    char line[STATUS_LINE_MAX];
+    _formatLine(line);
+    Serial.println(line);
+    _pending = false;
+    _last_report_ms = now;
+}
@@ -0,0 +1,39 @@
+// SimplePlotter_Firmware/src/io/status_report.h
+
+#ifndef STATUS_REPORT_H
+#define STATUS_REPORT_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+// Periodic status line enabled with M154 S<ms>, so the host doesn't have to poll
+// M114/M119 through the command buffer:
+//   <Run X:12.34 Y:5.60 Z:2.00 Q:3 B:1 SD:45 T:1234 E:Z>
+// State is Idle, Run, Jog or Hold (SD paused). Position comes from the step
+// counters (where the pen is, not where the planner ends up). Q = queued motion
+// blocks, B = buffered commands, SD = file progress in % (only while a file is
+// open), T = job time left in seconds (see job_eta.h; only once it is known),
+// E = triggered endstops ("-" if none).
+class StatusReporter {
+public:
+    StatusReporter();
+
+    void setInterval(unsigned long interval_ms); // 0 = off
+    unsigned long getInterval() const { return _interval_ms; }
+    void requestReport() { _pending = true; } // One report at the next opportunity
+
+    // Call from loop(). A due report waits until the serial TX buffer is empty, so it
+    // never blocks the loop and never gets ahead of an "ok" already queued.
+    void service();
+
+private:
+    unsigned long _interval_ms;
+    unsigned long _last_report_ms;
+    bool _pending;
+
+    void _formatLine(char* buf) const;
+};
+
+extern StatusReporter statusReporter; // Global instance
+
+#endif // STATUS_REPORT_H
@@ -0,0 +1,76 @@
+// SimplePlotter_Firmware/src/machine_config.h
+
+#ifndef MACHINE_CONFIG_H
+#define MACHINE_CONFIG_H
+
+// Typed machine description. Included from config.h, which selects the profile with
+// MACHINE_PROFILE and keeps the familiar X_STEPS_PER_MM / MAX_ACCEL_X / ... names as
+// aliases of these constants. Everything here is constexpr, so derived values
+// (steps/s, steps/s^2, ticks per step) fold to immediates wherever they are used.
+
+struct AxisMechanics {
+    float steps_per_mm;
+    float max_pos;      // Travel from the home side (mm)
+    float max_accel;    // mm/s^2
+    float max_velocity; // mm/s
+};
+
+struct MachineProfile {
+    const char* name;
+    AxisMechanics x;
+    AxisMechanics y;
+    AxisMechanics z;
+};
+
+// Original build: measured on the physical plotter.
+// X/Y: DRV8825 drivers at 1/32 microstepping, GT2 belt, 20-tooth pulley:
+//   200 full steps * 32 = 6400 steps/rev, 20 teeth * 2mm = 40mm/rev -> 160 steps/mm
+//   Verified: 50mm command moved 24.5mm at 80 steps/mm -> 4000/24.5 ~ 163 ~ 160
+// Z: T8 leadscrew (8mm pitch) at 1/16 microstepping: 3200 steps/rev / 8mm -> 400 steps/mm
+// Travel: X home (right) to far wall (left) 234mm, Y home (front) to far wall (back)
+// 191mm, Z 203mm (only 0-5mm used for the pen).
+constexpr MachineProfile PROFILE_PLOTTER_V1 = {
+    "plotter_v1",
+    { 160.0f, 234.0f, 1000.0f, 100.0f }, // X: accel configurable 500-2000, 6000 mm/min rapids
+    { 160.0f, 191.0f, 1000.0f, 100.0f }, // Y
+    { 400.0f, 203.0f,  500.0f,  10.0f }  // Z: pen lift - gentle, 600 mm/min
+};
+
+// Same machine with a DRV8825 at 1/32 on Z (6400 steps/rev / 8mm -> 800 steps/mm)
+constexpr MachineProfile PROFILE_PLOTTER_V1_Z32 = {
+    "plotter_v1_z32",
+    { 160.0f, 234.0f, 1000.0f, 100.0f },
+    { 160.0f, 191.0f, 1000.0f, 100.0f },
+    { 800.0f, 203.0f,  500.0f,  10.0f }
+};
+
+#if MACHINE_PROFILE == MACHINE_PROFILE_PLOTTER_V1
+constexpr MachineProfile MACHINE = PROFILE_PLOTTER_V1;
+#elif MACHINE_PROFILE == MACHINE_PROFILE_PLOTTER_V1_Z32
+constexpr MachineProfile MACHINE = PROFILE_PLOTTER_V1_Z32;
+#else
+#error "Unknown MACHINE_PROFILE"
+#endif
+
+// Sanity checks on the selected profile
+constexpr bool machineAxisValid(const AxisMechanics& a) {
+    return a.steps_per_mm > 0.0f && a.max_pos > 0.0f && a.max_accel > 0.0f && a.max_velocity > 0.0f;
+}
+constexpr bool machineAxisStepRateOk(const AxisMechanics& a) {
+    return a.max_velocity * a.steps_per_mm <= (float)MAX_STEP_RATE_HZ;
+}
+constexpr bool machineAxisTravelFits(const AxisMechanics& a) {
+    return a.max_pos * a.steps_per_mm * 2.0f < 2147483647.0f; // Homing searches up to twice the travel
+}
+static_assert(machineAxisValid(MACHINE.x) && machineAxisValid(MACHINE.y) && machineAxisValid(MACHINE.z),
+              "Machine profile: steps/mm, travel, acceleration and velocity must be positive");
+static_assert(machineAxisStepRateOk(MACHINE.x) && machineAxisStepRateOk(MACHINE.y) && machineAxisStepRateOk(MACHINE.z),
+              "Machine profile: max velocity exceeds MAX_STEP_RATE_HZ on some axis");
+static_assert(machineAxisTravelFits(MACHINE.x) && machineAxisTravelFits(MACHINE.y) && machineAxisTravelFits(MACHINE.z),
+              "Machine profile: travel in steps overflows the step counters");
+
+// X and Y share the rapid/draw ceilings
+constexpr float MACHINE_MAX_VELOCITY_XY =
+    (MACHINE.x.max_velocity < MACHINE.y.max_velocity) ? MACHINE.x.max_velocity : MACHINE.y.max_velocity;
+
+#endif // MACHINE_CONFIG_H
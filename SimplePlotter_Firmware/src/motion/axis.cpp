@@ -0,0 +1,24 @@
+// SimplePlotter_Firmware/src/motion/axis.cpp
+
+#include "axis.h"
+
+template<uint8_t A> static constexpr AxisConfig axisConfigFor() {
+    return AxisConfig{ AxisTraits<A>::STEPS_PER_MM, AxisTraits<A>::MAX_ACCEL, AxisTraits<A>::MAX_VELOCITY,
+                       AxisTraits<A>::MAX_POS, AxisTraits<A>::MAX_SPEED_STEPS, AxisTraits<A>::MAX_ACCEL_STEPS,
+                       AxisTraits<A>::HOMING_ACCEL_STEPS, AxisTraits<A>::HOME_DIR, AxisTraits<A>::NAME };
+}
+
+const AxisConfig axisConfig[AXIS_COUNT] = {
+    axisConfigFor<AXIS_X>(),
+    axisConfigFor<AXIS_Y>(),
+    axisConfigFor<AXIS_Z>()
+};
+
+static_assert(AxisTraits<AXIS_X>::NAME + 1 == AxisTraits<AXIS_Y>::NAME &&
+              AxisTraits<AXIS_Y>::NAME + 1 == AxisTraits<AXIS_Z>::NAME, "axisName() assumes X, Y, Z order");
+static_assert(AxisTraits<AXIS_X>::HOME_DIR * AxisTraits<AXIS_X>::HOME_DIR == 1 &&
+              AxisTraits<AXIS_Y>::HOME_DIR * AxisTraits<AXIS_Y>::HOME_DIR == 1 &&
+              AxisTraits<AXIS_Z>::HOME_DIR * AxisTraits<AXIS_Z>::HOME_DIR == 1, "HOME_DIR_* must be 1 or -1");
+static_assert(AxisTraits<AXIS_X>::TICKS_PER_STEP >= F_CPU / MAX_STEP_RATE_HZ &&
+              AxisTraits<AXIS_Y>::TICKS_PER_STEP >= F_CPU / MAX_STEP_RATE_HZ &&
+              AxisTraits<AXIS_Z>::TICKS_PER_STEP >= F_CPU / MAX_STEP_RATE_HZ, "Axis step period below the step loop's budget");
@@ -0,0 +1,104 @@
+// SimplePlotter_Firmware/src/motion/axis.h
+
+#ifndef AXIS_H
+#define AXIS_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+// Axis indices shared by stepper control, homing and endstops. Per-axis state lives
+// in arrays indexed by these; hot paths loop over the index instead of comparing
+// axis letters. The char-based public APIs convert once with axisIndex().
+enum AxisIndex : uint8_t {
+    AXIS_X = 0,
+    AXIS_Y,
+    AXIS_Z,
+    AXIS_COUNT
+};
+
+// Compile-time per-axis configuration, gathered from config.h and the machine profile.
+// Use AxisTraits<A>, which adds the derived constants below.
+template<uint8_t A> struct AxisSpec;
+
+template<> struct AxisSpec<AXIS_X> {
+    static constexpr char NAME = 'X';
+    static constexpr uint8_t STEP_PIN = X_STEP_PIN;
+    static constexpr uint8_t DIR_PIN = X_DIR_PIN;
+    static constexpr uint8_t ENABLE_PIN = X_ENABLE_PIN;
+    static constexpr uint8_t MIN_PIN = X_MIN_PIN;
+    static constexpr bool INVERT_DIR = INVERT_X_DIR;
+    static constexpr bool ENDSTOP_INVERTING = ENDSTOP_X_MIN_INVERTING;
+    static constexpr bool ENDSTOP_PULLUP = ENDSTOP_X_MIN_PULLUP;
+    static constexpr int8_t HOME_DIR = HOME_DIR_X;
+    static constexpr float STEPS_PER_MM = X_STEPS_PER_MM;
+    static constexpr float MAX_ACCEL = MAX_ACCEL_X;     // mm/s^2
+    static constexpr float MAX_VELOCITY = MAX_VELOCITY_X; // mm/s
+    static constexpr float MAX_POS = X_MAX_POS;         // mm
+};
+
+template<> struct AxisSpec<AXIS_Y> {
+    static constexpr char NAME = 'Y';
+    static constexpr uint8_t STEP_PIN = Y_STEP_PIN;
+    static constexpr uint8_t DIR_PIN = Y_DIR_PIN;
+    static constexpr uint8_t ENABLE_PIN = Y_ENABLE_PIN;
+    static constexpr uint8_t MIN_PIN = Y_MIN_PIN;
+    static constexpr bool INVERT_DIR = INVERT_Y_DIR;
+    static constexpr bool ENDSTOP_INVERTING = ENDSTOP_Y_MIN_INVERTING;
+    static constexpr bool ENDSTOP_PULLUP = ENDSTOP_Y_MIN_PULLUP;
+    static constexpr int8_t HOME_DIR = HOME_DIR_Y;
+    static constexpr float STEPS_PER_MM = Y_STEPS_PER_MM;
+    static constexpr float MAX_ACCEL = MAX_ACCEL_Y;
+    static constexpr float MAX_VELOCITY = MAX_VELOCITY_Y;
+    static constexpr float MAX_POS = Y_MAX_POS;
+};
+
+template<> struct AxisSpec<AXIS_Z> {
+    static constexpr char NAME = 'Z';
+    static constexpr uint8_t STEP_PIN = Z_STEP_PIN;
+    static constexpr uint8_t DIR_PIN = Z_DIR_PIN;
+    static constexpr uint8_t ENABLE_PIN = Z_ENABLE_PIN;
+    static constexpr uint8_t MIN_PIN = Z_MIN_PIN;
+    static constexpr bool INVERT_DIR = INVERT_Z_DIR;
+    static constexpr bool ENDSTOP_INVERTING = ENDSTOP_Z_MIN_INVERTING;
+    static constexpr bool ENDSTOP_PULLUP = ENDSTOP_Z_MIN_PULLUP;
+    static constexpr int8_t HOME_DIR = HOME_DIR_Z;
+    static constexpr float STEPS_PER_MM = Z_STEPS_PER_MM;
+    static constexpr float MAX_ACCEL = MAX_ACCEL_Z;
+    static constexpr float MAX_VELOCITY = MAX_VELOCITY_Z;
+    static constexpr float MAX_POS = Z_MAX_POS;
+};
+
+// Derived per-axis constants; every one folds to an immediate
+template<uint8_t A> struct AxisTraits : AxisSpec<A> {
+    static constexpr float MAX_SPEED_STEPS = AxisSpec<A>::MAX_VELOCITY * AxisSpec<A>::STEPS_PER_MM; // steps/s
+    static constexpr float MAX_ACCEL_STEPS = AxisSpec<A>::MAX_ACCEL * AxisSpec<A>::STEPS_PER_MM;    // steps/s^2
+    static constexpr float HOMING_ACCEL_STEPS = MAX_ACCEL_STEPS * (float)HOMING_ACCEL_FACTOR;       // steps/s^2
+    static constexpr uint32_t TICKS_PER_STEP = (uint32_t)((float)F_CPU / MAX_SPEED_STEPS);        // CPU cycles per step at max speed
+};
+
+// The same values as a table, for code that holds the axis as a runtime index
+struct AxisConfig {
+    float steps_per_mm;
+    float max_accel;    // mm/s^2
+    float max_velocity; // mm/s
+    float max_pos;      // mm
+    float max_speed_steps;    // steps/s
+    float max_accel_steps;    // steps/s^2
+    float homing_accel_steps; // steps/s^2
+    int8_t home_dir;
+    char name;
+};
+
+extern const AxisConfig axisConfig[AXIS_COUNT]; // Built from AxisTraits in axis.cpp
+
+// 'X'/'Y'/'Z' (either case) -> AXIS_X..AXIS_Z; AXIS_COUNT for anything else
+inline AxisIndex axisIndex(char axis) {
+    uint8_t idx = (uint8_t)((axis & ~0x20) - 'X');
+    return idx < AXIS_COUNT ? (AxisIndex)idx : AXIS_COUNT;
+}
+
+inline char axisName(uint8_t idx) { return (char)('X' + idx); }
+
+inline long axisMmToSteps(uint8_t idx, float mm) { return (long)(mm * axisConfig[idx].steps_per_mm); }
+
+#endif // AXIS_H
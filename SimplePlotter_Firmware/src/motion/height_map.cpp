@@ -0,0 +1,198 @@
+// SimplePlotter_Firmware/src/motion/height_map.cpp
+
+#include "height_map.h"
+#include <avr/wdt.h> // For watchdog reset during probing
+#include "stepper_control.h"
+#include "kinematics.h"
+#include "homing.h"
+#include "../io/endstops.h"
+#include "../io/serial_handler.h"
+
+HeightMap heightMap; // Global instance definition
+
+HeightMap::HeightMap() : _valid(false), _enabled(false), _cell_ix(-1), _cell_iy(-1) {
+    for (int iy = 0; iy < HEIGHTMAP_GRID_Y; iy++) {
+        for (int ix = 0; ix < HEIGHTMAP_GRID_X; ix++) {
+            _z[iy][ix] = 0;
+        }
+    }
+
+    // Grid geometry is fixed by config.h, so the float math happens once here
+    _origin_x_steps = (long)(HEIGHTMAP_MIN_X * X_STEPS_PER_MM);
+    _origin_y_steps = (long)(HEIGHTMAP_MIN_Y * Y_STEPS_PER_MM);
+    _cell_w_steps = (long)((HEIGHTMAP_MAX_X - HEIGHTMAP_MIN_X) * X_STEPS_PER_MM / (HEIGHTMAP_GRID_X - 1));
+    _cell_h_steps = (long)((HEIGHTMAP_MAX_Y - HEIGHTMAP_MIN_Y) * Y_STEPS_PER_MM / (HEIGHTMAP_GRID_Y - 1));
+    _inv_w_q24 = (1L << 24) / _cell_w_steps;
+    _inv_h_q24 = (1L << 24) / _cell_h_steps;
+
+    _cell_x0 = _cell_y0 = 0;
+    _c00 = _cdx = _cdy = _cdxy = 0;
+}
+
+void HeightMap::setEnabled(bool enabled) {
+    _enabled = enabled;
+}
+
+void HeightMap::_loadCell(int8_t ix, int8_t iy) {
+    long z00 = _z[iy][ix];
+    long z10 = _z[iy][ix + 1];
+    long z01 = _z[iy + 1][ix];
+    long z11 = _z[iy + 1][ix + 1];
+
+    _cell_ix = ix;
+    _cell_iy = iy;
+    _cell_x0 = _origin_x_steps + (long)ix * _cell_w_steps;
+    _cell_y0 = _origin_y_steps + (long)iy * _cell_h_steps;
+    _c00 = z00;
+    _cdx = z10 - z00;
+    _cdy = z01 - z00;
+    _cdxy = z11 - z10 - z01 + z00;
+}
+
+long HeightMap::zOffsetSteps(long x_steps, long y_steps) {
+    if (!isEnabled()) return 0;
+
+    // Locate the cell, clamping to the outer cells (heights are extrapolated flat)
+    long rel_x = x_steps - _origin_x_steps;
+    long rel_y = y_steps - _origin_y_steps;
+    int8_t ix = (rel_x <= 0) ? 0 : (int8_t)min(rel_x / _cell_w_steps, (long)(HEIGHTMAP_GRID_X - 2));
+    int8_t iy = (rel_y <= 0) ? 0 : (int8_t)min(rel_y / _cell_h_steps, (long)(HEIGHTMAP_GRID_Y - 2));
+    if (ix != _cell_ix || iy != _cell_iy) {
+        _loadCell(ix, iy);
+    }
+
+    // Fractional position inside the cell in Q8 (0..256)
+    long fx = ((x_steps - _cell_x0) * _inv_w_q24) >> 16;
+    long fy = ((y_steps - _cell_y0) * _inv_h_q24) >> 16;
+    fx = constrain(fx, 0L, 256L);
+    fy = constrain(fy, 0L, 256L);
+
+    // z = z00 + dx*fx + dy*fy + dxy*fx*fy (fractions in Q8)
+    long acc = _cdx * fx + _cdy * fy + ((_cdxy * fx * fy) >> 8);
+    return _c00 + (acc >> 8);
+}
+
+uint8_t HeightMap::cellCrossings(long x0, long y0, long x1, long y1, float (&t)[MAX_CROSSINGS]) const {
+    uint8_t n = 0;
+    for (uint8_t k = 0; k < HEIGHTMAP_GRID_X; k++) {
+        long gx = _origin_x_steps + (long)k * _cell_w_steps;
+        if (gx > min(x0, x1) && gx < max(x0, x1)) t[n++] = (float)(gx - x0) / (x1 - x0);
+    }
+    for (uint8_t k = 0; k < HEIGHTMAP_GRID_Y; k++) {
+        long gy = _origin_y_steps + (long)k * _cell_h_steps;
+        if (gy > min(y0, y1) && gy < max(y0, y1)) t[n++] = (float)(gy - y0) / (y1 - y0);
+    }
+
+    // Insertion sort; a move through a grid corner crosses two lines at once
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        float v = t[i];
+        uint8_t j = kept;
+        while (j > 0 && t[j - 1] > v) {
+            t[j] = t[j - 1];
+            j--;
+        }
+        t[j] = v;
+        kept++;
+    }
+    n = 0;
+    for (uint8_t i = 0; i < kept; i++) {
+        if (n == 0 || t[i] - t[n - 1] > 1e-4f) t[n++] = t[i];
+    }
+    return n;
+}
+
+bool HeightMap::_probePoint(long x_steps, long y_steps, int16_t& z_steps_out) {
+    long clearance_steps = kinematics.mmToStepsZ(HEIGHTMAP_CLEARANCE_Z);
+
+    // Raise to clearance height, then travel to the probe point
+    stepperControl.setMaxSpeed(AxisTraits<AXIS_X>::MAX_SPEED_STEPS,
+                               AxisTraits<AXIS_Y>::MAX_SPEED_STEPS,
+                               AxisTraits<AXIS_Z>::MAX_SPEED_STEPS);
+    stepperControl.setAcceleration(AxisTraits<AXIS_X>::MAX_ACCEL_STEPS,
+                                   AxisTraits<AXIS_Y>::MAX_ACCEL_STEPS,
+                                   AxisTraits<AXIS_Z>::MAX_ACCEL_STEPS);
+    stepperControl.moveTo(stepperControl.getCurrentXSteps(), stepperControl.getCurrentYSteps(), clearance_steps);
+    stepperControl.runBlocking();
+    stepperControl.moveTo(x_steps, y_steps, clearance_steps);
+    stepperControl.runBlocking();
+
+    if (endstops.getRawState(AXIS_Z)) {
+        serialHandler.sendError(ERR_HOMING_FAILED, F("Z endstop triggered at probe clearance height"));
+        return false;
+    }
+
+    // Slow descent until the optical endstop sees the paper
+    stepperControl.setAxisMaxSpeed(AXIS_Z, HEIGHTMAP_PROBE_FEEDRATE * Z_STEPS_PER_MM);
+    stepperControl.setAxisAcceleration(AXIS_Z, AxisTraits<AXIS_Z>::HOMING_ACCEL_STEPS);
+    stepperControl.moveAxisTo(AXIS_Z, -kinematics.mmToStepsZ(HEIGHTMAP_MAX_DEPTH_MM));
+
+    while (!endstops.getRawState(AXIS_Z)) {
+        wdt_reset();
+        stepperControl.runAxis(AXIS_Z);
+        if (!stepperControl.isAxisRunning(AXIS_Z)) {
+            serialHandler.sendError(ERR_HOMING_FAILED, F("Probe reached max depth without trigger"));
+            return false;
+        }
+    }
+    stepperControl.stopAxisImmediate(AXIS_Z);
+    z_steps_out = (int16_t)stepperControl.getCurrentZSteps();
+    return true;
+}
+
+bool HeightMap::probe() {
+    if (!homing.isHomed()) {
+        serialHandler.sendError(ERR_NOT_HOMED, F("G29 requires all axes homed"));
+        return false;
+    }
+
+    _valid = false;
+    _cell_ix = _cell_iy = -1; // Invalidate cached cell
+    stepperControl.enableSteppers();
+
+    // Serpentine order keeps XY travel between points short
+    for (int iy = 0; iy < HEIGHTMAP_GRID_Y; iy++) {
+        for (int i = 0; i < HEIGHTMAP_GRID_X; i++) {
+            int ix = (iy & 1) ? (HEIGHTMAP_GRID_X - 1 - i) : i;
+            long x_steps = _origin_x_steps + (long)ix * _cell_w_steps;
+            long y_steps = _origin_y_steps + (long)iy * _cell_h_steps;
+
+            if (!_probePoint(x_steps, y_steps, _z[iy][ix])) {
+                return false;
+            }
+
+            char msg[48];
+            snprintf_P(msg, sizeof(msg), PSTR("Probe %d,%d: %d steps"), ix, iy, _z[iy][ix]);
+            serialHandler.sendInfo(msg);
+        }
+    }
+
+    // Leave the pen at clearance height
+    stepperControl.setAxisMaxSpeed(AXIS_Z, AxisTraits<AXIS_Z>::MAX_SPEED_STEPS);
+    stepperControl.setAxisAcceleration(AXIS_Z, AxisTraits<AXIS_Z>::MAX_ACCEL_STEPS);
+    stepperControl.moveAxisTo(AXIS_Z, kinematics.mmToStepsZ(HEIGHTMAP_CLEARANCE_Z));
+    while (stepperControl.isAxisRunning(AXIS_Z)) {
+        wdt_reset();
+        stepperControl.runAxis(AXIS_Z);
+    }
+
+    _valid = true;
+    _enabled = true;
+    return true;
+}
+
+void HeightMap::report() {
+    if (!_valid) {
+        serialHandler.sendInfo(F("Height map: not probed"));
+        return;
+    }
+    serialHandler.sendInfo(isEnabled() ? F("Height map (mm), compensation ON:") : F("Height map (mm), compensation OFF:"));
+    // Print back row first so the output reads like the bed seen from the front
+    for (int iy = HEIGHTMAP_GRID_Y - 1; iy >= 0; iy--) {
+        String row = String('Y') + String(iy) + ':';
+        for (int ix = 0; ix < HEIGHTMAP_GRID_X; ix++) {
+            row = row + ' ' + String(kinematics.stepsToMmZ(_z[iy][ix]), 3);
+        }
+        serialHandler.sendInfo(row.c_str());
+    }
+}
@@ -0,0 +1,68 @@
+// SimplePlotter_Firmware/src/motion/height_map.h
+
+#ifndef HEIGHT_MAP_H
+#define HEIGHT_MAP_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+// Paper height map probed with the Z optical endstop (G29).
+// Heights are stored in Z steps relative to Z=0 (the trigger point found by Z homing).
+// Compensation is bilinear over the probed grid. The coefficients of the last used
+// cell are cached, so a move that stays in the same cell costs a few integer ops.
+class HeightMap {
+public:
+    HeightMap();
+
+    // Probe every grid point (requires X, Y and Z homed). Enables the map on success.
+    bool probe();
+
+    // Enable/disable compensation (M420 S1/S0). Ignored if no valid map was probed.
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return _enabled && _valid; }
+    bool isValid() const { return _valid; }
+
+    // Z correction in steps for an XY machine position given in steps
+    long zOffsetSteps(long x_steps, long y_steps);
+
+    // Where the XY move from (x0, y0) to (x1, y1) crosses a grid line, as fractions of the
+    // move in (0, 1), ascending. Between two of them the move stays in one cell, so
+    // the planner splits it there to follow the surface instead of one Z ramp.
+    static const uint8_t MAX_CROSSINGS = HEIGHTMAP_GRID_X + HEIGHTMAP_GRID_Y;
+    uint8_t cellCrossings(long x0, long y0, long x1, long y1, float (&t)[MAX_CROSSINGS]) const;
+
+    // Print the probed grid to serial (M420 V)
+    void report();
+
+private:
+    int16_t _z[HEIGHTMAP_GRID_Y][HEIGHTMAP_GRID_X]; // Probed paper heights in Z steps
+    bool _valid;
+    bool _enabled;
+
+    // Grid geometry in steps, computed once in the constructor
+    long _origin_x_steps;
+    long _origin_y_steps;
+    long _cell_w_steps;
+    long _cell_h_steps;
+    long _inv_w_q24; // (1 << 24) / _cell_w_steps
+    long _inv_h_q24; // (1 << 24) / _cell_h_steps
+
+    // Cached bilinear coefficients of the last used cell
+    int8_t _cell_ix;
+    int8_t _cell_iy;
+    long _cell_x0;
+    long _cell_y0;
+    long _c00;  // Height at the cell's lower-left corner
+    long _cdx;  // Height change across the cell in X
+    long _cdy;  // Height change across the cell in Y
+    long _cdxy; // Twist term (z11 - z10 - z01 + z00)
+
+    void _loadCell(int8_t ix, int8_t iy);
+
+    // Descend Z at the current XY until the endstop triggers; result in Z steps
+    bool _probePoint(long x_steps, long y_steps, int16_t& z_steps_out);
+};
+
+extern HeightMap heightMap; // Global instance
+
+#endif // HEIGHT_MAP_H
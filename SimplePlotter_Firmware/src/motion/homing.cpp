@@ -3,114 +3,105 @@
 #include "homing.h"
 #include <avr/wdt.h> // For watchdog timer reset during long operations
 #include "../ui/lcd_menu.h" // For menuUpdateDisplay() during homing spinner animation
+#include "../io/settings.h"  // Per-axis backoff, slow feedrate and settle time
+#include "pen.h"
 
 Homing homing; // Global instance definition
 
-Homing::Homing() : _is_homed_x(false), _is_homed_y(false), _is_homed_z(false) {
+Homing::Homing() : _is_homed{false, false, !PenActuator::USES_Z_AXIS} {
     // Constructor
 }
 
-int Homing::_getHomeDir(char axis) {
-    if (axis == 'X') return HOME_DIR_X;
-    if (axis == 'Y') return HOME_DIR_Y;
-    return HOME_DIR_Z;
+// Set one axis' position, keeping the others
+static void setAxisPosition(AxisIndex axis, long steps) {
+    long pos[AXIS_COUNT];
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) pos[i] = stepperControl.getCurrentSteps((AxisIndex)i);
+    pos[axis] = steps;
+    stepperControl.setCurrentPosition(pos[AXIS_X], pos[AXIS_Y], pos[AXIS_Z]);
 }
 
-float Homing::_getMaxPos(char axis) {
-    if (axis == 'X') return X_MAX_POS;
-    if (axis == 'Y') return Y_MAX_POS;
-    return Z_MAX_POS;
+// The switch reads `state` HOMING_TRIGGER_READS times in a row
+static bool switchReads(AxisIndex axis, bool state) {
+    for (uint8_t i = 0; i < HOMING_TRIGGER_READS; i++) {
+        if (endstops.getRawState(axis) != state) return false;
+    }
+    return true;
 }
 
+static bool switchClosed(AxisIndex axis) { return switchReads(axis, true); }
+
 // Perform homing sequence for specified axis
-bool Homing::homeAxis(char axis) {
-    if (axis != 'X' && axis != 'Y' && axis != 'Z') {
-        serialHandler.sendError(ERR_INVALID_SYNTAX, "Invalid axis for homing");
+bool Homing::homeAxis(AxisIndex axis) {
+    if (axis >= AXIS_COUNT) {
+        serialHandler.sendError(ERR_INVALID_SYNTAX, F("Invalid axis for homing"));
         return false;
     }
+    const AxisConfig& cfg = axisConfig[axis];
+
+#if PEN_BACKEND == PEN_BACKEND_SERVO
+    if (axis == AXIS_Z) {
+        // Servo pen: homing Z just raises the pen; the Z stepper is not used
+        pen.set(true);
+        pen.setQueued(true);
+        delay(PEN_SERVO_SETTLE_MS);
+        _is_homed[AXIS_Z] = true;
+        setAxisPosition(AXIS_Z, kinematics.mmToStepsZ(Z_HOME_POSITION));
+        return true;
+    }
+#endif
 
     // DIAGNOSTIC: Check initial endstop state
     bool initial_endstop_state = endstops.isTriggered(axis);
-    serialHandler.sendInfo(("Homing " + String(axis) + ": Initial endstop=" + String(initial_endstop_state ? "TRIGGERED" : "open")).c_str());
+    serialHandler.sendInfo((String(F("Homing ")) + String(cfg.name) + F(": Initial endstop=") + String(initial_endstop_state ? F("TRIGGERED") : F("open"))).c_str());
 
     // DIAGNOSTIC: Check initial position
-    long initial_pos = 0;
-    if (axis == 'X') initial_pos = stepperControl.getCurrentXSteps();
-    else if (axis == 'Y') initial_pos = stepperControl.getCurrentYSteps();
-    else if (axis == 'Z') initial_pos = stepperControl.getCurrentZSteps();
-    serialHandler.sendInfo(("Homing " + String(axis) + ": Initial position=" + String(initial_pos) + " steps").c_str());
+    long initial_pos = stepperControl.getCurrentSteps(axis);
+    serialHandler.sendInfo((String(F("Homing ")) + String(cfg.name) + F(": Initial position=") + String(initial_pos) + F(" steps")).c_str());
 
     // Determine max travel for the axis (used for stall detection)
     // Use 2x MAX_POS to ensure we can reach the endstop from any starting position,
     // even if the carriage starts beyond the soft limit boundary.
-    long max_travel_steps_for_stall = 0;
-    if (axis == 'X') {
-        max_travel_steps_for_stall = kinematics.mmToStepsX(X_MAX_POS * 2.0f);
-    } else if (axis == 'Y') {
-        max_travel_steps_for_stall = kinematics.mmToStepsY(Y_MAX_POS * 2.0f);
-    } else if (axis == 'Z') {
-        max_travel_steps_for_stall = kinematics.mmToStepsZ(Z_MAX_POS * 2.0f);
-    }
-    serialHandler.sendInfo(("Homing " + String(axis) + ": Max travel=" + String(max_travel_steps_for_stall) + " steps").c_str());
+    long max_travel_steps_for_stall = axisMmToSteps(axis, cfg.max_pos * 2.0f);
+    serialHandler.sendInfo((String(F("Homing ")) + String(cfg.name) + F(": Max travel=") + String(max_travel_steps_for_stall) + F(" steps")).c_str());
 
-    // Cap feedrates for Z axis — Z uses leadscrew with high steps/mm.
+    // Cap feedrates by the axis ceiling — Z uses leadscrew with high steps/mm.
     // MAX_VELOCITY_Z caps the physical speed to avoid stalling.
-    float fast_rate = HOMING_FEEDRATE_FAST;
-    float slow_rate = HOMING_FEEDRATE_SLOW;
-    if (axis == 'Z') {
-        fast_rate = min(fast_rate, (float)MAX_VELOCITY_Z);
-        slow_rate = min(slow_rate, (float)MAX_VELOCITY_Z);
-    }
+    float fast_rate = min((float)HOMING_FEEDRATE_FAST, cfg.max_velocity);
+    float slow_rate = min(settings.data().homing[axis].slow_feedrate, cfg.max_velocity);
 
     // Call the internal sequence
     bool success = _singleAxisHomingSequence(axis, max_travel_steps_for_stall, fast_rate, slow_rate);
 
     if (success) {
         // Update homed status
-        if (axis == 'X') _is_homed_x = true;
-        else if (axis == 'Y') _is_homed_y = true;
-        else if (axis == 'Z') _is_homed_z = true;
+        _is_homed[axis] = true;
 
         // Set position based on homing direction:
         // If homing to max (HOME_DIR=1), position = MAX_POS
         // If homing to min (HOME_DIR=-1), position = 0
-        long current_x = stepperControl.getCurrentXSteps();
-        long current_y = stepperControl.getCurrentYSteps();
-        long current_z = stepperControl.getCurrentZSteps();
-
-        if (axis == 'X') {
-            long home_pos = (HOME_DIR_X == 1) ? kinematics.mmToStepsX(X_MAX_POS) : 0;
-            stepperControl.setCurrentPosition(home_pos, current_y, current_z);
-        } else if (axis == 'Y') {
-            long home_pos = (HOME_DIR_Y == 1) ? kinematics.mmToStepsY(Y_MAX_POS) : 0;
-            stepperControl.setCurrentPosition(current_x, home_pos, current_z);
-        } else if (axis == 'Z') {
-            stepperControl.setCurrentPosition(current_x, current_y, 0);
+        setAxisPosition(axis, (cfg.home_dir == 1) ? axisMmToSteps(axis, cfg.max_pos) : 0);
+
+        if (axis == AXIS_Z) {
             // Move Z to configured home position (above sensor) for pen clearance
             long z_home_steps = kinematics.mmToStepsZ(Z_HOME_POSITION);
-            stepperControl.setAxisMaxSpeed('Z', MAX_VELOCITY_Z * Z_STEPS_PER_MM);
-            stepperControl.setAxisAcceleration('Z', MAX_ACCEL_Z * Z_STEPS_PER_MM);
-            stepperControl.moveAxisTo('Z', z_home_steps);
+            stepperControl.setAxisMaxSpeed(AXIS_Z, AxisTraits<AXIS_Z>::MAX_SPEED_STEPS);
+            stepperControl.setAxisAcceleration(AXIS_Z, AxisTraits<AXIS_Z>::MAX_ACCEL_STEPS);
+            stepperControl.moveAxisTo(AXIS_Z, z_home_steps);
             stepperControl.enableSteppers();
-            while (stepperControl.isAxisRunning('Z')) {
+            while (stepperControl.isAxisRunning(AXIS_Z)) {
                 wdt_reset();
-                stepperControl.runAxis('Z');
+                stepperControl.runAxis(AXIS_Z);
                 yield();
             }
-            serialHandler.sendInfo("Z moved to home position");
+            serialHandler.sendInfo(F("Z moved to home position"));
         }
 
         return true;
     } else {
-        serialHandler.sendError(ERR_HOMING_FAILED, "Homing failed for axis");
+        serialHandler.sendError(ERR_HOMING_FAILED, F("Homing failed for axis"));
         // Reset software position to 0 for the failed axis so the next homing attempt
         // moves the full max_travel distance and can reach the endstop from any position.
-        long current_x = stepperControl.getCurrentXSteps();
-        long current_y = stepperControl.getCurrentYSteps();
-        long current_z = stepperControl.getCurrentZSteps();
-        if (axis == 'X') stepperControl.setCurrentPosition(0, current_y, current_z);
-        else if (axis == 'Y') stepperControl.setCurrentPosition(current_x, 0, current_z);
-        else if (axis == 'Z') stepperControl.setCurrentPosition(current_x, current_y, 0);
+        setAxisPosition(axis, 0);
         return false;
     }
 }
@@ -121,46 +112,46 @@ bool Homing::homeAllAxes() {
     bool z_ok = false, x_ok = false, y_ok = false;
 
     // Print endstop states before homing for diagnostics
-    serialHandler.sendInfo("Pre-homing endstop check:");
+    serialHandler.sendInfo(F("Pre-homing endstop check:"));
     serialHandler.sendEndstopStatus(
-        endstops.isTriggered('X'),
-        endstops.isTriggered('Y'),
-        endstops.isTriggered('Z'));
+        endstops.isTriggered(AXIS_X),
+        endstops.isTriggered(AXIS_Y),
+        endstops.isTriggered(AXIS_Z));
 
     // Home Z first (pen lift for safety)
-    serialHandler.sendInfo("Homing Z axis...");
-    z_ok = homeAxis('Z');
-    _is_homed_z = z_ok;
+    serialHandler.sendInfo(F("Homing Z axis..."));
+    z_ok = homeAxis(AXIS_Z);
+    _is_homed[AXIS_Z] = z_ok;
 
     if (z_ok) {
-        // Z already moved to Z_HOME_POSITION in homeAxis('Z')
+        // Z already moved to Z_HOME_POSITION in homeAxis(AXIS_Z)
         // No additional Z move needed here
     }
 
     // Home X (attempt even if Z failed)
-    serialHandler.sendInfo("Homing X axis...");
-    x_ok = homeAxis('X');
-    _is_homed_x = x_ok;
+    serialHandler.sendInfo(F("Homing X axis..."));
+    x_ok = homeAxis(AXIS_X);
+    _is_homed[AXIS_X] = x_ok;
 
     // Home Y (attempt even if X failed)
-    serialHandler.sendInfo("Homing Y axis...");
-    y_ok = homeAxis('Y');
-    _is_homed_y = y_ok;
+    serialHandler.sendInfo(F("Homing Y axis..."));
+    y_ok = homeAxis(AXIS_Y);
+    _is_homed[AXIS_Y] = y_ok;
 
     // Report per-axis results
     char result_buf[64];
-    snprintf(result_buf, sizeof(result_buf), "Homing result: X=%s Y=%s Z=%s",
-             x_ok ? "OK" : "FAIL", y_ok ? "OK" : "FAIL", z_ok ? "OK" : "FAIL");
+    snprintf_P(result_buf, sizeof(result_buf), PSTR("Homing result: X=%S Y=%S Z=%S"),
+             x_ok ? PSTR("OK") : PSTR("FAIL"), y_ok ? PSTR("OK") : PSTR("FAIL"), z_ok ? PSTR("OK") : PSTR("FAIL"));
     serialHandler.sendInfo(result_buf);
 
     if (x_ok && y_ok && z_ok) {
         // All axes homed - move to origin with pen at safe height
         // X=0 is at far left, Y=0 is at front (home), Z stays at Z_HOME
-        serialHandler.sendInfo("Moving to home position (0,0,Z_HOME)...");
+        serialHandler.sendInfo(F("Moving to home position (0,0,Z_HOME)..."));
         stepperControl.moveTo(0, 0, kinematics.mmToStepsZ(Z_HOME_POSITION));
         stepperControl.enableSteppers();
         stepperControl.runBlocking();
-        serialHandler.sendInfo("All axes homed.");
+        serialHandler.sendInfo(F("All axes homed."));
         return true;
     } else {
         serialHandler.sendError(ERR_HOMING_FAILED, result_buf);
@@ -169,50 +160,49 @@ bool Homing::homeAllAxes() {
 }
 
 // Internal helper for homing a single axis (Phase 1-4)
-bool Homing::_singleAxisHomingSequence(char axis, long max_travel_steps, float fast_feedrate_mm_s, float slow_feedrate_mm_s) {
+bool Homing::_singleAxisHomingSequence(AxisIndex axis, long max_travel_steps, float fast_feedrate_mm_s, float slow_feedrate_mm_s) {
     stepperControl.enableSteppers(); // Enable steppers for homing
 
-    int home_dir = _getHomeDir(axis);
+    const AxisConfig& cfg = axisConfig[axis];
+    const HomingTuning& tune = settings.data().homing[axis];
+    int home_dir = cfg.home_dir;
     int backoff_dir = -home_dir;
 
     // Pre-check: if endstop is already triggered, back off to clear it first
-    if (endstops.getRawState(axis)) {
-        serialHandler.sendInfo("Endstop pre-triggered, clearing...");
+    if (switchClosed(axis)) {
+        serialHandler.sendInfo(F("Endstop pre-triggered, clearing..."));
         if (!_moveAwayFromEndstop(axis, HOMING_BACKOFF_MM * 2, fast_feedrate_mm_s, backoff_dir)) {
             stepperControl.disableSteppers();
             return false;
         }
-        delay(200); // Mechanical settle
-        if (endstops.getRawState(axis)) {
-            serialHandler.sendError(ERR_HOMING_FAILED, "Cannot clear pre-triggered endstop");
+        delay(tune.settle_ms); // Mechanical settle
+        if (switchClosed(axis)) {
+            serialHandler.sendError(ERR_HOMING_FAILED, F("Cannot clear pre-triggered endstop"));
             stepperControl.disableSteppers();
             return false;
         }
     }
 
     // Phase 1: Fast approach towards endstop
-    serialHandler.sendInfo("Homing Phase 1: Fast approach...");
+    serialHandler.sendInfo(F("Homing Phase 1: Fast approach..."));
     if (!_moveUntilTriggered(axis, fast_feedrate_mm_s, max_travel_steps, HOMING_TIMEOUT_S * 1000UL, home_dir)) {
         stepperControl.disableSteppers();
         return false;
     }
-    delay(200); // Mechanical settle after endstop contact
+    delay(tune.settle_ms); // Mechanical settle after endstop contact
 
     // Phase 2: Backoff from endstop (no endstop validation — Marlin approach)
-    serialHandler.sendInfo("Homing Phase 2: Backoff...");
-    if (!_moveAwayFromEndstop(axis, HOMING_BACKOFF_MM, fast_feedrate_mm_s, backoff_dir)) {
+    serialHandler.sendInfo(F("Homing Phase 2: Backoff..."));
+    if (!_moveAwayFromEndstop(axis, tune.backoff_mm, fast_feedrate_mm_s, backoff_dir)) {
         stepperControl.disableSteppers();
         return false;
     }
-    delay(200); // Mechanical settle before slow approach
+    delay(tune.settle_ms); // Mechanical settle before slow approach
 
     // Phase 3: Slow approach towards endstop (precision positioning)
-    serialHandler.sendInfo("Homing Phase 3: Slow approach...");
+    serialHandler.sendInfo(F("Homing Phase 3: Slow approach..."));
     // The maximum distance for the slow approach needs generous margin to account for any overshoot
-    long slow_approach_max_steps = 0;
-    if (axis == 'X') slow_approach_max_steps = kinematics.mmToStepsX(HOMING_BACKOFF_MM * 4);
-    else if (axis == 'Y') slow_approach_max_steps = kinematics.mmToStepsY(HOMING_BACKOFF_MM * 4);
-    else if (axis == 'Z') slow_approach_max_steps = kinematics.mmToStepsZ(HOMING_BACKOFF_MM * 4);
+    long slow_approach_max_steps = axisMmToSteps(axis, tune.backoff_mm * 4);
     if (!_moveUntilTriggered(axis, slow_feedrate_mm_s, slow_approach_max_steps, HOMING_TIMEOUT_S * 1000UL, home_dir)) {
         stepperControl.disableSteppers();
         return false;
@@ -222,19 +212,11 @@ bool Homing::_singleAxisHomingSequence(char axis, long max_travel_steps, float f
     // This prevents the Y mechanical switch from unclicking due to spring-back.
     // Motor stalls harmlessly against the endstop for the excess distance.
     {
-        long bump_steps = 0;
-        if (axis == 'X') bump_steps = kinematics.mmToStepsX(1.0);
-        else if (axis == 'Y') bump_steps = kinematics.mmToStepsY(1.0);
-        else if (axis == 'Z') bump_steps = kinematics.mmToStepsZ(1.0);
+        long bump_steps = axisMmToSteps(axis, 1.0);
 
         float bump_speed = slow_feedrate_mm_s;
-        float steps_per_mm = X_STEPS_PER_MM;
-        float accel_base = MAX_ACCEL_X;
-        if (axis == 'Y') { steps_per_mm = Y_STEPS_PER_MM; accel_base = MAX_ACCEL_Y; }
-        else if (axis == 'Z') { steps_per_mm = Z_STEPS_PER_MM; accel_base = MAX_ACCEL_Z; }
-
-        stepperControl.setAxisMaxSpeed(axis, bump_speed * steps_per_mm);
-        stepperControl.setAxisAcceleration(axis, accel_base * steps_per_mm * HOMING_ACCEL_FACTOR);
+        stepperControl.setAxisMaxSpeed(axis, bump_speed * cfg.steps_per_mm);
+        stepperControl.setAxisAcceleration(axis, cfg.homing_accel_steps);
         stepperControl.moveAxisBy(axis, home_dir * bump_steps);
 
         unsigned long bump_start = millis();
@@ -245,7 +227,7 @@ bool Homing::_singleAxisHomingSequence(char axis, long max_travel_steps, float f
             yield();
         }
         stepperControl.stopAxisImmediate(axis);
-        delay(100); // Settle
+        delay(tune.settle_ms / 2); // Settle
     }
 
     // Phase 4: Set zero position (handled by calling function homeAxis)
@@ -255,47 +237,32 @@ bool Homing::_singleAxisHomingSequence(char axis, long max_travel_steps, float f
 
 // Helper to move towards endstop until triggered or timeout
 // direction: -1 to move in negative step direction, 1 to move in positive step direction
-bool Homing::_moveUntilTriggered(char axis, float speed_mm_s, long max_distance_steps, unsigned long timeout_ms, int direction) {
-    float speed_steps_per_s = speed_mm_s; // Will be multiplied by steps_per_mm below
-    long current_axis_pos_at_start = 0; // Position when starting this move
+bool Homing::_moveUntilTriggered(AxisIndex axis, float speed_mm_s, long max_distance_steps, unsigned long timeout_ms, int direction) {
+    const AxisConfig& cfg = axisConfig[axis];
 
     // Set appropriate speed and reduced acceleration for homing (smoother motion)
-    if (axis == 'X') {
-        speed_steps_per_s *= X_STEPS_PER_MM;
-        stepperControl.setAxisMaxSpeed('X', speed_steps_per_s);
-        stepperControl.setAxisAcceleration('X', MAX_ACCEL_X * X_STEPS_PER_MM * HOMING_ACCEL_FACTOR);
-        current_axis_pos_at_start = stepperControl.getCurrentXSteps();
-        stepperControl.moveAxisBy('X', direction * max_distance_steps);
-    } else if (axis == 'Y') {
-        speed_steps_per_s *= Y_STEPS_PER_MM;
-        stepperControl.setAxisMaxSpeed('Y', speed_steps_per_s);
-        stepperControl.setAxisAcceleration('Y', MAX_ACCEL_Y * Y_STEPS_PER_MM * HOMING_ACCEL_FACTOR);
-        current_axis_pos_at_start = stepperControl.getCurrentYSteps();
-        stepperControl.moveAxisBy('Y', direction * max_distance_steps);
-    } else if (axis == 'Z') {
-        speed_steps_per_s *= Z_STEPS_PER_MM;
-        stepperControl.setAxisMaxSpeed('Z', speed_steps_per_s);
-        stepperControl.setAxisAcceleration('Z', MAX_ACCEL_Z * Z_STEPS_PER_MM * HOMING_ACCEL_FACTOR);
-        current_axis_pos_at_start = stepperControl.getCurrentZSteps();
-        stepperControl.moveAxisBy('Z', direction * max_distance_steps);
-    }
+    float speed_steps_per_s = speed_mm_s * cfg.steps_per_mm;
+    stepperControl.setAxisMaxSpeed(axis, speed_steps_per_s);
+    stepperControl.setAxisAcceleration(axis, cfg.homing_accel_steps);
+    long current_axis_pos_at_start = stepperControl.getCurrentSteps(axis); // Position when starting this move
+    stepperControl.moveAxisBy(axis, direction * max_distance_steps);
 
-    serialHandler.sendInfo(("Moving " + String(axis) + ": Start pos=" + String(current_axis_pos_at_start) +
-                           ", target offset=" + String(direction * max_distance_steps) +
-                           ", speed=" + String(speed_steps_per_s) + " steps/s").c_str());
+    serialHandler.sendInfo((String(F("Moving ")) + String(cfg.name) + F(": Start pos=") + String(current_axis_pos_at_start) +
+                           F(", target offset=") + String(direction * max_distance_steps) +
+                           F(", speed=") + String(speed_steps_per_s) + F(" steps/s")).c_str());
 
     unsigned long start_time = millis();
     unsigned long last_ui_update = 0; // Track last LCD update for spinner animation
-    while (!endstops.getRawState(axis)) {
+    uint8_t closed_reads = 0; // Noise on the line mustn't stop the approach
+    while (true) {
+        closed_reads = endstops.getRawState(axis) ? closed_reads + 1 : 0;
+        if (closed_reads >= HOMING_TRIGGER_READS) break;
         wdt_reset(); // Feed watchdog timer to prevent reset during long homing moves
 
         if (millis() - start_time > timeout_ms) {
             // DIAGNOSTIC: Report timeout
-            long final_pos = 0;
-            if (axis == 'X') final_pos = stepperControl.getCurrentXSteps();
-            else if (axis == 'Y') final_pos = stepperControl.getCurrentYSteps();
-            else if (axis == 'Z') final_pos = stepperControl.getCurrentZSteps();
-            serialHandler.sendInfo(("TIMEOUT " + String(axis) + ": Moved " + String(abs(current_axis_pos_at_start - final_pos)) + " steps").c_str());
+            long final_pos = stepperControl.getCurrentSteps(axis);
+            serialHandler.sendInfo((String(F("TIMEOUT ")) + String(cfg.name) + F(": Moved ") + String(abs(current_axis_pos_at_start - final_pos)) + F(" steps")).c_str());
             stepperControl.stopAxis(axis);
             return false; // Homing timeout handled by calling function
         }
@@ -305,12 +272,9 @@ bool Homing::_moveUntilTriggered(char axis, float speed_mm_s, long max_distance_
         // Stall detection: Check if we've traveled the full distance without hitting endstop
         if (!stepperControl.isAxisRunning(axis)) {
             // DIAGNOSTIC: Report stall detection
-            long final_pos = 0;
-            if (axis == 'X') final_pos = stepperControl.getCurrentXSteps();
-            else if (axis == 'Y') final_pos = stepperControl.getCurrentYSteps();
-            else if (axis == 'Z') final_pos = stepperControl.getCurrentZSteps();
-            serialHandler.sendInfo(("STALL " + String(axis) + ": Moved " + String(abs(current_axis_pos_at_start - final_pos)) +
-                                   " steps, endstop never triggered").c_str());
+            long final_pos = stepperControl.getCurrentSteps(axis);
+            serialHandler.sendInfo((String(F("STALL ")) + String(cfg.name) + F(": Moved ") + String(abs(current_axis_pos_at_start - final_pos)) +
+                                   F(" steps, endstop never triggered")).c_str());
             stepperControl.stopAxis(axis);
             return false; // Max travel reached without endstop trigger handled by calling function
         }
@@ -326,11 +290,8 @@ bool Homing::_moveUntilTriggered(char axis, float speed_mm_s, long max_distance_
     }
 
     // DIAGNOSTIC: Report successful endstop trigger
-    long final_pos = 0;
-    if (axis == 'X') final_pos = stepperControl.getCurrentXSteps();
-    else if (axis == 'Y') final_pos = stepperControl.getCurrentYSteps();
-    else if (axis == 'Z') final_pos = stepperControl.getCurrentZSteps();
-    serialHandler.sendInfo(("TRIGGERED " + String(axis) + ": Moved " + String(abs(current_axis_pos_at_start - final_pos)) + " steps").c_str());
+    long final_pos = stepperControl.getCurrentSteps(axis);
+    serialHandler.sendInfo((String(F("TRIGGERED ")) + String(cfg.name) + F(": Moved ") + String(abs(current_axis_pos_at_start - final_pos)) + F(" steps")).c_str());
 
     // Stop the stepper instantly (no deceleration overshoot)
     stepperControl.stopAxisImmediate(axis);
@@ -340,41 +301,20 @@ bool Homing::_moveUntilTriggered(char axis, float speed_mm_s, long max_distance_
 
 // Helper to move away from endstop for a specified distance
 // direction: -1 or 1, controlling which way to move (away from endstop)
-bool Homing::_moveAwayFromEndstop(char axis, float distance_mm, float speed_mm_s, int direction) {
-    long current_pos_steps = 0;
-    long move_distance_steps = 0;
-    float speed_steps_per_s = speed_mm_s; // Will be multiplied by steps_per_mm below
-    long new_target_pos_steps = 0;
+bool Homing::_moveAwayFromEndstop(AxisIndex axis, float distance_mm, float speed_mm_s, int direction) {
+    const AxisConfig& cfg = axisConfig[axis];
 
     // Set appropriate speed and reduced acceleration for homing backoff
-    if (axis == 'X') {
-        current_pos_steps = stepperControl.getCurrentXSteps();
-        move_distance_steps = kinematics.mmToStepsX(distance_mm);
-        speed_steps_per_s *= X_STEPS_PER_MM;
-        new_target_pos_steps = current_pos_steps + direction * move_distance_steps;
-        stepperControl.setAxisMaxSpeed('X', speed_steps_per_s);
-        stepperControl.setAxisAcceleration('X', MAX_ACCEL_X * X_STEPS_PER_MM);
-        stepperControl.moveAxisTo('X', new_target_pos_steps);
-    } else if (axis == 'Y') {
-        current_pos_steps = stepperControl.getCurrentYSteps();
-        move_distance_steps = kinematics.mmToStepsY(distance_mm);
-        speed_steps_per_s *= Y_STEPS_PER_MM;
-        new_target_pos_steps = current_pos_steps + direction * move_distance_steps;
-        stepperControl.setAxisMaxSpeed('Y', speed_steps_per_s);
-        stepperControl.setAxisAcceleration('Y', MAX_ACCEL_Y * Y_STEPS_PER_MM);
-        stepperControl.moveAxisTo('Y', new_target_pos_steps);
-    } else if (axis == 'Z') {
-        current_pos_steps = stepperControl.getCurrentZSteps();
-        move_distance_steps = kinematics.mmToStepsZ(distance_mm);
-        speed_steps_per_s *= Z_STEPS_PER_MM;
-        new_target_pos_steps = current_pos_steps + direction * move_distance_steps;
-        stepperControl.setAxisMaxSpeed('Z', speed_steps_per_s);
-        stepperControl.setAxisAcceleration('Z', MAX_ACCEL_Z * Z_STEPS_PER_MM);
-        stepperControl.moveAxisTo('Z', new_target_pos_steps);
-    }
+    long current_pos_steps = stepperControl.getCurrentSteps(axis);
+    long move_distance_steps = axisMmToSteps(axis, distance_mm);
+    float speed_steps_per_s = speed_mm_s * cfg.steps_per_mm;
+    long new_target_pos_steps = current_pos_steps + direction * move_distance_steps;
+    stepperControl.setAxisMaxSpeed(axis, speed_steps_per_s);
+    stepperControl.setAxisAcceleration(axis, cfg.max_accel_steps);
+    stepperControl.moveAxisTo(axis, new_target_pos_steps);
 
-    serialHandler.sendInfo(("Backoff " + String(axis) + ": " + String(distance_mm) + "mm (" + String(move_distance_steps) +
-                           " steps) from " + String(current_pos_steps) + " to " + String(new_target_pos_steps)).c_str());
+    serialHandler.sendInfo((String(F("Backoff ")) + String(cfg.name) + F(": ") + String(distance_mm) + F("mm (") + String(move_distance_steps) +
+                           F(" steps) from ") + String(current_pos_steps) + F(" to ") + String(new_target_pos_steps)).c_str());
 
     // Block until movement is complete (or timeout)
     // Calculate an approximate timeout based on distance and speed
@@ -385,7 +325,7 @@ bool Homing::_moveAwayFromEndstop(char axis, float distance_mm, float speed_mm_s
         wdt_reset(); // Feed watchdog timer
 
         if (millis() - start_time > timeout_calc_ms) {
-            serialHandler.sendInfo(("Backoff " + String(axis) + " TIMEOUT after " + String(millis() - start_time) + "ms").c_str());
+            serialHandler.sendInfo((String(F("Backoff ")) + String(cfg.name) + F(" TIMEOUT after ") + String(millis() - start_time) + F("ms")).c_str());
             return false; // Backoff timeout handled by calling function
         }
         stepperControl.runAxis(axis);
@@ -398,11 +338,174 @@ bool Homing::_moveAwayFromEndstop(char axis, float distance_mm, float speed_mm_s
         yield();
     }
 
-    long final_pos = 0;
-    if (axis == 'X') final_pos = stepperControl.getCurrentXSteps();
-    else if (axis == 'Y') final_pos = stepperControl.getCurrentYSteps();
-    else if (axis == 'Z') final_pos = stepperControl.getCurrentZSteps();
-    serialHandler.sendInfo(("Backoff " + String(axis) + " complete: final pos=" + String(final_pos)).c_str());
+    long final_pos = stepperControl.getCurrentSteps(axis);
+    serialHandler.sendInfo((String(F("Backoff ")) + String(cfg.name) + F(" complete: final pos=") + String(final_pos)).c_str());
 
     return true;
 }
+
+//===========================================================================
+// Homing calibration (M171)
+//===========================================================================
+
+bool Homing::calibrateAxis(AxisIndex axis, HomingTuning& out) {
+    stepperControl.enableSteppers();
+    bool ok = _calibrateSequence(axis, out);
+    _is_homed[axis] = false; // Touches end in hard stops; G28 before the next job
+    return ok;
+}
+
+bool Homing::_calibrateSequence(AxisIndex axis, HomingTuning& out) {
+    const AxisConfig& cfg = axisConfig[axis];
+    const int home_dir = cfg.home_dir;
+    char buf[72];
+
+    long max_travel = axisMmToSteps(axis, cfg.max_pos * 2.0f);
+    long release_limit = axisMmToSteps(axis, HOMING_BACKOFF_MM * 2);
+    float fast = min((float)HOMING_FEEDRATE_FAST, cfg.max_velocity);
+    long trigger, release;
+    uint16_t settle = 0;
+
+    // Start clear of the switch, then find it the way homing phase 1 does
+    if (endstops.getRawState(axis) && !_release(axis, release_limit, release)) return false;
+    if (!_touch(axis, fast, max_travel, trigger)) {
+        serialHandler.sendError(ERR_HOMING_FAILED, F("M171: endstop not reached"));
+        return false;
+    }
+    settle = max(settle, _measureSettle(axis));
+
+    // Distance to release after a fast touch: the least the phase 2 backoff must cover
+    if (!_release(axis, release_limit, release)) return false;
+    settle = max(settle, _measureSettle(axis));
+    float release_mm = labs(release - trigger) / cfg.steps_per_mm;
+
+    // Repeatability per feedrate, fastest first; the first one within tolerance wins
+    static const float feeds[] = { HOMING_TUNE_FEEDRATES };
+    float best_feed = 0.0f;
+    float best_spread_mm = 0.0f;
+    for (uint8_t f = 0; f < sizeof(feeds) / sizeof(feeds[0]) && best_feed == 0.0f; f++) {
+        float feed = feeds[f];
+        if (feed > cfg.max_velocity) continue;
+
+        // Start far enough out to be at speed before the release point
+        float runup_mm = feed * feed / (2.0f * cfg.max_accel * HOMING_ACCEL_FACTOR);
+        long start = trigger - home_dir * axisMmToSteps(axis, release_mm + runup_mm + HOMING_TUNE_MIN_BACKOFF_MM);
+        long touch_limit = 2 * labs(trigger - start);
+        long lo = 0x7FFFFFFFL, hi = -0x7FFFFFFFL;
+        for (uint8_t n = 0; n < HOMING_TUNE_TOUCHES; n++) {
+            _moveAxisToQuiet(axis, start, fast);
+            delay(settle + HOMING_TUNE_SETTLE_MARGIN_MS);
+            long pos;
+            if (!_touch(axis, feed, touch_limit, pos)) {
+                serialHandler.sendError(ERR_HOMING_FAILED, F("M171: endstop not reached"));
+                return false;
+            }
+            settle = max(settle, _measureSettle(axis));
+            if (pos < lo) lo = pos;
+            if (pos > hi) hi = pos;
+            menuUpdateDisplay();
+        }
+        float spread_mm = (hi - lo) / cfg.steps_per_mm;
+
+        char feed_str[8], spread_str[8];
+        dtostrf(feed, 1, 2, feed_str);
+        dtostrf(spread_mm, 1, 4, spread_str);
+        snprintf_P(buf, sizeof(buf), PSTR("M171 %c: F%s mm/s spread %s mm"), cfg.name, feed_str, spread_str);
+        serialHandler.sendInfo(buf);
+
+        if (spread_mm <= HOMING_TUNE_REPEATABILITY_MM) {
+            best_feed = feed;
+            best_spread_mm = spread_mm;
+        }
+    }
+    _moveAxisToQuiet(axis, trigger - home_dir * axisMmToSteps(axis, release_mm + HOMING_TUNE_MIN_BACKOFF_MM), fast);
+
+    if (best_feed == 0.0f) {
+        snprintf_P(buf, sizeof(buf), PSTR("M171 %c: no feedrate meets the repeatability target"), cfg.name);
+        serialHandler.sendError(ERR_HOMING_FAILED, buf);
+        return false;
+    }
+
+    float runup_mm = best_feed * best_feed / (2.0f * cfg.max_accel * HOMING_ACCEL_FACTOR);
+    out.backoff_mm = max(release_mm * (float)HOMING_TUNE_BACKOFF_MARGIN + runup_mm, (float)HOMING_TUNE_MIN_BACKOFF_MM);
+    out.slow_feedrate = best_feed;
+    out.settle_ms = settle + HOMING_TUNE_SETTLE_MARGIN_MS;
+    uint16_t spread_um = (uint16_t)(best_spread_mm * 1000.0f + 0.5f);
+    out.spread_um = spread_um ? spread_um : 1; // 0 is reserved for "not calibrated"
+    return true;
+}
+
+// Runs the axis' pending move until it completes or the endstop reads stop_state
+// HOMING_TRIGGER_READS times in a row, the rule homing phase 1 stops on. Returns true
+// if the endstop got there; the axis is stopped instantly either way.
+bool Homing::_runUntilEndstop(AxisIndex axis, bool stop_state, unsigned long timeout_ms) {
+    unsigned long start = millis();
+    uint8_t reads = 0; // Noise on the line mustn't end the move
+    while (stepperControl.isAxisRunning(axis)) {
+        wdt_reset();
+        reads = endstops.getRawState(axis) == stop_state ? reads + 1 : 0;
+        if (reads >= HOMING_TRIGGER_READS) break;
+        if (millis() - start > timeout_ms) break;
+        stepperControl.runAxis(axis);
+    }
+    stepperControl.stopAxisImmediate(axis);
+    return reads >= HOMING_TRIGGER_READS || switchReads(axis, stop_state);
+}
+
+bool Homing::touchEndstop(AxisIndex axis, long max_steps, long& trigger_pos) {
+    float slow = min(settings.data().homing[axis].slow_feedrate, axisConfig[axis].max_velocity);
+    stepperControl.enableSteppers();
+    return _touch(axis, slow, max_steps, trigger_pos);
+}
+
+// Approach the endstop at speed_mm_s; trigger_pos is where the switch closed (steps)
+bool Homing::_touch(AxisIndex axis, float speed_mm_s, long max_steps, long& trigger_pos) {
+    const AxisConfig& cfg = axisConfig[axis];
+    stepperControl.setAxisMaxSpeed(axis, speed_mm_s * cfg.steps_per_mm);
+    stepperControl.setAxisAcceleration(axis, cfg.homing_accel_steps);
+    stepperControl.moveAxisBy(axis, cfg.home_dir * max_steps);
+    if (!_runUntilEndstop(axis, true, HOMING_TIMEOUT_S * 1000UL)) return false;
+    trigger_pos = stepperControl.getCurrentSteps(axis);
+    return true;
+}
+
+// Creep away from the triggered endstop; release_pos is where the switch opened (steps)
+bool Homing::_release(AxisIndex axis, long max_steps, long& release_pos) {
+    const AxisConfig& cfg = axisConfig[axis];
+    stepperControl.setAxisMaxSpeed(axis, HOMING_TUNE_RELEASE_FEEDRATE * cfg.steps_per_mm);
+    stepperControl.setAxisAcceleration(axis, cfg.homing_accel_steps);
+    stepperControl.moveAxisBy(axis, -cfg.home_dir * max_steps);
+    if (!_runUntilEndstop(axis, false, HOMING_TIMEOUT_S * 1000UL)) {
+        serialHandler.sendError(ERR_HOMING_FAILED, F("M171: endstop does not release"));
+        return false;
+    }
+    release_pos = stepperControl.getCurrentSteps(axis);
+    return true;
+}
+
+void Homing::_moveAxisToQuiet(AxisIndex axis, long target_steps, float speed_mm_s) {
+    const AxisConfig& cfg = axisConfig[axis];
+    stepperControl.setAxisMaxSpeed(axis, speed_mm_s * cfg.steps_per_mm);
+    stepperControl.setAxisAcceleration(axis, cfg.homing_accel_steps);
+    stepperControl.moveAxisTo(axis, target_steps);
+    while (stepperControl.isAxisRunning(axis)) {
+        wdt_reset();
+        stepperControl.runAxis(axis);
+    }
+}
+
+// Watches the switch after a stop; ms from the stop to its last edge (contact bounce)
+uint16_t Homing::_measureSettle(AxisIndex axis) {
+    unsigned long start = millis();
+    unsigned long last_edge = start;
+    bool state = endstops.getRawState(axis);
+    while (millis() - start < HOMING_TUNE_SETTLE_WINDOW_MS) {
+        wdt_reset();
+        bool now_state = endstops.getRawState(axis);
+        if (now_state != state) {
+            state = now_state;
+            last_edge = millis();
+        }
+    }
+    return (uint16_t)(last_edge - start);
+}
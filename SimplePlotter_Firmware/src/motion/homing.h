@@ -9,43 +9,55 @@
 #include "kinematics.h"      // For mm to steps conversion and max travel
 #include "../io/endstops.h"  // For reading endstop states
 #include "../io/serial_handler.h" // For error reporting
+#include "axis.h"
+#include "../io/settings.h"   // HomingTuning
 
 class Homing {
 public:
     Homing();
 
     // Perform homing sequence for specified axis or all axes
-    bool homeAxis(char axis); // 'X', 'Y', 'Z'
+    bool homeAxis(AxisIndex axis);
     bool homeAllAxes();
 
     // Check if homing is complete for all axes
-    bool isHomed() const { return _is_homed_x && _is_homed_y && _is_homed_z; }
-    void setHomed(bool x, bool y, bool z) { _is_homed_x = x; _is_homed_y = y; _is_homed_z = z; }
-    bool isHomedX() const { return _is_homed_x; } // Added getter
-    bool isHomedY() const { return _is_homed_y; } // Added getter
-    bool isHomedZ() const { return _is_homed_z; } // Added getter
+    bool isHomed() const { return _is_homed[AXIS_X] && _is_homed[AXIS_Y] && _is_homed[AXIS_Z]; }
+    bool isHomed(AxisIndex axis) const { return _is_homed[axis]; }
+    void setHomed(bool x, bool y, bool z) { _is_homed[AXIS_X] = x; _is_homed[AXIS_Y] = y; _is_homed[AXIS_Z] = z; }
+    bool isHomedX() const { return _is_homed[AXIS_X]; }
+    bool isHomedY() const { return _is_homed[AXIS_Y]; }
+    bool isHomedZ() const { return _is_homed[AXIS_Z]; }
 
-private:
-    bool _is_homed_x;
-    bool _is_homed_y;
-    bool _is_homed_z;
+    // Homing calibration (M171): touch the endstop repeatedly at each HOMING_TUNE_FEEDRATES
+    // speed and fill `out` with the shortest backoff, fastest slow feedrate meeting
+    // HOMING_TUNE_REPEATABILITY_MM, and the settle time. Leaves the axis unhomed.
+    bool calibrateAxis(AxisIndex axis, HomingTuning& out);
 
-    // Get homing direction for axis: -1 (toward min) or 1 (toward max)
-    int _getHomeDir(char axis);
+    // Approach the switch from the current position at the calibrated slow feedrate and
+    // report where it closes (steps), without re-zeroing. Step-loss check for M172.
+    bool touchEndstop(AxisIndex axis, long max_steps, long& trigger_pos);
 
-    // Get maximum position for axis in mm
-    float _getMaxPos(char axis);
+private:
+    bool _is_homed[AXIS_COUNT];
 
     // Internal helper for homing a single axis
-    bool _singleAxisHomingSequence(char axis, long max_travel_steps, float fast_feedrate_mm_s, float slow_feedrate_mm_s);
+    bool _singleAxisHomingSequence(AxisIndex axis, long max_travel_steps, float fast_feedrate_mm_s, float slow_feedrate_mm_s);
 
     // Helper to move towards endstop until triggered or timeout
     // direction: -1 or 1, controlling which way the axis moves
-    bool _moveUntilTriggered(char axis, float speed_mm_s, long max_distance_steps, unsigned long timeout_ms, int direction);
+    bool _moveUntilTriggered(AxisIndex axis, float speed_mm_s, long max_distance_steps, unsigned long timeout_ms, int direction);
 
     // Helper to move away from endstop for a specified distance
     // direction: -1 or 1, controlling which way to back off
-    bool _moveAwayFromEndstop(char axis, float distance_mm, float speed_mm_s, int direction);
+    bool _moveAwayFromEndstop(AxisIndex axis, float distance_mm, float speed_mm_s, int direction);
+
+    // Calibration helpers: quiet, no LCD updates while the axis moves
+    bool _calibrateSequence(AxisIndex axis, HomingTuning& out);
+    bool _runUntilEndstop(AxisIndex axis, bool stop_state, unsigned long timeout_ms);
+    bool _touch(AxisIndex axis, float speed_mm_s, long max_steps, long& trigger_pos);
+    bool _release(AxisIndex axis, long max_steps, long& release_pos);
+    void _moveAxisToQuiet(AxisIndex axis, long target_steps, float speed_mm_s);
+    uint16_t _measureSettle(AxisIndex axis);
 };
 
 extern Homing homing; // Global instance
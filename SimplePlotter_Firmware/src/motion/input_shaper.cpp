@@ -0,0 +1,59 @@
+// SimplePlotter_Firmware/src/motion/input_shaper.cpp
+
+#include "input_shaper.h"
+
+InputShaper::InputShaper() : _freq(0.0f), _zeta(0.0f), _type(SHAPER_ZV), _count(1) {
+    // Disabled: a single unit impulse passes the reference through
+    _amp[0] = 32768U;
+    _amp[1] = _amp[2] = 0;
+    _delay[0] = _delay[1] = _delay[2] = 0;
+}
+
+bool InputShaper::configure(float freq_hz, float zeta, ShaperType type) {
+    if (freq_hz <= 0.0f) {
+        _freq = 0.0f;
+        _zeta = zeta;
+        _type = type;
+        _count = 1;
+        _amp[0] = 32768U;
+        _delay[0] = 0;
+        return true;
+    }
+    if (zeta < 0.0f || zeta >= 1.0f) return false;
+
+    // Half period of the damped oscillation
+    float half_period_ms = 500.0f / (freq_hz * sqrt(1.0f - zeta * zeta));
+    float k = exp(-zeta * PI / sqrt(1.0f - zeta * zeta));
+    uint8_t count = (type == SHAPER_ZVD) ? 3 : 2;
+    float last_delay_ms = half_period_ms * (count - 1);
+    if (last_delay_ms + 0.5f > INPUT_SHAPING_HISTORY_MS - 1) return false;
+
+    float a[3];
+    if (type == SHAPER_ZVD) {
+        float d = (1.0f + k) * (1.0f + k);
+        a[0] = 1.0f / d;
+        a[1] = 2.0f * k / d;
+        a[2] = k * k / d;
+    } else {
+        a[0] = 1.0f / (1.0f + k);
+        a[1] = k / (1.0f + k);
+        a[2] = 0.0f;
+    }
+
+    // Round the amplitudes, then put the rounding error on the first impulse so the
+    // shaped rate integrates to the same distance as the reference
+    uint16_t sum = 0;
+    for (uint8_t i = 1; i < count; i++) {
+        _amp[i] = (uint16_t)(a[i] * 32768.0f + 0.5f);
+        _delay[i] = (uint8_t)(half_period_ms * i + 0.5f);
+        sum += _amp[i];
+    }
+    _amp[0] = 32768U - sum;
+    _delay[0] = 0;
+
+    _freq = freq_hz;
+    _zeta = zeta;
+    _type = type;
+    _count = count;
+    return true;
+}
@@ -0,0 +1,50 @@
+// SimplePlotter_Firmware/src/motion/input_shaper.h
+
+#ifndef INPUT_SHAPER_H
+#define INPUT_SHAPER_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+static_assert((INPUT_SHAPING_HISTORY_MS & (INPUT_SHAPING_HISTORY_MS - 1)) == 0 && INPUT_SHAPING_HISTORY_MS <= 256,
+              "INPUT_SHAPING_HISTORY_MS must be a power of two <= 256");
+
+enum ShaperType {
+    SHAPER_ZV = 0,  // Two impulses, shortest delay
+    SHAPER_ZVD = 1  // Three impulses, more tolerant of a mistuned frequency
+};
+
+// Input shaper for one axis. The shaped step rate is a weighted sum of past
+// reference step rates: v(t) = sum(A_i * v_ref(t - d_i)). Amplitudes are Q15
+// (they sum to 32768), delays are in history ticks of 1 ms. Frequency 0 = off.
+class InputShaper {
+public:
+    InputShaper();
+
+    // Returns false (and leaves the shaper unchanged) if the delays don't fit the history
+    bool configure(float freq_hz, float zeta, ShaperType type);
+    bool isEnabled() const { return _freq > 0.0f; }
+
+    float frequency() const { return _freq; }
+    float damping() const { return _zeta; }
+    ShaperType type() const { return _type; }
+
+    // history is a ring of INPUT_SHAPING_HISTORY_MS reference rates, head = newest entry
+    uint16_t apply(const uint16_t* history, uint8_t head) const {
+        uint32_t acc = 0;
+        for (uint8_t i = 0; i < _count; i++) {
+            acc += (uint32_t)_amp[i] * history[(uint8_t)(head - _delay[i]) & (INPUT_SHAPING_HISTORY_MS - 1)];
+        }
+        return (uint16_t)(acc >> 15);
+    }
+
+private:
+    float _freq;
+    float _zeta;
+    ShaperType _type;
+    uint8_t _count;    // Number of impulses (1 when disabled)
+    uint16_t _amp[3];  // Q15 impulse amplitudes
+    uint8_t _delay[3]; // Impulse delays in ms
+};
+
+#endif // INPUT_SHAPER_H
@@ -1,6 +1,7 @@
 // SimplePlotter_Firmware/src/motion/kinematics.cpp
 
 #include "kinematics.h"
+#include "../io/settings.h" // Per-axis limits for travel moves
 
 Kinematics kinematics; // Global instance definition
 
@@ -29,3 +30,34 @@ bool Kinematics::isValidPosition(const Point3D& target_mm) {
     
     return true;
 }
+
+float Kinematics::limitAlongVector(float dx, float dy, float dz, float requested,
+                                   float limit_x, float limit_y, float limit_z) {
+    float dist = sqrtf(dx*dx + dy*dy + dz*dz);
+    if (dist < 0.001f) return requested;
+
+    // An axis carrying fraction |d_i|/|d| of the path sees requested * |d_i|/|d|
+    float ax = fabsf(dx), ay = fabsf(dy), az = fabsf(dz);
+    if (ax > 0.0001f) requested = min(requested, limit_x * dist / ax);
+    if (ay > 0.0001f) requested = min(requested, limit_y * dist / ay);
+    if (az > 0.0001f) requested = min(requested, limit_z * dist / az);
+    return requested;
+}
+
+// Travel takes the faster of the X/Y limits; limitAlongVector() then holds each axis
+// to its own, so a pure X or Y travel runs at that axis' measured limit
+float Kinematics::maxPathVelocity(MoveType type) {
+    switch (type) {
+        case MOVE_TRAVEL: return max(settings.data().limits[AXIS_X].max_velocity, settings.data().limits[AXIS_Y].max_velocity);
+        case MOVE_PEN:    return PEN_VELOCITY;
+        default:          return DRAW_VELOCITY;
+    }
+}
+
+float Kinematics::maxPathAcceleration(MoveType type) {
+    switch (type) {
+        case MOVE_TRAVEL: return max(settings.data().limits[AXIS_X].max_accel, settings.data().limits[AXIS_Y].max_accel);
+        case MOVE_PEN:    return PEN_ACCEL;
+        default:          return DRAW_ACCEL;
+    }
+}
@@ -18,6 +18,13 @@ struct Point3D {
     Point3D(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
 };
 
+// Move classification used to pick path velocity/acceleration limits
+enum MoveType {
+    MOVE_TRAVEL, // G0 rapid
+    MOVE_DRAW,   // G1 linear move
+    MOVE_PEN     // Z-only pen lift/lower
+};
+
 class Kinematics {
 public:
     Kinematics();
@@ -40,6 +47,15 @@ public:
 
     // Validate if a target position is within soft limits
     bool isValidPosition(const Point3D& target_mm);
+
+    // Limit a path-space quantity (velocity or acceleration) along the move vector (dx, dy, dz)
+    // so that each axis component stays within its own limit: min(requested, limit_i * |d| / |d_i|)
+    float limitAlongVector(float dx, float dy, float dz, float requested,
+                           float limit_x, float limit_y, float limit_z);
+
+    // Path velocity and acceleration limits for a move type (mm/s, mm/s^2)
+    float maxPathVelocity(MoveType type);
+    float maxPathAcceleration(MoveType type);
     
     // Get machine limits in millimeters
     Point3D getMaxMachineCoords() {
@@ -0,0 +1,142 @@
+// SimplePlotter_Firmware/src/motion/motion_queue.cpp
+
+#include "motion_queue.h"
+#include "stepper_control.h"
+#include "pen.h"
+#include "step_stream.h"
+#include "../io/endstops.h"
+#include "../gcode/latency_trace.h"
+#include "../utils/event_trace.h"
+
+MotionQueue motionQueue; // Global instance definition
+
+MotionQueue::MotionQueue() : _active(false), _penBlock(false), _checkMask(0), _endstopHit('\0'), _traceSeq(0), _traceStartUs(0),
+                             _queuedMs(0), _activeMs(0), _activeStartMs(0), _planEnd{0, 0, 0} {}
+
+// Trapezoid time of the dominant axis, the one StepperControl::beginMove() profiles
+static uint32_t estimateDurationMs(const MotionBlock& block, const long (&start)[3]) {
+    uint8_t dominant = 0;
+    float dist[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        dist[i] = (float)labs(block.target[i] - start[i]);
+        if (dist[i] > dist[dominant]) dominant = i;
+    }
+    float d = dist[dominant], v = block.max_speed[dominant], a = block.accel[dominant];
+    if (d == 0.0f || v <= 0.0f || a <= 0.0f) return 0;
+    float t = (d >= v * v / a) ? d / v + v / a : 2.0f * sqrtf(d / a);
+    return (uint32_t)(t * 1000.0f);
+}
+
+bool MotionQueue::push(const MotionBlock& block) {
+    if (_blocks.isFull()) return false;
+    // Nothing pending: position may have changed outside the queue (homing, G92, jog)
+    if (isIdle()) {
+        for (uint8_t i = 0; i < AXIS_COUNT; i++) _planEnd[i] = stepperControl.getCurrentSteps((AxisIndex)i);
+    }
+    MotionBlock planned = block;
+    if (block.pen != PEN_KEEP) {
+        planned.duration_ms = PEN_SERVO_SETTLE_MS;
+    } else {
+        planned.duration_ms = estimateDurationMs(block, _planEnd);
+        for (uint8_t i = 0; i < 3; i++) _planEnd[i] = block.target[i];
+    }
+    _queuedMs += planned.duration_ms;
+    return _blocks.push(planned);
+}
+
+uint32_t MotionQueue::remainingMs() const {
+    uint32_t remaining = _queuedMs;
+    if (_active) {
+        unsigned long elapsed = millis() - _activeStartMs;
+        if (elapsed < _activeMs) remaining += _activeMs - elapsed;
+    }
+    return remaining;
+}
+
+void MotionQueue::planEnd(long (&steps)[3]) const {
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        steps[i] = isIdle() ? stepperControl.getCurrentSteps((AxisIndex)i) : _planEnd[i];
+    }
+}
+
+bool MotionQueue::_endstopCheck() {
+    uint8_t mask = motionQueue._checkMask;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if ((mask & (1 << i)) && endstops.isTriggered((AxisIndex)i)) return true;
+    }
+    return false;
+}
+
+void MotionQueue::_startNext() {
+    MotionBlock block;
+    if (!_blocks.pop(block)) return;
+    _queuedMs -= block.duration_ms;
+
+    stepStream.recordBlock(block);
+    _checkMask = block.endstop_mask;
+    _endstopHit = '\0';
+    _penBlock = block.pen != PEN_KEEP;
+    if (_penBlock) {
+        // No steps: the servo moves now and the queue holds until it has settled
+        block.duration_ms = pen.set(block.pen == PEN_RAISE);
+    } else {
+        stepperControl.enableSteppers();
+        stepperControl.setMaxSpeed(block.max_speed[0], block.max_speed[1], block.max_speed[2]);
+        stepperControl.setAcceleration(block.accel[0], block.accel[1], block.accel[2]);
+        stepperControl.moveTo(block.target[0], block.target[1], block.target[2]);
+        stepperControl.beginMove(_checkMask ? _endstopCheck : nullptr);
+    }
+    _active = true;
+    _traceSeq = block.trace_seq;
+    _traceStartUs = micros();
+    _activeMs = block.duration_ms;
+    _activeStartMs = millis();
+    TRACE_EVENT(EV_BLOCK_START, _blocks.size());
+}
+
+void MotionQueue::_finishActive() {
+    if (stepperControl.moveStoppedEarly()) {
+        for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+            if ((_checkMask & (1 << i)) && endstops.isTriggered((AxisIndex)i)) {
+                _endstopHit = axisName(i);
+                break;
+            }
+        }
+    }
+    _checkMask = 0;
+    _active = false;
+    if (_blocks.isEmpty()) TRACE_EVENT(EV_QUEUE_EMPTY, 0);
+    if (_traceSeq) {
+        latencyTrace.reportBlock(_traceSeq, _traceStartUs, micros());
+        _traceSeq = 0;
+    }
+}
+
+void MotionQueue::service() {
+    if (!_active) {
+        if (_blocks.isEmpty()) return;
+        _startNext();
+    }
+
+    if (_penBlock) {
+        if (millis() - _activeStartMs < _activeMs) return;
+        _finishActive();
+        return;
+    }
+
+    // The block steps from the Timer4 ISR; this only advances its speed profile
+    if (stepperControl.serviceMove()) return;
+    _finishActive();
+}
+
+void MotionQueue::clear() {
+    MotionBlock dropped;
+    while (_blocks.pop(dropped)) {}
+    _queuedMs = 0;
+    pen.dropQueued();
+    if (_active) {
+        if (!_penBlock) stepperControl.abortMove();
+        _checkMask = 0;
+        _active = false;
+    }
+}
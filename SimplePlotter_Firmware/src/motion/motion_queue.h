@@ -0,0 +1,74 @@
+// SimplePlotter_Firmware/src/motion/motion_queue.h
+
+#ifndef MOTION_QUEUE_H
+#define MOTION_QUEUE_H
+
+#include <Arduino.h>
+#include "../config.h"
+#include "../utils/ringbuffer.h"
+
+// Servo pen change carried by a block (PenActuator, servo backend)
+enum PenChange : uint8_t {
+    PEN_KEEP = 0, // Ordinary move
+    PEN_RAISE,    // No steps: raise the pen and wait for it to settle
+    PEN_LOWER
+};
+
+// One planned linear move. Limits are already projected onto the axes by the planner.
+struct MotionBlock {
+    long target[3];       // Absolute target in steps (X, Y, Z)
+    float max_speed[3];   // steps/s
+    float accel[3];       // steps/s^2
+    uint8_t endstop_mask; // Bit per axis: stop the block if that endstop triggers (jog toward home)
+    uint16_t trace_seq;   // Latency trace sequence of the command that queued it (0 = untraced)
+    uint8_t pen;          // PenChange; anything but PEN_KEEP ignores the fields above
+    uint32_t duration_ms; // Estimated run time, filled in by push()
+};
+
+// FIFO of planned moves executed one after another by StepperControl.
+// service() must be called from loop() at least every few ms; it advances the speed
+// profile of the running block (stepped from the Timer4 ISR) and starts the next one.
+class MotionQueue {
+public:
+    MotionQueue();
+
+    bool push(const MotionBlock& block); // False if the queue is full
+    bool isFull() const { return _blocks.isFull(); }
+    bool isIdle() const { return !_active && _blocks.isEmpty(); }
+    int size() const { return _blocks.size() + (_active ? 1 : 0); }
+    int freeSlots() const { return MOTION_QUEUE_SIZE - _blocks.size(); }
+
+    // Estimated time until the queue drains: the running block's remainder plus every
+    // queued block's trapezoid time. Basis of the job ETA (job_eta.h).
+    uint32_t remainingMs() const;
+
+    // Where the axes will be once every queued block has run (steps)
+    void planEnd(long (&steps)[3]) const;
+
+    void service();
+    void clear(); // Quickstop: abort the running block and drop the rest
+
+    // Axis whose endstop stopped the last finished block early, '\0' otherwise
+    char endstopHit() const { return _endstopHit; }
+
+private:
+    RingBuffer<MotionBlock, MOTION_QUEUE_SIZE> _blocks;
+    bool _active;       // A block has been handed to StepperControl (or the pen)
+    bool _penBlock;     // The active block is a pen change, waiting out _activeMs
+    uint8_t _checkMask; // endstop_mask of the running block
+    char _endstopHit;
+    uint16_t _traceSeq;       // trace_seq of the running block
+    uint32_t _traceStartUs;   // When it started
+    uint32_t _queuedMs;       // Sum of duration_ms over _blocks
+    uint32_t _activeMs;       // duration_ms of the running block
+    unsigned long _activeStartMs;
+    long _planEnd[3];         // Target of the last pushed block (start of the next one)
+
+    void _startNext();
+    void _finishActive();
+    static bool _endstopCheck();
+};
+
+extern MotionQueue motionQueue; // Global instance
+
+#endif // MOTION_QUEUE_H
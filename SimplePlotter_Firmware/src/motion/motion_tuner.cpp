@@ -0,0 +1,131 @@
+// SimplePlotter_Firmware/src/motion/motion_tuner.cpp
+
+#include "motion_tuner.h"
+#include <avr/wdt.h>
+#include "motion_queue.h"
+#include "stepper_control.h"
+#include "homing.h"
+#include "../io/serial_handler.h"
+#include "../ui/lcd_menu.h" // menuUpdateDisplay() between strokes
+
+MotionTuner motionTuner; // Global instance definition
+
+MotionTuner::MotionTuner() : _axis(AXIS_X), _checkPos(0), _farPos(0), _baseline(0), _aborted(false) {}
+
+bool MotionTuner::tuneAxis(AxisIndex axis, AxisLimits& out) {
+    _axis = axis;
+    _aborted = false;
+    const AxisConfig& cfg = axisConfig[axis];
+    float velocity_ceiling = (float)MAX_STEP_RATE_HZ / cfg.steps_per_mm;
+    if (!_prepare()) return false;
+
+    // Acceleration first, at a moderate velocity so the strokes are mostly ramps; then
+    // velocity at the acceleration that will actually be stored
+    float best_accel = _search(AUTOTUNE_ACCEL_START, AUTOTUNE_ACCEL_MAX, true,
+                               min((float)AUTOTUNE_VELOCITY_START, velocity_ceiling));
+    if (best_accel == 0.0f) return false;
+    float accel = best_accel * AUTOTUNE_SAFETY_FACTOR;
+    float best_velocity = _search(AUTOTUNE_VELOCITY_START, velocity_ceiling, false, accel);
+    if (best_velocity == 0.0f) return false;
+
+    out.max_accel = accel;
+    out.max_velocity = best_velocity * AUTOTUNE_SAFETY_FACTOR;
+    return true;
+}
+
+// Raises one limit by AUTOTUNE_STEP_FACTOR until a level loses steps or the ceiling has
+// passed. Returns the last passing level (0 = none); re-homes after a loss.
+float MotionTuner::_search(float start, float ceiling, bool accel_phase, float other) {
+    float best = 0.0f;
+    float level = min(start, ceiling);
+    while (true) {
+        if (!_runLevel(accel_phase ? level : other, accel_phase ? other : level)) {
+            if (_aborted || !_prepare()) return 0.0f;
+            break;
+        }
+        best = level;
+        if (level >= ceiling) break;
+        level = min(level * (float)AUTOTUNE_STEP_FACTOR, ceiling);
+    }
+    return best;
+}
+
+bool MotionTuner::_prepare() {
+    const AxisConfig& cfg = axisConfig[_axis];
+    if (!homing.homeAxis(_axis)) return false;
+
+    long home = (cfg.home_dir == 1) ? axisMmToSteps(_axis, cfg.max_pos) : 0;
+    float span = min((float)AUTOTUNE_SPAN_MM, cfg.max_pos - 2.0f * AUTOTUNE_CHECK_MM);
+    _checkPos = home - cfg.home_dir * axisMmToSteps(_axis, AUTOTUNE_CHECK_MM);
+    _farPos = _checkPos - cfg.home_dir * axisMmToSteps(_axis, span);
+    if (!_touch(_baseline)) {
+        if (_aborted) return false;
+        serialHandler.sendError(ERR_HOMING_FAILED, F("M172: endstop not reached after homing"));
+        return false;
+    }
+    return true;
+}
+
+bool MotionTuner::_runLevel(float accel, float velocity) {
+    for (uint8_t n = 0; n < AUTOTUNE_STROKES; n++) {
+        if (!_moveTo(_farPos, velocity, accel) || !_moveTo(_checkPos, velocity, accel)) return false;
+        menuUpdateDisplay();
+    }
+    long trigger = 0;
+    bool reached = _touch(trigger);
+    if (_aborted) return false;
+    float drift_mm = labs(trigger - _baseline) / axisConfig[_axis].steps_per_mm;
+    bool ok = reached && drift_mm <= AUTOTUNE_LOSS_MM;
+
+    char buf[72], accel_str[8], velocity_str[8], drift_str[8];
+    dtostrf(accel, 1, 0, accel_str);
+    dtostrf(velocity, 1, 1, velocity_str);
+    dtostrf(drift_mm, 1, 3, drift_str);
+    if (reached) {
+        snprintf_P(buf, sizeof(buf), PSTR("M172 %c: A%s V%s drift %smm %S"),
+                   axisName(_axis), accel_str, velocity_str, drift_str, ok ? PSTR("ok") : PSTR("LOST STEPS"));
+    } else {
+        snprintf_P(buf, sizeof(buf), PSTR("M172 %c: A%s V%s endstop missed, LOST STEPS"),
+                   axisName(_axis), accel_str, velocity_str);
+    }
+    serialHandler.sendInfo(buf);
+    return ok;
+}
+
+// Slow touch from _checkPos, then back to _checkPos. Lost steps shift the trigger
+// position by exactly the steps lost; more than 3x the check distance away is a miss.
+bool MotionTuner::_touch(long& trigger_pos) {
+    const AxisConfig& cfg = axisConfig[_axis];
+    float accel = cfg.max_accel * HOMING_ACCEL_FACTOR;
+    if (!_moveTo(_checkPos, HOMING_FEEDRATE_FAST, accel)) return false;
+    delay(settings.data().homing[_axis].settle_ms);
+    bool reached = homing.touchEndstop(_axis, axisMmToSteps(_axis, AUTOTUNE_CHECK_MM * 3.0f), trigger_pos);
+    return _moveTo(_checkPos, HOMING_FEEDRATE_FAST, accel) && reached;
+}
+
+// One single-axis block through the motion queue; blocks until it has run. Serial input
+// is read meanwhile so a quickstop can end it; false once one has (the block is dropped).
+bool MotionTuner::_moveTo(long target_steps, float velocity, float accel) {
+    const AxisConfig& cfg = axisConfig[_axis];
+    MotionBlock block;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        block.target[i] = stepperControl.getCurrentSteps((AxisIndex)i);
+        block.max_speed[i] = 0.0f;
+        block.accel[i] = 0.0f;
+    }
+    block.target[_axis] = target_steps;
+    block.max_speed[_axis] = velocity * cfg.steps_per_mm;
+    block.accel[_axis] = accel * cfg.steps_per_mm;
+    block.endstop_mask = 0;
+    block.trace_seq = 0;
+    block.pen = PEN_KEEP;
+
+    if (_aborted) return false;
+    motionQueue.push(block);
+    while (!motionQueue.isIdle()) {
+        wdt_reset();
+        serialHandler.handleSerialInput();
+        motionQueue.service();
+    }
+    return !_aborted;
+}
@@ -0,0 +1,46 @@
+// SimplePlotter_Firmware/src/motion/motion_tuner.h
+
+#ifndef MOTION_TUNER_H
+#define MOTION_TUNER_H
+
+#include <Arduino.h>
+#include "../config.h"
+#include "axis.h"
+#include "../io/settings.h" // AxisLimits
+
+// Motion-limit auto-tune (M172). Strokes the axis back and forth through the motion
+// queue, so the test uses the same step generator as real moves, first at rising
+// acceleration and then at rising velocity. After every level the endstop is touched
+// slowly; a trigger position that drifted from the post-homing baseline by more than
+// AUTOTUNE_LOSS_MM means the level lost steps.
+class MotionTuner {
+public:
+    MotionTuner();
+
+    // Homes the axis, searches, and fills `out` with the highest passing levels times
+    // AUTOTUNE_SAFETY_FACTOR. False (out untouched) if even the first level loses steps
+    // or homing fails. On success the axis is homed and parked near its switch.
+    bool tuneAxis(AxisIndex axis, AxisLimits& out);
+
+    // Quickstop (0x18 or M410, read between strokes): the running tune returns false at
+    // once, without re-homing. aborted() tells that apart from a failed search.
+    void abort() { _aborted = true; }
+    bool aborted() const { return _aborted; }
+
+private:
+    AxisIndex _axis;
+    long _checkPos; // Steps, AUTOTUNE_CHECK_MM off the switch; strokes start and end here
+    long _farPos;   // Other end of the strokes
+    long _baseline; // Trigger position measured right after homing
+    bool _aborted;
+
+    bool _prepare(); // Home, park at _checkPos, measure the baseline
+    float _search(float start, float ceiling, bool accel_phase, float other);
+    bool _runLevel(float accel, float velocity);
+    bool _touch(long& trigger_pos);
+    bool _moveTo(long target_steps, float velocity, float accel);
+};
+
+extern MotionTuner motionTuner; // Global instance
+
+#endif // MOTION_TUNER_H
@@ -0,0 +1,61 @@
+// SimplePlotter_Firmware/src/motion/pen.cpp
+
+#include "pen.h"
+#include <avr/wdt.h>
+#include "stepper_control.h"
+#include "../ui/screens.h" // pen_up_z / pen_down_z
+
+PenActuator pen; // Global instance definition
+
+PenActuator::PenActuator() : _up(true), _queuedUp(true) {}
+
+bool PenActuator::isUpHeight(float z_mm) {
+    return z_mm >= (pen_up_z + pen_down_z) * 0.5f;
+}
+
+#if PEN_BACKEND == PEN_BACKEND_SERVO
+
+#define SERVO_TICKS_PER_US (F_CPU / 8 / 1000000UL) // Timer1 at clk/8
+#define SERVO_PERIOD_TICKS (F_CPU / 8 / 50)        // 20 ms frame
+
+static_assert(PEN_SERVO_PIN == 11, "Servo PWM is wired to OC1A (Mega pin 11)");
+static_assert(PEN_SERVO_UP_DEG <= 180 && PEN_SERVO_DOWN_DEG <= 180, "Servo angles are 0-180 degrees");
+
+static uint16_t angleToTicks(uint8_t deg) {
+    uint32_t us = PEN_SERVO_MIN_US + (uint32_t)(PEN_SERVO_MAX_US - PEN_SERVO_MIN_US) * deg / 180;
+    return (uint16_t)(us * SERVO_TICKS_PER_US);
+}
+
+void PenActuator::init() {
+    // Fast PWM with TOP = ICR1 (mode 14), non-inverting on OC1A
+    pinMode(PEN_SERVO_PIN, OUTPUT);
+    TCCR1A = _BV(COM1A1) | _BV(WGM11);
+    TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS11);
+    ICR1 = SERVO_PERIOD_TICKS - 1;
+    OCR1A = angleToTicks(PEN_SERVO_UP_DEG);
+    _up = _queuedUp = true;
+}
+
+uint16_t PenActuator::set(bool up) {
+    // OCR1A is double-buffered: the new width starts with the next 20 ms frame
+    OCR1A = angleToTicks(up ? PEN_SERVO_UP_DEG : PEN_SERVO_DOWN_DEG);
+    bool changed = up != _up;
+    _up = up;
+    return changed ? PEN_SERVO_SETTLE_MS : 0;
+}
+
+#else // PEN_BACKEND_Z_STEPPER
+
+void PenActuator::init() {}
+
+uint16_t PenActuator::set(bool up) {
+    stepperControl.enableSteppers();
+    stepperControl.setAxisMaxSpeed(AXIS_Z, AxisTraits<AXIS_Z>::MAX_SPEED_STEPS);
+    stepperControl.setAxisAcceleration(AXIS_Z, AxisTraits<AXIS_Z>::MAX_ACCEL_STEPS);
+    stepperControl.moveAxisTo(AXIS_Z, (long)((up ? pen_up_z : pen_down_z) * Z_STEPS_PER_MM));
+    while (stepperControl.runAxis(AXIS_Z)) { wdt_reset(); }
+    _up = _queuedUp = up;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,47 @@
+// SimplePlotter_Firmware/src/motion/pen.h
+
+#ifndef PEN_H
+#define PEN_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+#if PEN_BACKEND != PEN_BACKEND_Z_STEPPER && PEN_BACKEND != PEN_BACKEND_SERVO
+#error "Unknown PEN_BACKEND"
+#endif
+
+// Pen lift, with the backend fixed at build time by PEN_BACKEND:
+//  - Z_STEPPER: the pen height is the Z axis. G-code Z moves are ordinary queued moves
+//    and set() is a blocking Z move (LCD pen test).
+//  - SERVO: Timer1 drives PEN_SERVO_PIN with a 50 Hz hardware PWM pulse, so the pulse
+//    has no interrupt jitter. The executor turns a Z change into a pen block; the motion
+//    queue calls set() when the block comes up and waits PEN_SERVO_SETTLE_MS.
+class PenActuator {
+public:
+    static constexpr bool USES_Z_AXIS = (PEN_BACKEND == PEN_BACKEND_Z_STEPPER);
+
+    PenActuator();
+
+    void init(); // Servo: start the PWM with the pen up
+
+    // Move the pen now. Returns how long motion must wait before the pen is there (ms);
+    // the Z-stepper backend returns once the move has finished.
+    uint16_t set(bool up);
+    bool isUp() const { return _up; }
+
+    // Logical Z height -> up/down, split halfway between pen_up_z and pen_down_z
+    static bool isUpHeight(float z_mm);
+
+    // State after every queued pen block has run (servo backend)
+    bool isQueuedUp() const { return _queuedUp; }
+    void setQueued(bool up) { _queuedUp = up; }
+    void dropQueued() { _queuedUp = _up; } // Motion queue cleared
+
+private:
+    bool _up;
+    bool _queuedUp;
+};
+
+extern PenActuator pen; // Global instance
+
+#endif // PEN_H
@@ -0,0 +1,297 @@
+// SimplePlotter_Firmware/src/motion/step_stream.cpp
+
+#include "step_stream.h"
+#include <util/crc16.h>
+#include "stepper_control.h"
+#include "homing.h"
+#include "pen.h"
+#include "../io/sd_card.h"
+#include "../io/serial_handler.h"
+#include "../io/settings.h"
+#include "../gcode/executor.h" // syncPositionFromSteps()
+
+StepStream stepStream; // Global instance definition
+
+static const char STREAM_MAGIC[4] = {'S', 'P', 'S', '2'};
+
+// What the steps depend on besides the blocks: a replay refuses a stream whose
+// machine differs from the current one
+struct StreamMachine {
+    float steps_per_mm[3];
+    float max_velocity[3]; // Speed/accel limits (M503) the blocks were planned within
+    float max_accel[3];
+    float shaper_freq[2];  // M593, X and Y; 0 = off
+    float shaper_zeta[2];
+    uint8_t shaper_type[2];
+};
+
+struct StreamHeader {
+    char magic[4];
+    StreamMachine machine;
+    int32_t start[3];
+};
+
+static void currentMachine(StreamMachine& m) {
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        m.steps_per_mm[i] = axisConfig[i].steps_per_mm;
+        m.max_velocity[i] = settings.data().limits[i].max_velocity;
+        m.max_accel[i] = settings.data().limits[i].max_accel;
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        const InputShaper& shaper = stepperControl.getInputShaper(i == 0 ? 'X' : 'Y');
+        m.shaper_freq[i] = shaper.frequency();
+        m.shaper_zeta[i] = shaper.damping();
+        m.shaper_type[i] = shaper.type();
+    }
+}
+
+// CRC-16 of the current machine, to notice a change while recording without a copy in RAM
+static uint16_t machineCrc() {
+    StreamMachine m;
+    currentMachine(m);
+    const uint8_t* p = (const uint8_t*)&m;
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < sizeof(m); i++) crc = _crc16_update(crc, p[i]);
+    return crc;
+}
+
+struct StreamAxis {
+    int32_t target;
+    float max_speed;
+    float accel;
+};
+
+static_assert(sizeof(StreamAxis) * 3 + 1 == StepStream::RECORD_MAX, "Record layout changed");
+static_assert(StepStream::RECORD_MAX == HOST_FRAME_RECORD_MAX, "Host frames carry step stream records");
+
+StepStream::StepStream() : _recording(false), _replaying(false), _blocks(0), _last{0, 0, 0}, _machineCrc(0) {}
+
+bool StepStream::isStreamFile(const char* filename) {
+    const char* dot = strrchr(filename, '.');
+    return dot && strcasecmp_P(dot, PSTR(".stp")) == 0;
+}
+
+//===========================================================================
+// Recording
+//===========================================================================
+
+bool StepStream::startRecording(const char* filename) {
+    if (_recording) stopRecording();
+
+    if (!isStreamFile(filename)) {
+        serialHandler.sendError(ERR_INVALID_SYNTAX, F("M930: file name must end in .stp"));
+        return false;
+    }
+    if (!sdCard.isInitialized() && !sdCard.init()) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M930: no SD card"));
+        return false;
+    }
+    if (!sdWriter.claim(F("M930"))) return false;
+    if (!sdWriter.file.open(filename, O_WRONLY | O_CREAT | O_TRUNC)) {
+        sdWriter.release();
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M930: cannot create file"));
+        return false;
+    }
+
+    StreamHeader header;
+    memcpy(header.magic, STREAM_MAGIC, sizeof(header.magic));
+    currentMachine(header.machine);
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        header.start[i] = _last[i] = stepperControl.getCurrentSteps((AxisIndex)i);
+    }
+    _machineCrc = machineCrc();
+    _recording = true;
+    _blocks = 0;
+    _write(&header, sizeof(header));
+    if (!_recording) return false;
+
+    char msg[48];
+    snprintf_P(msg, sizeof(msg), PSTR("M930: recording steps to %s"), filename);
+    serialHandler.sendInfo(msg);
+    return true;
+}
+
+void StepStream::stopRecording() {
+    if (!_recording) return;
+    sdWriter.file.close();
+    sdWriter.release();
+    _recording = false;
+
+    char msg[48];
+    snprintf_P(msg, sizeof(msg), PSTR("M931: step stream closed, %lu blocks"), _blocks);
+    serialHandler.sendInfo(msg);
+}
+
+// A failed write ends the recording: a stream with a hole in it must not be replayed
+void StepStream::_write(const void* data, uint8_t len) {
+    if (sdWriter.file.write(data, len) == len) return;
+    sdWriter.file.close();
+    sdWriter.release();
+    _recording = false;
+    serialHandler.sendError(ERR_OUT_OF_RANGE, F("M930: SD write failed, recording stopped"));
+}
+
+uint8_t StepStream::recordSize(uint8_t flags) {
+    uint8_t size = 1;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (flags & (1 << i)) size += sizeof(StreamAxis);
+    }
+    return size;
+}
+
+uint8_t StepStream::encodeRecord(const MotionBlock& block, const long (&prev)[3], uint8_t* record) {
+    if (block.pen != PEN_KEEP) {
+        record[0] = block.pen << 3;
+        return 1;
+    }
+    uint8_t flags = (block.endstop_mask & 0x07) << 5;
+    uint8_t size = 1;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (block.target[i] == prev[i]) continue;
+        flags |= 1 << i;
+        StreamAxis axis = {(int32_t)block.target[i], block.max_speed[i], block.accel[i]};
+        memcpy(record + size, &axis, sizeof(axis));
+        size += sizeof(axis);
+    }
+    if (size == 1) return 0; // No steps
+    record[0] = flags;
+    return size;
+}
+
+bool StepStream::decodeRecord(const uint8_t* record, const long (&prev)[3], MotionBlock& block) {
+    uint8_t flags = record[0];
+    block.pen = (flags >> 3) & 0x03;
+    block.endstop_mask = flags >> 5;
+    block.trace_seq = 0;
+    const uint8_t* p = record + 1;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        block.target[i] = prev[i];
+        block.max_speed[i] = 0.0f;
+        block.accel[i] = 0.0f;
+        if (!(flags & (1 << i))) continue;
+        StreamAxis axis;
+        memcpy(&axis, p, sizeof(axis));
+        p += sizeof(axis);
+        block.target[i] = axis.target;
+        block.max_speed[i] = axis.max_speed;
+        block.accel[i] = axis.accel;
+    }
+    return block.pen <= PEN_LOWER && (block.pen == PEN_KEEP || (flags & 0x07) == 0);
+}
+
+void StepStream::recordBlock(const MotionBlock& block) {
+    if (!_recording) return;
+
+    // Homing, G92 or a jog moved the axes outside the queue; a replay can't repeat that
+    for (uint8_t i = 0; i < AXIS_COUNT && block.pen == PEN_KEEP; i++) {
+        if (stepperControl.getCurrentSteps((AxisIndex)i) != _last[i]) {
+            serialHandler.sendError(ERR_OUT_OF_RANGE, F("M930: position changed outside the motion queue, recording stopped"));
+            stopRecording();
+            return;
+        }
+    }
+    // The header holds the limits and shaping the recording started with
+    if (machineCrc() != _machineCrc) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("M930: speed/accel limits or input shaping changed, recording stopped"));
+        stopRecording();
+        return;
+    }
+
+    // The write happens between blocks, so it can't stall a move; SdFat only goes to
+    // the card when its sector cache is full
+    uint8_t record[RECORD_MAX];
+    uint8_t size = encodeRecord(block, _last, record);
+    if (size == 0) return;
+    _write(record, size);
+    if (block.pen == PEN_KEEP) {
+        for (uint8_t i = 0; i < AXIS_COUNT; i++) _last[i] = block.target[i];
+    }
+    _blocks++;
+}
+
+//===========================================================================
+// Replay
+//===========================================================================
+
+bool StepStream::prepareJob(const char* filename) {
+    _replaying = false;
+    if (!isStreamFile(filename)) return true;
+
+    StreamHeader header;
+    if (sdCard.read(&header, sizeof(header)) != (int)sizeof(header) ||
+        memcmp(header.magic, STREAM_MAGIC, sizeof(header.magic)) != 0) {
+        serialHandler.sendError(ERR_INVALID_SYNTAX, F("Step stream: bad header"));
+        return false;
+    }
+    StreamMachine m;
+    currentMachine(m);
+    if (memcmp(header.machine.steps_per_mm, m.steps_per_mm, sizeof(m.steps_per_mm)) != 0) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Step stream: recorded with another machine profile"));
+        return false;
+    }
+    if (memcmp(header.machine.max_velocity, m.max_velocity, sizeof(m.max_velocity)) != 0 ||
+        memcmp(header.machine.max_accel, m.max_accel, sizeof(m.max_accel)) != 0) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Step stream: recorded with other speed/accel limits (M503)"));
+        return false;
+    }
+    if (memcmp(header.machine.shaper_freq, m.shaper_freq, sizeof(m.shaper_freq)) != 0 ||
+        memcmp(header.machine.shaper_zeta, m.shaper_zeta, sizeof(m.shaper_zeta)) != 0 ||
+        memcmp(header.machine.shaper_type, m.shaper_type, sizeof(m.shaper_type)) != 0) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Step stream: recorded with other input shaping (M593)"));
+        return false;
+    }
+    if (!homing.isHomed()) {
+        serialHandler.sendError(ERR_NOT_HOMED, F("Step stream: home all axes first"));
+        return false;
+    }
+    if (!motionQueue.isIdle()) {
+        serialHandler.sendError(ERR_OUT_OF_RANGE, F("Step stream: machine is still moving"));
+        return false;
+    }
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (stepperControl.getCurrentSteps((AxisIndex)i) != header.start[i]) {
+            char msg[64], x[10], y[10], z[10];
+            dtostrf(header.start[AXIS_X] / axisConfig[AXIS_X].steps_per_mm, 1, 2, x);
+            dtostrf(header.start[AXIS_Y] / axisConfig[AXIS_Y].steps_per_mm, 1, 2, y);
+            dtostrf(header.start[AXIS_Z] / axisConfig[AXIS_Z].steps_per_mm, 1, 2, z);
+            snprintf_P(msg, sizeof(msg), PSTR("Step stream: starts at X%s Y%s Z%s, move there first"), x, y, z);
+            serialHandler.sendError(ERR_OUT_OF_RANGE, msg);
+            return false;
+        }
+    }
+
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) _last[i] = header.start[i];
+    _blocks = 0;
+    _replaying = true;
+    return true;
+}
+
+bool StepStream::feed() {
+    while (!motionQueue.isFull()) {
+        uint8_t record[RECORD_MAX];
+        int n = sdCard.read(record, 1);
+        if (n == 0) return false; // End of the stream
+
+        uint8_t rest = (n == 1) ? recordSize(record[0]) - 1 : 0;
+        MotionBlock block;
+        if (n != 1 || sdCard.read(record + 1, rest) != rest || !decodeRecord(record, _last, block)) {
+            serialHandler.sendError(ERR_INVALID_SYNTAX, F("Step stream: damaged record, replay stopped"));
+            return false;
+        }
+
+        motionQueue.push(block);
+        if (block.pen != PEN_KEEP) {
+            pen.setQueued(block.pen == PEN_RAISE);
+        } else {
+            for (uint8_t i = 0; i < AXIS_COUNT; i++) _last[i] = block.target[i];
+        }
+        _blocks++;
+    }
+    return true;
+}
+
+void StepStream::service() {
+    if (!_replaying || sdCard.isFileOpen() || !motionQueue.isIdle()) return;
+    _replaying = false;
+    syncPositionFromSteps();
+}
@@ -0,0 +1,78 @@
+// SimplePlotter_Firmware/src/motion/step_stream.h
+
+#ifndef STEP_STREAM_H
+#define STEP_STREAM_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include "../config.h"
+#include "motion_queue.h"
+
+// Recorded step stream (.stp): the blocks exactly as the motion queue handed them to
+// StepperControl. A replay pushes them straight back into the queue, skipping parsing,
+// kinematics, speed factor, height map and planning. StepperControl derives the step
+// timing of a block from its targets, speeds and accelerations alone, so every replay
+// steps the same way.
+//
+// File layout (little-endian):
+//   header: "SPS2", float steps_per_mm[3], float max_velocity[3], float max_accel[3],
+//           float shaper_freq[2], float shaper_zeta[2], uint8 shaper_type[2] (X, Y),
+//           int32 start_steps[3]
+//   record: uint8 flags: bits 0-2 axes whose target changed, bits 3-4 PenChange,
+//                        bits 5-7 endstop_mask
+//           per changed axis, X first: int32 target, float max_speed, float accel
+// Targets are absolute, so a checked jog that stopped early doesn't shift the rest.
+// Host-planned blocks (M932) arrive in the same record layout.
+class StepStream {
+public:
+    static constexpr uint8_t RECORD_MAX = 1 + 3 * 12; // Flags + all three axes
+
+    StepStream();
+
+    // M930/M931. The motion queue must be idle when recording starts: its position is
+    // the stream's start. Both send their own errors and summaries.
+    bool startRecording(const char* filename);
+    void stopRecording();
+    bool isRecording() const { return _recording; }
+
+    // MotionQueue: block is about to be handed to StepperControl
+    void recordBlock(const MotionBlock& block);
+
+    // After an SD job's file was opened: a step stream is validated and switches the
+    // job to replay; any other file stays a G-code job. False (error sent) when the
+    // stream can't run here: other machine profile, axes not homed, wrong start point.
+    bool prepareJob(const char* filename);
+    bool isReplaying() const { return _replaying; }
+
+    // Replay: fill the motion queue from the file. False at the end of the file or on
+    // a damaged record (error sent).
+    bool feed();
+
+    // Call from loop(): once a replay has ended and its last block has run, the
+    // logical position is resynced (the executor never saw these moves)
+    void service();
+
+    static bool isStreamFile(const char* filename);
+
+    // Record bytes, flags byte included, for a record starting with flags
+    static uint8_t recordSize(uint8_t flags);
+    // Block -> record; axes whose target equals prev are left out. Returns the size,
+    // 0 for a motion block without steps.
+    static uint8_t encodeRecord(const MotionBlock& block, const long (&prev)[3], uint8_t* record);
+    // Record -> block; axes the record leaves out keep their target from prev.
+    // False for an invalid pen change.
+    static bool decodeRecord(const uint8_t* record, const long (&prev)[3], MotionBlock& block);
+
+private:
+    bool _recording;
+    bool _replaying;
+    unsigned long _blocks;
+    long _last[3]; // Target of the previous record (start point for the first)
+    uint16_t _machineCrc; // Limits and shaping in the header being recorded
+
+    void _write(const void* data, uint8_t len);
+};
+
+extern StepStream stepStream; // Global instance
+
+#endif // STEP_STREAM_H
@@ -2,422 +2,607 @@
 
 #include "stepper_control.h"
 #include <avr/wdt.h>
+#include <util/atomic.h>
+#include "homing.h"          // For soft limits of homed axes while jogging
+#include "../io/endstops.h" // For interrupt-latched endstops while jogging
+#include "../io/position_trust.h" // Saved position stops being trusted once anything changes
 
 StepperControl stepperControl; // Global instance definition
 
+// Move step timer: Timer4 at clk/8. The ISR wakes at least every ms so profile changes
+// are picked up, and never sooner than STEP_TICK_MIN_COUNTS after the previous wake.
+#define STEP_TIMER_HZ           (F_CPU / 8)
+#define STEP_TICK_MAX_COUNTS    (STEP_TIMER_HZ / 1000)
+#define STEP_TICK_MIN_COUNTS    20    // 10 us
+#define STEP_PULSE_COUNTS       4     // 2 us high, above the A4988/DRV8825 minimum
+
+static const uint8_t move_dir_pin[AXIS_COUNT] = {
+    AxisTraits<AXIS_X>::DIR_PIN, AxisTraits<AXIS_Y>::DIR_PIN, AxisTraits<AXIS_Z>::DIR_PIN
+};
+static const bool move_dir_invert[AXIS_COUNT] = {
+    AxisTraits<AXIS_X>::INVERT_DIR, AxisTraits<AXIS_Y>::INVERT_DIR, AxisTraits<AXIS_Z>::INVERT_DIR
+};
+
 StepperControl::StepperControl() :
-    _stepperX(DRIVER_TYPE, X_STEP_PIN, X_DIR_PIN),
-    _stepperY(DRIVER_TYPE, Y_STEP_PIN, Y_DIR_PIN),
-    _stepperZ(DRIVER_TYPE, Z_STEP_PIN, Z_DIR_PIN),
-    _steppers_are_disabled(true) // Initialize as disabled
+    _steppers{
+        AccelStepper(DRIVER_TYPE, AxisTraits<AXIS_X>::STEP_PIN, AxisTraits<AXIS_X>::DIR_PIN),
+        AccelStepper(DRIVER_TYPE, AxisTraits<AXIS_Y>::STEP_PIN, AxisTraits<AXIS_Y>::DIR_PIN),
+        AccelStepper(DRIVER_TYPE, AxisTraits<AXIS_Z>::STEP_PIN, AxisTraits<AXIS_Z>::DIR_PIN)
+    },
+    _steppers_are_disabled(true), // Initialize as disabled
+    _accel{
+        AxisTraits<AXIS_X>::MAX_ACCEL_STEPS,
+        AxisTraits<AXIS_Y>::MAX_ACCEL_STEPS,
+        AxisTraits<AXIS_Z>::MAX_ACCEL_STEPS
+    },
+    _moving(false),
+    _moveStoppedEarly(false),
+    _moveShouldStop(nullptr),
+    _tickClock(0),
+    _tickPeriod(STEP_TICK_MIN_COUNTS),
+    _shapeHead(0),
+    _jogging(false),
+    _jogLastCommand(0),
+    _jogLastUpdate(0)
 {
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        _jogDir[i] = 0;
+        _jogBlocked[i] = 0;
+        _jogTarget[i] = 0.0f;
+        _jogSpeed[i] = 0.0f;
+        _jogMin[i] = 0;
+        _jogMax[i] = 0;
+        _tickPos[i] = 0;
+        _tickLeft[i] = 0;
+        _tickDir[i] = 0;
+        _tickInterval[i] = 0;
+        _tickLast[i] = 0;
+        _stepPort[i] = nullptr;
+        _stepMask[i] = 0;
+    }
+    _shaperX.configure(INPUT_SHAPING_FREQ_X, INPUT_SHAPING_ZETA_X, INPUT_SHAPING_TYPE);
+    _shaperY.configure(INPUT_SHAPING_FREQ_Y, INPUT_SHAPING_ZETA_Y, INPUT_SHAPING_TYPE);
     // Steppers are initialized, but further setup is done in init()
 }
 
-void StepperControl::init() {
-    _stepperX.setEnablePin(X_ENABLE_PIN);
-    _stepperY.setEnablePin(Y_ENABLE_PIN);
-    _stepperZ.setEnablePin(Z_ENABLE_PIN);
-
+template<uint8_t A> void StepperControl::_initAxis() {
+    _steppers[A].setEnablePin(AxisTraits<A>::ENABLE_PIN);
     // setPinsInverted(directionInvert, stepInvert, enableInvert)
     // Enable is active-LOW on MKS Gen v1.4 (HIGH disables), so enableInvert=true
     // Direction inversion configured in config.h per axis
-    _stepperX.setPinsInverted(INVERT_X_DIR, false, true);
-    _stepperY.setPinsInverted(INVERT_Y_DIR, false, true);
-    _stepperZ.setPinsInverted(INVERT_Z_DIR, false, true);
+    _steppers[A].setPinsInverted(AxisTraits<A>::INVERT_DIR, false, true);
+    // The move ISR drives step and direction itself (AccelStepper sets the pin modes)
+    _stepPort[A] = portOutputRegister(digitalPinToPort(AxisTraits<A>::STEP_PIN));
+    _stepMask[A] = digitalPinToBitMask(AxisTraits<A>::STEP_PIN);
+}
+
+void StepperControl::init() {
+    _initAxis<AXIS_X>();
+    _initAxis<AXIS_Y>();
+    _initAxis<AXIS_Z>();
 
     // Set initial maximum speeds and accelerations from config
-    setMaxSpeed(MAX_VELOCITY_XY * X_STEPS_PER_MM,
-                MAX_VELOCITY_XY * Y_STEPS_PER_MM,
-                MAX_VELOCITY_Z * Z_STEPS_PER_MM);
-    setAcceleration(MAX_ACCEL_X * X_STEPS_PER_MM,
-                    MAX_ACCEL_Y * Y_STEPS_PER_MM,
-                    MAX_ACCEL_Z * Z_STEPS_PER_MM);
+    setMaxSpeed(AxisTraits<AXIS_X>::MAX_SPEED_STEPS,
+                AxisTraits<AXIS_Y>::MAX_SPEED_STEPS,
+                AxisTraits<AXIS_Z>::MAX_SPEED_STEPS);
+    setAcceleration(AxisTraits<AXIS_X>::MAX_ACCEL_STEPS,
+                    AxisTraits<AXIS_Y>::MAX_ACCEL_STEPS,
+                    AxisTraits<AXIS_Z>::MAX_ACCEL_STEPS);
 
     disableSteppers(); // Start with steppers disabled
 }
 
 void StepperControl::enableSteppers() {
-    _stepperX.enableOutputs();
-    _stepperY.enableOutputs();
-    _stepperZ.enableOutputs();
+    positionTrust.invalidate();
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) _steppers[i].enableOutputs();
     _steppers_are_disabled = false;
 }
 
 void StepperControl::disableSteppers() {
-    _stepperX.disableOutputs();
-    _stepperY.disableOutputs();
-    _stepperZ.disableOutputs();
+    positionTrust.invalidate(); // M84 and the idle timeout save again afterwards
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) _steppers[i].disableOutputs();
     _steppers_are_disabled = true;
 }
 
 void StepperControl::setMaxSpeed(float x_steps_per_s, float y_steps_per_s, float z_steps_per_s) {
     // Guard against zero — AccelStepper::setMaxSpeed(0) causes division by zero internally.
     // Skip updating an axis if speed is zero (axis doesn't move, keeps previous safe value).
-    if (x_steps_per_s > 0.0f) _stepperX.setMaxSpeed(x_steps_per_s);
-    if (y_steps_per_s > 0.0f) _stepperY.setMaxSpeed(y_steps_per_s);
-    if (z_steps_per_s > 0.0f) _stepperZ.setMaxSpeed(z_steps_per_s);
+    if (x_steps_per_s > 0.0f) _steppers[AXIS_X].setMaxSpeed(x_steps_per_s);
+    if (y_steps_per_s > 0.0f) _steppers[AXIS_Y].setMaxSpeed(y_steps_per_s);
+    if (z_steps_per_s > 0.0f) _steppers[AXIS_Z].setMaxSpeed(z_steps_per_s);
 }
 
 void StepperControl::setAcceleration(float x_steps_per_s2, float y_steps_per_s2, float z_steps_per_s2) {
-    _stepperX.setAcceleration(x_steps_per_s2);
-    _stepperY.setAcceleration(y_steps_per_s2);
-    _stepperZ.setAcceleration(z_steps_per_s2);
+    // Zero means the axis doesn't take part in the move; keep its previous value
+    // (AccelStepper ignores setAcceleration(0) as well).
+    setAxisAcceleration(AXIS_X, x_steps_per_s2);
+    setAxisAcceleration(AXIS_Y, y_steps_per_s2);
+    setAxisAcceleration(AXIS_Z, z_steps_per_s2);
+}
+
+bool StepperControl::setInputShaper(char axis, float freq_hz, float zeta, ShaperType type) {
+    if (axis == 'X') return _shaperX.configure(freq_hz, zeta, type);
+    if (axis == 'Y') return _shaperY.configure(freq_hz, zeta, type);
+    return false;
 }
 
 void StepperControl::moveTo(long x_steps, long y_steps, long z_steps) {
-    _stepperX.moveTo(x_steps);
-    _stepperY.moveTo(y_steps);
-    _stepperZ.moveTo(z_steps);
+    _steppers[AXIS_X].moveTo(x_steps);
+    _steppers[AXIS_Y].moveTo(y_steps);
+    _steppers[AXIS_Z].moveTo(z_steps);
 }
 
 void StepperControl::runBlocking() {
+    runBlockingWithCheck(nullptr);
+}
+
+bool StepperControl::runBlockingWithCheck(bool (*shouldStop)()) {
+    beginMove(shouldStop);
+    while (serviceMove()) {
+        wdt_reset();
+    }
+    return _moveStoppedEarly;
+}
+
+void StepperControl::beginMove(bool (*shouldStop)()) {
+    if (_jogging) jogFinish(); // Never step an axis from both the tick and this loop
     // Trapezoidal speed profile: accelerate, cruise, decelerate.
-    // We recalculate speed every ~5ms (200Hz) to keep per-step loop lightweight
-    // while providing smooth acceleration. Uses runSpeedToPosition() for the actual
-    // stepping (no sqrt per step like run()).
-
-    long distX = abs(_stepperX.distanceToGo());
-    long distY = abs(_stepperY.distanceToGo());
-    long distZ = abs(_stepperZ.distanceToGo());
-
-    // Find dominant axis (longest travel in steps)
-    long maxDist = max(distX, max(distY, distZ));
-    if (maxDist == 0) return; // Nothing to move
-
-    // Get max speeds for each axis
-    float maxSpeedX = _stepperX.maxSpeed();
-    float maxSpeedY = _stepperY.maxSpeed();
-    float maxSpeedZ = _stepperZ.maxSpeed();
-
-    // Determine the dominant axis and its parameters
-    float dominantMaxSpeed, dominantAccel;
-    long dominantDist;
-    if (distX >= distY && distX >= distZ) {
-        dominantMaxSpeed = maxSpeedX;
-        dominantAccel = MAX_ACCEL_X * X_STEPS_PER_MM;
-        dominantDist = distX;
-    } else if (distY >= distX && distY >= distZ) {
-        dominantMaxSpeed = maxSpeedY;
-        dominantAccel = MAX_ACCEL_Y * Y_STEPS_PER_MM;
-        dominantDist = distY;
-    } else {
-        dominantMaxSpeed = maxSpeedZ;
-        dominantAccel = MAX_ACCEL_Z * Z_STEPS_PER_MM;
-        dominantDist = distZ;
+    // serviceMove() recalculates the speed every ~5ms (200Hz) and hands each axis its
+    // step interval; moveTick() issues the steps (no sqrt per step like run()).
+    // If shouldStop is given it is polled every 5ms; returning true stops all axes
+    // immediately and sets moveStoppedEarly().
+
+    _moveStoppedEarly = false;
+    _moveShouldStop = shouldStop;
+
+    // The dominant axis (longest travel in steps, first on a tie) drives the profile. Its
+    // acceleration is its projected share of the path acceleration, as set by setAcceleration().
+    uint8_t dominant = AXIS_X;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        _moveDist[i] = abs(_steppers[i].distanceToGo());
+        _moveMaxSpeed[i] = _steppers[i].maxSpeed();
+        _moveStart[i] = _steppers[i].currentPosition();
+        if (_moveDist[i] > _moveDist[dominant]) dominant = i;
+    }
+    if (_moveDist[dominant] == 0) {
+        _moving = false;
+        return;
     }
+    _moveDominantMaxSpeed = _moveMaxSpeed[dominant];
+    _moveDominantAccel = _accel[dominant];
+    _moveDominantDist = _moveDist[dominant];
 
-    // Compute trapezoidal profile for dominant axis
-    // accelSteps = v_max^2 / (2 * accel)
-    float accelSteps = (dominantMaxSpeed * dominantMaxSpeed) / (2.0f * dominantAccel);
+    float accelSteps = (_moveDominantMaxSpeed * _moveDominantMaxSpeed) / (2.0f * _moveDominantAccel);
     float decelSteps = accelSteps;
+    if (accelSteps + decelSteps > _moveDominantDist) {
+        accelSteps = _moveDominantDist / 2.0f;
+        decelSteps = _moveDominantDist - accelSteps;
+    }
+    _moveCruiseStart = accelSteps;
+    _moveCruiseEnd = _moveDominantDist - decelSteps;
+
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        _tickPos[i] = _moveStart[i];
+        _tickLeft[i] = _moveDist[i];
+        _tickDir[i] = (_steppers[i].distanceToGo() > 0) ? 1 : -1;
+        _tickInterval[i] = 0xFFFFFFFFUL;
+        // Same level AccelStepper writes for a step toward +/-
+        if (_moveDist[i] > 0) digitalWrite(move_dir_pin[i], (_tickDir[i] > 0) != move_dir_invert[i] ? HIGH : LOW);
+    }
 
-    // If not enough room for full accel+decel, use triangle profile
-    if (accelSteps + decelSteps > dominantDist) {
-        accelSteps = dominantDist / 2.0f;
-        decelSteps = dominantDist - accelSteps;
+    float initSpeed = max(_moveDominantMaxSpeed * 0.05f, 50.0f);
+    _setProfileSpeed(initSpeed);
+
+    // Shaped moves run the trapezoid on a reference position integrated in time (the
+    // actual axes lag it by the shaper delay) and update speeds every 1 ms instead of 5.
+    _moveShaping = (_moveDist[AXIS_X] > 0 && _shaperX.isEnabled()) || (_moveDist[AXIS_Y] > 0 && _shaperY.isEnabled());
+    _moveRefProgress = 0.0f;
+    if (_moveShaping) {
+        for (uint8_t i = 0; i < INPUT_SHAPING_HISTORY_MS; i++) _shapeHistory[i] = 0;
+        _shapeHead = 0;
+        _shapeHistory[0] = (uint16_t)initSpeed;
     }
-    float cruiseStart = accelSteps;
-    float cruiseEnd = dominantDist - decelSteps;
-
-    // Record starting positions to track progress
-    long startX = _stepperX.currentPosition();
-    long startY = _stepperY.currentPosition();
-    long startZ = _stepperZ.currentPosition();
-
-    // Prime all axes with initial speed BEFORE entering the loop.
-    // runSpeedToPosition() won't generate steps if speed=0 (stepInterval=0),
-    // so we MUST set a non-zero speed on every moving axis before the first call.
-    // runSpeedToPosition() handles direction internally (target vs current), so
-    // only the speed magnitude matters here.
-    float initSpeed = max(dominantMaxSpeed * 0.05f, 50.0f);
-    float initRatio = initSpeed / dominantMaxSpeed;
-    if (distX > 0) _stepperX.setSpeed((distX == dominantDist) ? initSpeed : maxSpeedX * initRatio);
-    if (distY > 0) _stepperY.setSpeed((distY == dominantDist) ? initSpeed : maxSpeedY * initRatio);
-    if (distZ > 0) _stepperZ.setSpeed((distZ == dominantDist) ? initSpeed : maxSpeedZ * initRatio);
-
-    unsigned long lastSpeedUpdate = millis();
-
-    while (_stepperX.distanceToGo() != 0 ||
-           _stepperY.distanceToGo() != 0 ||
-           _stepperZ.distanceToGo() != 0) {
-        wdt_reset();
 
-        // Recalculate speed every 5ms (200Hz)
-        unsigned long now = millis();
-        if (now - lastSpeedUpdate >= 5) {
-            lastSpeedUpdate = now;
-
-            // Estimate progress along dominant axis
-            long progressX = abs(_stepperX.currentPosition() - startX);
-            long progressY = abs(_stepperY.currentPosition() - startY);
-            long progressZ = abs(_stepperZ.currentPosition() - startZ);
-            long progress = max(progressX, max(progressY, progressZ));
-
-            // Determine which phase we're in and compute target speed
-            float targetSpeed;
-            if (progress < (long)cruiseStart) {
-                // Acceleration phase: v = sqrt(2 * accel * distance)
-                float v = sqrt(2.0f * dominantAccel * (float)max(progress, 1L));
-                targetSpeed = min(v, dominantMaxSpeed);
-                targetSpeed = max(targetSpeed, dominantMaxSpeed * 0.05f);
-            } else if (progress < (long)cruiseEnd) {
-                // Cruise phase
-                targetSpeed = dominantMaxSpeed;
-            } else {
-                // Deceleration phase
-                long remaining = dominantDist - progress;
-                float v = sqrt(2.0f * dominantAccel * (float)max(remaining, 1L));
-                targetSpeed = min(v, dominantMaxSpeed);
-                targetSpeed = max(targetSpeed, dominantMaxSpeed * 0.05f);
-            }
+    _moveLastUpdate = millis();
+    _moving = true;
 
-            // Scale axis speeds proportionally to dominant axis speed.
-            // runSpeedToPosition() determines direction internally, so only magnitude matters.
-            float ratio = targetSpeed / dominantMaxSpeed;
-            if (distX > 0) _stepperX.setSpeed((distX == dominantDist) ? targetSpeed : maxSpeedX * ratio);
-            if (distY > 0) _stepperY.setSpeed((distY == dominantDist) ? targetSpeed : maxSpeedY * ratio);
-            if (distZ > 0) _stepperZ.setSpeed((distZ == dominantDist) ? targetSpeed : maxSpeedZ * ratio);
-        }
+    // First step of each axis on the first tick, as AccelStepper's runSpeed() did
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) _tickLast[i] = 0UL - _tickInterval[i];
+    _tickClock = 0;
+    _moveStartTimer();
+}
 
-        _stepperX.runSpeedToPosition();
-        _stepperY.runSpeedToPosition();
-        _stepperZ.runSpeedToPosition();
+void StepperControl::_setProfileSpeed(float targetSpeed) {
+    float ratio = targetSpeed / _moveDominantMaxSpeed;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (_moveDist[i] > 0) _setAxisRate(i, (_moveDist[i] == _moveDominantDist) ? targetSpeed : _moveMaxSpeed[i] * ratio);
     }
 }
 
-bool StepperControl::runBlockingWithCheck(bool (*shouldStop)()) {
-    // Same as runBlocking but calls shouldStop() every 5ms.
-    // If shouldStop returns true, all axes are stopped immediately.
-    // Returns true if stopped by callback, false if completed normally.
-
-    long distX = abs(_stepperX.distanceToGo());
-    long distY = abs(_stepperY.distanceToGo());
-    long distZ = abs(_stepperZ.distanceToGo());
-
-    long maxDist = max(distX, max(distY, distZ));
-    if (maxDist == 0) return false;
-
-    float maxSpeedX = _stepperX.maxSpeed();
-    float maxSpeedY = _stepperY.maxSpeed();
-    float maxSpeedZ = _stepperZ.maxSpeed();
-
-    float dominantMaxSpeed, dominantAccel;
-    long dominantDist;
-    if (distX >= distY && distX >= distZ) {
-        dominantMaxSpeed = maxSpeedX;
-        dominantAccel = MAX_ACCEL_X * X_STEPS_PER_MM;
-        dominantDist = distX;
-    } else if (distY >= distX && distY >= distZ) {
-        dominantMaxSpeed = maxSpeedY;
-        dominantAccel = MAX_ACCEL_Y * Y_STEPS_PER_MM;
-        dominantDist = distY;
-    } else {
-        dominantMaxSpeed = maxSpeedZ;
-        dominantAccel = MAX_ACCEL_Z * Z_STEPS_PER_MM;
-        dominantDist = distZ;
-    }
+void StepperControl::_setAxisRate(uint8_t axis, float steps_per_s) {
+    float counts = (float)STEP_TIMER_HZ / steps_per_s;
+    uint32_t interval = (counts < 4.0e9f) ? (uint32_t)counts : 0xFFFFFFFFUL;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { _tickInterval[axis] = interval; }
+}
 
-    float accelSteps = (dominantMaxSpeed * dominantMaxSpeed) / (2.0f * dominantAccel);
-    float decelSteps = accelSteps;
-    if (accelSteps + decelSteps > dominantDist) {
-        accelSteps = dominantDist / 2.0f;
-        decelSteps = dominantDist - accelSteps;
-    }
-    float cruiseStart = accelSteps;
-    float cruiseEnd = dominantDist - decelSteps;
+long StepperControl::_movePosition(uint8_t axis) {
+    long pos;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { pos = _tickPos[axis]; }
+    return pos;
+}
 
-    long startX = _stepperX.currentPosition();
-    long startY = _stepperY.currentPosition();
-    long startZ = _stepperZ.currentPosition();
+bool StepperControl::serviceMove() {
+    if (!_moving) return false;
 
-    float initSpeed = max(dominantMaxSpeed * 0.05f, 50.0f);
-    float initRatio = initSpeed / dominantMaxSpeed;
-    if (distX > 0) _stepperX.setSpeed((distX == dominantDist) ? initSpeed : maxSpeedX * initRatio);
-    if (distY > 0) _stepperY.setSpeed((distY == dominantDist) ? initSpeed : maxSpeedY * initRatio);
-    if (distZ > 0) _stepperZ.setSpeed((distZ == dominantDist) ? initSpeed : maxSpeedZ * initRatio);
+    bool left = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < AXIS_COUNT; i++) left = left || _tickLeft[i] != 0;
+    }
+    if (!left) {
+        _endMove();
+        return false; // Completed normally
+    }
 
-    unsigned long lastSpeedUpdate = millis();
+    unsigned long now = millis();
+    unsigned long updateIntervalMs = _moveShaping ? 1 : 5;
+    if (now - _moveLastUpdate >= updateIntervalMs) {
+        unsigned long elapsedMs = now - _moveLastUpdate;
+        _moveLastUpdate = now;
+
+        // Check stop callback
+        if (_moveShouldStop && _moveShouldStop()) {
+            abortMove();
+            _moveStoppedEarly = true;
+            return false; // Stopped by callback
+        }
 
-    while (_stepperX.distanceToGo() != 0 ||
-           _stepperY.distanceToGo() != 0 ||
-           _stepperZ.distanceToGo() != 0) {
-        wdt_reset();
+        long progress;
+        if (_moveShaping) {
+            progress = (long)_moveRefProgress;
+        } else {
+            progress = 0;
+            for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+                long axisProgress = abs(_movePosition(i) - _moveStart[i]);
+                if (axisProgress > progress) progress = axisProgress;
+            }
+        }
 
-        unsigned long now = millis();
-        if (now - lastSpeedUpdate >= 5) {
-            lastSpeedUpdate = now;
+        float targetSpeed;
+        if (progress < (long)_moveCruiseStart) {
+            float v = sqrt(2.0f * _moveDominantAccel * (float)max(progress, 1L));
+            targetSpeed = min(v, _moveDominantMaxSpeed);
+            targetSpeed = max(targetSpeed, _moveDominantMaxSpeed * 0.05f);
+        } else if (progress < (long)_moveCruiseEnd) {
+            targetSpeed = _moveDominantMaxSpeed;
+        } else {
+            long remaining = _moveDominantDist - progress;
+            float v = sqrt(2.0f * _moveDominantAccel * (float)max(remaining, 1L));
+            targetSpeed = min(v, _moveDominantMaxSpeed);
+            targetSpeed = max(targetSpeed, _moveDominantMaxSpeed * 0.05f);
+        }
 
-            // Check stop callback
-            if (shouldStop && shouldStop()) {
-                _stepperX.setCurrentPosition(_stepperX.currentPosition());
-                _stepperY.setCurrentPosition(_stepperY.currentPosition());
-                _stepperZ.setCurrentPosition(_stepperZ.currentPosition());
-                return true; // Stopped by callback
+        if (!_moveShaping) {
+            _setProfileSpeed(targetSpeed);
+        } else {
+            // The reference stops once it has covered the move; the shaped tail follows
+            bool refDone = _moveRefProgress >= _moveDominantDist;
+            if (refDone) targetSpeed = 0.0f;
+            _moveRefProgress += targetSpeed * elapsedMs * 0.001f;
+
+            // One history entry per elapsed millisecond keeps the delays in real time
+            uint16_t sample = (uint16_t)min(targetSpeed, 65535.0f);
+            for (unsigned long i = min(elapsedMs, (unsigned long)INPUT_SHAPING_HISTORY_MS); i > 0; i--) {
+                _shapeHead = (_shapeHead + 1) & (INPUT_SHAPING_HISTORY_MS - 1);
+                _shapeHistory[_shapeHead] = sample;
             }
 
-            long progressX = abs(_stepperX.currentPosition() - startX);
-            long progressY = abs(_stepperY.currentPosition() - startY);
-            long progressZ = abs(_stepperZ.currentPosition() - startZ);
-            long progress = max(progressX, max(progressY, progressZ));
-
-            float targetSpeed;
-            if (progress < (long)cruiseStart) {
-                float v = sqrt(2.0f * dominantAccel * (float)max(progress, 1L));
-                targetSpeed = min(v, dominantMaxSpeed);
-                targetSpeed = max(targetSpeed, dominantMaxSpeed * 0.05f);
-            } else if (progress < (long)cruiseEnd) {
-                targetSpeed = dominantMaxSpeed;
-            } else {
-                long remaining = dominantDist - progress;
-                float v = sqrt(2.0f * dominantAccel * (float)max(remaining, 1L));
-                targetSpeed = min(v, dominantMaxSpeed);
-                targetSpeed = max(targetSpeed, dominantMaxSpeed * 0.05f);
+            // Axis rate = its share of the dominant rate, shaped with its own filter. If
+            // rounding leaves an axis a few steps short, it creeps them in at the floor rate
+            // only after the last impulse has passed (shaped rate back to 0), so the
+            // shaped ramp-down itself is never cut off.
+            float floorRate = _moveDominantMaxSpeed * 0.05f;
+            float refRate = _shapeHistory[_shapeHead];
+            float rateX = _shaperX.apply(_shapeHistory, _shapeHead);
+            float rateY = _shaperY.apply(_shapeHistory, _shapeHead);
+            const float rate[AXIS_COUNT] = { rateX, rateY, refRate };
+            for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+                if (_moveDist[i] == 0) continue;
+                float axisRate = (refDone && rate[i] == 0.0f) ? floorRate : rate[i];
+                _setAxisRate(i, axisRate * _moveMaxSpeed[i] / _moveDominantMaxSpeed);
             }
-
-            float ratio = targetSpeed / dominantMaxSpeed;
-            if (distX > 0) _stepperX.setSpeed((distX == dominantDist) ? targetSpeed : maxSpeedX * ratio);
-            if (distY > 0) _stepperY.setSpeed((distY == dominantDist) ? targetSpeed : maxSpeedY * ratio);
-            if (distZ > 0) _stepperZ.setSpeed((distZ == dominantDist) ? targetSpeed : maxSpeedZ * ratio);
         }
+    }
+
+    return true;
+}
+
+void StepperControl::abortMove() {
+    // Drop the remaining distance; the axes stop where they are
+    if (!_moving) return;
+    _endMove();
+}
 
-        _stepperX.runSpeedToPosition();
-        _stepperY.runSpeedToPosition();
-        _stepperZ.runSpeedToPosition();
+void StepperControl::_endMove() {
+    _moveStopTimer();
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        _tickLeft[i] = 0;
+        _steppers[i].setCurrentPosition(_tickPos[i]); // Also zeros speed and distanceToGo
     }
-    return false; // Completed normally
+    _moving = false;
 }
 
-long StepperControl::getCurrentXSteps() {
-    return _stepperX.currentPosition();
+ISR(TIMER4_COMPA_vect) {
+    stepperControl.moveTick();
 }
 
-long StepperControl::getCurrentYSteps() {
-    return _stepperY.currentPosition();
+void StepperControl::_moveStartTimer() {
+    // Timer4 CTC mode, prescaler 8 -> 2 MHz count
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TCCR4A = 0;
+        TCCR4B = _BV(WGM42) | _BV(CS41);
+        _tickPeriod = STEP_TICK_MIN_COUNTS;
+        OCR4A = _tickPeriod - 1;
+        TCNT4 = 0;
+        TIFR4 = _BV(OCF4A);
+        TIMSK4 |= _BV(OCIE4A);
+    }
+}
+
+void StepperControl::_moveStopTimer() {
+    TIMSK4 &= ~_BV(OCIE4A);
+}
+
+void StepperControl::moveTick() {
+    // Runs at each due step (and at least every ms): pulse the due axes, then sleep until
+    // the earliest next one. The clock advances by whole compare periods, so steps keep
+    // their exact spacing however late the ISR itself was entered.
+    uint32_t now = (_tickClock += _tickPeriod);
+    uint8_t due = 0;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (_tickLeft[i] != 0 && now - _tickLast[i] >= _tickInterval[i]) {
+            *_stepPort[i] |= _stepMask[i];
+            due |= 1 << i;
+        }
+    }
+    uint16_t raised = TCNT4;
+
+    uint32_t wait = STEP_TICK_MAX_COUNTS;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (_tickLeft[i] == 0) continue;
+        uint32_t interval = _tickInterval[i];
+        if (due & (1 << i)) {
+            _tickPos[i] += _tickDir[i];
+            _tickLeft[i]--;
+            // Keep the spacing, unless a slower rate left the axis far behind its schedule
+            _tickLast[i] = (now - _tickLast[i] - interval < interval) ? _tickLast[i] + interval : now;
+            if (_tickLeft[i] == 0) continue;
+        }
+        uint32_t since = now - _tickLast[i];
+        uint32_t left = (since < interval) ? interval - since : 0;
+        if (left < wait) wait = left;
+    }
+
+    while ((uint16_t)(TCNT4 - raised) < STEP_PULSE_COUNTS) {}
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        if (due & (1 << i)) *_stepPort[i] &= ~_stepMask[i];
+    }
+
+    // The counter restarted at this compare: a period it has already passed would only
+    // match after wrapping, so never schedule closer than the minimum from now
+    uint16_t period = (wait < STEP_TICK_MIN_COUNTS) ? STEP_TICK_MIN_COUNTS : (uint16_t)wait;
+    uint16_t elapsed = TCNT4;
+    if (period < elapsed + STEP_TICK_MIN_COUNTS) period = elapsed + STEP_TICK_MIN_COUNTS;
+    OCR4A = period - 1;
+    _tickPeriod = period;
 }
 
-long StepperControl::getCurrentZSteps() {
-    return _stepperZ.currentPosition();
+long StepperControl::getCurrentSteps(AxisIndex axis) {
+    long pos;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { // The jog tick or the move ISR may be stepping
+        pos = _moving ? _tickPos[axis] : _steppers[axis].currentPosition();
+    }
+    return pos;
 }
 
 void StepperControl::setCurrentPosition(long x, long y, long z) {
-    _stepperX.setCurrentPosition(x);
-    _stepperY.setCurrentPosition(y);
-    _stepperZ.setCurrentPosition(z);
+    positionTrust.invalidate();
+#if ENDSTOP_SIM
+    // A new count doesn't move the virtual carriage
+    endstopSim.countSet(AXIS_X, x);
+    endstopSim.countSet(AXIS_Y, y);
+    endstopSim.countSet(AXIS_Z, z);
+#endif
+    _steppers[AXIS_X].setCurrentPosition(x);
+    _steppers[AXIS_Y].setCurrentPosition(y);
+    _steppers[AXIS_Z].setCurrentPosition(z);
 }
 
 // Individual axis control for homing/jogging
-void StepperControl::moveAxisTo(char axis, long steps) {
-    if (axis == 'X') {
-        _stepperX.moveTo(steps);
-    } else if (axis == 'Y') {
-        _stepperY.moveTo(steps);
-    } else if (axis == 'Z') {
-        _stepperZ.moveTo(steps);
-    }
+void StepperControl::setAxisAcceleration(AxisIndex axis, float acceleration_steps_per_s2) {
+    if (acceleration_steps_per_s2 <= 0.0f) return;
+    _steppers[axis].setAcceleration(acceleration_steps_per_s2);
+    _accel[axis] = acceleration_steps_per_s2;
 }
 
-void StepperControl::setAxisSpeed(char axis, float speed_steps_per_s) {
-    if (axis == 'X') {
-        _stepperX.setSpeed(speed_steps_per_s);
-    } else if (axis == 'Y') {
-        _stepperY.setSpeed(speed_steps_per_s);
-    } else if (axis == 'Z') {
-        _stepperZ.setSpeed(speed_steps_per_s);
-    }
+bool StepperControl::runAllAxes() {
+    bool x = _steppers[AXIS_X].run();
+    bool y = _steppers[AXIS_Y].run();
+    bool z = _steppers[AXIS_Z].run();
+    return x || y || z;
+}
+
+void StepperControl::stopAxisImmediate(AxisIndex axis) {
+    // setCurrentPosition(currentPosition()) zeros both speed and distanceToGo instantly
+    _steppers[axis].setCurrentPosition(_steppers[axis].currentPosition());
+}
+
+//===========================================================================
+// Continuous jog
+//===========================================================================
+
+static_assert(JOG_MAX_VELOCITY_XY * AxisTraits<AXIS_X>::STEPS_PER_MM < JOG_TICK_HZ, "X jog step rate exceeds JOG_TICK_HZ");
+static_assert(JOG_MAX_VELOCITY_XY * AxisTraits<AXIS_Y>::STEPS_PER_MM < JOG_TICK_HZ, "Y jog step rate exceeds JOG_TICK_HZ");
+static_assert(JOG_MAX_VELOCITY_Z * AxisTraits<AXIS_Z>::STEPS_PER_MM < JOG_TICK_HZ, "Z jog step rate exceeds JOG_TICK_HZ");
+
+// Jog limits and ramps per axis (steps/s, steps/s^2)
+static const float jog_max_speed[AXIS_COUNT] = {
+    JOG_MAX_VELOCITY_XY * AxisTraits<AXIS_X>::STEPS_PER_MM,
+    JOG_MAX_VELOCITY_XY * AxisTraits<AXIS_Y>::STEPS_PER_MM,
+    JOG_MAX_VELOCITY_Z * AxisTraits<AXIS_Z>::STEPS_PER_MM
+};
+static const float jog_accel[AXIS_COUNT] = {
+    JOG_ACCEL_XY * AxisTraits<AXIS_X>::STEPS_PER_MM,
+    JOG_ACCEL_XY * AxisTraits<AXIS_Y>::STEPS_PER_MM,
+    JOG_ACCEL_Z * AxisTraits<AXIS_Z>::STEPS_PER_MM
+};
+// Read by the tick: the endstop only blocks motion toward home
+static const int8_t jog_home_dir[AXIS_COUNT] = {
+    AxisTraits<AXIS_X>::HOME_DIR, AxisTraits<AXIS_Y>::HOME_DIR, AxisTraits<AXIS_Z>::HOME_DIR
+};
+
+ISR(TIMER3_COMPA_vect) {
+    stepperControl.jogTick();
 }
 
-void StepperControl::setAxisAcceleration(char axis, float acceleration_steps_per_s2) {
-    if (axis == 'X') {
-        _stepperX.setAcceleration(acceleration_steps_per_s2);
-    } else if (axis == 'Y') {
-        _stepperY.setAcceleration(acceleration_steps_per_s2);
-    } else if (axis == 'Z') {
-        _stepperZ.setAcceleration(acceleration_steps_per_s2);
+void StepperControl::_jogStartTimer() {
+    // Timer3 CTC mode, prescaler 8 -> 2 MHz count
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TCCR3A = 0;
+        TCCR3B = _BV(WGM32) | _BV(CS31);
+        OCR3A = (uint16_t)(F_CPU / 8 / JOG_TICK_HZ - 1);
+        TCNT3 = 0;
+        TIMSK3 |= _BV(OCIE3A);
     }
 }
 
-bool StepperControl::runAxis(char axis) {
-    if (axis == 'X') {
-        return _stepperX.run();
-    } else if (axis == 'Y') {
-        return _stepperY.run();
-    } else if (axis == 'Z') {
-        return _stepperZ.run();
+void StepperControl::_jogStopTimer() {
+    TIMSK3 &= ~_BV(OCIE3A);
+}
+
+void StepperControl::jogSetVelocity(AxisIndex axis, float steps_per_s) {
+    if (axis >= AXIS_COUNT) return;
+    uint8_t idx = axis;
+
+    float limit = jog_max_speed[idx];
+    _jogTarget[idx] = constrain(steps_per_s, -limit, limit);
+    _jogLastCommand = millis();
+
+    // Any request away from a blocking endstop/limit releases the block. The blocked
+    // direction is kept because jogService() has already settled the speed at zero.
+    if (_jogBlocked[idx] != 0 && _jogTarget[idx] * _jogBlocked[idx] < 0.0f) _jogBlocked[idx] = 0;
+
+    if (!_jogging) {
+        // Soft limits apply only to homed axes
+        for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+            bool homed = homing.isHomed((AxisIndex)i);
+            _jogMin[i] = homed ? 0 : -0x7FFFFFFFL;
+            _jogMax[i] = homed ? axisMmToSteps(i, axisConfig[i].max_pos) : 0x7FFFFFFFL;
+            _jogSpeed[i] = 0.0f;
+            _jogDir[i] = 0;
+            _jogBlocked[i] = 0;
+            _steppers[i].setSpeed(0.0f);
+        }
+        enableSteppers();
+        _jogLastUpdate = millis();
+        _jogging = true;
+        _jogStartTimer();
     }
-    return false;
 }
 
-bool StepperControl::runAllAxes() {
-    bool x = _stepperX.run();
-    bool y = _stepperY.run();
-    bool z = _stepperZ.run();
-    return x || y || z;
+void StepperControl::jogStop() {
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) _jogTarget[i] = 0.0f;
 }
 
-void StepperControl::moveAxisBy(char axis, long steps) {
-    if (axis == 'X') {
-        _stepperX.move(steps);
-    } else if (axis == 'Y') {
-        _stepperY.move(steps);
-    } else if (axis == 'Z') {
-        _stepperZ.move(steps);
+void StepperControl::jogAbort() {
+    _jogStopTimer();
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        _jogTarget[i] = 0.0f;
+        _jogSpeed[i] = 0.0f;
+        _jogDir[i] = 0;
+        _steppers[i].setSpeed(0.0f);
     }
+    _jogging = false;
 }
 
-void StepperControl::setAxisMaxSpeed(char axis, float max_speed_steps_per_s) {
-    if (axis == 'X') {
-        _stepperX.setMaxSpeed(max_speed_steps_per_s);
-    } else if (axis == 'Y') {
-        _stepperY.setMaxSpeed(max_speed_steps_per_s);
-    } else if (axis == 'Z') {
-        _stepperZ.setMaxSpeed(max_speed_steps_per_s);
+void StepperControl::jogFinish() {
+    jogStop();
+    while (_jogging) {
+        wdt_reset();
+        jogService();
     }
 }
 
-void StepperControl::stopAxis(char axis) {
-    if (axis == 'X') {
-        _stepperX.stop();
-    } else if (axis == 'Y') {
-        _stepperY.stop();
-    } else if (axis == 'Z') {
-        _stepperZ.stop();
+void StepperControl::jogService() {
+    if (!_jogging) return;
+
+    unsigned long now = millis();
+    if (now - _jogLastUpdate < 5) return;
+    float dt = (now - _jogLastUpdate) * 0.001f;
+    _jogLastUpdate = now;
+
+    // Dead-man: the encoder or host must keep refreshing the velocity
+    if (now - _jogLastCommand > JOG_COMMAND_TIMEOUT_MS) jogStop();
+
+    bool moving = false;
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        AxisIndex axis = (AxisIndex)i;
+
+        // Drop latches once the switch has been released
+        if (endstops.isLatched(axis) && !endstops.getRawState(axis)) endstops.clearLatch(axis);
+
+        if (_jogBlocked[i] != 0) {
+            // The tick already stopped stepping; settle the ramp at zero
+            _jogSpeed[i] = 0.0f;
+            _jogTarget[i] = 0.0f;
+        } else {
+            float step = jog_accel[i] * dt;
+            float diff = _jogTarget[i] - _jogSpeed[i];
+            _jogSpeed[i] += constrain(diff, -step, step);
+        }
+
+        int8_t dir = (_jogSpeed[i] > 0.5f) ? 1 : (_jogSpeed[i] < -0.5f) ? -1 : 0;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            _steppers[i].setSpeed(dir ? _jogSpeed[i] : 0.0f);
+            _jogDir[i] = dir;
+        }
+        if (dir != 0 || _jogTarget[i] != 0.0f) moving = true;
+    }
+
+    if (!moving) {
+        _jogStopTimer();
+        _jogging = false;
     }
 }
 
-void StepperControl::stopAxisImmediate(char axis) {
-    // setCurrentPosition(currentPosition()) zeros both speed and distanceToGo instantly
-    if (axis == 'X') _stepperX.setCurrentPosition(_stepperX.currentPosition());
-    else if (axis == 'Y') _stepperY.setCurrentPosition(_stepperY.currentPosition());
-    else if (axis == 'Z') _stepperZ.setCurrentPosition(_stepperZ.currentPosition());
-}
-
-bool StepperControl::isAxisRunning(char axis) {
-    if (axis == 'X') {
-        return _stepperX.distanceToGo() != 0;
-    } else if (axis == 'Y') {
-        return _stepperY.distanceToGo() != 0;
-    } else if (axis == 'Z') {
-        return _stepperZ.distanceToGo() != 0;
+void StepperControl::jogTick() {
+    // Runs at JOG_TICK_HZ: keep it to flag reads, one compare and runSpeed()
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        int8_t dir = _jogDir[i];
+        if (dir == 0 || _jogBlocked[i] != 0) continue;
+
+        long pos = _steppers[i].currentPosition();
+        bool at_endstop = (dir == jog_home_dir[i]) && endstops.isLatched((AxisIndex)i);
+        bool at_limit = (dir > 0) ? (pos >= _jogMax[i]) : (pos <= _jogMin[i]);
+        if (at_endstop || at_limit) {
+            _jogBlocked[i] = dir;
+            continue;
+        }
+        _steppers[i].runSpeed();
     }
-    return false;
 }
 
-void StepperControl::testMotorDirect(char axis, int steps, int delayUs) {
+void StepperControl::testMotorDirect(AxisIndex axis, int steps, int delayUs) {
     // Raw pin-toggle test that bypasses AccelStepper entirely.
     // This tests the hardware path: MCU pin -> driver -> motor.
     // If this moves the motor but AccelStepper doesn't, the issue is in
     // AccelStepper configuration. If this doesn't move it either, the
     // issue is hardware (wiring, driver, current).
 
-    uint8_t enablePin, stepPin, dirPin;
-    if (axis == 'X') {
-        enablePin = X_ENABLE_PIN; stepPin = X_STEP_PIN; dirPin = X_DIR_PIN;
-    } else if (axis == 'Y') {
-        enablePin = Y_ENABLE_PIN; stepPin = Y_STEP_PIN; dirPin = Y_DIR_PIN;
-    } else {
-        enablePin = Z_ENABLE_PIN; stepPin = Z_STEP_PIN; dirPin = Z_DIR_PIN;
-    }
+    static const uint8_t enable_pins[AXIS_COUNT] = { AxisTraits<AXIS_X>::ENABLE_PIN, AxisTraits<AXIS_Y>::ENABLE_PIN, AxisTraits<AXIS_Z>::ENABLE_PIN };
+    static const uint8_t step_pins[AXIS_COUNT] = { AxisTraits<AXIS_X>::STEP_PIN, AxisTraits<AXIS_Y>::STEP_PIN, AxisTraits<AXIS_Z>::STEP_PIN };
+    static const uint8_t dir_pins[AXIS_COUNT] = { AxisTraits<AXIS_X>::DIR_PIN, AxisTraits<AXIS_Y>::DIR_PIN, AxisTraits<AXIS_Z>::DIR_PIN };
+    if (axis >= AXIS_COUNT) axis = AXIS_Z;
+    uint8_t enablePin = enable_pins[axis], stepPin = step_pins[axis], dirPin = dir_pins[axis];
 
     pinMode(enablePin, OUTPUT);
     pinMode(stepPin, OUTPUT);
@@ -445,5 +630,5 @@ void StepperControl::testMotorDirect(char axis, int steps, int delayUs) {
 }
 
 void StepperControl::testZMotorDirect(int steps, int delayUs) {
-    testMotorDirect('Z', steps, delayUs);
+    testMotorDirect(AXIS_Z, steps, delayUs);
 }
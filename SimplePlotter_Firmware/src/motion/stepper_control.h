@@ -5,6 +5,8 @@
 
 #include <AccelStepper.h>
 #include "../config.h" // Include our configuration
+#include "input_shaper.h"
+#include "axis.h"
 
 // Define the stepper motor driver type
 // AccelStepper::DRIVER is the default for step/dir drivers.
@@ -19,7 +21,9 @@ public:
     void enableSteppers();
     void disableSteppers();
 
-    // Set maximum speed and acceleration for all axes (in steps/s and steps/s^2)
+    // Set maximum speed and acceleration for all axes (in steps/s and steps/s^2).
+    // For coordinated moves the caller projects the path limits onto each axis;
+    // runBlocking() then ramps with the dominant axis' share of the path acceleration.
     void setMaxSpeed(float x_steps_per_s, float y_steps_per_s, float z_steps_per_s);
     void setAcceleration(float x_steps_per_s2, float y_steps_per_s2, float z_steps_per_s2);
 
@@ -27,11 +31,27 @@ public:
     void moveTo(long x_steps, long y_steps, long z_steps);
     void runBlocking(); // Blocks until all moves are complete
     bool runBlockingWithCheck(bool (*shouldStop)()); // Same but calls shouldStop every 5ms; returns true if stopped early
+
+    // Non-blocking form of runBlockingWithCheck(): beginMove() after moveTo(), then call
+    // serviceMove() from loop() until it returns false. The steps come from a Timer4
+    // compare ISR scheduled for each axis' next step, so work in loop() between calls
+    // can't stall or jitter the step train; serviceMove() only advances the speed profile.
+    void beginMove(bool (*shouldStop)() = nullptr);
+    bool serviceMove();   // Updates the profile every 1-5 ms; false once the move is over
+    void abortMove();     // Stop instantly and drop the remaining distance
+    void moveTick();      // Called from the Timer4 compare ISR only
+    bool isMoving() const { return _moving; }
+    bool moveStoppedEarly() const { return _moveStoppedEarly; } // Last move ended by shouldStop
     
+    // Input shaping for X/Y (M593). Returns false if the frequency is too low for the history.
+    bool setInputShaper(char axis, float freq_hz, float zeta, ShaperType type);
+    const InputShaper& getInputShaper(char axis) const { return (axis == 'Y') ? _shaperY : _shaperX; }
+
     // Get current position in steps
-    long getCurrentXSteps();
-    long getCurrentYSteps();
-    long getCurrentZSteps();
+    long getCurrentSteps(AxisIndex axis);
+    long getCurrentXSteps() { return getCurrentSteps(AXIS_X); }
+    long getCurrentYSteps() { return getCurrentSteps(AXIS_Y); }
+    long getCurrentZSteps() { return getCurrentSteps(AXIS_Z); }
 
     // Check if steppers are disabled
     bool is_steppers_disabled() const { return _steppers_are_disabled; }
@@ -40,27 +60,97 @@ public:
     void setCurrentPosition(long x, long y, long z);
     
     // Individual axis control (mainly for homing or manual jog)
-    void moveAxisTo(char axis, long steps); // Move individual axis to absolute position in steps
-    void moveAxisBy(char axis, long steps); // Move individual axis by relative distance in steps
-    void setAxisSpeed(char axis, float speed_steps_per_s); // Set speed for individual axis in steps/s (constant speed mode)
-    void setAxisMaxSpeed(char axis, float max_speed_steps_per_s); // Set max speed for acceleration mode
-    void setAxisAcceleration(char axis, float acceleration_steps_per_s2); // Set acceleration for individual axis in steps/s^2
-    bool runAxis(char axis); // Run individual axis (needs to be called repeatedly in loop)
+    void moveAxisTo(AxisIndex axis, long steps) { _steppers[axis].moveTo(steps); } // Absolute position in steps
+    void moveAxisBy(AxisIndex axis, long steps) { _steppers[axis].move(steps); }   // Relative distance in steps
+    void setAxisSpeed(AxisIndex axis, float speed_steps_per_s) { _steppers[axis].setSpeed(speed_steps_per_s); } // Constant speed mode
+    void setAxisMaxSpeed(AxisIndex axis, float max_speed_steps_per_s) { _steppers[axis].setMaxSpeed(max_speed_steps_per_s); } // Acceleration mode
+    void setAxisAcceleration(AxisIndex axis, float acceleration_steps_per_s2); // Steps/s^2
+    bool runAxis(AxisIndex axis) { return _steppers[axis].run(); } // Needs to be called repeatedly in loop
     bool runAllAxes(); // Run all axes (needs to be called repeatedly in loop for non-blocking multi-stepper)
-    void stopAxis(char axis); // Stop individual axis (decelerates)
-    void stopAxisImmediate(char axis); // Instant stop, no deceleration
-    bool isAxisRunning(char axis); // Check if axis is still moving towards target
+    void stopAxis(AxisIndex axis) { _steppers[axis].stop(); } // Decelerates
+    void stopAxisImmediate(AxisIndex axis); // Instant stop, no deceleration
+    bool isAxisRunning(AxisIndex axis) { return _steppers[axis].distanceToGo() != 0; } // Still moving towards target
+
+    // Continuous jog (velocity mode). Steps come from a Timer3 tick, so jogging keeps
+    // running while the main loop redraws the LCD. The ramp toward the target velocity
+    // is advanced by jogService() from loop(). Endstops (interrupt-latched) and soft
+    // limits of homed axes stop an axis from within the tick.
+    void jogSetVelocity(AxisIndex axis, float steps_per_s); // Signed target velocity; refresh within JOG_COMMAND_TIMEOUT_MS
+    void jogStop();   // Decelerate all jogging axes to rest
+    void jogAbort();  // Stop all jogging axes instantly (quickstop)
+    void jogFinish(); // jogStop() and block until at rest
+    bool isJogging() const { return _jogging; }
+    void jogService(); // Call from loop()
+    void jogTick();    // Called from the Timer3 compare ISR only
 
     // Raw pin-toggle motor test (bypasses AccelStepper entirely for diagnostics)
-    void testMotorDirect(char axis, int steps = 800, int delayUs = 500);
+    void testMotorDirect(AxisIndex axis, int steps = 800, int delayUs = 500);
     void testZMotorDirect(int steps = 800, int delayUs = 500); // Kept for backward compat
 
 private:
-    AccelStepper _stepperX;
-    AccelStepper _stepperY;
-    AccelStepper _stepperZ;
+    AccelStepper _steppers[AXIS_COUNT];
 
     bool _steppers_are_disabled; // Track stepper enable/disable state
+
+    // Last acceleration set per axis (steps/s^2), used for the trapezoid in runBlocking
+    float _accel[AXIS_COUNT];
+
+    // Profile state of the move in progress (indexed by AxisIndex)
+    bool _moving;
+    bool _moveStoppedEarly;
+    bool (*_moveShouldStop)();
+    long _moveDist[AXIS_COUNT];
+    long _moveStart[AXIS_COUNT];
+    float _moveMaxSpeed[AXIS_COUNT];
+    float _moveDominantMaxSpeed;
+    float _moveDominantAccel;
+    long _moveDominantDist;
+    float _moveCruiseStart;
+    float _moveCruiseEnd;
+    bool _moveShaping;
+    float _moveRefProgress;       // Reference (unshaped) progress of a shaped move, in steps
+    unsigned long _moveLastUpdate;
+
+    // Step generator of the move in progress, in Timer4 counts (STEP_TIMER_HZ). The ISR
+    // owns the positions while _moving; AccelStepper's are synced when the move ends.
+    volatile long _tickPos[AXIS_COUNT];
+    volatile long _tickLeft[AXIS_COUNT];          // Steps still to issue
+    int8_t _tickDir[AXIS_COUNT];
+    volatile uint32_t _tickInterval[AXIS_COUNT];  // Counts between steps, set by the profile
+    uint32_t _tickLast[AXIS_COUNT];               // Clock of the last step
+    uint32_t _tickClock;                          // Counts since the move began
+    uint16_t _tickPeriod;                         // Compare period now running
+    volatile uint8_t* _stepPort[AXIS_COUNT];      // Step pins as port bits, written from the ISR
+    uint8_t _stepMask[AXIS_COUNT];
+
+    void _setProfileSpeed(float targetSpeed); // Dominant-axis speed, others scaled to arrive together
+    void _setAxisRate(uint8_t axis, float steps_per_s);
+    long _movePosition(uint8_t axis);
+    void _endMove(); // Stops the ISR and hands the positions back to AccelStepper
+
+    // Input shaping: X/Y shapers share one history of the reference (unshaped) step rate
+    // of the dominant axis, sampled every 1 ms while a shaped move runs
+    InputShaper _shaperX;
+    InputShaper _shaperY;
+    uint16_t _shapeHistory[INPUT_SHAPING_HISTORY_MS];
+    uint8_t _shapeHead;
+
+    // Continuous jog state (indexed by AxisIndex)
+    volatile bool _jogging;
+    volatile int8_t _jogDir[AXIS_COUNT]; // Sign of the commanded speed, read by the tick
+    volatile int8_t _jogBlocked[AXIS_COUNT]; // Direction the tick stopped at an endstop/soft limit, 0 if free
+    float _jogTarget[AXIS_COUNT];        // Target velocity (steps/s, signed)
+    float _jogSpeed[AXIS_COUNT];         // Current ramped velocity (steps/s, signed)
+    long _jogMin[AXIS_COUNT];            // Soft limits in steps (only enforced for homed axes)
+    long _jogMax[AXIS_COUNT];
+    unsigned long _jogLastCommand;
+    unsigned long _jogLastUpdate;
+
+    template<uint8_t A> void _initAxis();
+    void _moveStartTimer();
+    void _moveStopTimer();
+    void _jogStartTimer();
+    void _jogStopTimer();
 };
 
 extern StepperControl stepperControl; // Global instance
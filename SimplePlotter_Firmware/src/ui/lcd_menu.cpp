@@ -5,11 +5,15 @@
 #include "../globals.h"
 #include "../io/sd_card.h"
 #include "../io/buzzer.h"
+#include "../motion/motion_queue.h"
+#include "../gcode/executor.h" // For syncPositionFromSteps
+#include "../utils/event_trace.h"
 
 // Instantiate all specific screen objects
 MainStatusScreen mainStatusScreen;
 ManualControlScreen manualControlScreen;
 JogStepScreen jogStepScreen;
+ContinuousJogScreen continuousJogScreen;
 HomeAxisScreen homeAxisScreen;
 PenSettingsScreen penSettingsScreen;
 MotionSettingsScreen motionSettingsScreen;
@@ -59,6 +63,7 @@ LCDMenu::LCDMenu() :
     _screens[SCREEN_MAIN_STATUS]    = &mainStatusScreen;
     _screens[SCREEN_MANUAL_CONTROL] = &manualControlScreen;
     _screens[SCREEN_JOG_STEP]       = &jogStepScreen;
+    _screens[SCREEN_JOG_CONTINUOUS] = &continuousJogScreen;
     _screens[SCREEN_HOME_AXIS]      = &homeAxisScreen;
     _screens[SCREEN_PEN_SETTINGS]   = &penSettingsScreen;
     _screens[SCREEN_MOTION_SETTINGS]= &motionSettingsScreen;
@@ -82,14 +87,22 @@ void LCDMenu::init() {
 
     // Go to the initial screen (Main Status)
     goToScreen(SCREEN_MAIN_STATUS);
+    _initialized = true;
 }
 
 void LCDMenu::update() {
+    if (!_initialized) return; // Display comes up after boot, from loop()
+
     // Update encoder state
     uiEncoder.update();
 
+    // While a queued move is mid-block, screen actions (some run blocking motion) and
+    // redraws would stall or disturb it. Rotation stays pending in the encoder and a
+    // click is held until the block ends; a long press still cancels immediately.
+    bool moving = stepperControl.isMoving();
+
     // Handle encoder rotation
-    EncoderDirection rotation = uiEncoder.getRotation();
+    EncoderDirection rotation = moving ? ENCODER_NO_CHANGE : uiEncoder.getRotation();
     if (rotation != ENCODER_NO_CHANGE) {
         _current_screen->onEncoderTurn(rotation);
         // Defer redraw to next periodic cycle to avoid double draws
@@ -98,6 +111,13 @@ void LCDMenu::update() {
 
     // Handle button events
     ButtonEvent button_event = uiEncoder.getButtonEvent();
+    if (button_event == BUTTON_CLICK && moving) {
+        _deferred_click = true;
+        button_event = BUTTON_NO_EVENT;
+    } else if (button_event == BUTTON_NO_EVENT && _deferred_click && !moving) {
+        _deferred_click = false;
+        button_event = BUTTON_CLICK;
+    }
     switch (button_event) {
         case BUTTON_CLICK:
             _current_screen->onButtonClick();
@@ -109,6 +129,8 @@ void LCDMenu::update() {
             if (sd_exec_state == SD_EXEC_RUNNING || sd_exec_state == SD_EXEC_PAUSED) {
                 sd_exec_state = SD_EXEC_IDLE;
                 sdCard.closeFile();
+                motionQueue.clear(); // Already-queued moves of the file stop too
+                syncPositionFromSteps();
                 Buzzer::playPlotStop();
             }
             // Long press from any screen returns to Main Status
@@ -124,7 +146,7 @@ void LCDMenu::update() {
     }
 
     // Redraw periodically for dynamic content, or immediately if flagged
-    if (_needs_redraw || millis() - _last_redraw_time > REDRAW_INTERVAL_MS) {
+    if (!moving && (_needs_redraw || millis() - _last_redraw_time > REDRAW_INTERVAL_MS)) {
         _drawCurrentScreen();
         _last_redraw_time = millis();
         _needs_redraw = false;
@@ -155,12 +177,17 @@ void LCDMenu::beep(unsigned int duration_ms, unsigned int frequency_hz) {
 }
 
 void LCDMenu::_drawCurrentScreen() {
+    TRACE_EVENT(EV_LCD_BEGIN, _current_screen_type);
+    unsigned long start_us = micros();
     u8g2.firstPage();
     do {
         u8g2.setFontMode(1); // Transparent font background
         u8g2.setDrawColor(1); // White foreground
         _current_screen->draw();
     } while (u8g2.nextPage());
+    _last_frame_us = micros() - start_us;
+    if (_last_frame_us > _max_frame_us) _max_frame_us = _last_frame_us;
+    TRACE_EVENT(EV_LCD_END, _last_frame_us > 0xFFFF ? 0xFFFF : _last_frame_us);
 }
 
 void LCDMenu::updateDisplay() {
@@ -16,7 +16,7 @@ public:
     LCDMenu();
 
     void init();
-    void update(); // Call frequently in loop() to handle input and redraw
+    void update(); // Call frequently in loop() to handle input and redraw; no-op until init()
 
     void goToScreen(ScreenType screen_type); // Navigate to a specific screen without history management
     void back(); // Go back to the previous screen in history
@@ -25,6 +25,10 @@ public:
     // Beeper control
     void beep(unsigned int duration_ms = 50, unsigned int frequency_hz = 2000);
 
+    // Time to render and transmit one full frame (reported by M503)
+    unsigned long getLastFrameUs() const { return _last_frame_us; }
+    unsigned long getMaxFrameUs() const { return _max_frame_us; }
+
 private:
     BaseScreen* _screens[SCREEN_NUM_SCREENS]; // Array of all screen objects
     BaseScreen* _current_screen; // Pointer to the currently active screen
@@ -36,6 +40,10 @@ private:
 
     unsigned long _last_redraw_time;
     bool _needs_redraw = false; // Deferred redraw flag
+    bool _initialized = false;
+    bool _deferred_click = false; // Click received mid-move, delivered when the block ends
+    unsigned long _last_frame_us = 0;
+    unsigned long _max_frame_us = 0;
     static const unsigned long REDRAW_INTERVAL_MS = 150; // Redraw rate for static elements
 
     void _drawCurrentScreen(); // Internal function to draw the active screen
@@ -0,0 +1,182 @@
+// SimplePlotter_Firmware/src/ui/lcd_transport.cpp
+
+#include "lcd_transport.h"
+#include <util/atomic.h>
+
+#if LCD_TRANSPORT != LCD_TRANSPORT_SW_SPI
+
+// Chip select, resolved once at BYTE_INIT
+static volatile uint8_t* cs_port;
+static uint8_t cs_mask;
+
+// Pins above PORTG are outside the sbi/cbi range, so writes are read-modify-write
+// and must not interleave with an ISR touching the same port
+static inline void writePin(volatile uint8_t* port, uint8_t mask, uint8_t level) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (level) *port |= mask;
+        else       *port &= ~mask;
+    }
+}
+
+static void resolvePin(uint8_t pin, volatile uint8_t*& port, uint8_t& mask) {
+    port = portOutputRegister(digitalPinToPort(pin));
+    mask = digitalPinToBitMask(pin);
+}
+
+#endif
+
+#if LCD_TRANSPORT == LCD_TRANSPORT_FAST_SW
+
+static volatile uint8_t* clk_port;
+static uint8_t clk_mask;
+static volatile uint8_t* data_port;
+static uint8_t data_mask;
+
+// Same edge order as U8g2's u8x8_byte_4wire_sw_spi. One port write is ~5 cycles
+// (300 ns at 16 MHz), above the ST7920's 200 ns minimum clock high/low time, so
+// no extra delay is needed. Interrupts are held off for one byte (~5 us).
+static void shiftOut(const uint8_t* data, uint8_t len, uint8_t takeover_edge) {
+    uint8_t clk_take = takeover_edge ? clk_mask : 0;
+    uint8_t clk_not_take = takeover_edge ? 0 : clk_mask;
+    while (len--) {
+        uint8_t b = *data++;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            for (uint8_t i = 0; i < 8; i++) {
+                if (b & 0x80) *data_port |= data_mask;
+                else          *data_port &= ~data_mask;
+                b <<= 1;
+                *clk_port = (*clk_port & ~clk_mask) | clk_not_take;
+                *clk_port = (*clk_port & ~clk_mask) | clk_take;
+            }
+        }
+    }
+}
+
+uint8_t lcdTransportByte(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+    switch (msg) {
+        case U8X8_MSG_BYTE_INIT:
+            // Pin modes were set by the GPIO callback at GPIO_AND_DELAY_INIT
+            resolvePin(u8x8->pins[U8X8_PIN_CS], cs_port, cs_mask);
+            resolvePin(u8x8->pins[U8X8_PIN_SPI_CLOCK], clk_port, clk_mask);
+            resolvePin(u8x8->pins[U8X8_PIN_SPI_DATA], data_port, data_mask);
+            writePin(cs_port, cs_mask, u8x8->display_info->chip_disable_level);
+            writePin(clk_port, clk_mask, u8x8_GetSPIClockPolarity(u8x8));
+            break;
+        case U8X8_MSG_BYTE_SEND:
+            shiftOut((const uint8_t*)arg_ptr, arg_int, u8x8_GetSPIClockPhase(u8x8));
+            break;
+        case U8X8_MSG_BYTE_SET_DC:
+            break; // ST7920 serial mode carries RS in the sync byte
+        case U8X8_MSG_BYTE_START_TRANSFER:
+            writePin(cs_port, cs_mask, u8x8->display_info->chip_enable_level);
+            u8x8_gpio_Delay(u8x8, U8X8_MSG_DELAY_NANO, u8x8->display_info->post_chip_enable_wait_ns);
+            break;
+        case U8X8_MSG_BYTE_END_TRANSFER:
+            u8x8_gpio_Delay(u8x8, U8X8_MSG_DELAY_NANO, u8x8->display_info->pre_chip_disable_wait_ns);
+            writePin(cs_port, cs_mask, u8x8->display_info->chip_disable_level);
+            break;
+        default:
+            return 0;
+    }
+    return 1;
+}
+
+uint8_t lcdTransportGpioAndDelay(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+    return u8x8_gpio_and_delay_arduino(u8x8, msg, arg_int, arg_ptr);
+}
+
+#elif LCD_TRANSPORT == LCD_TRANSPORT_HW_SPI
+
+// Transmit ring drained by SPI_STC_vect. tx_busy is set while a byte is in SPDR.
+static volatile uint8_t tx_ring[LCD_TX_RING_SIZE];
+static volatile uint8_t tx_head = 0; // Next free slot (written by loop())
+static volatile uint8_t tx_tail = 0; // Next byte to send (advanced by the ISR)
+static volatile bool tx_busy = false;
+static uint8_t spcr_lcd; // SPCR for the display; SdFat reprograms the bus between frames
+
+ISR(SPI_STC_vect) {
+    if (tx_tail != tx_head) {
+        SPDR = tx_ring[tx_tail];
+        tx_tail = (tx_tail + 1) & (LCD_TX_RING_SIZE - 1);
+    } else {
+        tx_busy = false;
+    }
+}
+
+static void txPush(uint8_t b) {
+    uint8_t next = (tx_head + 1) & (LCD_TX_RING_SIZE - 1);
+    while (next == tx_tail) {} // Ring full: the ISR frees a slot every 8 us
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!tx_busy) {
+            tx_busy = true;
+            SPDR = b;
+        } else {
+            tx_ring[tx_head] = b;
+            tx_head = next;
+        }
+    }
+}
+
+static void txDrain() {
+    while (tx_busy) {}
+}
+
+uint8_t lcdTransportByte(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+    switch (msg) {
+        case U8X8_MSG_BYTE_INIT: {
+            resolvePin(u8x8->pins[U8X8_PIN_CS], cs_port, cs_mask);
+            writePin(cs_port, cs_mask, u8x8->display_info->chip_disable_level);
+            // Master mode needs SS as an output; it is the SD card's select, keep it deselected
+            pinMode(SDSS, OUTPUT);
+            digitalWrite(SDSS, HIGH);
+            pinMode(SCK, OUTPUT);
+            pinMode(MOSI, OUTPUT);
+            // F_CPU/16 = 1 MHz, well inside the ST7920's serial clock limit
+            spcr_lcd = _BV(SPE) | _BV(MSTR) | _BV(SPR0);
+            if (u8x8_GetSPIClockPolarity(u8x8)) spcr_lcd |= _BV(CPOL);
+            if (u8x8_GetSPIClockPhase(u8x8)) spcr_lcd |= _BV(CPHA);
+            break;
+        }
+        case U8X8_MSG_BYTE_SEND: {
+            const uint8_t* data = (const uint8_t*)arg_ptr;
+            while (arg_int--) txPush(*data++);
+            break;
+        }
+        case U8X8_MSG_BYTE_SET_DC:
+            break; // ST7920 serial mode carries RS in the sync byte
+        case U8X8_MSG_BYTE_START_TRANSFER:
+            SPCR = spcr_lcd;
+            SPSR &= ~_BV(SPI2X);
+            (void)SPSR; // Clear a stale SPIF left by the last SD transfer
+            (void)SPDR;
+            SPCR |= _BV(SPIE);
+            writePin(cs_port, cs_mask, u8x8->display_info->chip_enable_level);
+            u8x8_gpio_Delay(u8x8, U8X8_MSG_DELAY_NANO, u8x8->display_info->post_chip_enable_wait_ns);
+            break;
+        case U8X8_MSG_BYTE_END_TRANSFER:
+            txDrain();
+            SPCR &= ~_BV(SPIE); // Hand the bus back to SdFat's polled transfers
+            u8x8_gpio_Delay(u8x8, U8X8_MSG_DELAY_NANO, u8x8->display_info->pre_chip_disable_wait_ns);
+            writePin(cs_port, cs_mask, u8x8->display_info->chip_disable_level);
+            break;
+        default:
+            return 0;
+    }
+    return 1;
+}
+
+uint8_t lcdTransportGpioAndDelay(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+    switch (msg) {
+        case U8X8_MSG_DELAY_MILLI:
+        case U8X8_MSG_DELAY_10MICRO:
+        case U8X8_MSG_DELAY_100NANO:
+        case U8X8_MSG_DELAY_NANO:
+            txDrain(); // The st7920 layer times command execution from the last byte
+            break;
+        default:
+            break;
+    }
+    return u8x8_gpio_and_delay_arduino(u8x8, msg, arg_int, arg_ptr);
+}
+
+#endif // LCD_TRANSPORT
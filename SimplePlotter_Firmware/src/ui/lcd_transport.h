@@ -0,0 +1,50 @@
+// SimplePlotter_Firmware/src/ui/lcd_transport.h
+
+#ifndef LCD_TRANSPORT_H
+#define LCD_TRANSPORT_H
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include "../config.h"
+
+// Byte transports for the ST7920 in serial mode. The display's sync/RW/RS framing
+// is composed by U8g2's st7920 command layer, so a transport only has to clock
+// raw bytes out with the chip select held at the display's enable level.
+//
+// A USART in master-SPI mode would be the natural spare peripheral, but the MKS
+// Gen board doesn't break out any XCK clock pin, so the choice is between:
+//   LCD_TRANSPORT_FAST_SW - same EXP1 pins as stock (SCLK D23, SID D17, CS D16),
+//                           bit-banged with direct port writes instead of
+//                           digitalWrite (no pin table lookups per edge).
+//   LCD_TRANSPORT_HW_SPI  - the SPI peripheral shared with the SD card. Needs the
+//                           display's SCLK/SID moved to D52/D51; CS stays on D16
+//                           (active high, so SD traffic never reaches the display).
+//                           Bytes go out from SPI_STC_vect through a small ring.
+//   LCD_TRANSPORT_SW_SPI  - U8g2's own U8G2_ST7920_128X64_2_SW_SPI.
+#if LCD_TRANSPORT == LCD_TRANSPORT_HW_SPI
+static_assert((LCD_TX_RING_SIZE & (LCD_TX_RING_SIZE - 1)) == 0 && LCD_TX_RING_SIZE <= 256,
+              "LCD_TX_RING_SIZE must be a power of two <= 256");
+#endif
+
+// U8g2 byte callback for the selected transport
+uint8_t lcdTransportByte(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr);
+// Forwards to the Arduino GPIO/delay callback; with HW_SPI, delays first wait for
+// queued bytes so the display sees the pause after them, not in the middle
+uint8_t lcdTransportGpioAndDelay(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr);
+
+#if LCD_TRANSPORT == LCD_TRANSPORT_SW_SPI
+typedef U8G2_ST7920_128X64_2_SW_SPI PlotterLcd;
+#else
+// ST7920 128x64, 2-page buffer, on the transport above. Same constructor
+// arguments as U8G2_ST7920_128X64_2_SW_SPI.
+class PlotterLcd : public U8G2 {
+public:
+    PlotterLcd(const u8g2_cb_t* rotation, uint8_t clock, uint8_t data, uint8_t cs,
+               uint8_t reset = U8X8_PIN_NONE) : U8G2() {
+        u8g2_Setup_st7920_s_128x64_2(&u8g2, rotation, lcdTransportByte, lcdTransportGpioAndDelay);
+        u8x8_SetPin_4Wire_SW_SPI(getU8x8(), clock, data, cs, U8X8_PIN_NONE, reset);
+    }
+};
+#endif
+
+#endif // LCD_TRANSPORT_H
@@ -6,11 +6,15 @@
 #include "cat_animation.h"
 #include "../globals.h"
 #include "../io/sd_card.h"
+#include "../io/job_eta.h"
 #include "../io/buzzer.h"
+#include "../motion/height_map.h"
+#include "../motion/pen.h"
+#include "../motion/step_stream.h"
 #include <avr/wdt.h>
 
 // Global U8g2 object definition
-U8G2_ST7920_128X64_2_SW_SPI u8g2(U8G2_R0, LCD_PINS_D4, LCD_PINS_ENABLE, LCD_PINS_RS);
+PlotterLcd u8g2(U8G2_R0, LCD_PINS_D4, LCD_PINS_ENABLE, LCD_PINS_RS);
 
 // Runtime-adjustable pen Z positions
 float pen_up_z = PEN_UP_Z;
@@ -33,35 +37,35 @@ extern void menuUpdateDisplay();
 
 void MainStatusScreen::draw() {
     // Title bar
-    drawTitleBar(u8g2, "SimplePlotter");
+    drawTitleBar_P(u8g2, PSTR("SimplePlotter"));
 
     u8g2.setFont(u8g2_font_5x7_tf);
 
     // Position display
     char buf[22];
-    snprintf(buf, sizeof(buf), "X:%.1f Y:%.1f", (double)current_position_mm.x, (double)current_position_mm.y);
+    snprintf_P(buf, sizeof(buf), PSTR("X:%.1f Y:%.1f"), (double)current_position_mm.x, (double)current_position_mm.y);
     u8g2.drawStr(0, 22, buf);
 
-    snprintf(buf, sizeof(buf), "Z:%.1f", (double)current_position_mm.z);
+    snprintf_P(buf, sizeof(buf), PSTR("Z:%.1f"), (double)current_position_mm.z);
     u8g2.drawStr(0, 31, buf);
 
     // Homing status
     if (homing.isHomed()) {
-        u8g2.drawStr(50, 31, "[HOMED]");
+        drawStr_P(u8g2, 50, 31, PSTR("[HOMED]"));
     } else {
-        u8g2.drawStr(50, 31, "[!HOME]");
+        drawStr_P(u8g2, 50, 31, PSTR("[!HOME]"));
     }
 
     // Speed factor
-    snprintf(buf, sizeof(buf), "Spd:%d%%", (int)speed_factor);
+    snprintf_P(buf, sizeof(buf), PSTR("Spd:%d%%"), (int)speed_factor);
     u8g2.drawStr(0, 41, buf);
 
     // SD status
-    u8g2.drawStr(60, 41, "SD:");
+    drawStr_P(u8g2, 60, 41, PSTR("SD:"));
     if (digitalRead(SD_DETECT_PIN) == LOW) {
-        u8g2.drawStr(78, 41, "OK");
+        drawStr_P(u8g2, 78, 41, PSTR("OK"));
     } else {
-        u8g2.drawStr(78, 41, "--");
+        drawStr_P(u8g2, 78, 41, PSTR("--"));
     }
 
     // Sans animation (bottom-right corner) - desktop pet behavior!
@@ -94,7 +98,7 @@ void MainStatusScreen::draw() {
 
     // Hint at bottom
     u8g2.setFont(u8g2_font_4x6_tf);
-    u8g2.drawStr(0, 63, "Click: Menu");
+    drawStr_P(u8g2, 0, 63, PSTR("Click: Menu"));
 }
 
 void MainStatusScreen::onButtonClick() {
@@ -105,8 +109,9 @@ void MainStatusScreen::onButtonClick() {
 // ManualControlScreen - main menu with scrollable list
 //===========================================================================
 
-static const char* const manualMenuItems[] = {
+static const MenuLabel manualMenuItems[] PROGMEM = {
     "Jog Step",
+    "Cont. Jog",
     "Home Axes",
     "Pen Settings",
     "Motion Settings",
@@ -116,8 +121,8 @@ static const char* const manualMenuItems[] = {
 };
 
 void ManualControlScreen::draw() {
-    drawTitleBar(u8g2, "Menu");
-    drawMenuList(u8g2, manualMenuItems, ITEM_COUNT, _selectedItem, _scrollOffset);
+    drawTitleBar_P(u8g2, PSTR("Menu"));
+    drawMenuList_P(u8g2, manualMenuItems, ITEM_COUNT, _selectedItem, _scrollOffset);
 }
 
 void ManualControlScreen::onEncoderTurn(int direction) {
@@ -128,12 +133,13 @@ void ManualControlScreen::onEncoderTurn(int direction) {
 void ManualControlScreen::onButtonClick() {
     switch (_selectedItem) {
         case 0: menuGoTo(SCREEN_JOG_STEP); break;
-        case 1: menuGoTo(SCREEN_HOME_AXIS); break;
-        case 2: menuGoTo(SCREEN_PEN_SETTINGS); break;
-        case 3: menuGoTo(SCREEN_MOTION_SETTINGS); break;
-        case 4: menuGoTo(SCREEN_INFO); break;
-        case 5: menuGoTo(SCREEN_SD_CARD); break;
-        case 6: menuBack(); break;
+        case 1: menuGoTo(SCREEN_JOG_CONTINUOUS); break;
+        case 2: menuGoTo(SCREEN_HOME_AXIS); break;
+        case 3: menuGoTo(SCREEN_PEN_SETTINGS); break;
+        case 4: menuGoTo(SCREEN_MOTION_SETTINGS); break;
+        case 5: menuGoTo(SCREEN_INFO); break;
+        case 6: menuGoTo(SCREEN_SD_CARD); break;
+        case 7: menuBack(); break;
     }
 }
 
@@ -149,13 +155,13 @@ void ManualControlScreen::onExit() {}
 //===========================================================================
 
 static const float jogStepOptions[] = {0.1, 0.5, 1.0, 5.0, 10.0};
-static const char* const jogStepLabels[] = {
+static const MenuLabel jogStepLabels[] PROGMEM = {
     "0.1 mm", "0.5 mm", "1.0 mm", "5.0 mm", "10.0 mm", "Back"
 };
 
 void JogStepScreen::draw() {
-    drawTitleBar(u8g2, "Jog Step");
-    drawMenuList(u8g2, jogStepLabels, STEP_COUNT, _selectedIdx, _scrollOffset);
+    drawTitleBar_P(u8g2, PSTR("Jog Step"));
+    drawMenuList_P(u8g2, jogStepLabels, STEP_COUNT, _selectedIdx, _scrollOffset);
 }
 
 void JogStepScreen::onEncoderTurn(int direction) {
@@ -186,25 +192,81 @@ void JogStepScreen::onEnter() {
 
 void JogStepScreen::onExit() {}
 
+//===========================================================================
+// ContinuousJogScreen - encoder velocity drives the selected axis
+//===========================================================================
+
+void ContinuousJogScreen::draw() {
+    drawTitleBar_P(u8g2, PSTR("Cont. Jog"));
+    u8g2.setFont(u8g2_font_6x10_tf);
+
+    char buf[24];
+    if (_axis > 2) {
+        drawStr_P(u8g2, 4, 24, PSTR("Axis: Back"));
+    } else {
+        snprintf_P(buf, sizeof(buf), PSTR("Axis: %c"), 'X' + _axis);
+        u8g2.drawStr(4, 24, buf);
+    }
+    snprintf_P(buf, sizeof(buf), PSTR("X:%.1f Y:%.1f"), (double)current_position_mm.x, (double)current_position_mm.y);
+    u8g2.drawStr(4, 36, buf);
+    snprintf_P(buf, sizeof(buf), PSTR("Z:%.2f"), (double)current_position_mm.z);
+    if (stepperControl.isJogging()) strncat_P(buf, PSTR(" moving"), sizeof(buf) - strlen(buf) - 1);
+    u8g2.drawStr(4, 48, buf);
+    drawStr_P(u8g2, 4, 60, PSTR("Turn=jog Click=axis"));
+}
+
+void ContinuousJogScreen::onEncoderTurn(int direction) {
+    if (_axis > 2) return;
+
+    // Velocity from the time between detents; a first detent after a pause starts slowly
+    unsigned long now = millis();
+    unsigned long interval = now - _lastDetent;
+    _lastDetent = now;
+    if (interval > JOG_COMMAND_TIMEOUT_MS) interval = JOG_COMMAND_TIMEOUT_MS;
+    if (interval < 1) interval = 1;
+
+    AxisIndex axis = (AxisIndex)_axis;
+    float mm_s = direction * JOG_MM_PER_DETENT * 1000.0f / interval;
+    stepperControl.jogSetVelocity(axis, mm_s * axisConfig[axis].steps_per_mm); // Clamped to JOG_MAX_VELOCITY_*
+}
+
+void ContinuousJogScreen::onButtonClick() {
+    if (_axis == 3) {
+        menuBack();
+        return;
+    }
+    stepperControl.jogStop();
+    _axis = (_axis + 1) % 4;
+}
+
+void ContinuousJogScreen::onEnter() {
+    _axis = 0;
+    _lastDetent = 0;
+}
+
+void ContinuousJogScreen::onExit() {
+    stepperControl.jogStop();
+}
+
 //===========================================================================
 // HomeAxisScreen - select axis to home, with spinner feedback
 //===========================================================================
 
-static const char* const homeMenuItems[] = {
-    "Home X", "Home Y", "Home Z", "Home All", "Back"
+static const MenuLabel homeMenuItems[] PROGMEM = {
+    "Home X", "Home Y", "Home Z", "Home All", "Probe Paper", "Back"
 };
 
 void HomeAxisScreen::draw() {
-    drawTitleBar(u8g2, "Home Axes");
+    drawTitleBar_P(u8g2, PSTR("Home Axes"));
 
     if (_isHoming) {
         // Show homing in progress
         u8g2.setFont(u8g2_font_6x10_tf);
-        u8g2.drawStr(10, 30, _homingLabel);
+        drawStr_P(u8g2, 10, 30, _homingLabel);
         drawSpinner(u8g2, 100, 35, 8, _spinnerFrame++);
         drawProgressBar(u8g2, 10, 48, 108, 8, -1); // indeterminate
     } else {
-        drawMenuList(u8g2, homeMenuItems, ITEM_COUNT, _selectedItem, _scrollOffset);
+        drawMenuList_P(u8g2, homeMenuItems, ITEM_COUNT, _selectedItem, _scrollOffset);
     }
 }
 
@@ -220,33 +282,47 @@ void HomeAxisScreen::onButtonClick() {
     switch (_selectedItem) {
         case 0:
             _isHoming = true;
-            strncpy(_homingLabel, "Homing X...", sizeof(_homingLabel));
+            _homingLabel = PSTR("Homing X...");
             menuUpdateDisplay();
-            homing.homeAxis('X');
+            homing.homeAxis(AXIS_X);
             _isHoming = false;
             break;
         case 1:
             _isHoming = true;
-            strncpy(_homingLabel, "Homing Y...", sizeof(_homingLabel));
+            _homingLabel = PSTR("Homing Y...");
             menuUpdateDisplay();
-            homing.homeAxis('Y');
+            homing.homeAxis(AXIS_Y);
             _isHoming = false;
             break;
         case 2:
             _isHoming = true;
-            strncpy(_homingLabel, "Homing Z...", sizeof(_homingLabel));
+            _homingLabel = PSTR("Homing Z...");
             menuUpdateDisplay();
-            homing.homeAxis('Z');
+            homing.homeAxis(AXIS_Z);
             _isHoming = false;
             break;
         case 3:
             _isHoming = true;
-            strncpy(_homingLabel, "Homing All...", sizeof(_homingLabel));
+            _homingLabel = PSTR("Homing All...");
             menuUpdateDisplay();
             homing.homeAllAxes();
             _isHoming = false;
             break;
         case 4:
+            _isHoming = true;
+            _homingLabel = PSTR("Probing...");
+            menuUpdateDisplay();
+            if (heightMap.probe()) {
+                Buzzer::playHomingDone();
+            } else {
+                Buzzer::playError();
+            }
+            current_position_mm.x = kinematics.stepsToMmX(stepperControl.getCurrentXSteps());
+            current_position_mm.y = kinematics.stepsToMmY(stepperControl.getCurrentYSteps());
+            current_position_mm.z = kinematics.stepsToMmZ(stepperControl.getCurrentZSteps());
+            _isHoming = false;
+            break;
+        case 5:
             menuBack();
             return;
     }
@@ -267,31 +343,37 @@ void HomeAxisScreen::onExit() {
 // PenSettingsScreen - adjust pen up/down Z + test pen
 //===========================================================================
 
+static const MenuLabel penStaticItems[] PROGMEM = { "Test Pen", "Test Z Raw", "Back" };
+
 void PenSettingsScreen::draw() {
-    drawTitleBar(u8g2, "Pen Settings");
+    drawTitleBar_P(u8g2, PSTR("Pen Settings"));
 
     u8g2.setFont(u8g2_font_6x10_tf);
     const int startY = 14;
     const int lineH = 11;
     const int visibleLines = (64 - startY) / lineH; // 4 visible
 
-    // Build dynamic labels
-    char buf0[24], buf1[24];
-    snprintf(buf0, sizeof(buf0), "Pen Up Z: %.1f", (double)pen_up_z);
-    snprintf(buf1, sizeof(buf1), "Pen Dn Z: %.1f", (double)pen_down_z);
-    const char* labels[5] = { buf0, buf1, "Test Pen", "Test Z Raw", "Back" };
-
     for (int i = 0; i < visibleLines && (_scrollOffset + i) < ITEM_COUNT; i++) {
         int itemIdx = _scrollOffset + i;
         int y = startY + i * lineH + 9;
 
+        // Z values are formatted, the rest come from flash
+        char label[24];
+        if (itemIdx == 0) {
+            snprintf_P(label, sizeof(label), PSTR("Pen Up Z: %.1f"), (double)pen_up_z);
+        } else if (itemIdx == 1) {
+            snprintf_P(label, sizeof(label), PSTR("Pen Dn Z: %.1f"), (double)pen_down_z);
+        } else {
+            strncpy_P(label, penStaticItems[itemIdx - 2], sizeof(label));
+        }
+
         if (itemIdx == _selectedItem) {
             u8g2.drawBox(0, startY + i * lineH, 128, lineH);
             u8g2.setDrawColor(0);
         }
-        u8g2.drawStr(2, y, labels[itemIdx]);
+        u8g2.drawStr(2, y, label);
         if (_editing && itemIdx == _selectedItem && itemIdx < 2) {
-            u8g2.drawStr(108, y, "<>");
+            drawStr_P(u8g2, 108, y, PSTR("<>"));
         }
         u8g2.setDrawColor(1);
     }
@@ -325,18 +407,10 @@ void PenSettingsScreen::onButtonClick() {
     }
 
     if (_selectedItem == 2) {
-        // Test pen: move Z down then up
-        long downSteps = (long)(pen_down_z * Z_STEPS_PER_MM);
-        long upSteps = (long)(pen_up_z * Z_STEPS_PER_MM);
-        stepperControl.enableSteppers();
-        stepperControl.setAxisMaxSpeed('Z', MAX_VELOCITY_Z * Z_STEPS_PER_MM);
-        stepperControl.setAxisAcceleration('Z', MAX_ACCEL_Z * Z_STEPS_PER_MM);
-        stepperControl.moveAxisTo('Z', downSteps);
-        while (stepperControl.runAxis('Z')) { wdt_reset(); }
-        delay(500);
+        // Test pen: down, hold, up
+        delay(pen.set(false) + 500);
         wdt_reset();
-        stepperControl.moveAxisTo('Z', upSteps);
-        while (stepperControl.runAxis('Z')) { wdt_reset(); }
+        delay(pen.set(true));
         return;
     }
 
@@ -365,7 +439,7 @@ void PenSettingsScreen::onExit() {
 //===========================================================================
 
 void MotionSettingsScreen::draw() {
-    drawTitleBar(u8g2, "Motion");
+    drawTitleBar_P(u8g2, PSTR("Motion"));
 
     u8g2.setFont(u8g2_font_6x10_tf);
     const int startY = 14;
@@ -378,9 +452,9 @@ void MotionSettingsScreen::draw() {
         u8g2.setDrawColor(0);
     }
     char buf[24];
-    snprintf(buf, sizeof(buf), "Speed: %d%%", (int)speed_factor);
+    snprintf_P(buf, sizeof(buf), PSTR("Speed: %d%%"), (int)speed_factor);
     u8g2.drawStr(2, y, buf);
-    if (_editing && _selectedItem == 0) u8g2.drawStr(115, y, "<>");
+    if (_editing && _selectedItem == 0) drawStr_P(u8g2, 115, y, PSTR("<>"));
     u8g2.setDrawColor(1);
 
     // Item 1: Back
@@ -389,7 +463,7 @@ void MotionSettingsScreen::draw() {
         u8g2.drawBox(0, startY + lineH, 128, lineH);
         u8g2.setDrawColor(0);
     }
-    u8g2.drawStr(2, y, "Back");
+    drawStr_P(u8g2, 2, y, PSTR("Back"));
     u8g2.setDrawColor(1);
 
     // Show speed bar (map 0-200% to 0-100 for progress bar)
@@ -428,26 +502,26 @@ void MotionSettingsScreen::onExit() {
 //===========================================================================
 
 void InfoScreen::draw() {
-    drawTitleBar(u8g2, "Info");
+    drawTitleBar_P(u8g2, PSTR("Info"));
 
     u8g2.setFont(u8g2_font_5x7_tf);
 
-    u8g2.drawStr(2, 22, "FW: SimplePlotter " FIRMWARE_VERSION_STRING);
+    drawStr_P(u8g2, 2, 22, PSTR("FW: SimplePlotter " FIRMWARE_VERSION_STRING));
 
     char buf[24];
-    snprintf(buf, sizeof(buf), "Free RAM: %d B", freeMemory());
+    snprintf_P(buf, sizeof(buf), PSTR("Free RAM: %d B"), freeMemory());
     u8g2.drawStr(2, 31, buf);
 
     char uptimeBuf[12];
     formatUptime(millis(), uptimeBuf, sizeof(uptimeBuf));
-    snprintf(buf, sizeof(buf), "Uptime: %s", uptimeBuf);
+    snprintf_P(buf, sizeof(buf), PSTR("Uptime: %s"), uptimeBuf);
     u8g2.drawStr(2, 40, buf);
 
-    snprintf(buf, sizeof(buf), "Lines: %lu", lines_plotted);
+    snprintf_P(buf, sizeof(buf), PSTR("Lines: %lu"), lines_plotted);
     u8g2.drawStr(2, 49, buf);
 
     u8g2.setFont(u8g2_font_4x6_tf);
-    u8g2.drawStr(2, 63, "Click: Back");
+    drawStr_P(u8g2, 2, 63, PSTR("Click: Back"));
 }
 
 void InfoScreen::onEncoderTurn(int direction) {
@@ -466,35 +540,37 @@ volatile SDExecState sd_exec_state = SD_EXEC_IDLE;
 char sd_exec_filename[13] = {0};
 
 void SDScreen::draw() {
-    drawTitleBar(u8g2, "SD Card");
+    drawTitleBar_P(u8g2, PSTR("SD Card"));
 
     // If currently executing, show progress
     if (_showingExec && sd_exec_state != SD_EXEC_IDLE) {
         u8g2.setFont(u8g2_font_5x7_tf);
 
         char buf[24];
-        snprintf(buf, sizeof(buf), "File: %.12s", sd_exec_filename);
+        snprintf_P(buf, sizeof(buf), PSTR("File: %.12s"), sd_exec_filename);
         u8g2.drawStr(2, 22, buf);
 
         if (sd_exec_state == SD_EXEC_RUNNING) {
-            u8g2.drawStr(2, 32, "Printing...");
+            drawStr_P(u8g2, 2, 32, PSTR("Printing..."));
         } else if (sd_exec_state == SD_EXEC_PAUSED) {
-            u8g2.drawStr(2, 32, "PAUSED");
+            drawStr_P(u8g2, 2, 32, PSTR("PAUSED"));
         } else if (sd_exec_state == SD_EXEC_DONE) {
-            u8g2.drawStr(2, 32, "Done!");
+            drawStr_P(u8g2, 2, 32, PSTR("Done!"));
         }
 
         uint8_t pct = sdCard.progressPercent();
         drawProgressBar(u8g2, 2, 38, 124, 8, pct);
 
-        snprintf(buf, sizeof(buf), "%d%%", pct);
-        u8g2.drawStr(55, 55, buf);
+        char eta[9];
+        jobEta.format(eta);
+        snprintf_P(buf, sizeof(buf), PSTR("%d%%  ETA %s"), pct, eta);
+        u8g2.drawStr(2, 55, buf);
 
         u8g2.setFont(u8g2_font_4x6_tf);
         if (sd_exec_state == SD_EXEC_DONE) {
-            u8g2.drawStr(2, 63, "Click: Back");
+            drawStr_P(u8g2, 2, 63, PSTR("Click: Back"));
         } else {
-            u8g2.drawStr(2, 63, "Click:Pause Long:Cancel");
+            drawStr_P(u8g2, 2, 63, PSTR("Click:Pause Long:Cancel"));
         }
         return;
     }
@@ -503,17 +579,17 @@ void SDScreen::draw() {
     u8g2.setFont(u8g2_font_6x10_tf);
 
     if (!sdCard.isPresent()) {
-        u8g2.drawStr(10, 30, "No SD card");
-        u8g2.drawStr(10, 42, "Insert card...");
+        drawStr_P(u8g2, 10, 30, PSTR("No SD card"));
+        drawStr_P(u8g2, 10, 42, PSTR("Insert card..."));
         u8g2.setFont(u8g2_font_4x6_tf);
-        u8g2.drawStr(2, 63, "Click: Back");
+        drawStr_P(u8g2, 2, 63, PSTR("Click: Back"));
         return;
     }
 
     if (_fileCount == 0) {
-        u8g2.drawStr(10, 30, "No .gcode files");
+        drawStr_P(u8g2, 10, 30, PSTR("No .gcode files"));
         u8g2.setFont(u8g2_font_4x6_tf);
-        u8g2.drawStr(2, 63, "Click: Back");
+        drawStr_P(u8g2, 2, 63, PSTR("Click: Back"));
         return;
     }
 
@@ -522,7 +598,9 @@ void SDScreen::draw() {
     for (int i = 0; i < _fileCount; i++) {
         ptrs[i] = _fileList[i];
     }
-    ptrs[_fileCount] = "Back";
+    char back[5];
+    strcpy_P(back, PSTR("Back"));
+    ptrs[_fileCount] = back;
     int totalItems = _fileCount + 1;
     drawMenuList(u8g2, ptrs, totalItems, _selectedItem, _scrollOffset);
 }
@@ -569,6 +647,11 @@ void SDScreen::onButtonClick() {
     sd_exec_filename[12] = '\0';
 
     if (sdCard.openFile(sd_exec_filename)) {
+        if (!stepStream.prepareJob(sd_exec_filename)) {
+            sdCard.closeFile();
+            Buzzer::playError();
+            return;
+        }
         sd_exec_state = SD_EXEC_RUNNING;
         _showingExec = true;
         plotPreviewScreen.clear();
@@ -613,15 +696,17 @@ void PlotPreviewScreen::draw() {
 
     // Status bar below preview
     u8g2.setFont(u8g2_font_4x6_tf);
-    char buf[28];
-    snprintf(buf, sizeof(buf), "Lines:%lu Spd:%d%%", lines_plotted, (int)speed_factor);
+    char buf[32];
+    char eta[9];
+    jobEta.format(eta);
+    snprintf_P(buf, sizeof(buf), PSTR("L:%lu Spd:%d%% ETA:%s"), lines_plotted, (int)speed_factor, eta);
     u8g2.drawStr(0, 55, buf);
 
     // Progress bar at bottom
     drawProgressBar(u8g2, 0, 57, 100, 7, _progress);
 
     // Percentage text
-    snprintf(buf, sizeof(buf), "%d%%", _progress);
+    snprintf_P(buf, sizeof(buf), PSTR("%d%%"), _progress);
     u8g2.drawStr(104, 63, buf);
 }
 
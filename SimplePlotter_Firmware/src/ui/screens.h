@@ -6,6 +6,7 @@
 #include <Arduino.h>
 #include <U8g2lib.h>
 #include "../config.h"
+#include "lcd_transport.h"
 #include "../motion/kinematics.h"
 
 // SD card constants (must match sd_card.h)
@@ -16,13 +17,13 @@
 #define SD_MAX_FILENAME 13
 #endif
 
-// Global U8g2 object declaration
-// ST7920 SW_SPI constructor: (rotation, clock, data, cs [, reset])
+// Global U8g2 object declaration (PlotterLcd: ST7920 on the LCD_TRANSPORT byte transport)
+// Constructor: (rotation, clock, data, cs [, reset])
 //   Clock (SCK):  LCD_PINS_D4     (D23)
 //   Data  (SID):  LCD_PINS_ENABLE (D17)
 //   CS:           LCD_PINS_RS     (D16)
 // Using _2_ (2-page buffer, 512 bytes) for faster refresh vs _1_ (1-page, 256 bytes).
-extern U8G2_ST7920_128X64_2_SW_SPI u8g2;
+extern PlotterLcd u8g2;
 
 // Runtime-adjustable pen Z positions (initialized from config.h defines)
 extern float pen_up_z;
@@ -50,6 +51,7 @@ enum ScreenType {
     SCREEN_MAIN_STATUS,
     SCREEN_MANUAL_CONTROL,
     SCREEN_JOG_STEP,
+    SCREEN_JOG_CONTINUOUS,
     SCREEN_HOME_AXIS,
     SCREEN_PEN_SETTINGS,
     SCREEN_MOTION_SETTINGS,
@@ -80,7 +82,7 @@ public:
 private:
     int _selectedItem = 0;
     int _scrollOffset = 0;
-    static const int ITEM_COUNT = 7;
+    static const int ITEM_COUNT = 8;
 };
 
 class JogStepScreen : public BaseScreen {
@@ -96,6 +98,20 @@ private:
     static const int STEP_COUNT = 6; // 5 steps + Back
 };
 
+// Continuous jog: the encoder works like a handwheel. Turning speed sets the
+// carriage velocity; the carriage coasts to a stop shortly after turning stops.
+class ContinuousJogScreen : public BaseScreen {
+public:
+    void draw() override;
+    void onEncoderTurn(int direction) override;
+    void onButtonClick() override;
+    void onEnter() override;
+    void onExit() override;
+private:
+    uint8_t _axis = 0;            // 0=X, 1=Y, 2=Z, 3=Back
+    unsigned long _lastDetent = 0; // millis() of the previous encoder detent
+};
+
 class HomeAxisScreen : public BaseScreen {
 public:
     void draw() override;
@@ -107,9 +123,9 @@ private:
     int _selectedItem = 0;
     int _scrollOffset = 0;
     bool _isHoming = false;
-    char _homingLabel[16];
+    PGM_P _homingLabel = nullptr; // Flash string shown while homing
     uint8_t _spinnerFrame = 0;
-    static const int ITEM_COUNT = 5;
+    static const int ITEM_COUNT = 6;
 };
 
 class PenSettingsScreen : public BaseScreen {
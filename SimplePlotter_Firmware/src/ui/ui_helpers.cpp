@@ -1,6 +1,13 @@
 #include "ui_helpers.h"
 #include <Arduino.h>
 
+void drawStr_P(U8G2 &u8g2, int x, int y, PGM_P str) {
+    char buf[UI_TEXT_P_MAX];
+    strncpy_P(buf, str, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    u8g2.drawStr(x, y, buf);
+}
+
 void drawTitleBar(U8G2 &u8g2, const char* title) {
     u8g2.setFont(u8g2_font_6x10_tf);
     u8g2.setDrawColor(1);
@@ -10,33 +17,61 @@ void drawTitleBar(U8G2 &u8g2, const char* title) {
     u8g2.setDrawColor(1);
 }
 
+void drawTitleBar_P(U8G2 &u8g2, PGM_P title) {
+    char buf[UI_TEXT_P_MAX];
+    strncpy_P(buf, title, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    drawTitleBar(u8g2, buf);
+}
+
+static const int MENU_LINE_HEIGHT = 11;
+
+static void drawMenuRow(U8G2 &u8g2, int row, const char* text, bool selected, int startY) {
+    int y = startY + row * MENU_LINE_HEIGHT + 9;
+    if (selected) {
+        // Draw highlight bar
+        u8g2.drawBox(0, startY + row * MENU_LINE_HEIGHT, 128, MENU_LINE_HEIGHT);
+        u8g2.setDrawColor(0);
+        u8g2.drawStr(2, y, text);
+        u8g2.setDrawColor(1);
+    } else {
+        u8g2.drawStr(2, y, text);
+    }
+}
+
+static void drawMenuScrollbar(U8G2 &u8g2, int itemCount, int scrollOffset, int startY) {
+    const int visibleLines = (64 - startY) / MENU_LINE_HEIGHT;
+    if (itemCount > visibleLines) {
+        int barHeight = max(4, (64 - startY) * visibleLines / itemCount);
+        int barY = startY + (int)((long)(64 - startY - barHeight) * scrollOffset / max(1, itemCount - visibleLines));
+        u8g2.drawBox(126, barY, 2, barHeight);
+    }
+}
+
 void drawMenuList(U8G2 &u8g2, const char* const items[], int itemCount,
                   int selectedIndex, int scrollOffset, int startY) {
     u8g2.setFont(u8g2_font_6x10_tf);
-    const int lineHeight = 11;
-    const int visibleLines = (64 - startY) / lineHeight;
+    const int visibleLines = (64 - startY) / MENU_LINE_HEIGHT;
 
     for (int i = 0; i < visibleLines && (scrollOffset + i) < itemCount; i++) {
         int itemIdx = scrollOffset + i;
-        int y = startY + i * lineHeight + 9;
-
-        if (itemIdx == selectedIndex) {
-            // Draw highlight bar
-            u8g2.drawBox(0, startY + i * lineHeight, 128, lineHeight);
-            u8g2.setDrawColor(0);
-            u8g2.drawStr(2, y, items[itemIdx]);
-            u8g2.setDrawColor(1);
-        } else {
-            u8g2.drawStr(2, y, items[itemIdx]);
-        }
+        drawMenuRow(u8g2, i, items[itemIdx], itemIdx == selectedIndex, startY);
     }
+    drawMenuScrollbar(u8g2, itemCount, scrollOffset, startY);
+}
 
-    // Draw scrollbar if needed
-    if (itemCount > visibleLines) {
-        int barHeight = max(4, (64 - startY) * visibleLines / itemCount);
-        int barY = startY + (int)((long)(64 - startY - barHeight) * scrollOffset / max(1, itemCount - visibleLines));
-        u8g2.drawBox(126, barY, 2, barHeight);
+void drawMenuList_P(U8G2 &u8g2, const MenuLabel items[], int itemCount,
+                    int selectedIndex, int scrollOffset, int startY) {
+    u8g2.setFont(u8g2_font_6x10_tf);
+    const int visibleLines = (64 - startY) / MENU_LINE_HEIGHT;
+    char label[MENU_LABEL_LEN];
+
+    for (int i = 0; i < visibleLines && (scrollOffset + i) < itemCount; i++) {
+        int itemIdx = scrollOffset + i;
+        strncpy_P(label, items[itemIdx], sizeof(label));
+        drawMenuRow(u8g2, i, label, itemIdx == selectedIndex, startY);
     }
+    drawMenuScrollbar(u8g2, itemCount, scrollOffset, startY);
 }
 
 void drawProgressBar(U8G2 &u8g2, int x, int y, int width, int height, int percent) {
@@ -64,10 +99,11 @@ void formatUptime(unsigned long ms, char* buffer, int bufSize) {
     unsigned long hours = totalSec / 3600;
     unsigned long minutes = (totalSec % 3600) / 60;
     unsigned long seconds = totalSec % 60;
-    snprintf(buffer, bufSize, "%02lu:%02lu:%02lu", hours, minutes, seconds);
+    snprintf_P(buffer, bufSize, PSTR("%02lu:%02lu:%02lu"), hours, minutes, seconds);
 }
 
 // Get free SRAM by checking gap between heap and stack
+#ifdef __AVR__
 extern unsigned int __heap_start;
 extern void *__brkval;
 
@@ -75,6 +111,11 @@ int freeMemory() {
     int v;
     return (int)&v - (__brkval == 0 ? (int)&__heap_start : (int)__brkval);
 }
+#else
+int freeMemory() {
+    return 0; // Native test build: no AVR heap to measure
+}
+#endif
 
 int clampInt(int value, int minVal, int maxVal) {
     if (value < minVal) return minVal;
@@ -2,14 +2,28 @@
 #define UI_HELPERS_H
 
 #include <U8g2lib.h>
+#include <avr/pgmspace.h>
+
+// Static UI text lives in flash. Menus are fixed-width label tables in PROGMEM;
+// the _P helpers copy one string at a time into a stack buffer for U8g2.
+#define MENU_LABEL_LEN 16 // Longest label + terminator
+typedef char MenuLabel[MENU_LABEL_LEN];
+
+// Draw a flash string (PSTR / PROGMEM), up to UI_TEXT_P_MAX - 1 characters
+#define UI_TEXT_P_MAX 32
+void drawStr_P(U8G2 &u8g2, int x, int y, PGM_P str);
 
 // Draw a title bar at the top of the screen
 void drawTitleBar(U8G2 &u8g2, const char* title);
+void drawTitleBar_P(U8G2 &u8g2, PGM_P title);
 
 // Draw a scrollable menu list with highlight on selected item
 // Returns the first visible item index (for scroll management)
 void drawMenuList(U8G2 &u8g2, const char* const items[], int itemCount,
                   int selectedIndex, int scrollOffset, int startY = 14);
+// Same, labels from a PROGMEM table
+void drawMenuList_P(U8G2 &u8g2, const MenuLabel items[], int itemCount,
+                    int selectedIndex, int scrollOffset, int startY = 14);
 
 // Draw a progress bar
 void drawProgressBar(U8G2 &u8g2, int x, int y, int width, int height, int percent);
@@ -0,0 +1,107 @@
+// SimplePlotter_Firmware/src/utils/event_trace.cpp
+
+#include "event_trace.h"
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <avr/wdt.h>
+
+EventTrace eventTrace; // Global instance definition
+
+#if EVENT_TRACE_ENABLED
+
+#define EVENT_TRACE_MAGIC 0x5E7A
+
+// Not zeroed by the C runtime: contents of the previous run are still there after a
+// watchdog or reset-button reset. The magic pair tells them apart from power-on garbage.
+struct TraceRing {
+    uint16_t magic;
+    uint16_t magic_inv;
+    uint8_t head;   // Next slot to write
+    uint8_t count;  // Valid events (saturates at EVENT_TRACE_SIZE)
+    TraceEvent events[EVENT_TRACE_SIZE];
+};
+static TraceRing ring __attribute__((section(".noinit")));
+static volatile bool dumping = false;
+
+static const char name_boot[] PROGMEM = "boot";
+static const char name_line_rx[] PROGMEM = "line_rx";
+static const char name_sd_read[] PROGMEM = "sd_read";
+static const char name_block_planned[] PROGMEM = "block_planned";
+static const char name_block_start[] PROGMEM = "block_start";
+static const char name_queue_empty[] PROGMEM = "queue_empty";
+static const char name_lcd_begin[] PROGMEM = "lcd_begin";
+static const char name_lcd_end[] PROGMEM = "lcd_end";
+static const char name_endstop[] PROGMEM = "endstop";
+static const char name_wdt_near_miss[] PROGMEM = "wdt_near_miss";
+
+static const char* const event_names[EV_TYPE_COUNT] PROGMEM = {
+    name_boot, name_line_rx, name_sd_read, name_block_planned, name_block_start,
+    name_queue_empty, name_lcd_begin, name_lcd_end, name_endstop, name_wdt_near_miss
+};
+
+void EventTrace::init(uint8_t reset_flags) {
+    bool valid = ring.magic == EVENT_TRACE_MAGIC && ring.magic_inv == (uint16_t)~EVENT_TRACE_MAGIC &&
+                 ring.head < EVENT_TRACE_SIZE && ring.count <= EVENT_TRACE_SIZE;
+    if (!valid) clear();
+    record(EV_BOOT, reset_flags);
+}
+
+void EventTrace::clear() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ring.magic = EVENT_TRACE_MAGIC;
+        ring.magic_inv = (uint16_t)~EVENT_TRACE_MAGIC;
+        ring.head = 0;
+        ring.count = 0;
+    }
+}
+
+void EventTrace::record(TraceEventType type, uint16_t arg) {
+    if (dumping) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TraceEvent& ev = ring.events[ring.head];
+        ev.t_us = micros();
+        ev.type = type;
+        ev.reserved = 0;
+        ev.arg = arg;
+        ring.head = (ring.head + 1) & (EVENT_TRACE_SIZE - 1);
+        if (ring.count < EVENT_TRACE_SIZE) ring.count++;
+    }
+}
+
+void EventTrace::dump() {
+    // Recording pauses while printing (a few hundred ms), so the dump is one consistent
+    // window instead of a ring that is overwritten under the reader
+    dumping = true;
+    uint8_t count = ring.count;
+    uint8_t start = (ring.head - count) & (EVENT_TRACE_SIZE - 1);
+
+    Serial.print(F("// Event trace: "));
+    Serial.print(count);
+    Serial.println(F(" events, oldest first (t_us type arg)"));
+    for (uint8_t i = 0; i < count; i++) {
+        const TraceEvent& ev = ring.events[(start + i) & (EVENT_TRACE_SIZE - 1)];
+        Serial.print(F("// EV "));
+        Serial.print(ev.t_us);
+        Serial.print(' ');
+        if (ev.type < EV_TYPE_COUNT) {
+            Serial.print((const __FlashStringHelper*)pgm_read_ptr(&event_names[ev.type]));
+        } else {
+            Serial.print(ev.type);
+        }
+        Serial.print(' ');
+        Serial.println(ev.arg);
+        wdt_reset();
+    }
+    dumping = false;
+}
+
+#else
+
+void EventTrace::init(uint8_t reset_flags) {}
+void EventTrace::record(TraceEventType type, uint16_t arg) {}
+void EventTrace::clear() {}
+void EventTrace::dump() {
+    Serial.println(F("// Event trace disabled (EVENT_TRACE_ENABLED 0)"));
+}
+
+#endif // EVENT_TRACE_ENABLED
@@ -0,0 +1,53 @@
+// SimplePlotter_Firmware/src/utils/event_trace.h
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+// Post-mortem event trace: the last EVENT_TRACE_SIZE events with a micros()
+// timestamp, in a ring placed in .noinit so a watchdog reset doesn't clear it.
+// Tracepoints are TRACE_EVENT(type, arg) and disappear with EVENT_TRACE_ENABLED 0.
+enum TraceEventType : uint8_t {
+    EV_BOOT = 0,        // arg: MCUSR reset flags (timestamps restart here)
+    EV_LINE_RX,         // Serial line complete, arg: length
+    EV_SD_READ,         // SD line read, arg: read time in us
+    EV_BLOCK_PLANNED,   // Move queued, arg: queue depth after push
+    EV_BLOCK_START,     // Block handed to the steppers, arg: blocks still waiting
+    EV_QUEUE_EMPTY,     // Last block finished, nothing waiting
+    EV_LCD_BEGIN,       // Frame render start, arg: screen
+    EV_LCD_END,         // Frame sent, arg: frame time in us (saturated)
+    EV_ENDSTOP,         // Endstop edge (ISR), arg: axis index << 8 | triggered
+    EV_WDT_NEAR_MISS,   // loop() pass longer than EVENT_TRACE_WDT_WARN_MS, arg: ms
+    EV_TYPE_COUNT
+};
+
+struct TraceEvent {
+    uint32_t t_us;
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t arg;
+};
+
+class EventTrace {
+public:
+    // Call first in setup(): keeps a ring that survived the reset, starts a fresh one otherwise
+    void init(uint8_t reset_flags);
+
+    void record(TraceEventType type, uint16_t arg); // Safe from ISRs
+    void dump();  // Oldest first, as info lines
+    void clear();
+};
+
+extern EventTrace eventTrace; // Global instance
+
+#if EVENT_TRACE_ENABLED
+static_assert((EVENT_TRACE_SIZE & (EVENT_TRACE_SIZE - 1)) == 0 && EVENT_TRACE_SIZE <= 128,
+              "EVENT_TRACE_SIZE must be a power of two <= 128");
+#define TRACE_EVENT(type, arg) eventTrace.record((type), (uint16_t)(arg))
+#else
+#define TRACE_EVENT(type, arg) ((void)sizeof(arg)) // Not evaluated, no code
+#endif
+
+#endif // EVENT_TRACE_H
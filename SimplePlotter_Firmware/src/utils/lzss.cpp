@@ -0,0 +1,82 @@
+// SimplePlotter_Firmware/src/utils/lzss.cpp
+
+#include "lzss.h"
+
+#define LZSS_WINDOW_MASK ((1 << LZSS_WINDOW_BITS) - 1)
+
+static_assert(LZSS_WINDOW_BITS >= 4 && LZSS_WINDOW_BITS <= 9, "Window of 16-512 bytes");
+static_assert(LZSS_LOOKAHEAD_BITS >= 3 && LZSS_LOOKAHEAD_BITS < LZSS_WINDOW_BITS, "Lookahead must be shorter than the window");
+
+uint8_t LzssDecoder::_window[1 << LZSS_WINDOW_BITS];
+LzssDecoder* LzssDecoder::_owner = nullptr;
+
+LzssDecoder::LzssDecoder() : _head(0), _mask(0) {
+    endFrame();
+}
+
+void LzssDecoder::reset() {
+    _owner = this;
+    memset(_window, 0, sizeof(_window)); // heatshrink starts from a zeroed window
+    _head = 0;
+    _mask = 0;
+    endFrame();
+}
+
+void LzssDecoder::release() {
+    if (_owner == this) _owner = nullptr;
+}
+
+void LzssDecoder::endFrame() {
+    _state = TAG;
+    _mask = 0;
+    _acc = 0;
+    _accBits = 0;
+}
+
+int LzssDecoder::_bits(uint8_t n) {
+    while (_accBits < n) {
+        if (_mask == 0) return -1;
+        _acc = (_acc << 1) | ((_in & _mask) ? 1 : 0);
+        _mask >>= 1;
+        _accBits++;
+    }
+    int value = _acc;
+    _acc = 0;
+    _accBits = 0;
+    return value;
+}
+
+uint8_t LzssDecoder::_output(uint8_t c) {
+    _window[_head & LZSS_WINDOW_MASK] = c;
+    _head++;
+    return c;
+}
+
+int LzssDecoder::next() {
+    while (true) {
+        int v;
+        switch (_state) {
+            case TAG:
+                if ((v = _bits(1)) < 0) return -1;
+                _state = v ? LITERAL : OFFSET;
+                break;
+            case LITERAL:
+                if ((v = _bits(8)) < 0) return -1;
+                _state = TAG;
+                return _output(v);
+            case OFFSET:
+                if ((v = _bits(LZSS_WINDOW_BITS)) < 0) return -1;
+                _offset = v + 1;
+                _state = COUNT;
+                break;
+            case COUNT:
+                if ((v = _bits(LZSS_LOOKAHEAD_BITS)) < 0) return -1;
+                _count = v + 1;
+                _state = COPY;
+                break;
+            case COPY:
+                if (--_count == 0) _state = TAG;
+                return _output(_window[(_head - _offset) & LZSS_WINDOW_MASK]);
+        }
+    }
+}
@@ -0,0 +1,49 @@
+// SimplePlotter_Firmware/src/utils/lzss.h
+
+#ifndef LZSS_H
+#define LZSS_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+// Streaming decoder for heatshrink-format LZSS (window LZSS_WINDOW_BITS, lookahead
+// LZSS_LOOKAHEAD_BITS), MSB-first bit stream:
+//   '1' + 8 bits                        literal byte
+//   '0' + W bits (offset - 1) + L bits (count - 1)   copy from the last 2^W output bytes
+// Pull interface: feed() one compressed byte whenever next() returns -1. State is kept
+// between bytes, so a code may span any number of input bytes.
+// All decoders (serial frames, .gcz jobs) share one window. reset() takes it over; a
+// decoder whose window was taken has to be reset again before it decodes anything.
+class LzssDecoder {
+public:
+    LzssDecoder();
+
+    void reset();   // New stream: take the window and clear it
+    void release(); // Stream done: the window is free
+    bool hasWindow() const { return _owner == this; }
+    static bool windowInUse() { return _owner != nullptr; }
+    void feed(uint8_t in) { _in = in; _mask = 0x80; }
+    int next();   // Next decoded byte, or -1 when the fed input is used up
+
+    // Serial frames end on a byte boundary: drop the padding bits but keep the window
+    void endFrame();
+
+private:
+    enum State : uint8_t { TAG, LITERAL, OFFSET, COUNT, COPY };
+
+    static uint8_t _window[1 << LZSS_WINDOW_BITS];
+    static LzssDecoder* _owner;
+    uint16_t _head;   // Bytes output so far (window position = _head & mask)
+    State _state;
+    uint8_t _in;      // Current input byte
+    uint8_t _mask;    // Next bit of _in, 0 = used up
+    uint16_t _acc;    // Bits of a field read so far
+    uint8_t _accBits;
+    uint16_t _offset;
+    uint8_t _count;
+
+    int _bits(uint8_t n); // n-bit field, or -1 if the input ran out first
+    uint8_t _output(uint8_t c);
+};
+
+#endif // LZSS_H
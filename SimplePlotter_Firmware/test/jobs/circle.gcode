@@ -0,0 +1,21 @@
+; 10 mm circle as 16 segments: short blocks that hand over without stopping
+G90
+G1 Z0.5 F600
+G1 X117.000 Y95.000 F2400
+G1 X120.827 Y95.761 F2400
+G1 X124.071 Y97.929 F2400
+G1 X126.239 Y101.173 F2400
+G1 X127.000 Y105.000 F2400
+G1 X126.239 Y108.827 F2400
+G1 X124.071 Y112.071 F2400
+G1 X120.827 Y114.239 F2400
+G1 X117.000 Y115.000 F2400
+G1 X113.173 Y114.239 F2400
+G1 X109.929 Y112.071 F2400
+G1 X107.761 Y108.827 F2400
+G1 X107.000 Y105.000 F2400
+G1 X107.761 Y101.173 F2400
+G1 X109.929 Y97.929 F2400
+G1 X113.173 Y95.761 F2400
+G1 X117.000 Y95.000 F2400
+G1 Z3 F600
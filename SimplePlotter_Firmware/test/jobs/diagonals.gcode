@@ -0,0 +1,8 @@
+; Coordinated X/Y moves at several slopes, so the slower axis is paced by the faster one
+G90
+G1 X137 Y100 F4800
+G1 X127 Y120 F4800
+G1 X107 Y117 F4800
+G1 X97 Y97 F4800
+G1 X117.3 Y95.1 F1200
+G0 X117 Y95
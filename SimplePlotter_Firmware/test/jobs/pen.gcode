@@ -0,0 +1,12 @@
+; Z pen strokes between short dashes, as a hatch fill does
+G90
+G1 Z0.5 F600
+G1 X122 Y95 F3000
+G1 Z3 F600
+G1 Z0.5 F600
+G1 X132 Y100 F3000
+G1 Z3 F600
+G1 Z0.5 F600
+G1 X142 Y95 F3000
+G1 Z3 F600
+G0 X117 Y95
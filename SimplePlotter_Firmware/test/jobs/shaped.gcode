@@ -0,0 +1,7 @@
+; Square and diagonal with input shaping on both axes (M593), switched off again at the end
+M593 F40 D0.1 T0
+G90
+G1 X137 Y95 F6000
+G1 X137 Y115 F6000
+G1 X117 Y95 F6000
+M593 F0
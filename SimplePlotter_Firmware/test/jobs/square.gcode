@@ -0,0 +1,8 @@
+; 20 mm square from the park point (X117 Y95), pen down
+G90
+G1 Z0.5 F600
+G1 X137 Y95 F3000
+G1 X137 Y115 F3000
+G1 X117 Y115 F3000
+G1 X117 Y95 F3000
+G1 Z3 F600
@@ -0,0 +1,171 @@
+// SimplePlotter_Firmware/test/plotter_harness.h
+
+#ifndef PLOTTER_HARNESS_H
+#define PLOTTER_HARNESS_H
+
+// Shared by the native test suites: boots the firmware on the virtual board
+// (lib/native_arduino), talks to it over the simulated UART and records the step
+// and direction pins. Everything runs on the simulator's cycle clock, so a run is
+// the same every time and as fast as the host allows.
+
+#include <Arduino.h>
+#include <native_sim.h>
+#include <string>
+#include <vector>
+#include "../src/config.h"
+#include "../src/motion/axis.h"
+
+static_assert(NATIVE_SD_DETECT_PIN == SD_DETECT_PIN, "platformio.ini [env:native] NATIVE_SD_DETECT_PIN must match config.h");
+
+#ifndef PLOTTER_TEST_DIR
+#define PLOTTER_TEST_DIR "test" // pio test runs from the project directory
+#endif
+
+// One step pulse: the cycle of its rising edge, the axis and the direction pin's
+// meaning at that moment (+1 = towards positive steps)
+struct StepEvent {
+    uint64_t cycle;
+    uint8_t axis;
+    int8_t dir;
+};
+
+class PlotterHarness {
+public:
+    std::vector<StepEvent> steps;
+    bool recording = false;
+
+    static PlotterHarness& instance() {
+        static PlotterHarness h;
+        return h;
+    }
+
+    // setup(), then loop() until the ready token; homes once so absolute moves work
+    bool boot() {
+        if (_booted) return true;
+        nativeSim.watchPins(&PlotterHarness::_onPin);
+        setup();
+        if (!waitFor(READY_TOKEN, 5.0)) return false;
+        _booted = true;
+        return send("G28").find("error") == std::string::npos;
+    }
+
+    // Loop passes until `text` has appeared in the output, or `max_s` of board time
+    bool waitFor(const char* text, double max_s) {
+        double until = nativeSim.seconds() + max_s;
+        size_t from = 0;
+        while (nativeSim.seconds() < until) {
+            pump();
+            size_t at = _out.find(text, from);
+            if (at != std::string::npos) {
+                _out.erase(0, at + strlen(text));
+                return true;
+            }
+            from = _out.size() > strlen(text) ? _out.size() - strlen(text) : 0;
+        }
+        return false;
+    }
+
+    // Everything the firmware sends up to the end of the line that contains `text`, with
+    // "<timeout>" appended when it doesn't come within `max_s` of board time
+    std::string readUntil(const char* text, double max_s) {
+        double until = nativeSim.seconds() + max_s;
+        do {
+            pump();
+            size_t at = _out.find(text);
+            size_t end = at == std::string::npos ? at : _out.find('\n', at);
+            if (end != std::string::npos) {
+                std::string got = _out.substr(0, end + 1);
+                _out.erase(0, end + 1);
+                return got;
+            }
+        } while (nativeSim.seconds() < until);
+        std::string got = _out + "<timeout>";
+        _out.clear();
+        return got;
+    }
+
+    // Lets `s` of board time pass, as a host busy with something else would
+    void idle(double s) {
+        double until = nativeSim.seconds() + s;
+        while (nativeSim.seconds() < until) pump();
+    }
+
+    // Sends one line and returns everything the firmware answered up to its "ok"
+    std::string send(const char* line, double max_s = 600.0) {
+        nativeSim.sendToFirmware(line);
+        nativeSim.sendToFirmware("\n");
+        double until = nativeSim.seconds() + max_s;
+        do { // A blocking command (G28) can overrun max_s in one pass and still finish
+            pump();
+            size_t at = _findOk();
+            if (at != std::string::npos) {
+                std::string reply = _out.substr(0, at);
+                _out.erase(0, at + 4);
+                return reply;
+            }
+        } while (nativeSim.seconds() < until);
+        std::string reply = _out + "<timeout>";
+        _out.clear();
+        return reply;
+    }
+
+    // Streams a G-code file from test/jobs line by line, then M400. Returns the
+    // replies that contained an error, empty when the job ran clean.
+    std::string runJob(const char* name) {
+        std::string path = std::string(PLOTTER_TEST_DIR) + "/jobs/" + name;
+        FILE* f = fopen(path.c_str(), "r");
+        if (!f) return "cannot open " + path;
+        std::string errors;
+        char line[256]; // Comments can be longer than a command line
+        while (fgets(line, sizeof(line), f)) {
+            line[strcspn(line, "\r\n;")] = '\0';
+            if (!line[0]) continue;
+            std::string reply = send(line);
+            if (reply.find("error") != std::string::npos || reply.find("<timeout>") != std::string::npos) {
+                errors += std::string(line) + " -> " + reply;
+            }
+        }
+        fclose(f);
+        std::string reply = send("M400");
+        if (reply.find("<timeout>") != std::string::npos) errors += "M400 -> " + reply;
+        return errors;
+    }
+
+    void pump() {
+        nativeSim.runLoop();
+        _out += nativeSim.takeOutput();
+    }
+
+    static const uint8_t STEP_PINS[AXIS_COUNT];
+    static const uint8_t DIR_PINS[AXIS_COUNT];
+    static const bool INVERT[AXIS_COUNT];
+
+private:
+    bool _booted = false;
+    std::string _out;
+
+    size_t _findOk() const {
+        size_t at = 0;
+        while ((at = _out.find("ok\r\n", at)) != std::string::npos) {
+            if (at == 0 || _out[at - 1] == '\n') return at;
+            at++;
+        }
+        return std::string::npos;
+    }
+
+    static void _onPin(uint8_t pin, uint8_t level, uint64_t cycle) {
+        PlotterHarness& h = instance();
+        if (!h.recording || level != HIGH) return;
+        for (uint8_t a = 0; a < AXIS_COUNT; a++) {
+            if (pin != STEP_PINS[a]) continue;
+            bool high = nativeSim.level(DIR_PINS[a]) == HIGH;
+            h.steps.push_back({cycle, a, (int8_t)(high != INVERT[a] ? 1 : -1)});
+        }
+    }
+};
+
+const uint8_t PlotterHarness::STEP_PINS[AXIS_COUNT] = {X_STEP_PIN, Y_STEP_PIN, Z_STEP_PIN};
+const uint8_t PlotterHarness::DIR_PINS[AXIS_COUNT] = {X_DIR_PIN, Y_DIR_PIN, Z_DIR_PIN};
+const bool PlotterHarness::INVERT[AXIS_COUNT] = {INVERT_X_DIR, INVERT_Y_DIR, INVERT_Z_DIR};
+
+#endif // PLOTTER_HARNESS_H
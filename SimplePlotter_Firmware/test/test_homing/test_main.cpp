@@ -0,0 +1,110 @@
+// SimplePlotter_Firmware/test/test_homing/test_main.cpp
+
+// Homing trials against the endstop simulator (pio test -e native -f test_homing).
+// Each case sends M934, which homes an axis HOMING_RUNS times from random start
+// points through the normal homing code, and checks what it reports:
+//   - every good switch homes, and every dead one is caught
+//   - the homed position repeats within the switch jitter plus a step either way
+//   - no run takes longer than a full-travel approach, backoff and slow touch allow
+//   - the watchdog is fed throughout
+// HOMING_RUNS and HOMING_SEED in the environment change the run count and seed.
+
+#include <unity.h>
+#include <stdlib.h>
+#include "../plotter_harness.h"
+
+#define HOMING_RUNS_DEFAULT   500   // Per case: 2000 runs in all
+#define HOMING_SEED_DEFAULT   1
+#define HOMING_DEAD_PCT       10    // Share of runs with a switch that never closes
+#define HOMING_TIME_MARGIN_S  1.0   // On top of the travel time, for ramps and settling
+
+static PlotterHarness& board = PlotterHarness::instance();
+
+static unsigned long envOr(const char* name, unsigned long fallback) {
+    const char* v = getenv(name);
+    return (v && *v) ? strtoul(v, nullptr, 10) : fallback;
+}
+
+struct TrialReport {
+    float time_max_s;
+    float spread_mm;
+    unsigned false_fail, good;
+    unsigned caught, dead;
+};
+
+// Runs M934 for one axis and parses the lines EndstopSim::runTrials() prints
+static TrialReport runTrials(char axis, const char* params) {
+    TEST_ASSERT_TRUE_MESSAGE(board.boot(), "firmware did not boot and home");
+    unsigned long runs = envOr("HOMING_RUNS", HOMING_RUNS_DEFAULT);
+    unsigned long seed = envOr("HOMING_SEED", HOMING_SEED_DEFAULT);
+    char line[64];
+    snprintf(line, sizeof(line), "M934 %c N%lu S%lu D%d %s", axis, runs, seed, HOMING_DEAD_PCT, params);
+    unsigned long bites = nativeSim.watchdogBites();
+    std::string reply = board.send(line, 1e9); // Thousands of homing runs are hours of board time
+    TEST_ASSERT_EQUAL_MESSAGE(bites, nativeSim.watchdogBites(), "watchdog expired during the trials");
+
+    TrialReport r = {};
+    char key[24];
+    const char* at;
+    snprintf(key, sizeof(key), "M934 %c: homing time", axis);
+    at = strstr(reply.c_str(), key);
+    TEST_ASSERT_TRUE_MESSAGE(at && sscanf(at + strlen(key), " avg %*fs max %fs", &r.time_max_s) == 1, reply.c_str());
+    snprintf(key, sizeof(key), "M934 %c: home at", axis);
+    at = strstr(reply.c_str(), key);
+    TEST_ASSERT_TRUE_MESSAGE(at && sscanf(at + strlen(key), " %*fmm past trigger, spread %fmm", &r.spread_mm) == 1, reply.c_str());
+    snprintf(key, sizeof(key), "M934 %c:", axis);
+    at = strstr(reply.c_str(), "good switches failed"); // The last line, after its own key
+    while (at && at > reply.c_str() && strncmp(at, key, strlen(key)) != 0) at--;
+    TEST_ASSERT_TRUE_MESSAGE(at && sscanf(at + strlen(key), " %u of %u good switches failed, %u of %u dead switches caught",
+                                          &r.false_fail, &r.good, &r.caught, &r.dead) == 4, reply.c_str());
+    TEST_MESSAGE(reply.c_str());
+    return r;
+}
+
+// Longest a good run may take: the farthest start at the fast feedrate, then the
+// backoff and the slow touch over it
+static float timeBound(AxisIndex axis) {
+    const AxisConfig& cfg = axisConfig[axis];
+    float fast = min((float)HOMING_FEEDRATE_FAST, cfg.max_velocity);
+    float slow = min((float)HOMING_FEEDRATE_SLOW, cfg.max_velocity);
+    return cfg.max_pos / fast + HOMING_BACKOFF_MM / fast + 2.0f * HOMING_BACKOFF_MM / slow + HOMING_TIME_MARGIN_S;
+}
+
+static void checkReport(AxisIndex axis, const TrialReport& r, float jitter_mm) {
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%c: good switches that failed to home", axisConfig[axis].name);
+    TEST_ASSERT_EQUAL_MESSAGE(0, r.false_fail, msg);
+    snprintf(msg, sizeof(msg), "%c: dead switches not caught", axisConfig[axis].name);
+    TEST_ASSERT_EQUAL_MESSAGE(r.dead, r.caught, msg);
+    snprintf(msg, sizeof(msg), "%c: homed position spread (mm)", axisConfig[axis].name);
+    float spread = 2.0f * jitter_mm + 2.0f / axisConfig[axis].steps_per_mm;
+    TEST_ASSERT_TRUE_MESSAGE(r.spread_mm <= spread + 0.0005f, msg);
+    snprintf(msg, sizeof(msg), "%c: longest homing %.2fs, bound %.2fs", axisConfig[axis].name, r.time_max_s, timeBound(axis));
+    TEST_ASSERT_TRUE_MESSAGE(r.time_max_s <= timeBound(axis), msg);
+}
+
+//===========================================================================
+// Tests
+//===========================================================================
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// The switch model of config.h: jitter, hysteresis and contact bounce
+static void test_homing_x() { checkReport(AXIS_X, runTrials('X', ""), ENDSTOP_SIM_JITTER_MM); }
+static void test_homing_y() { checkReport(AXIS_Y, runTrials('Y', ""), ENDSTOP_SIM_JITTER_MM); }
+static void test_homing_z() { checkReport(AXIS_Z, runTrials('Z', ""), ENDSTOP_SIM_JITTER_MM); }
+
+// A worn switch: more jitter and bounce, and stray readings on the line
+static void test_homing_noisy_switch() {
+    checkReport(AXIS_X, runTrials('X', "J0.03 B5 R200"), 0.03f);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_homing_x);
+    RUN_TEST(test_homing_y);
+    RUN_TEST(test_homing_z);
+    RUN_TEST(test_homing_noisy_switch);
+    return UNITY_END();
+}
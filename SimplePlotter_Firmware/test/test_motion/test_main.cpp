@@ -0,0 +1,243 @@
+// SimplePlotter_Firmware/test/test_motion/test_main.cpp
+
+// Motion regression suite (pio test -e native -f test_motion). Each job in test/jobs
+// is streamed to the firmware from the same park point; the step and direction pins
+// are recorded and compared with test/golden/<job>.trace:
+//   - final positions and per-axis step counts must match exactly
+//   - the path, as a walk on the step lattice, may stray at most TRACE_MAX_DEVIATION
+//     steps from the golden one (Chebyshev distance to its nearest point nearby)
+//   - the whole job within TRACE_TIME_TOLERANCE of the golden time, and each step
+//     within TRACE_LAG_MS plus that share of its golden time
+// GOLDEN_UPDATE=1 in the environment rewrites the traces instead of checking them;
+// review the diff like any other change to motion behaviour.
+
+#include <unity.h>
+#include <stdlib.h>
+#include "../plotter_harness.h"
+#include "../../src/motion/stepper_control.h"
+
+#define TRACE_MAX_DEVIATION   2     // Steps off the golden path
+#define TRACE_WINDOW          200   // Golden events either side searched for the nearest point
+#define TRACE_TIME_TOLERANCE  0.02  // Share of the golden time
+#define TRACE_LAG_MS          5.0   // Fixed allowance per step on top of that
+
+static const char AXIS_NAMES[AXIS_COUNT + 1] = "XYZ";
+static const char* PARK = "G0 X117 Y95 Z3 F6000";
+
+struct Trace {
+    long start[AXIS_COUNT];
+    long final[AXIS_COUNT];
+    std::vector<StepEvent> steps; // Cycles from the start of the job
+};
+
+static PlotterHarness& board = PlotterHarness::instance();
+
+//===========================================================================
+// Trace files
+//===========================================================================
+
+static std::string goldenPath(const char* job) {
+    std::string name(job);
+    return std::string(PLOTTER_TEST_DIR) + "/golden/" + name.substr(0, name.rfind('.')) + ".trace";
+}
+
+static void countSteps(const Trace& t, long plus[AXIS_COUNT], long minus[AXIS_COUNT]) {
+    for (uint8_t a = 0; a < AXIS_COUNT; a++) plus[a] = minus[a] = 0;
+    for (const StepEvent& e : t.steps) (e.dir > 0 ? plus : minus)[e.axis]++;
+}
+
+// Header lines start with '#'; each step is "<cycles since the previous one> <axis><+|->"
+static bool writeTrace(const char* job, const Trace& t) {
+    FILE* f = fopen(goldenPath(job).c_str(), "w");
+    if (!f) return false;
+    long plus[AXIS_COUNT], minus[AXIS_COUNT];
+    countSteps(t, plus, minus);
+    fprintf(f, "# job %s, cycles at %lu Hz\n", job, (unsigned long)F_CPU);
+    fprintf(f, "# start %ld %ld %ld\n", t.start[0], t.start[1], t.start[2]);
+    fprintf(f, "# final %ld %ld %ld\n", t.final[0], t.final[1], t.final[2]);
+    fprintf(f, "# steps X+%ld X-%ld Y+%ld Y-%ld Z+%ld Z-%ld\n", plus[0], minus[0], plus[1], minus[1], plus[2], minus[2]);
+    fprintf(f, "# end %llu\n", t.steps.empty() ? 0ULL : (unsigned long long)t.steps.back().cycle);
+    uint64_t last = 0;
+    for (const StepEvent& e : t.steps) {
+        fprintf(f, "%llu %c%c\n", (unsigned long long)(e.cycle - last), AXIS_NAMES[e.axis], e.dir > 0 ? '+' : '-');
+        last = e.cycle;
+    }
+    return fclose(f) == 0;
+}
+
+static bool readTrace(const char* job, Trace& t) {
+    FILE* f = fopen(goldenPath(job).c_str(), "r");
+    if (!f) return false;
+    char line[96];
+    uint64_t at = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') {
+            if (!strncmp(line, "# start ", 8)) ok = sscanf(line + 8, "%ld %ld %ld", &t.start[0], &t.start[1], &t.start[2]) == 3;
+            if (!strncmp(line, "# final ", 8)) ok = sscanf(line + 8, "%ld %ld %ld", &t.final[0], &t.final[1], &t.final[2]) == 3;
+            continue;
+        }
+        unsigned long long dt;
+        char axis, dir;
+        ok = sscanf(line, "%llu %c%c", &dt, &axis, &dir) == 3 && strchr(AXIS_NAMES, axis);
+        at += dt;
+        if (ok) t.steps.push_back({at, (uint8_t)(strchr(AXIS_NAMES, axis) - AXIS_NAMES), (int8_t)(dir == '+' ? 1 : -1)});
+    }
+    fclose(f);
+    return ok;
+}
+
+//===========================================================================
+// Running and comparing
+//===========================================================================
+
+static void currentSteps(long out[AXIS_COUNT]) {
+    for (uint8_t a = 0; a < AXIS_COUNT; a++) out[a] = stepperControl.getCurrentSteps((AxisIndex)a);
+}
+
+static void park() {
+    TEST_ASSERT_TRUE_MESSAGE(board.boot(), "firmware did not boot and home");
+    std::string reply = board.send(PARK);
+    TEST_ASSERT_TRUE_MESSAGE(reply.find("error") == std::string::npos, reply.c_str());
+    board.send("M400");
+}
+
+// Recorded steps of whatever `run` does, relative to the cycle it started
+template<class F> static Trace record(F run) {
+    Trace t;
+    currentSteps(t.start);
+    board.steps.clear();
+    board.recording = true;
+    uint64_t begin = nativeSim.cycles();
+    run();
+    board.recording = false;
+    currentSteps(t.final);
+    t.steps = board.steps;
+    for (StepEvent& e : t.steps) e.cycle -= begin;
+    return t;
+}
+
+// Lattice positions after each step, from the trace's start point
+static std::vector<std::vector<long> > walk(const Trace& t) {
+    std::vector<std::vector<long> > path;
+    std::vector<long> pos(t.start, t.start + AXIS_COUNT);
+    for (const StepEvent& e : t.steps) {
+        pos[e.axis] += e.dir;
+        path.push_back(pos);
+    }
+    return path;
+}
+
+static void compare(const char* job, const Trace& got) {
+    if (getenv("GOLDEN_UPDATE")) {
+        TEST_ASSERT_TRUE_MESSAGE(writeTrace(job, got), "cannot write the golden trace");
+        TEST_MESSAGE((std::string("golden trace rewritten: ") + goldenPath(job)).c_str());
+        return;
+    }
+    Trace want;
+    TEST_ASSERT_TRUE_MESSAGE(readTrace(job, want), (std::string("cannot read ") + goldenPath(job)).c_str());
+    char msg[160];
+
+    // Exact: where the job starts and ends, and how many steps each way
+    long gp[AXIS_COUNT], gm[AXIS_COUNT], wp[AXIS_COUNT], wm[AXIS_COUNT];
+    countSteps(got, gp, gm);
+    countSteps(want, wp, wm);
+    for (uint8_t a = 0; a < AXIS_COUNT; a++) {
+        snprintf(msg, sizeof(msg), "%s: %c start", job, AXIS_NAMES[a]);
+        TEST_ASSERT_EQUAL_INT32_MESSAGE(want.start[a], got.start[a], msg);
+        snprintf(msg, sizeof(msg), "%s: %c final position", job, AXIS_NAMES[a]);
+        TEST_ASSERT_EQUAL_INT32_MESSAGE(want.final[a], got.final[a], msg);
+        snprintf(msg, sizeof(msg), "%s: %c+ steps", job, AXIS_NAMES[a]);
+        TEST_ASSERT_EQUAL_INT32_MESSAGE(wp[a], gp[a], msg);
+        snprintf(msg, sizeof(msg), "%s: %c- steps", job, AXIS_NAMES[a]);
+        TEST_ASSERT_EQUAL_INT32_MESSAGE(wm[a], gm[a], msg);
+    }
+    if (want.steps.empty()) return;
+
+    // Path: every point near a point of the golden path at about the same progress
+    std::vector<std::vector<long> > a = walk(got), b = walk(want);
+    long worst = 0;
+    size_t worst_at = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        size_t lo = i > TRACE_WINDOW ? i - TRACE_WINDOW : 0;
+        size_t hi = i + TRACE_WINDOW < b.size() ? i + TRACE_WINDOW : b.size() - 1;
+        long best = -1;
+        for (size_t j = lo; j <= hi && best != 0; j++) {
+            long d = 0;
+            for (uint8_t k = 0; k < AXIS_COUNT; k++) d = max(d, labs(a[i][k] - b[j][k]));
+            if (best < 0 || d < best) best = d;
+        }
+        if (best > worst) {
+            worst = best;
+            worst_at = i;
+        }
+    }
+    snprintf(msg, sizeof(msg), "%s: path deviation at step %lu", job, (unsigned long)worst_at);
+    TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(TRACE_MAX_DEVIATION, worst, msg);
+
+    // Timing: the whole job, then each step against its golden counterpart
+    double want_s = (double)want.steps.back().cycle / F_CPU;
+    double got_s = (double)got.steps.back().cycle / F_CPU;
+    snprintf(msg, sizeof(msg), "%s: job time (s)", job);
+    TEST_ASSERT_DOUBLE_WITHIN_MESSAGE(want_s * TRACE_TIME_TOLERANCE, want_s, got_s, msg);
+    for (size_t i = 0; i < got.steps.size(); i++) {
+        double t_want = (double)want.steps[i].cycle / F_CPU;
+        double t_got = (double)got.steps[i].cycle / F_CPU;
+        if (fabs(t_got - t_want) > TRACE_LAG_MS / 1000.0 + t_want * TRACE_TIME_TOLERANCE) {
+            snprintf(msg, sizeof(msg), "%s: step %lu at %.4fs, golden %.4fs", job, (unsigned long)i, t_got, t_want);
+            TEST_FAIL_MESSAGE(msg);
+        }
+    }
+}
+
+static void runJob(const char* job) {
+    park();
+    std::string errors;
+    Trace t = record([&]() { errors = board.runJob(job); });
+    TEST_ASSERT_TRUE_MESSAGE(errors.empty(), errors.c_str());
+    compare(job, t);
+}
+
+//===========================================================================
+// Tests
+//===========================================================================
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_square() { runJob("square.gcode"); }
+static void test_diagonals() { runJob("diagonals.gcode"); }
+static void test_circle() { runJob("circle.gcode"); }
+static void test_pen() { runJob("pen.gcode"); }
+static void test_shaped() { runJob("shaped.gcode"); }
+
+// StepperControl on its own, as homing and probing drive it: out and back with runBlocking()
+static void test_direct_moves() {
+    park();
+    Trace t = record([]() {
+        long home[AXIS_COUNT];
+        currentSteps(home);
+        stepperControl.setMaxSpeed(AxisTraits<AXIS_X>::MAX_SPEED_STEPS,
+                                   AxisTraits<AXIS_Y>::MAX_SPEED_STEPS,
+                                   AxisTraits<AXIS_Z>::MAX_SPEED_STEPS);
+        stepperControl.setAcceleration(AxisTraits<AXIS_X>::MAX_ACCEL_STEPS,
+                                       AxisTraits<AXIS_Y>::MAX_ACCEL_STEPS,
+                                       AxisTraits<AXIS_Z>::MAX_ACCEL_STEPS);
+        stepperControl.moveTo(home[AXIS_X] + 2400, home[AXIS_Y] + 1000, home[AXIS_Z] - 600);
+        stepperControl.runBlocking();
+        stepperControl.moveTo(home[AXIS_X], home[AXIS_Y], home[AXIS_Z]);
+        stepperControl.runBlocking();
+    });
+    compare("direct", t);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_square);
+    RUN_TEST(test_diagonals);
+    RUN_TEST(test_circle);
+    RUN_TEST(test_pen);
+    RUN_TEST(test_shaped);
+    RUN_TEST(test_direct_moves);
+    return UNITY_END();
+}
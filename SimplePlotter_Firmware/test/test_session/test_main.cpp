@@ -0,0 +1,193 @@
+// SimplePlotter_Firmware/test/test_session/test_main.cpp
+
+// Session capture and replay (pio test -e native -f test_session). A slow host streams
+// test/jobs/circle.gcode under M936, pausing SESSION_HOST_GAP_S after every ok, so the
+// machine runs dry between lines. The capture goes to a temporary SD directory and is
+// then replayed from the same park point with M938, at the original pacing and with
+// S1. Each replay must:
+//   - feed every line, with no errors, and end where the captured session ended
+//   - at the original pacing, take the captured time, see the host's starvation and
+//     no ack slower than the host saw one
+//   - with S1, finish sooner and wait for bytes for less time in all
+
+#include <unity.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../plotter_harness.h"
+#include "../../src/motion/stepper_control.h"
+
+#define SESSION_HOST_GAP_S     0.15  // Host delay after each ok, longer than a circle segment
+#define SESSION_TIME_TOLERANCE 0.02  // Share of the captured time
+#define SESSION_TIME_SLACK_S   0.05  // For the replay's start and final idle checks
+#define SESSION_MAX_S          600.0
+
+static const char* PARK = "G0 X117 Y95 Z3 F6000";
+static const char* JOB = "circle.gcode";
+static const char* CAPTURE = "CIRCLE.SSN";
+
+static PlotterHarness& board = PlotterHarness::instance();
+
+// What the capture saw, for the replays to be held against
+struct Captured {
+    bool done;
+    unsigned long lines;
+    double seconds;     // M936's ok to M400's ok
+    double worst_ack_s; // Longest from starting to send a line to its ok
+    long final[AXIS_COUNT];
+};
+
+static Captured captured;
+
+struct ReplayReport {
+    float seconds;
+    unsigned long lines, errors;
+    float latency_avg_ms, latency_max_ms;
+    unsigned long starvations;
+    float starved_s;
+    long final[AXIS_COUNT];
+};
+
+static void park() {
+    TEST_ASSERT_TRUE_MESSAGE(board.boot(), "firmware did not boot and home");
+    std::string reply = board.send(PARK);
+    TEST_ASSERT_TRUE_MESSAGE(reply.find("error") == std::string::npos, reply.c_str());
+    board.send("M400");
+}
+
+static void currentSteps(long out[AXIS_COUNT]) {
+    for (uint8_t a = 0; a < AXIS_COUNT; a++) out[a] = stepperControl.getCurrentSteps((AxisIndex)a);
+}
+
+// Creates the SD directory once; the card stays in for the whole suite
+static void insertCard() {
+    static char dir[] = "/tmp/plotter_session_XXXXXX";
+    static bool made = false;
+    if (!made) {
+        TEST_ASSERT_NOT_NULL_MESSAGE(mkdtemp(dir), "cannot create the SD directory");
+        made = true;
+    }
+    nativeSim.setSdRoot(dir);
+}
+
+static void capture() {
+    if (captured.done) return;
+    captured.done = true; // Once, even if it fails
+    park();
+    insertCard();
+    char line[64];
+    snprintf(line, sizeof(line), "M936 %s", CAPTURE);
+    std::string reply = board.send(line);
+    TEST_ASSERT_TRUE_MESSAGE(reply.find("capturing session") != std::string::npos, reply.c_str());
+    double start = nativeSim.seconds();
+
+    std::string path = std::string(PLOTTER_TEST_DIR) + "/jobs/" + JOB;
+    FILE* f = fopen(path.c_str(), "r");
+    TEST_ASSERT_NOT_NULL_MESSAGE(f, path.c_str());
+    char buf[256];
+    while (fgets(buf, sizeof(buf), f)) {
+        buf[strcspn(buf, "\r\n;")] = '\0';
+        if (!buf[0]) continue;
+        double sent = nativeSim.seconds();
+        reply = board.send(buf);
+        TEST_ASSERT_TRUE_MESSAGE(reply.find("error") == std::string::npos && reply.find("<timeout>") == std::string::npos,
+                                 (std::string(buf) + " -> " + reply).c_str());
+        captured.worst_ack_s = max(captured.worst_ack_s, nativeSim.seconds() - sent);
+        captured.lines++;
+        board.idle(SESSION_HOST_GAP_S);
+    }
+    fclose(f);
+    double sent = nativeSim.seconds();
+    reply = board.send("M400", SESSION_MAX_S);
+    TEST_ASSERT_TRUE_MESSAGE(reply.find("<timeout>") == std::string::npos, reply.c_str());
+    captured.worst_ack_s = max(captured.worst_ack_s, nativeSim.seconds() - sent);
+    captured.lines++;
+    captured.seconds = nativeSim.seconds() - start;
+    currentSteps(captured.final);
+
+    reply = board.send("M937");
+    unsigned long bytes = 0, acks = 0;
+    const char* at = strstr(reply.c_str(), "M937: session closed,");
+    TEST_ASSERT_TRUE_MESSAGE(at && sscanf(at, "M937: session closed, %lu bytes received, %lu acks", &bytes, &acks) == 2, reply.c_str());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(captured.lines, acks, "acks captured (the job and M400; M937 answers after closing)");
+}
+
+// Replays the capture from the park point and parses the three report lines
+static ReplayReport replay(bool fast) {
+    capture();
+    park();
+    char line[64];
+    snprintf(line, sizeof(line), "M938 %s%s", CAPTURE, fast ? " S1" : "");
+    std::string reply = board.send(line);
+    TEST_ASSERT_TRUE_MESSAGE(reply.find("M938: replaying") != std::string::npos, reply.c_str());
+    std::string report = board.readUntil("M938: waited for bytes", SESSION_MAX_S);
+    TEST_ASSERT_TRUE_MESSAGE(report.find("<timeout>") == std::string::npos, "replay did not finish");
+    board.send("M400");
+
+    ReplayReport r = {};
+    const char* at = strstr(report.c_str(), "M938: done in");
+    TEST_ASSERT_TRUE_MESSAGE(at && sscanf(at, "M938: done in %fs, %lu lines, %lu errors", &r.seconds, &r.lines, &r.errors) == 3, report.c_str());
+    at = strstr(report.c_str(), "M938: ack latency");
+    TEST_ASSERT_TRUE_MESSAGE(at && sscanf(at, "M938: ack latency avg %fms max %fms", &r.latency_avg_ms, &r.latency_max_ms) == 2, report.c_str());
+    at = strstr(report.c_str(), "M938: waited for bytes");
+    TEST_ASSERT_TRUE_MESSAGE(at && sscanf(at, "M938: waited for bytes %lu times, %fs", &r.starvations, &r.starved_s) == 2, report.c_str());
+    currentSteps(r.final);
+
+    char msg[160];
+    snprintf(msg, sizeof(msg), "M938%s: %.2fs, %lu lines, %lu errors, ack avg %.1fms max %.1fms, starved %lu times for %.2fs",
+             fast ? " S1" : "", r.seconds, r.lines, r.errors, r.latency_avg_ms, r.latency_max_ms, r.starvations, r.starved_s);
+    TEST_MESSAGE(msg);
+    return r;
+}
+
+static void checkComplete(const ReplayReport& r) {
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(captured.lines + 1, r.lines, "lines replayed (M937 is in the capture)");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, r.errors, "errors in the replay");
+    TEST_ASSERT_TRUE_MESSAGE(r.latency_avg_ms <= r.latency_max_ms, "average ack latency above the worst");
+    static const char NAMES[] = "XYZ";
+    char msg[48];
+    for (uint8_t a = 0; a < AXIS_COUNT; a++) {
+        snprintf(msg, sizeof(msg), "%c final position", NAMES[a]);
+        TEST_ASSERT_EQUAL_INT32_MESSAGE(captured.final[a], r.final[a], msg);
+    }
+}
+
+//===========================================================================
+// Tests
+//===========================================================================
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static ReplayReport paced;
+
+static void test_capture() {
+    capture();
+    char msg[96];
+    snprintf(msg, sizeof(msg), "captured %lu lines in %.2fs, slowest ok %.1fms",
+             captured.lines, captured.seconds, captured.worst_ack_s * 1000.0);
+    TEST_MESSAGE(msg);
+}
+
+static void test_replay_paced() {
+    paced = replay(false);
+    checkComplete(paced);
+    TEST_ASSERT_DOUBLE_WITHIN_MESSAGE(captured.seconds * SESSION_TIME_TOLERANCE + SESSION_TIME_SLACK_S,
+                                      captured.seconds, paced.seconds, "replay time against the capture (s)");
+    TEST_ASSERT_TRUE_MESSAGE(paced.starvations > 0, "the slow host's gaps were not seen as starvation");
+    TEST_ASSERT_TRUE_MESSAGE(paced.latency_max_ms <= captured.worst_ack_s * 1000.0, "an ack slower than the host saw");
+}
+
+static void test_replay_fast() {
+    ReplayReport fast = replay(true);
+    checkComplete(fast);
+    TEST_ASSERT_TRUE_MESSAGE(fast.seconds < paced.seconds, "S1 no faster than the original pacing");
+    TEST_ASSERT_TRUE_MESSAGE(fast.starved_s < paced.starved_s, "S1 waited for bytes no less");
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_capture);
+    RUN_TEST(test_replay_paced);
+    RUN_TEST(test_replay_fast);
+    return UNITY_END();
+}